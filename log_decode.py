@@ -0,0 +1,383 @@
+import argparse
+import base64
+import re
+import struct
+import sys
+import time
+import zlib
+
+# 与 src/managers/log/log_binary.h 保持一致
+MAGIC = b'HLOG'
+VERSION = 1
+HEADER_SIZE = 16
+RECORD_HDR = 14
+ANCHOR_TEXT = 'HydroSense binary log v1'
+
+RECORD_TYPE_LOG = 0
+RECORD_TYPE_ANCHOR = 1
+FLAG_INLINE_MODULE = 0x08
+
+LEVEL_NAMES = ['ERROR', 'WARN', 'INFO', 'DEBUG']
+
+# 与 src/managers/log/log_store.cpp 保持一致
+STORE_SECTOR_SIZE = 4096
+STORE_SECTOR_MAGIC = 0x31534C48
+STORE_SECTOR_HDR = 16
+STORE_FRAME_HDR = 4
+
+# 与 src/managers/log/log_archive.h / log_lzss.h 保持一致
+ARCHIVE_MAGIC = b'HLZA'
+ARCHIVE_VERSION = 1
+ARCHIVE_HEADER_SIZE = 16
+ARCHIVE_BLOCK_HDR = 4
+ARCHIVE_SOURCE_SECTORS = 1
+ARCHIVE_SOURCE_FILE = 2
+LZSS_MIN_MATCH = 2
+DUMP_RE = re.compile(r'-----BEGIN HLZA SEGMENT (\d+) (\d+)-----(.*?)-----END HLZA SEGMENT crc32=([0-9a-fA-F]{8})-----', re.S)
+
+# C 格式说明符: flags, width, precision, length, conversion
+SPEC_RE = re.compile(r'%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d*))?(hh|h|ll|l|j|q|z|t|L)?([diouxXeEfFgGaAcspn%])')
+
+
+class ElfImage:
+    """
+    最小化的 ELF32 读取器，只用于按虚拟地址读取只读数据段中的字符串。
+    """
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+        if self.data[:4] != b'\x7fELF' or self.data[4] != 1:
+            raise ValueError(f"'{path}' 不是 ELF32 文件")
+
+        e_shoff, = struct.unpack_from('<I', self.data, 0x20)
+        e_shentsize, e_shnum = struct.unpack_from('<HH', self.data, 0x2E)
+
+        self.sections = []
+        for i in range(e_shnum):
+            off = e_shoff + i * e_shentsize
+            _, sh_type, sh_flags, sh_addr, sh_offset, sh_size = struct.unpack_from('<IIIIII', self.data, off)
+            # SHT_PROGBITS 且 SHF_ALLOC
+            if sh_type == 1 and (sh_flags & 0x2) and sh_addr != 0:
+                self.sections.append((sh_addr, sh_size, sh_offset))
+
+    def read_cstr(self, addr):
+        for sh_addr, sh_size, sh_offset in self.sections:
+            if sh_addr <= addr < sh_addr + sh_size:
+                start = sh_offset + (addr - sh_addr)
+                end = self.data.index(b'\0', start)
+                return self.data[start:end].decode('utf-8', errors='replace')
+        return None
+
+
+def decode_args(fmt, payload):
+    """
+    按格式字符串的说明符顺序从参数区取出参数，返回 Python 可用的格式串与参数元组。
+    """
+    out_fmt = []
+    args = []
+    pos = 0
+    last = 0
+
+    def take(size, code):
+        nonlocal pos
+        if pos + size > len(payload):
+            raise IndexError
+        value, = struct.unpack_from(code, payload, pos)
+        pos += size
+        return value
+
+    for m in SPEC_RE.finditer(fmt):
+        out_fmt.append(fmt[last:m.start()].replace('%', '%%'))
+        last = m.end()
+        flags, width, precision, length, conv = m.groups()
+
+        if conv == '%':
+            out_fmt.append('%%')
+            continue
+
+        try:
+            spec = '%' + flags
+            if width == '*':
+                args.append(take(4, '<i'))
+            if width:
+                spec += width
+            if precision is not None:
+                if precision == '*':
+                    args.append(take(4, '<i'))
+                spec += '.' + precision
+
+            if conv in 'diouxXc':
+                # ESP32 上 long/size_t 为 32 位，只有 ll/j/q 为 64 位
+                if length in ('ll', 'j', 'q'):
+                    value = take(8, '<q' if conv in 'di' else '<Q')
+                else:
+                    value = take(4, '<i' if conv in 'di' else '<I')
+                if conv == 'c':
+                    value = chr(value & 0xFF)
+                args.append(value)
+                spec += {'i': 'd', 'u': 'd'}.get(conv, conv)
+            elif conv in 'eEfFgGaA':
+                args.append(take(8, '<d'))
+                spec += 'e' if conv in 'aA' else conv
+            elif conv == 's':
+                slen = take(1, '<B')
+                args.append(payload[pos:pos + slen].decode('utf-8', errors='replace'))
+                pos += slen
+                spec += 's'
+            elif conv == 'p':
+                args.append(take(4, '<I'))
+                spec = '0x%08x'
+            else:
+                spec = '?'
+            out_fmt.append(spec)
+        except IndexError:
+            # 设备端参数区满时截断，剩余参数显示为 '?'
+            out_fmt.append('?')
+
+    out_fmt.append(fmt[last:].replace('%', '%%'))
+    return ''.join(out_fmt), tuple(args)
+
+
+def format_time(tick_ms, anchor):
+    if anchor is not None:
+        anchor_tick, anchor_unix = anchor
+        ts = anchor_unix + (tick_ms - anchor_tick) / 1000.0
+        return time.strftime('%Y-%m-%d %H:%M:%S', time.localtime(ts))
+    seconds = tick_ms // 1000
+    return f'+{seconds // 3600:02d}:{seconds // 60 % 60:02d}:{seconds % 60:02d}'
+
+
+def decode_stream(data, elf, out):
+    """
+    解码一个二进制日志文件（可以是多个文件按顺序拼接的结果）。
+    """
+    pos = 0
+    anchor = None
+
+    while pos < len(data):
+        if data[pos:pos + 4] == MAGIC:
+            version = data[pos + 4]
+            anchor_addr, = struct.unpack_from('<I', data, pos + 8)
+            if version != VERSION:
+                print(f'警告: 日志版本 {version} 与解码器版本 {VERSION} 不一致', file=sys.stderr)
+            if elf.read_cstr(anchor_addr) != ANCHOR_TEXT:
+                print('警告: ELF 与日志不匹配，格式字符串可能解析错误', file=sys.stderr)
+            pos += HEADER_SIZE
+            continue
+
+        if pos + RECORD_HDR > len(data):
+            print(f'警告: 偏移 {pos} 处记录不完整，已忽略', file=sys.stderr)
+            break
+
+        type_level, arg_len = data[pos], data[pos + 1]
+        tick_ms, fmt_addr, module_addr = struct.unpack_from('<III', data, pos + 2)
+        payload = data[pos + RECORD_HDR:pos + RECORD_HDR + arg_len]
+        pos += RECORD_HDR + arg_len
+
+        rec_type = type_level >> 4
+        if rec_type == RECORD_TYPE_ANCHOR:
+            anchor = (tick_ms, fmt_addr)
+            continue
+        if rec_type != RECORD_TYPE_LOG:
+            print(f'警告: 未知记录类型 {rec_type}，停止解码', file=sys.stderr)
+            break
+
+        if type_level & FLAG_INLINE_MODULE:
+            mlen = payload[0]
+            module = payload[1:1 + mlen].decode('utf-8', errors='replace')
+            payload = payload[1 + mlen:]
+        else:
+            module = elf.read_cstr(module_addr) or f'?{module_addr:08x}'
+
+        fmt = elf.read_cstr(fmt_addr)
+        if fmt is None:
+            message = f'<unknown format 0x{fmt_addr:08x}> {payload.hex()}'
+        else:
+            py_fmt, args = decode_args(fmt, payload)
+            try:
+                message = py_fmt % args
+            except (TypeError, ValueError):
+                message = f'{fmt} {args}'
+
+        level = LEVEL_NAMES[type_level & 0x03]
+        out.write(f'[{format_time(tick_ms, anchor)}][{level}][{module}] {message}\n')
+
+
+def read_partition(data):
+    """
+    按扇区序号顺序遍历日志分区镜像中的记录帧，返回 [(tag, payload), ...]。
+    """
+    sectors = []
+    for base in range(0, len(data) - STORE_SECTOR_HDR + 1, STORE_SECTOR_SIZE):
+        magic, seq, tag, crc = struct.unpack_from('<IIII', data, base)
+        if magic == STORE_SECTOR_MAGIC and crc == zlib.crc32(data[base:base + 12]):
+            sectors.append((seq, tag, base))
+    sectors.sort()
+
+    records = []
+    for seq, tag, base in sectors:
+        pos = base + STORE_SECTOR_HDR
+        end = base + STORE_SECTOR_SIZE
+        while pos + STORE_FRAME_HDR <= end:
+            length, crc = struct.unpack_from('<HH', data, pos)
+            payload = data[pos + STORE_FRAME_HDR:pos + STORE_FRAME_HDR + length]
+            if length in (0, 0xFFFF) or len(payload) != length or zlib.crc32(payload) & 0xFFFF != crc:
+                break
+            records.append((tag, payload))
+            pos += (STORE_FRAME_HDR + length + 3) & ~3
+    return records
+
+
+def decode_partition(data, elf, out):
+    """
+    解码日志分区镜像（esptool.py read_flash 读出的 `logs` 分区）。
+    扇区格式标记为0的是文本日志，否则为二进制记录，标记值为锚点字符串地址。
+    """
+    binary = bytearray()
+    warned = False
+    for tag, payload in read_partition(data):
+        if tag == 0:
+            if binary:
+                decode_stream(bytes(binary), elf, out)
+                binary.clear()
+            out.write(payload.decode('utf-8', errors='replace') + '\n')
+            continue
+        if not warned and elf.read_cstr(tag) != ANCHOR_TEXT:
+            print('警告: ELF 与日志分区不匹配，格式字符串可能解析错误', file=sys.stderr)
+            warned = True
+        binary += payload
+    if binary:
+        decode_stream(bytes(binary), elf, out)
+
+
+def lzss_decompress(data, window_bits, length_bits):
+    """
+    解压一个 LZSS 块（位流格式见 log_lzss.h）。
+    """
+    out = bytearray()
+    acc = int.from_bytes(data, 'big')
+    remaining = len(data) * 8
+    backref_bits = 1 + window_bits + length_bits
+
+    while remaining > 0:
+        literal = (acc >> (remaining - 1)) & 1
+        need = 9 if literal else backref_bits
+        if remaining < need:
+            break
+        remaining -= need
+        token = (acc >> remaining) & ((1 << need) - 1)
+        if literal:
+            out.append(token & 0xFF)
+        else:
+            dist = ((token >> length_bits) & ((1 << window_bits) - 1)) + 1
+            count = (token & ((1 << length_bits) - 1)) + LZSS_MIN_MATCH
+            for _ in range(count):
+                out.append(out[-dist])
+    return bytes(out)
+
+
+def read_archive(data):
+    """
+    解压一个归档分段，返回 (来源, 格式标记, 原始数据)。截断的最后一块被忽略。
+    """
+    if data[:4] != ARCHIVE_MAGIC:
+        raise ValueError('不是 HLZA 归档分段')
+    version, window_bits, length_bits, source = data[4], data[5], data[6], data[7]
+    tag, = struct.unpack_from('<I', data, 8)
+    if version != ARCHIVE_VERSION:
+        print(f'警告: 归档版本 {version} 与解码器版本 {ARCHIVE_VERSION} 不一致', file=sys.stderr)
+
+    raw = bytearray()
+    pos = ARCHIVE_HEADER_SIZE
+    while pos + ARCHIVE_BLOCK_HDR <= len(data):
+        comp_len, raw_len = struct.unpack_from('<HH', data, pos)
+        block = data[pos + ARCHIVE_BLOCK_HDR:pos + ARCHIVE_BLOCK_HDR + comp_len]
+        if len(block) != comp_len:
+            print(f'警告: 偏移 {pos} 处压缩块不完整，已忽略', file=sys.stderr)
+            break
+        plain = lzss_decompress(block, window_bits, length_bits)
+        if len(plain) != raw_len:
+            print(f'警告: 偏移 {pos} 处压缩块长度不符 ({len(plain)} != {raw_len})', file=sys.stderr)
+        raw += plain
+        pos += ARCHIVE_BLOCK_HDR + comp_len
+    return source, tag, bytes(raw)
+
+
+def extract_archive_dumps(data):
+    """
+    从 `log archive dump <n>` 的串口输出中提取分段；输入本身就是分段文件时原样返回。
+    """
+    if data[:4] == ARCHIVE_MAGIC:
+        return [data]
+    segments = []
+    for match in DUMP_RE.finditer(data.decode('utf-8', errors='replace')):
+        index, size, body, crc = match.groups()
+        segment = base64.b64decode(''.join(body.split()))
+        if len(segment) != int(size) or zlib.crc32(segment) != int(crc, 16):
+            print(f'警告: 分段 {index} 长度或CRC校验失败，已跳过', file=sys.stderr)
+            continue
+        segments.append(segment)
+    return segments
+
+
+def decode_archive(data, elf, out):
+    """
+    解码归档分段文件或包含分段转储的串口日志。
+    """
+    for segment in extract_archive_dumps(data):
+        source, tag, raw = read_archive(segment)
+        if source == ARCHIVE_SOURCE_SECTORS:
+            decode_partition(raw, elf, out)
+        elif tag != 0:
+            decode_stream(raw, elf, out)
+        else:
+            out.write(raw.decode('utf-8', errors='replace'))
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(
+        description='HydroSense 二进制日志解码器',
+        formatter_class=argparse.RawTextHelpFormatter
+    )
+    parser.add_argument(
+        '--elf',
+        required=True,
+        help='生成日志的固件 ELF 文件\n'
+             '(例如 .pio/build/hydrosense_esp32s3_n16r8/firmware.elf)'
+    )
+    parser.add_argument(
+        'files',
+        nargs='*',
+        help='二进制日志文件 (system.blog)，按时间先后给出。\n'
+             '省略时从标准输入读取。'
+    )
+    parser.add_argument(
+        '--partition',
+        action='store_true',
+        help='输入为日志分区镜像，例如:\n'
+             'esptool.py read_flash 0x80000 0x80000 logs.bin'
+    )
+
+    parser.add_argument(
+        '--archive',
+        action='store_true',
+        help='输入为压缩归档分段 (/spiffs/logarc/NNNNN.lzs)，\n'
+             '或包含 `log archive dump <n>` 输出的串口日志'
+    )
+
+    args = parser.parse_args()
+    elf = ElfImage(args.elf)
+
+    if args.archive:
+        decode = decode_archive
+    elif args.partition:
+        decode = decode_partition
+    else:
+        decode = decode_stream
+    if args.files:
+        for path in args.files:
+            with open(path, 'rb') as f:
+                decode(f.read(), elf, sys.stdout)
+    else:
+        decode(sys.stdin.buffer.read(), elf, sys.stdout)
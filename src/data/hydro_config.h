@@ -19,6 +19,19 @@ typedef struct {
     uint16_t humidity_wet;      ///< 湿润阈值 (ADC值, 用于百分比计算下限)
     uint16_t humidity_dry;      ///< 干燥阈值 (ADC值, 用于百分比计算上限)
     char plant_type[32];        ///< 植物类型 (如"绿萝", "多肉")
+    uint8_t filter_window;      ///< 湿度中位数/Hampel窗口长度 (1-9, 1表示不滤波)
+    float hampel_k;             ///< Hampel离群阈值倍数 (0表示不剔除)
+    uint16_t hysteresis;        ///< 浇水判定迟滞带宽度 (ADC值)
+    uint16_t daily_budget_s;    ///< 每日水泵运行时间上限 (秒, 0表示不限)
+    uint16_t flow_ml_min;       ///< 水泵在 power 占空比下的流量 (ml/min, 0表示未标定)
+    uint16_t daily_budget_ml;   ///< 每日浇水量上限 (ml, 0表示不限, 需标定流量)
+    uint8_t quiet_start_h;      ///< 静默时段开始 (0-23时, 本地时间)
+    uint8_t quiet_end_h;        ///< 静默时段结束 (0-23时, 与开始相同表示不启用)
+    uint8_t adaptive;           ///< 自适应浇水: 0=固定时长, 1=按学习到的土壤响应计算时长与占空比
+    uint16_t target;            ///< 自适应浇水的目标读数 (ADC值, 目标带宽度为 hysteresis)
+    uint8_t pulse_count;        ///< 分段浇水的脉冲数 (1表示一次连续浇完, 本次剂量平均分到各脉冲)
+    uint16_t pulse_gap_s;       ///< 脉冲之间的渗透间隙 (秒)
+    uint8_t pulse_sample;       ///< 间隙末尾采样湿度, 达到 target 时提前结束: 0=不采样, 1=采样
 } hydro_watering_config_t;
 
 /**
@@ -48,8 +61,37 @@ typedef struct {
     bool ntp_enabled;           ///< 是否启用NTP时间同步
     char timezone[32];          ///< 时区 (如 "CST-8")
     char ntp_server[64];        ///< NTP服务器地址
+    char log_levels[128];       ///< 模块日志级别表 (如 "*=INFO,Display=WARN"，空表示编译默认值)
+    uint8_t run_sleep;          ///< RUN模式两次检查之间: 0=保持唤醒轮询, 1=定时深度睡眠, 2=ULP哨兵值守
+    uint16_t check_max_s;       ///< 按干燥速率预测延长检查间隔的上限 (秒，0=固定间隔)
+    uint8_t check_margin_pct;   ///< 预测的安全余量：在预计越过阈值前此比例的时间处检查
 } hydro_system_config_t;
 
+/**
+ * @brief 电池模型配置
+ */
+typedef struct {
+    char soc_curve[96];               ///< 放电曲线 "mV:百分比,..." (空表示内置锂电池曲线)
+    uint16_t capacity_mah;            ///< 电池容量 (mAh)
+    uint16_t internal_resistance_mohm; ///< 电池内阻 (毫欧，用于负载压降补偿)
+} hydro_battery_config_t;
+
+/**
+ * @brief 能耗账本的各项估计电流与电源轨保持时间
+ */
+typedef struct {
+    uint32_t sensor_ua;         ///< 传感器电源 (uA)
+    uint32_t boost_ua;          ///< 12V升压模块空载 (uA)
+    uint32_t screen_ua;         ///< 墨水屏电源 (uA)
+    uint32_t pump_ua;           ///< 水泵运行，在升压模块之上 (uA)
+    uint32_t cpu_ua;            ///< 主CPU唤醒 (uA)
+    uint32_t wifi_ua;           ///< WiFi射频工作，在CPU之上 (uA)
+    uint32_t sleep_ua;          ///< 深度睡眠整板电流 (uA)
+    uint16_t sensor_linger_ms;  ///< 最后一个租约释放后传感器电源的保持时间 (ms)
+    uint16_t boost_linger_ms;   ///< 12V升压模块的保持时间 (ms)
+    uint16_t screen_linger_ms;  ///< 墨水屏电源的保持时间 (ms)
+} hydro_power_config_t;
+
 /**
  * @brief HydroSense完整配置结构
  */
@@ -58,6 +100,8 @@ typedef struct {
     hydro_wifi_config_t wifi;         ///< WiFi配置
     hydro_llm_config_t llm;           ///< LLM配置
     hydro_system_config_t system;     ///< 系统配置
+    hydro_battery_config_t battery;   ///< 电池模型配置
+    hydro_power_config_t power;       ///< 能耗账本配置
 } hydro_config_t;
 
 #endif // HYDRO_CONFIG_H
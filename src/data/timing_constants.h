@@ -115,6 +115,225 @@ extern "C" {
  */
 #define POWER_SHUTDOWN_DELAY_MS 50
 
+// =============================================================================
+// Sensor Timing Constants
+// =============================================================================
+
+/**
+ * @brief 传感器上电后的最长稳定等待时间 (ms)
+ * @details 自适应预热的硬上限，等于原先固定的200ms延时
+ */
+#define SENSOR_SETTLE_MAX_MS 200
+
+/**
+ * @brief 自适应预热的轮询间隔 (ms)
+ * @details 上电后每隔此时间快速采样一次，判断读数是否收敛
+ */
+#define SENSOR_SETTLE_POLL_MS 5
+
+/**
+ * @brief 预热收敛容差 (ADC计数)
+ * @details 相邻两次快速采样之差不超过此值视为一次收敛
+ */
+#define SENSOR_SETTLE_TOLERANCE 12
+
+/**
+ * @brief 预热收敛所需的连续收敛次数
+ */
+#define SENSOR_SETTLE_STABLE_COUNT 3
+
+/**
+ * @brief 传感器历史记录间隔 (ms)
+ * @details RUN模式下每隔此时间向时间序列存储追加一次湿度与电池电压
+ */
+#define SENSOR_HISTORY_INTERVAL_MS 300000
+
+/**
+ * @brief 浇水后等待湿度读数下降的时间窗口 (ms)
+ * @details 窗口内读数未下降 SENSOR_HEALTH_RESPONSE_DROP 计为一次无响应浇水
+ */
+#define SENSOR_HEALTH_RESPONSE_WINDOW_MS 600000
+
+/**
+ * @brief 浇水无响应故障下自动浇水的重试间隔 (ms)
+ */
+#define SENSOR_HEALTH_NO_RESPONSE_RETRY_MS 21600000
+
+/**
+ * @brief 湿度滤波窗口的有效期 (ms)
+ * @details 从深度睡眠恢复时，距上次样本超过此时间则丢弃窗口内的旧样本
+ */
+#define HUMIDITY_FILTER_STALE_MS 21600000
+
+/**
+ * @brief 低电量时RUN模式的湿度检查间隔 (ms)
+ * @details 电池进入 LOW 等级后降低采样频率以延长续航
+ */
+#define RUN_CHECK_INTERVAL_LOW_BATTERY_MS 30000
+
+/**
+ * @brief 电量严重不足时RUN模式的湿度检查间隔 (ms)
+ */
+#define RUN_CHECK_INTERVAL_CRITICAL_BATTERY_MS 120000
+
+/**
+ * @brief 低电量时RUN模式的定时全屏刷新间隔 (ms)
+ */
+#define RUN_FULL_REFRESH_LOW_BATTERY_MS 7200000
+
+/**
+ * @brief 电量严重不足时RUN模式的定时全屏刷新间隔 (ms)
+ */
+#define RUN_FULL_REFRESH_CRITICAL_BATTERY_MS 21600000
+
+/**
+ * @brief RUN模式深度睡眠的检查间隔 (ms)
+ * @details system.run_sleep=1 时每个周期唤醒、检查湿度后再次睡眠的间隔，与历史记录间隔一致
+ */
+#define RUN_SLEEP_INTERVAL_MS 300000
+
+/**
+ * @brief 低电量时RUN模式深度睡眠的检查间隔 (ms)
+ */
+#define RUN_SLEEP_INTERVAL_LOW_BATTERY_MS 900000
+
+/**
+ * @brief 电量严重不足时RUN模式深度睡眠的检查间隔 (ms)
+ */
+#define RUN_SLEEP_INTERVAL_CRITICAL_BATTERY_MS 1800000
+
+/**
+ * @brief RUN模式深度睡眠周期内等待屏幕刷新完成的超时 (ms)
+ */
+#define RUN_SLEEP_REFRESH_TIMEOUT_MS 5000
+
+// =============================================================================
+// Pump Profile Timing Constants
+// =============================================================================
+
+/**
+ * @brief 水泵软启动时长 (ms)
+ * @details 占空比从0线性升到目标值，降低冲击电流造成的电池电压跌落
+ */
+#define ACTUATOR_SOFT_START_MS 300
+
+/**
+ * @brief 定时运行结束前的降速时长 (ms)
+ */
+#define ACTUATOR_SOFT_STOP_MS 100
+
+/**
+ * @brief 斜坡段的占空比更新步长 (ms)
+ */
+#define ACTUATOR_RAMP_TICK_MS 10
+
+/**
+ * @brief 分段浇水的最短脉冲时长 (ms)
+ * @details 剂量不足以分成配置的脉冲数时减少脉冲数，避免脉冲只剩软启动
+ */
+#define WATERING_PROGRAM_MIN_PULSE_MS 800
+
+// =============================================================================
+// Adaptive Watering Timing Constants
+// =============================================================================
+
+/**
+ * @brief 自适应浇水的最短时长 (ms)
+ * @details 剂量更小时降低占空比而不是继续缩短时长
+ */
+#define ADAPTIVE_WATERING_MIN_MS 1000
+
+/**
+ * @brief 自适应浇水的最长时长 (ms)
+ * @details 不足的部分留给下一次浇水；配置的固定时长更长时以固定时长为上限
+ */
+#define ADAPTIVE_WATERING_MAX_MS 10000
+
+/**
+ * @brief 浇水后等待渗透再观测响应的时间 (ms)
+ */
+#define ADAPTIVE_WATERING_SOAK_MS 600000
+
+// =============================================================================
+// Predictive Check Timing Constants
+// =============================================================================
+
+/**
+ * @brief 干燥速率观测的最短时间跨度 (ms)
+ * @details 两次湿度检查相距更近时继续累积，避免把读数噪声当作速率
+ */
+#define DRYING_MODEL_MIN_SPAN_MS 900000
+
+/**
+ * @brief 浇水后土壤干燥较快的时间窗口 (ms)
+ * @details 窗口内的速率按单独学习的倍数修正
+ */
+#define DRYING_MODEL_POST_WATERING_MS 21600000
+
+/**
+ * @brief 预测越过阈值时间的积分步长 (ms)
+ */
+#define DRYING_MODEL_PREDICT_STEP_MS 600000
+
+// =============================================================================
+// Loop Monitor Timing Constants
+// =============================================================================
+
+/**
+ * @brief 主循环单次迭代间隔预算 (ms)
+ * @details 超过此值的迭代间隔计为超限；LVGL刷新的精度取决于此（泵由定时器停止）
+ */
+#define LOOP_JITTER_BUDGET_MS 20
+
+/**
+ * @brief run jitter bench 默认持续时间 (ms)
+ */
+#define TEST_JITTER_BENCH_DURATION_MS 10000
+
+/**
+ * @brief run jitter bench 中的采集周期 (ms)
+ */
+#define TEST_JITTER_BENCH_INTERVAL_MS 1000
+
+// =============================================================================
+// ULP Sentinel Timing Constants
+// =============================================================================
+
+/**
+ * @brief 深度睡眠期间 ULP 哨兵的采样周期 (ms)
+ */
+#define ULP_SENTINEL_PERIOD_MS 600000
+
+/**
+ * @brief ULP 定时器单次唤醒周期的上限 (ms)
+ * @details ESP32-S3 的 RTC_CNTL_ULP_CP_TIMER_SLP_CYCLE 只有24位，按约136kHz慢速时钟
+ *          最长约123s；更长的采样周期由 ULP 程序对子周期计数实现
+ */
+#define ULP_SENTINEL_TIMER_MAX_MS 100000
+
+/**
+ * @brief 哨兵未检测到干燥时主CPU的最长睡眠时间 (ms)
+ * @details 采样预算 = 此值 / 采样周期，用完后唤醒主CPU刷新屏幕和电池状态
+ */
+#define ULP_SENTINEL_MAX_SLEEP_MS 21600000
+
+/**
+ * @brief ULP 状态机时钟每毫秒的周期数
+ * @details RTC_FAST_CLK 约 17.5MHz，用于把稳定时间换算为 I_DELAY 循环
+ */
+#define ULP_FSM_CYCLES_PER_MS 17500
+
+// =============================================================================
+// Power Ledger Timing Constants
+// =============================================================================
+
+/**
+ * @brief 能耗账本保存到 NVS 的最小间隔 (ms，按账本统计时长计)
+ * @details 平时账本只写 RTC 内存；进入深度睡眠时距上次保存超过此值才写一次 NVS，
+ *          断电最多丢失这段时间的统计，同时避免每个睡眠周期擦写闪存
+ */
+#define POWER_LEDGER_SAVE_INTERVAL_MS 3600000
+
 // =============================================================================
 // Display Timing Constants
 // =============================================================================
@@ -5,11 +5,28 @@
 
 #include "hal_adc.h"
 #include <Arduino.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include "driver/adc.h"
+#include "esp_adc_cal.h"
+
+// 与 analogRead() 默认配置一致：12位精度、11dB衰减（约0-3.1V量程）
+#define HAL_ADC_ATTEN       ADC_ATTEN_DB_11
+#define HAL_ADC_WIDTH       ADC_WIDTH_BIT_12
+#define HAL_ADC_DEFAULT_VREF 1100
+#define HAL_ADC_TYPICAL_FULL_SCALE_MV 3100
+
+static esp_adc_cal_characteristics_t s_adc_chars;
+static bool s_calibrated = false;
+static uint16_t s_configured_channels = 0;  // 已设置衰减的 ADC1 通道位图
 
 void hal_adc_init() {
-    // ESP32-S3的ADC特性是自动校准的，
-    // 并且analogRead函数会自动处理初始化。
-    // 因此，目前无需在此处添加特定代码。
+    adc1_config_width(HAL_ADC_WIDTH);
+
+    // ESP32-S3 的出厂校准值烧录在 eFuse 中（两点拟合）
+    s_calibrated = esp_adc_cal_check_efuse(ESP_ADC_CAL_VAL_EFUSE_TP_FIT) == ESP_OK;
+    esp_adc_cal_characterize(ADC_UNIT_1, HAL_ADC_ATTEN, HAL_ADC_WIDTH, HAL_ADC_DEFAULT_VREF, &s_adc_chars);
 }
 
 uint16_t hal_adc_read(uint8_t pin_num, bool* p_success) {
@@ -27,4 +44,145 @@ uint16_t hal_adc_read(uint8_t pin_num, bool* p_success) {
     }
 
     return value;
-}
\ No newline at end of file
+}
+
+void hal_adc_default_config(hal_adc_sample_config_t* p_config) {
+    p_config->samples = HAL_ADC_DEFAULT_SAMPLES;
+    p_config->reject = HAL_ADC_REJECT_TRIM;
+    p_config->trim_percent = HAL_ADC_DEFAULT_TRIM_PERCENT;
+    p_config->mad_k = HAL_ADC_DEFAULT_MAD_K;
+    p_config->interval_us = HAL_ADC_DEFAULT_INTERVAL_US;
+}
+
+bool hal_adc_config_valid(const hal_adc_sample_config_t* p_config) {
+    return p_config != nullptr &&
+           p_config->samples >= 1 && p_config->samples <= HAL_ADC_MAX_SAMPLES &&
+           p_config->reject <= HAL_ADC_REJECT_MAD &&
+           p_config->trim_percent < 50 &&
+           p_config->mad_k > 0.0f &&
+           p_config->interval_us <= 10000;
+}
+
+bool hal_adc_capture(uint8_t pin_num, uint16_t* p_samples, uint16_t count, uint16_t interval_us) {
+    int8_t channel = digitalPinToAnalogChannel(pin_num);
+    if (channel < 0) return false;
+
+    // ADC2 引脚（与 WiFi 共用）交给 analogRead 处理仲裁
+    bool on_adc1 = channel < ADC1_CHANNEL_MAX;
+    if (on_adc1 && !(s_configured_channels & (1u << channel))) {
+        adc1_config_channel_atten((adc1_channel_t)channel, HAL_ADC_ATTEN);
+        s_configured_channels |= (1u << channel);
+    }
+
+    for (uint16_t i = 0; i < count; i++) {
+        if (i > 0 && interval_us > 0) {
+            delayMicroseconds(interval_us);
+        }
+        int raw = on_adc1 ? adc1_get_raw((adc1_channel_t)channel) : analogRead(pin_num);
+        p_samples[i] = raw < 0 ? 0 : (uint16_t)raw;
+    }
+    return true;
+}
+
+bool hal_adc_sample(uint8_t pin_num, const hal_adc_sample_config_t* p_config, hal_adc_stats_t* p_stats) {
+    hal_adc_sample_config_t defaults;
+    if (p_config == nullptr) {
+        hal_adc_default_config(&defaults);
+        p_config = &defaults;
+    }
+    if (!hal_adc_config_valid(p_config) || p_stats == nullptr) return false;
+
+    uint16_t samples[HAL_ADC_MAX_SAMPLES];
+    uint32_t start = micros();
+    if (!hal_adc_capture(pin_num, samples, p_config->samples, p_config->interval_us)) {
+        return false;
+    }
+    uint32_t duration = micros() - start;
+
+    bool ok = hal_adc_compute_stats(samples, p_config->samples, p_config, p_stats);
+    p_stats->duration_us = duration;
+    p_stats->millivolts = hal_adc_raw_to_mv((uint16_t)lroundf(p_stats->mean));
+    return ok;
+}
+
+bool hal_adc_compute_stats(uint16_t* p_samples, uint8_t count,
+                           const hal_adc_sample_config_t* p_config, hal_adc_stats_t* p_stats) {
+    memset(p_stats, 0, sizeof(*p_stats));
+    if (count == 0) return false;
+
+    // 插入排序（样本数不超过64）
+    for (uint8_t i = 1; i < count; i++) {
+        uint16_t v = p_samples[i];
+        int j = i - 1;
+        while (j >= 0 && p_samples[j] > v) {
+            p_samples[j + 1] = p_samples[j];
+            j--;
+        }
+        p_samples[j + 1] = v;
+    }
+
+    p_stats->taken = count;
+    p_stats->min = p_samples[0];
+    p_stats->max = p_samples[count - 1];
+    p_stats->median = (count & 1) ? p_samples[count / 2]
+                                  : (uint16_t)((p_samples[count / 2 - 1] + p_samples[count / 2] + 1) / 2);
+    for (uint8_t i = 0; i < count; i++) {
+        if (p_samples[i] == 0 || p_samples[i] == HAL_ADC_RAW_MAX) p_stats->rail++;
+    }
+
+    // 选出参与均值计算的区间 [lo, hi)
+    uint8_t lo = 0;
+    uint8_t hi = count;
+    if (p_config->reject == HAL_ADC_REJECT_TRIM) {
+        uint8_t cut = (uint8_t)((uint16_t)count * p_config->trim_percent / 100);
+        lo = cut;
+        hi = count - cut;
+    } else if (p_config->reject == HAL_ADC_REJECT_MAD) {
+        // 中位数绝对偏差，乘以1.4826换算为正态分布下的标准差估计
+        uint16_t dev[HAL_ADC_MAX_SAMPLES];
+        for (uint8_t i = 0; i < count; i++) {
+            dev[i] = (uint16_t)abs((int)p_samples[i] - (int)p_stats->median);
+        }
+        for (uint8_t i = 1; i < count; i++) {
+            uint16_t v = dev[i];
+            int j = i - 1;
+            while (j >= 0 && dev[j] > v) {
+                dev[j + 1] = dev[j];
+                j--;
+            }
+            dev[j + 1] = v;
+        }
+        float threshold = p_config->mad_k * 1.4826f * dev[count / 2];
+        if (threshold < 1.0f) threshold = 1.0f;  // 样本完全一致时保留相邻计数
+        while (lo < count && p_stats->median - (float)p_samples[lo] > threshold) lo++;
+        while (hi > lo && (float)p_samples[hi - 1] - p_stats->median > threshold) hi--;
+    }
+
+    p_stats->used = hi - lo;
+    if (p_stats->used == 0) return false;
+
+    float sum = 0.0f;
+    for (uint8_t i = lo; i < hi; i++) sum += p_samples[i];
+    p_stats->mean = sum / p_stats->used;
+
+    float sq = 0.0f;
+    for (uint8_t i = lo; i < hi; i++) {
+        float d = p_samples[i] - p_stats->mean;
+        sq += d * d;
+    }
+    p_stats->variance = p_stats->used > 1 ? sq / (p_stats->used - 1) : 0.0f;
+
+    // 多数样本落在量程两端视为短路或断路
+    return p_stats->rail * 2 <= count;
+}
+
+uint32_t hal_adc_raw_to_mv(uint16_t raw) {
+    if (s_calibrated) {
+        return esp_adc_cal_raw_to_voltage(raw, &s_adc_chars);
+    }
+    return (uint32_t)raw * HAL_ADC_TYPICAL_FULL_SCALE_MV / HAL_ADC_RAW_MAX;
+}
+
+bool hal_adc_is_calibrated() {
+    return s_calibrated;
+}
@@ -1,7 +1,9 @@
 /**
  * @file hal_adc.h
  * @brief ADC读取硬件抽象层
- * @details 提供ADC传感器读取的硬件抽象接口
+ * @details 提供ADC传感器读取的硬件抽象接口。
+ *          hal_adc_sample() 在一次突发中连续采集N个样本，按剔除策略去除离群值后
+ *          给出截尾均值、中位数与方差；原始值到毫伏的换算使用 eFuse 中的出厂校准。
  */
 
 #ifndef HAL_ADC_H
@@ -9,8 +11,54 @@
 
 #include <stdint.h>
 
+#define HAL_ADC_MAX_SAMPLES   64
+#define HAL_ADC_RAW_MAX       4095
+
+// 默认采样配置
+#define HAL_ADC_DEFAULT_SAMPLES      16
+#define HAL_ADC_DEFAULT_TRIM_PERCENT 25     // 截尾比例：两端各去掉25%（四分位均值）
+#define HAL_ADC_DEFAULT_MAD_K        3.0f
+#define HAL_ADC_DEFAULT_INTERVAL_US  50
+
+/**
+ * @brief 离群值剔除策略
+ */
+typedef enum {
+    HAL_ADC_REJECT_NONE = 0,  ///< 不剔除，使用全部样本
+    HAL_ADC_REJECT_TRIM,      ///< 排序后两端各去掉 trim_percent% 的样本
+    HAL_ADC_REJECT_MAD        ///< 去掉偏离中位数超过 mad_k 倍标准化MAD的样本
+} hal_adc_reject_t;
+
+/**
+ * @brief 多样本采集配置
+ */
+typedef struct {
+    uint8_t samples;           ///< 每次采集的样本数 (1 - HAL_ADC_MAX_SAMPLES)
+    hal_adc_reject_t reject;   ///< 剔除策略
+    uint8_t trim_percent;      ///< HAL_ADC_REJECT_TRIM 时每端去掉的比例 (0-49)
+    float mad_k;               ///< HAL_ADC_REJECT_MAD 时的阈值倍数
+    uint16_t interval_us;      ///< 相邻样本的间隔 (微秒)
+} hal_adc_sample_config_t;
+
+/**
+ * @brief 一次多样本采集的统计结果（单位均为ADC原始计数）
+ */
+typedef struct {
+    float mean;                ///< 剔除后的（截尾）均值
+    uint16_t median;           ///< 全部样本的中位数
+    float variance;            ///< 剔除后样本的方差
+    uint16_t min;              ///< 全部样本最小值
+    uint16_t max;              ///< 全部样本最大值
+    uint8_t taken;             ///< 采集的样本数
+    uint8_t used;              ///< 剔除后参与均值计算的样本数
+    uint8_t rail;              ///< 落在 0 或 4095 的样本数（短路或断路迹象）
+    uint32_t millivolts;       ///< 均值经校准换算的引脚电压 (mV)
+    uint32_t duration_us;      ///< 采集耗时 (微秒)
+} hal_adc_stats_t;
+
 /**
  * @brief 初始化ADC硬件抽象层
+ * @details 设置12位精度并加载 eFuse 校准数据
  */
 void hal_adc_init();
 
@@ -22,4 +70,52 @@ void hal_adc_init();
  */
 uint16_t hal_adc_read(uint8_t pin_num, bool* p_success);
 
-#endif // HAL_ADC_H
\ No newline at end of file
+/**
+ * @brief 获取默认采集配置
+ */
+void hal_adc_default_config(hal_adc_sample_config_t* p_config);
+
+/**
+ * @brief 检查采集配置是否有效
+ */
+bool hal_adc_config_valid(const hal_adc_sample_config_t* p_config);
+
+/**
+ * @brief 突发采集原始样本
+ * @param pin_num GPIO引脚号
+ * @param p_samples 输出样本数组
+ * @param count 样本数
+ * @param interval_us 相邻样本间隔
+ * @return true 成功, false 引脚不支持ADC
+ */
+bool hal_adc_capture(uint8_t pin_num, uint16_t* p_samples, uint16_t count, uint16_t interval_us);
+
+/**
+ * @brief 多样本采集并计算统计量
+ * @param pin_num GPIO引脚号
+ * @param p_config 采集配置（NULL 使用默认配置）
+ * @param p_stats 输出统计结果
+ * @return true 成功, false 引脚无效或多数样本落在量程两端
+ */
+bool hal_adc_sample(uint8_t pin_num, const hal_adc_sample_config_t* p_config, hal_adc_stats_t* p_stats);
+
+/**
+ * @brief 由样本计算统计量（纯函数，不访问硬件）
+ * @details 样本数组会被原地排序。millivolts 与 duration_us 不填写。
+ * @return true 有效, false 无样本或多数样本落在量程两端
+ */
+bool hal_adc_compute_stats(uint16_t* p_samples, uint8_t count,
+                           const hal_adc_sample_config_t* p_config, hal_adc_stats_t* p_stats);
+
+/**
+ * @brief 将原始读数换算为引脚电压
+ * @return 电压 (mV)；无校准数据时按典型值换算
+ */
+uint32_t hal_adc_raw_to_mv(uint16_t raw);
+
+/**
+ * @brief 是否使用了 eFuse 校准数据
+ */
+bool hal_adc_is_calibrated();
+
+#endif // HAL_ADC_H
@@ -23,9 +23,36 @@ void hal_rtc_enter_deep_sleep() {
 
     // (可选但推荐) 禁用所有非必要的 RTC 外设，进一步降低功耗
     esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_PERIPH, ESP_PD_OPTION_OFF);
-    esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_SLOW_MEM, ESP_PD_OPTION_OFF);
+    // RTC慢速内存保持自动：有 RTC_DATA_ATTR 变量（如湿度滤波状态）时保持供电
+    esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_SLOW_MEM, ESP_PD_OPTION_AUTO);
     esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_FAST_MEM, ESP_PD_OPTION_OFF);
 
     // 进入深度睡眠
     esp_deep_sleep_start();
-}
\ No newline at end of file
+}
+
+void hal_rtc_enter_sentinel_sleep() {
+    hal_rtc_enter_run_sleep(0, true);
+}
+
+void hal_rtc_enter_run_sleep(uint64_t timer_us, bool ulp_wakeup) {
+    // 离开RUN模式（切到INTERACTIVE或OFF）时B引脚由LOW变为HIGH；
+    // 睡眠期间数字上拉失效，改用RTC上拉保持B引脚在开关断开时为高电平
+    rtc_gpio_pullup_en((gpio_num_t)PIN_MODE_SWITCH_B);
+    rtc_gpio_pulldown_dis((gpio_num_t)PIN_MODE_SWITCH_B);
+    esp_sleep_enable_ext1_wakeup((1ULL << PIN_MODE_SWITCH_B), ESP_EXT1_WAKEUP_ANY_HIGH);
+    if (timer_us > 0) {
+        esp_sleep_enable_timer_wakeup(timer_us);
+    }
+    if (ulp_wakeup) {
+        esp_sleep_enable_ulp_wakeup();
+    }
+
+    // RTC外设保持供电：RTC上拉，以及ULP运行时的RTC GPIO（传感器电源）和SAR ADC；
+    // 慢速内存保存 RUN 模式状态、时间序列尾块和ULP程序
+    esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_PERIPH, ESP_PD_OPTION_ON);
+    esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_SLOW_MEM, ESP_PD_OPTION_ON);
+    esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_FAST_MEM, ESP_PD_OPTION_OFF);
+
+    esp_deep_sleep_start();
+}
@@ -5,6 +5,9 @@
 #ifndef HAL_RTC_H
 #define HAL_RTC_H
 
+#include <stdint.h>
+#include <stdbool.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -19,6 +22,22 @@ void hal_rtc_init();
  */
 void hal_rtc_enter_deep_sleep();
 
+/**
+ * @brief RUN模式下进入由ULP哨兵值守的深度睡眠
+ * @details 调用前需已通过 ulp_manager_start() 启动哨兵。
+ *          唤醒源为ULP（需要浇水或采样预算用完）和离开RUN模式（B引脚变为高电平）。
+ */
+void hal_rtc_enter_sentinel_sleep();
+
+/**
+ * @brief RUN模式两次检查之间进入深度睡眠
+ * @details 离开RUN模式（B引脚变为高电平）总是唤醒；RTC外设与慢速内存保持供电，
+ *          以保留 RTC_DATA_ATTR 状态和B引脚的上拉。
+ * @param timer_us 定时唤醒时间 (us)，0 表示不使用定时器
+ * @param ulp_wakeup 是否允许ULP唤醒（需已启动哨兵）
+ */
+void hal_rtc_enter_run_sleep(uint64_t timer_us, bool ulp_wakeup);
+
 #ifdef __cplusplus
 }
 #endif
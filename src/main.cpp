@@ -15,6 +15,7 @@
   #include "test/test_commands_hal.h"
   #include "test/test_commands_log.h"
   #include "test/test_commands_run.h"
+  #include "test/test_commands_history.h"
   #include "test/test_commands_config.h"
   #include "test/test_commands_wifi.h"
   #include "test/test_commands_time.h"
@@ -22,23 +23,34 @@
   #include "test/test_commands_chat.h"
   #include "test/test_commands_input.h"
   #include "test/test_commands_interactive.h"
+  #include "test/test_commands_ulp.h"
 #endif
 
 #include "managers/power_manager.h"
 #include "managers/sensor_manager.h"
+#include "managers/battery_manager.h"
+#include "managers/humidity_filter.h"
+#include "managers/sensor_health.h"
+#include "managers/watering_controller.h"
+#include "managers/drying_model.h"
+#include "managers/ulp_manager.h"
 #include "managers/log_manager.h"
 #include "managers/actuator_manager.h"
+#include "managers/watering_program.h"
 #include "managers/run_mode_manager.h"
 #include "managers/interactive_mode_manager.h"
 #include "ui/ui_manager.h"
 #include "ui/display_manager.h"
 #include "managers/input_manager.h"
 #include "hal/hal_rtc.h"
+#include "system/loop_monitor.h"
+#include "managers/ts/ts_store.h"
 #include "services/config_manager.h"
 #include "services/wifi_manager.h"
 #include "services/time_manager.h"
 #include "services/llm_connector.h"
 #include "services/history_manager.h"
+#include "services/watering_scheduler.h"
 
 // --- 私有状态变量 ---
 static system_mode_t current_mode = SYSTEM_MODE_UNKNOWN;
@@ -46,6 +58,7 @@ static system_mode_t last_read_mode = SYSTEM_MODE_UNKNOWN;
 static system_mode_t last_active_mode = SYSTEM_MODE_UNKNOWN;
 static unsigned long last_debounce_time = 0;
 static const unsigned long debounce_delay = 50; // 50ms 消抖延迟
+static bool s_minimal_boot = false;  // RUN模式睡眠唤醒的精简启动，未初始化WiFi/LLM/UI等
 
 // --- 私有函数 ---
 static void enter_off_mode_logic();
@@ -69,6 +82,7 @@ static void test_mode_setup() {
   test_commands_hal_init();
   test_commands_log_init();
   test_commands_run_init();
+  test_commands_history_init();
   test_commands_config_init();
   test_commands_wifi_init();
   test_commands_time_init();
@@ -76,6 +90,7 @@ static void test_mode_setup() {
   test_commands_chat_init();
   test_commands_input_init();
   test_commands_interactive_init();
+  test_commands_ulp_init();
 }
 #endif
 
@@ -86,19 +101,40 @@ void setup() {
   #endif
 
   log_manager_init();
+  if (!ts_store_init()) {             // 传感器时间序列存储（tsdb 分区）
+    LOG_WARN("Main", "Time-series store unavailable (missing tsdb partition?)");
+  }
   ConfigManager::instance().init();   // 初始化配置管理器
-  WiFiManager::instance().init();     // 初始化WiFi管理器
-  TimeManager::instance().init();     // 初始化时间管理器
-  HistoryManager::instance().init();  // 初始化对话历史管理器
-  LLMConnector::instance().init();    // 初始化LLM连接器
+  log_manager_apply_level_spec(ConfigManager::instance().getConfig().system.log_levels);  // 应用持久化的模块日志级别
+  input_manager_init();               // 模式开关（决定是否走精简启动）
+
+  // RUN模式睡眠唤醒且开关仍在RUN：只初始化一次检查所需的模块，缩短唤醒时间
+  #ifndef TEST_MODE
+    s_minimal_boot = run_mode_manager_woke_from_sleep() && input_manager_get_mode() == SYSTEM_MODE_RUN;
+  #endif
+
+  if (!s_minimal_boot) {
+    WiFiManager::instance().init();     // 初始化WiFi管理器
+    TimeManager::instance().init();     // 初始化时间管理器
+    HistoryManager::instance().init();  // 初始化对话历史管理器
+    LLMConnector::instance().init();    // 初始化LLM连接器
+  }
+  ulp_manager_init();                 // 停止哨兵并归还传感器电源引脚（须在电源管理器之前）
   power_result_t power_init_result = power_manager_init();
   sensor_manager_init();
+  battery_manager_init();             // 电池模型（依赖配置管理器）
+  humidity_filter_init();             // 湿度滤波状态（从RTC内存恢复）
+  sensor_health_init();               // 传感器健康监测状态（从RTC内存恢复）
+  watering_controller_init();         // 自适应浇水模型（从NVS读取）
+  drying_model_init();                // 干燥速率模型（从RTC内存恢复）
   actuator_manager_init();
-  run_mode_manager_init();
-  interactive_mode_manager_init();    // 初始化Interactive Mode管理器
-  input_manager_init();
+  WateringScheduler::instance().init();  // 浇水间隔与每日预算（从NVS恢复）
+  run_mode_manager_init();            // RUN模式状态（从RTC内存恢复）
   hal_rtc_init();
-  ui_manager_init();
+  if (!s_minimal_boot) {
+    interactive_mode_manager_init();    // 初始化Interactive Mode管理器
+    ui_manager_init();                  // 精简启动时由RUN模式在需要刷新屏幕时初始化
+  }
 
   #ifdef TEST_MODE
     if (power_init_result != POWER_OK) {
@@ -107,15 +143,24 @@ void setup() {
     }
   #else
     // 在正常模式下，获取初始模式
-
+    if (s_minimal_boot) {
+      // 直接继续RUN模式，跳过进入RUN时的全屏刷新
+      current_mode = SYSTEM_MODE_RUN;
+      last_read_mode = SYSTEM_MODE_RUN;
+      last_active_mode = SYSTEM_MODE_RUN;
+      run_mode_manager_resume();
+    }
   #endif
 }
 
 void loop() {
   // 主循环
+  loop_monitor_tick();  // 记录迭代间隔（抖动统计）
 
   #ifdef TEST_MODE
     actuator_manager_loop();
+    watering_program_loop();
+    power_manager_loop();
     ui_manager_loop();
     input_manager_loop();
     WiFiManager::instance().update();  // 更新WiFi状态
@@ -137,6 +182,15 @@ void loop() {
         if (reading != current_mode) {
             LOG_INFO("Main", "Mode changed from %d to %d", current_mode, reading);
 
+            // 精简启动缺少其他模式需要的模块：保存状态后完整重启
+            if (s_minimal_boot) {
+                run_mode_manager_exit();
+                power_ledger_save();
+                ts_store_suspend();
+                log_manager_flush_now();
+                ESP.restart();
+            }
+
             // 退出旧模式的逻辑
             if (last_active_mode == SYSTEM_MODE_RUN) {
                 run_mode_manager_exit();
@@ -151,6 +205,7 @@ void loop() {
             if (current_mode == SYSTEM_MODE_OFF) {
                 // OFF模式前：立即保存所有日志到SPIFFS
                 log_manager_flush_now();
+                ts_store_flush();   // 封存时间序列尾块，避免断电丢失
                 delay(100); // 等待写入完成
                 enter_off_mode_logic();
             } else if (current_mode == SYSTEM_MODE_RUN) {
@@ -165,12 +220,19 @@ void loop() {
     if (current_mode == SYSTEM_MODE_RUN) {
         ui_manager_loop();            // 处理LVGL任务队列
         run_mode_manager_loop();      // 自动浇水逻辑和智能UI更新
-        actuator_manager_loop();      // 必须调用以支持定时泵操作
+        actuator_manager_loop();      // 定时运行结束后关闭12V电源（停泵由定时器完成）
+        watering_program_loop();      // 分段浇水的间隙与采样
+        power_manager_loop();         // 关闭保持时间已结束的电源轨
+        if (run_mode_manager_sleep_pending()) {
+            run_mode_manager_sleep(); // 本周期检查完成，深度睡眠到下次检查（不返回）
+        }
     } else if (current_mode == SYSTEM_MODE_INTERACTIVE) {
         ui_manager_loop();            // 处理LVGL任务队列
         input_manager_loop();         // 处理编码器和按钮输入
         interactive_mode_manager_loop();  // Interactive模式状态机
         actuator_manager_loop();      // 必须调用以支持浇水操作
+        watering_program_loop();
+        power_manager_loop();
         WiFiManager::instance().update();  // 更新WiFi状态（LLM需要）
     }
   #endif
@@ -183,6 +245,7 @@ static void enter_off_mode_logic() {
     LOG_INFO("Main", "Entering OFF mode...");
 
     // 1. 确保执行器停止
+    watering_program_abort();
     actuator_manager_stop_pump();
 
     // 2. 显示关机屏幕
@@ -198,6 +261,10 @@ static void enter_off_mode_logic() {
     power_pump_module_enable(false);
     power_screen_enable(false);
 
-    // 4. 进入深度睡眠
+    // 4. 结算能耗账本（关机可能持续很久，直接写入NVS）
+    power_ledger_suspend();
+    power_ledger_save();
+
+    // 5. 进入深度睡眠
     hal_rtc_enter_deep_sleep();
 }
\ No newline at end of file
@@ -8,38 +8,290 @@
 #include "hal/hal_gpio.h"
 #include "hal/hal_ledc.h"
 #include "hal/hal_config.h"
+#include "data/timing_constants.h"
 #include "log_manager.h"
 #include <Arduino.h>
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include "esp_timer.h"
 
 #define PUMP_LEDC_CHANNEL 0
+#define MIN_TIMER_DELAY_US 50   // 已到期的事件也经定时器处理，避免在回调里递归
 
-// 内部状态
-static bool is_pump_running = false;
-static uint32_t pump_start_time = 0;
-static uint32_t pump_duration_ms = 0;
+// 内部状态（定时器回调与主循环共享，由 s_engine_mux 保护）
+static volatile bool is_pump_running = false;
+static volatile bool s_finished = false;   // 已按截止时刻停泵，等待主循环关闭12V电源
+static actuator_profile_t s_profile;
+static int64_t s_start_us = 0;
+static uint32_t s_total_ms = 0;
+static uint32_t s_next_ms = 0;
+static uint8_t s_duty = 0;
+static uint8_t s_segment = 0;
+static uint32_t s_events = 0;
+static int32_t s_last_stop_error_us = 0;
+static esp_timer_handle_t s_timer = nullptr;
+static portMUX_TYPE s_engine_mux = portMUX_INITIALIZER_UNLOCKED;
+static bool s_boost_leased = false;        // 持有12V电源租约（空闲后保持片刻再关闭）
 
 // 私有辅助函数
 static void ensure_12v_power() {
-    if (!power_pump_module_is_enabled()) {
-        LOG_DEBUG("Actuator", "12V power is off. Turning on...");
-        power_result_t result = power_pump_module_enable(true);
-        if (result != POWER_OK) {
-            LOG_ERROR("Actuator", "Failed to enable 12V boost module!");
-        }
+    if (s_boost_leased) {
+        return;
+    }
+    bool was_on = false;
+    power_result_t result = power_rail_acquire(POWER_RAIL_BOOST, &was_on);
+    if (result != POWER_OK) {
+        LOG_ERROR("Actuator", "Failed to enable 12V boost module!");
+        return;
+    }
+    s_boost_leased = true;
+    if (!was_on) {
+        LOG_DEBUG("Actuator", "12V power was off. Turned on.");
         delay(50); // 等待电源稳定
     }
 }
 
 static void shutdown_12v_if_idle() {
-    if (!is_pump_running) {
-        LOG_DEBUG("Actuator", "All actuators idle. Turning off 12V power.");
-        power_result_t result = power_pump_module_enable(false);
+    if (!is_pump_running && s_boost_leased) {
+        LOG_DEBUG("Actuator", "All actuators idle. Releasing 12V power.");
+        s_boost_leased = false;
+        power_result_t result = power_rail_release(POWER_RAIL_BOOST);
         if (result != POWER_OK) {
-            LOG_ERROR("Actuator", "Failed to disable 12V boost module.");
+            LOG_ERROR("Actuator", "Failed to release 12V boost module.");
         }
     }
 }
 
+static uint8_t lerp_duty(uint8_t from, uint8_t to, uint32_t pos, uint32_t span) {
+    if (span == 0 || pos >= span) {
+        return to;
+    }
+    return (uint8_t)(from + ((int32_t)to - from) * (int64_t)pos / span);
+}
+
+static uint32_t min_u32(uint32_t a, uint32_t b) {
+    return a < b ? a : b;
+}
+
+// 以下两个函数须在 s_engine_mux 内调用
+static void apply_duty_locked(uint8_t duty) {
+    if (duty != s_duty) {
+        // 注意：由于NPN三极管反相，占空比需要反转
+        hal_ledc_set_duty(PUMP_LEDC_CHANNEL, 255 - duty);
+        s_duty = duty;
+    }
+}
+
+static void output_off_locked() {
+    hal_ledc_set_duty(PUMP_LEDC_CHANNEL, 255); // 确保PWM输出为0V
+    hal_ledc_detach_pin(PIN_ACTUATOR_PUMP);
+    hal_gpio_write(PIN_ACTUATOR_PUMP, HIGH); // 恢复安全状态
+    s_duty = 0;
+    is_pump_running = false;
+}
+
+// 曲线引擎：按当前时间设置占空比，到截止时刻停泵，并安排下一次事件
+static void engine_service() {
+    int64_t now_us = esp_timer_get_time();
+    int64_t delay_us = -1;
+    bool stopped = false;
+
+    portENTER_CRITICAL(&s_engine_mux);
+    if (is_pump_running) {
+        uint32_t elapsed_ms = (uint32_t)((now_us - s_start_us) / 1000);
+        uint32_t next_ms = UINT32_MAX;
+        uint8_t duty = actuator_profile_eval(&s_profile, elapsed_ms, &next_ms, &s_segment);
+        s_events++;
+        if (s_total_ms != ACTUATOR_DURATION_INFINITE && elapsed_ms >= s_total_ms) {
+            s_last_stop_error_us = (int32_t)(now_us - (s_start_us + (int64_t)s_total_ms * 1000));
+            output_off_locked();
+            s_finished = true;
+            stopped = true;
+        } else {
+            apply_duty_locked(duty);
+            s_next_ms = next_ms;
+            if (next_ms != UINT32_MAX) {
+                delay_us = s_start_us + (int64_t)next_ms * 1000 - now_us;
+            }
+        }
+    }
+    portEXIT_CRITICAL(&s_engine_mux);
+
+    if (stopped) {
+        power_ledger_set_active(POWER_LEDGER_PUMP, false);
+    }
+    if (delay_us >= 0 && s_timer != nullptr) {
+        esp_timer_start_once(s_timer, delay_us < MIN_TIMER_DELAY_US ? MIN_TIMER_DELAY_US : delay_us);
+    }
+}
+
+static void engine_timer_cb(void* arg) {
+    (void)arg;
+    engine_service();
+}
+
+/* ========== 占空比曲线 ========== */
+
+void actuator_profile_clear(actuator_profile_t* p_profile)
+{
+    memset(p_profile, 0, sizeof(*p_profile));
+}
+
+bool actuator_profile_add(actuator_profile_t* p_profile, const actuator_segment_t* p_segment)
+{
+    if (p_profile->count >= ACTUATOR_PROFILE_MAX_SEGMENTS) {
+        return false;
+    }
+    if (p_segment->type != ACTUATOR_SEGMENT_HOLD && p_segment->duration_ms == 0) {
+        return false;
+    }
+    if (p_segment->type == ACTUATOR_SEGMENT_PULSE && p_segment->on_ms == 0) {
+        return false;
+    }
+
+    actuator_segment_t segment = *p_segment;
+    if (segment.ramp_ms > segment.on_ms) {
+        segment.ramp_ms = segment.on_ms;
+    }
+    p_profile->segments[p_profile->count++] = segment;
+    return true;
+}
+
+void actuator_profile_soft_start(actuator_profile_t* p_profile, uint8_t duty, uint32_t duration_ms,
+                                 uint32_t ramp_up_ms, uint32_t ramp_down_ms)
+{
+    actuator_profile_clear(p_profile);
+
+    if (duration_ms != 0) {
+        ramp_up_ms = min_u32(ramp_up_ms, duration_ms / 2);
+        ramp_down_ms = min_u32(ramp_down_ms, duration_ms / 2);
+    } else {
+        ramp_down_ms = 0; // 保持到停止，没有降速段
+    }
+
+    actuator_segment_t segment;
+    memset(&segment, 0, sizeof(segment));
+    if (ramp_up_ms > 0) {
+        segment.type = ACTUATOR_SEGMENT_RAMP;
+        segment.duty_start = 0;
+        segment.duty_end = duty;
+        segment.duration_ms = ramp_up_ms;
+        actuator_profile_add(p_profile, &segment);
+    }
+
+    uint32_t hold_ms = duration_ms == 0 ? 0 : duration_ms - ramp_up_ms - ramp_down_ms;
+    if (duration_ms == 0 || hold_ms > 0) {
+        segment.type = ACTUATOR_SEGMENT_HOLD;
+        segment.duty_start = duty;
+        segment.duty_end = duty;
+        segment.duration_ms = hold_ms;
+        actuator_profile_add(p_profile, &segment);
+    }
+
+    if (ramp_down_ms > 0) {
+        segment.type = ACTUATOR_SEGMENT_RAMP;
+        segment.duty_start = duty;
+        segment.duty_end = 0;
+        segment.duration_ms = ramp_down_ms;
+        actuator_profile_add(p_profile, &segment);
+    }
+}
+
+void actuator_profile_pulses(actuator_profile_t* p_profile, uint8_t duty, uint16_t count,
+                             uint32_t on_ms, uint32_t off_ms, uint32_t ramp_ms)
+{
+    actuator_profile_clear(p_profile);
+    if (count == 0) {
+        return;
+    }
+
+    // 最后一个脉冲后没有间隙
+    uint64_t duration = (uint64_t)count * on_ms + (uint64_t)(count - 1) * off_ms;
+    actuator_segment_t segment;
+    memset(&segment, 0, sizeof(segment));
+    segment.type = ACTUATOR_SEGMENT_PULSE;
+    segment.duty_start = 0;
+    segment.duty_end = duty;
+    segment.duration_ms = duration >= ACTUATOR_DURATION_INFINITE ? ACTUATOR_DURATION_INFINITE - 1 : (uint32_t)duration;
+    segment.on_ms = on_ms;
+    segment.off_ms = off_ms;
+    segment.ramp_ms = ramp_ms;
+    actuator_profile_add(p_profile, &segment);
+}
+
+uint32_t actuator_profile_duration_ms(const actuator_profile_t* p_profile)
+{
+    uint64_t total = 0;
+    for (uint8_t i = 0; i < p_profile->count; i++) {
+        const actuator_segment_t* p_segment = &p_profile->segments[i];
+        if (p_segment->type == ACTUATOR_SEGMENT_HOLD && p_segment->duration_ms == 0) {
+            return ACTUATOR_DURATION_INFINITE;
+        }
+        total += p_segment->duration_ms;
+    }
+    return total >= ACTUATOR_DURATION_INFINITE ? ACTUATOR_DURATION_INFINITE - 1 : (uint32_t)total;
+}
+
+uint8_t actuator_profile_eval(const actuator_profile_t* p_profile, uint32_t elapsed_ms,
+                              uint32_t* p_next_ms, uint8_t* p_segment)
+{
+    uint64_t base = 0;
+    for (uint8_t i = 0; i < p_profile->count; i++) {
+        const actuator_segment_t* p_seg = &p_profile->segments[i];
+        bool infinite = p_seg->type == ACTUATOR_SEGMENT_HOLD && p_seg->duration_ms == 0;
+        uint64_t end = infinite ? UINT32_MAX : base + p_seg->duration_ms;
+        if (end > UINT32_MAX) {
+            end = UINT32_MAX;
+        }
+        if (elapsed_ms >= end) {
+            base = end;
+            continue;
+        }
+
+        uint32_t local = elapsed_ms - (uint32_t)base;
+        uint32_t next = (uint32_t)end;
+        uint8_t duty;
+        switch (p_seg->type) {
+            case ACTUATOR_SEGMENT_RAMP:
+                duty = lerp_duty(p_seg->duty_start, p_seg->duty_end, local, p_seg->duration_ms);
+                if (p_seg->duty_start != p_seg->duty_end) {
+                    next = min_u32(elapsed_ms + ACTUATOR_RAMP_TICK_MS, next);
+                }
+                break;
+            case ACTUATOR_SEGMENT_PULSE: {
+                uint32_t period = p_seg->on_ms + p_seg->off_ms;
+                uint32_t phase = local % period;
+                uint32_t pulse_start = elapsed_ms - phase;
+                if (phase < p_seg->ramp_ms) {
+                    duty = lerp_duty(p_seg->duty_start, p_seg->duty_end, phase, p_seg->ramp_ms);
+                    next = min_u32(min_u32(elapsed_ms + ACTUATOR_RAMP_TICK_MS, pulse_start + p_seg->ramp_ms), next);
+                } else if (phase < p_seg->on_ms) {
+                    duty = p_seg->duty_end;
+                    next = min_u32(pulse_start + p_seg->on_ms, next);
+                } else {
+                    duty = p_seg->duty_start;
+                    next = min_u32(pulse_start + period, next);
+                }
+                break;
+            }
+            case ACTUATOR_SEGMENT_HOLD:
+            default:
+                duty = p_seg->duty_end;
+                break;
+        }
+
+        if (p_next_ms != nullptr) *p_next_ms = next;
+        if (p_segment != nullptr) *p_segment = i;
+        return duty;
+    }
+
+    if (p_next_ms != nullptr) *p_next_ms = UINT32_MAX;
+    if (p_segment != nullptr) *p_segment = p_profile->count;
+    return 0;
+}
+
+/* ========== 公共 API ========== */
+
 void actuator_manager_init()
 {
     // 初始化水泵PWM通道
@@ -48,40 +300,91 @@ void actuator_manager_init()
     hal_gpio_pin_mode(PIN_ACTUATOR_PUMP, OUTPUT);
     hal_gpio_write(PIN_ACTUATOR_PUMP, HIGH);
 
+    if (s_timer == nullptr) {
+        esp_timer_create_args_t timer_args;
+        memset(&timer_args, 0, sizeof(timer_args));
+        timer_args.callback = engine_timer_cb;
+        timer_args.dispatch_method = ESP_TIMER_TASK;
+        timer_args.name = "pump_engine";
+        if (esp_timer_create(&timer_args, &s_timer) != ESP_OK) {
+            s_timer = nullptr;
+            LOG_ERROR("Actuator", "Failed to create pump timer, falling back to main loop timing.");
+        }
+    }
+
     LOG_INFO("Actuator", "Actuator manager initialized.");
 }
 
-void actuator_manager_start_pump(uint8_t duty_cycle)
+actuator_result_t actuator_manager_run_profile(const actuator_profile_t* p_profile)
 {
+    if (p_profile == nullptr || p_profile->count == 0 || actuator_profile_duration_ms(p_profile) == 0) {
+        return ACTUATOR_ERROR_INVALID_PARAM;
+    }
     if (is_pump_running) {
         LOG_WARN("Actuator", "Pump is already running.");
-        return;
+        return ACTUATOR_ERROR_BUSY;
     }
-    LOG_INFO("Actuator", "Starting pump at %d/255 power.", duty_cycle);
 
     ensure_12v_power();
+    hal_ledc_set_duty(PUMP_LEDC_CHANNEL, 255); // 从0开始，由曲线引擎升速
+    hal_ledc_attach_pin(PIN_ACTUATOR_PUMP, PUMP_LEDC_CHANNEL);
+
+    if (s_timer != nullptr) {
+        esp_timer_stop(s_timer);
+    }
+    portENTER_CRITICAL(&s_engine_mux);
+    s_profile = *p_profile;
+    s_total_ms = actuator_profile_duration_ms(p_profile);
+    s_start_us = esp_timer_get_time();
+    s_next_ms = 0;
+    s_duty = 0;
+    s_segment = 0;
+    s_events = 0;
+    s_finished = false;
     is_pump_running = true;
+    portEXIT_CRITICAL(&s_engine_mux);
 
-    hal_ledc_attach_pin(PIN_ACTUATOR_PUMP, PUMP_LEDC_CHANNEL);
-    
-    // 注意：由于NPN三极管反相，占空比需要反转
-    uint8_t inverted_duty = 255 - duty_cycle;
-    hal_ledc_set_duty(PUMP_LEDC_CHANNEL, inverted_duty);
+    power_ledger_set_active(POWER_LEDGER_PUMP, true);
+    engine_service();
+    return ACTUATOR_OK;
 }
 
-void actuator_manager_stop_pump()
+void actuator_manager_start_pump(uint8_t duty_cycle)
 {
-    if (!is_pump_running) {
+    if (is_pump_running) {
+        LOG_WARN("Actuator", "Pump is already running.");
         return;
     }
-    LOG_INFO("Actuator", "Stopping pump.");
+    LOG_INFO("Actuator", "Starting pump at %d/255 power.", duty_cycle);
 
-    hal_ledc_set_duty(PUMP_LEDC_CHANNEL, 255); // 确保PWM输出为0V
-    hal_ledc_detach_pin(PIN_ACTUATOR_PUMP);
-    hal_gpio_write(PIN_ACTUATOR_PUMP, HIGH); // 恢复安全状态
+    actuator_profile_t profile;
+    actuator_profile_soft_start(&profile, duty_cycle, 0, ACTUATOR_SOFT_START_MS, 0);
+    actuator_manager_run_profile(&profile);
+}
 
-    is_pump_running = false;
-    pump_duration_ms = 0; // 清除计时
+void actuator_manager_stop_pump()
+{
+    if (s_timer != nullptr) {
+        esp_timer_stop(s_timer);
+    }
+
+    portENTER_CRITICAL(&s_engine_mux);
+    bool was_running = is_pump_running;
+    bool finished = s_finished;
+    if (was_running) {
+        output_off_locked();
+    }
+    s_finished = false;
+    portEXIT_CRITICAL(&s_engine_mux);
+
+    if (was_running) {
+        power_ledger_set_active(POWER_LEDGER_PUMP, false);
+        LOG_INFO("Actuator", "Stopping pump.");
+    } else if (finished) {
+        LOG_INFO("Actuator", "Timed run finished.");
+    } else {
+        return;
+    }
     shutdown_12v_if_idle();
 }
 
@@ -91,22 +394,48 @@ void actuator_manager_run_pump_for(uint8_t duty_cycle, uint32_t duration_ms)
         LOG_WARN("Actuator", "Pump is already running. Ignoring new timed run request.");
         return;
     }
-    pump_duration_ms = duration_ms;
-    pump_start_time = millis();
-    actuator_manager_start_pump(duty_cycle);
+    LOG_INFO("Actuator", "Running pump at %d/255 power for %lu ms.", duty_cycle, (unsigned long)duration_ms);
+
+    actuator_profile_t profile;
+    actuator_profile_soft_start(&profile, duty_cycle, duration_ms, ACTUATOR_SOFT_START_MS, ACTUATOR_SOFT_STOP_MS);
+    actuator_manager_run_profile(&profile);
 }
 
 void actuator_manager_loop()
 {
-    if (is_pump_running && pump_duration_ms > 0) {
-        if (millis() - pump_start_time >= pump_duration_ms) {
-            LOG_INFO("Actuator", "Timed run finished.");
-            actuator_manager_stop_pump();
-        }
+    // 定时器不可用时由主循环驱动曲线（精度取决于主循环）
+    if (s_timer == nullptr && is_pump_running &&
+        esp_timer_get_time() - s_start_us >= (int64_t)s_next_ms * 1000) {
+        engine_service();
+    }
+
+    if (s_finished) {
+        portENTER_CRITICAL(&s_engine_mux);
+        s_finished = false;
+        int32_t error_us = s_last_stop_error_us;
+        portEXIT_CRITICAL(&s_engine_mux);
+
+        LOG_INFO("Actuator", "Timed run finished (%ld us after deadline).", (long)error_us);
+        shutdown_12v_if_idle();
     }
 }
 
 bool actuator_manager_is_pump_running()
 {
     return is_pump_running;
-}
\ No newline at end of file
+}
+
+void actuator_manager_get_status(actuator_status_t* p_status)
+{
+    int64_t now_us = esp_timer_get_time();
+
+    portENTER_CRITICAL(&s_engine_mux);
+    p_status->running = is_pump_running;
+    p_status->duty = s_duty;
+    p_status->segment = s_segment;
+    p_status->elapsed_ms = is_pump_running ? (uint32_t)((now_us - s_start_us) / 1000) : 0;
+    p_status->total_ms = s_total_ms;
+    p_status->events = s_events;
+    p_status->last_stop_error_us = s_last_stop_error_us;
+    portEXIT_CRITICAL(&s_engine_mux);
+}
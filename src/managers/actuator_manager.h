@@ -2,6 +2,18 @@
  * @file actuator_manager.h
  * @brief 执行器管理器
  * @details 负责水泵等执行器的控制
+ *
+ *   水泵由 esp_timer 驱动的占空比曲线引擎控制，不依赖主循环的调用频率：
+ *   1. 曲线由若干段组成：斜坡（占空比线性变化）、保持、脉冲串。
+ *      引擎只在占空比需要变化时唤醒（斜坡每 ACTUATOR_RAMP_TICK_MS 一步，
+ *      保持段只在段末唤醒），截止时刻由同一个单次定时器精确触发，
+ *      传感器读取或 LLM 请求阻塞主循环时水泵仍按时停止。
+ *   2. 定时运行默认软启动：ACTUATOR_SOFT_START_MS 内从 0 升到目标占空比，
+ *      结束前 ACTUATOR_SOFT_STOP_MS 内降回 0，降低冲击电流造成的电池电压跌落
+ *      （以及由此带来的ADC读数偏差）和停泵时的水锤。
+ *   3. 定时器回调只操作PWM输出；12V电源租约的释放和日志留给 actuator_manager_loop()
+ *      或下一次 actuator_manager_stop_pump() 完成。租约释放后升压模块保持
+ *      power.boost_linger_ms 再关闭，紧接着的下一次运行无需重新上电和等待稳定。
  */
 
 #ifndef ACTUATOR_MANAGER_H
@@ -10,6 +22,103 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#define ACTUATOR_PROFILE_MAX_SEGMENTS 8
+#define ACTUATOR_DURATION_INFINITE    UINT32_MAX   // 曲线没有截止时刻（运行到停止）
+
+/**
+ * @brief 执行器操作结果
+ */
+typedef enum {
+    ACTUATOR_OK = 0,
+    ACTUATOR_ERROR_BUSY,            ///< 水泵正在运行
+    ACTUATOR_ERROR_INVALID_PARAM,   ///< 曲线为空或参数无效
+    ACTUATOR_ERROR_TIMER            ///< 定时器不可用
+} actuator_result_t;
+
+/**
+ * @brief 曲线段类型
+ */
+typedef enum {
+    ACTUATOR_SEGMENT_RAMP = 0,      ///< duty_start 线性变化到 duty_end
+    ACTUATOR_SEGMENT_HOLD,          ///< 保持 duty_end（时长为 0 表示一直保持到停止）
+    ACTUATOR_SEGMENT_PULSE          ///< on_ms 的 duty_end 与 off_ms 的 duty_start 交替
+} actuator_segment_type_t;
+
+/**
+ * @brief 曲线段
+ */
+typedef struct {
+    actuator_segment_type_t type;
+    uint8_t duty_start;             ///< 斜坡起点；脉冲间隙的占空比
+    uint8_t duty_end;               ///< 斜坡终点；保持和脉冲的占空比
+    uint32_t duration_ms;           ///< 段时长
+    uint32_t on_ms;                 ///< 脉冲时长
+    uint32_t off_ms;                ///< 脉冲间隙
+    uint32_t ramp_ms;               ///< 每个脉冲开头的软启动时长
+} actuator_segment_t;
+
+/**
+ * @brief 占空比曲线
+ */
+typedef struct {
+    actuator_segment_t segments[ACTUATOR_PROFILE_MAX_SEGMENTS];
+    uint8_t count;
+} actuator_profile_t;
+
+/**
+ * @brief 引擎状态
+ */
+typedef struct {
+    bool running;                   ///< 水泵正在运行
+    uint8_t duty;                   ///< 当前占空比 (0-255，未反相)
+    uint8_t segment;                ///< 当前曲线段
+    uint32_t elapsed_ms;            ///< 本次运行已经过的时间
+    uint32_t total_ms;              ///< 曲线总时长（ACTUATOR_DURATION_INFINITE 表示无截止）
+    uint32_t events;                ///< 本次运行的定时器事件数
+    int32_t last_stop_error_us;     ///< 最近一次按截止时刻停止的误差 (us)
+} actuator_status_t;
+
+/**
+ * @brief 清空曲线
+ */
+void actuator_profile_clear(actuator_profile_t* p_profile);
+
+/**
+ * @brief 追加一段曲线
+ * @return false 段数已满或时长无效
+ */
+bool actuator_profile_add(actuator_profile_t* p_profile, const actuator_segment_t* p_segment);
+
+/**
+ * @brief 生成软启动曲线：斜坡升到 duty、保持、斜坡降到 0
+ * @details 总时长为 duration_ms（0 表示保持到停止，此时没有降速段）；
+ *          运行时间不足时斜坡按比例缩短，各占不超过一半
+ */
+void actuator_profile_soft_start(actuator_profile_t* p_profile, uint8_t duty, uint32_t duration_ms,
+                                 uint32_t ramp_up_ms, uint32_t ramp_down_ms);
+
+/**
+ * @brief 生成脉冲串曲线：count 个 on_ms 的脉冲，间隔 off_ms，每个脉冲软启动 ramp_ms
+ */
+void actuator_profile_pulses(actuator_profile_t* p_profile, uint8_t duty, uint16_t count,
+                             uint32_t on_ms, uint32_t off_ms, uint32_t ramp_ms);
+
+/**
+ * @brief 曲线总时长 (ms)
+ * @return ACTUATOR_DURATION_INFINITE 表示含有无限保持段
+ */
+uint32_t actuator_profile_duration_ms(const actuator_profile_t* p_profile);
+
+/**
+ * @brief 计算曲线在某一时刻的占空比（纯函数）
+ * @param elapsed_ms 从曲线开始经过的时间
+ * @param p_next_ms 输出占空比下一次可能变化的时刻（UINT32_MAX 表示不再变化），可为NULL
+ * @param p_segment 输出所在曲线段，可为NULL
+ * @return 占空比；曲线已结束时为 0
+ */
+uint8_t actuator_profile_eval(const actuator_profile_t* p_profile, uint32_t elapsed_ms,
+                              uint32_t* p_next_ms, uint8_t* p_segment);
+
 /**
  * @brief 初始化执行器管理器
  * @details 该函数应在系统启动时调用一次
@@ -17,7 +126,7 @@
 void actuator_manager_init();
 
 /**
- * @brief 启动水泵
+ * @brief 启动水泵（软启动后保持，直到调用停止）
  * @param duty_cycle 功率 (0-255)
  */
 void actuator_manager_start_pump(uint8_t duty_cycle);
@@ -29,16 +138,23 @@ void actuator_manager_stop_pump();
 
 /**
  * @brief 运行水泵指定时长 (非阻塞)
- * @details 此函数会立即返回。水泵将在后台运行指定时间后自动停止。
- *          需要周期性调用 actuator_manager_loop() 来驱动此逻辑。
+ * @details 此函数会立即返回。水泵按软启动曲线运行，由定时器在截止时刻停止，
+ *          不需要主循环参与；actuator_manager_loop() 负责随后释放12V电源。
  * @param duty_cycle 功率 (0-255)
- * @param duration_ms 运行的时长 (毫秒)
+ * @param duration_ms 运行的时长 (毫秒，含软启动与降速)
  */
 void actuator_manager_run_pump_for(uint8_t duty_cycle, uint32_t duration_ms);
 
+/**
+ * @brief 按占空比曲线运行水泵 (非阻塞)
+ * @param p_profile 曲线（复制保存，调用后可释放）
+ */
+actuator_result_t actuator_manager_run_profile(const actuator_profile_t* p_profile);
+
 /**
  * @brief 执行器管理器的循环函数
- * @details 该函数应在主循环中被周期性调用，以处理非阻塞逻辑。
+ * @details 该函数应在主循环中被周期性调用，处理运行结束后的12V电源释放与日志；
+ *          定时器不可用时兼作曲线引擎。
  */
 void actuator_manager_loop();
 
@@ -48,4 +164,9 @@ void actuator_manager_loop();
  */
 bool actuator_manager_is_pump_running();
 
-#endif // ACTUATOR_MANAGER_H
\ No newline at end of file
+/**
+ * @brief 获取引擎状态
+ */
+void actuator_manager_get_status(actuator_status_t* p_status);
+
+#endif // ACTUATOR_MANAGER_H
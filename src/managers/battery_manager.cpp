@@ -0,0 +1,361 @@
+/**
+ * @file battery_manager.cpp
+ * @brief 电池模型实现
+ */
+
+#include "battery_manager.h"
+#include "power_manager.h"
+#include "sensor_manager.h"
+#include "actuator_manager.h"
+#include "managers/log_manager.h"
+#include "../services/config_manager.h"
+#include <Arduino.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <sys/time.h>
+#include "esp_crc.h"
+
+// 卡尔曼滤波参数（状态为开路电压，随机游走模型）
+#define KF_PROCESS_NOISE_PER_S  1e-7f   // 过程噪声 (V²/s)：放电与负载模型误差
+#define KF_MEASURE_NOISE        9e-4f   // 测量噪声 (V²)：约30mV标准差
+#define KF_PUMP_NOISE_FACTOR    16.0f   // 水泵运行时电压纹波大，测量噪声放大倍数
+#define KF_GATE_SIGMA           4.0f    // 新息超过4σ视为瞬时跌落
+#define KF_MAX_REJECTS          3       // 连续剔除次数达到后视为真实阶跃（如接入充电）并重新初始化
+#define KF_MAX_DT_S             86400.0f
+
+#define LOAD_AVG_TAU_S          3600.0f // 平均负载电流的时间常数
+#define LEVEL_HYSTERESIS_PERCENT 2.0f   // 等级回升需超过阈值的幅度，避免在阈值附近反复切换
+
+#define RTC_STATE_MAGIC 0x42415454      // "BATT"
+
+typedef struct {
+    uint16_t mv;
+    uint8_t percent;
+} curve_point_t;
+
+static bool is_initialized = false;
+
+static curve_point_t s_curve[BATTERY_CURVE_MAX_POINTS];
+static uint8_t s_curve_len = 0;
+static uint16_t s_capacity_mah = BATTERY_DEFAULT_CAPACITY_MAH;
+static float s_resistance_ohm = BATTERY_DEFAULT_RESISTANCE_MOHM / 1000.0f;
+
+/**
+ * 滤波状态保存在 RTC 慢速内存中，深度睡眠与软件复位后保留，
+ * 每次唤醒的单次读数继续参与滤波而不是重新初始化滤波器。
+ * 时间戳取系统时间（睡眠期间由 RTC 继续计时）。
+ */
+typedef struct {
+    uint32_t magic;
+    battery_state_t state;
+    int64_t last_update_ms;       // 最近一次接受测量的系统时间 (ms)
+    uint8_t consecutive_rejects;
+    bool ledger_valid;            // 下列能耗账本快照有效
+    uint64_t ledger_charge_ua_ms; // 最近一次测量时账本的总电荷
+    uint64_t ledger_span_ms;      // 最近一次测量时账本的统计时长
+    uint32_t crc;
+} rtc_battery_state_t;
+
+RTC_DATA_ATTR static rtc_battery_state_t s_rtc;
+
+// --- 私有函数 ---
+
+static uint32_t rtc_crc() {
+    return esp_crc32_le(0, (const uint8_t*)&s_rtc, offsetof(rtc_battery_state_t, crc));
+}
+
+static void rtc_commit() {
+    s_rtc.magic = RTC_STATE_MAGIC;
+    s_rtc.crc = rtc_crc();
+}
+
+static int64_t wall_clock_ms() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+/**
+ * @brief 解析放电曲线
+ * @return 点数；格式错误返回0
+ */
+static uint8_t parse_curve(const char* spec, curve_point_t* out) {
+    if (spec == nullptr) return 0;
+
+    uint8_t count = 0;
+    const char* p = spec;
+    while (*p != '\0') {
+        if (count >= BATTERY_CURVE_MAX_POINTS) return 0;
+
+        char* end;
+        long mv = strtol(p, &end, 10);
+        if (end == p || *end != ':') return 0;
+        p = end + 1;
+        long pct = strtol(p, &end, 10);
+        if (end == p || (*end != ',' && *end != '\0')) return 0;
+        p = (*end == ',') ? end + 1 : end;
+
+        if (mv < 2000 || mv > 5000 || pct < 0 || pct > 100) return 0;
+        // 电压严格递减，百分比不增
+        if (count > 0 && (mv >= out[count - 1].mv || pct > out[count - 1].percent)) return 0;
+
+        out[count].mv = (uint16_t)mv;
+        out[count].percent = (uint8_t)pct;
+        count++;
+    }
+    return count >= 2 ? count : 0;
+}
+
+static battery_level_t classify_level(float soc, battery_level_t previous) {
+    float low = BATTERY_LOW_PERCENT;
+    float critical = BATTERY_CRITICAL_PERCENT;
+    // 只对回升方向加滞回
+    if (previous == BATTERY_LEVEL_CRITICAL) critical += LEVEL_HYSTERESIS_PERCENT;
+    if (previous != BATTERY_LEVEL_NORMAL) low += LEVEL_HYSTERESIS_PERCENT;
+
+    if (soc < critical) return BATTERY_LEVEL_CRITICAL;
+    if (soc < low) return BATTERY_LEVEL_LOW;
+    return BATTERY_LEVEL_NORMAL;
+}
+
+/**
+ * @param interval_load_ma 上一次测量以来的平均负载电流；
+ *        深度睡眠时各次测量只代表唤醒时的负载，需按整个区间（含睡眠）的平均值平滑
+ */
+static void update_estimates(float dt_s, float interval_load_ma) {
+    s_rtc.state.soc_percent = battery_manager_voltage_to_soc(s_rtc.state.filtered_voltage);
+
+    if (s_rtc.state.updates == 1) {
+        s_rtc.state.avg_load_ma = interval_load_ma;
+    } else {
+        float alpha = 1.0f - expf(-dt_s / LOAD_AVG_TAU_S);
+        s_rtc.state.avg_load_ma += alpha * (interval_load_ma - s_rtc.state.avg_load_ma);
+    }
+    s_rtc.state.runtime_hours = s_rtc.state.avg_load_ma > 0.0f
+        ? s_rtc.state.soc_percent / 100.0f * s_capacity_mah / s_rtc.state.avg_load_ma
+        : 0.0f;
+
+    battery_level_t level = classify_level(s_rtc.state.soc_percent, s_rtc.state.level);
+    if (s_rtc.state.updates > 1 && level != s_rtc.state.level) {
+        LOG_INFO("Battery", "Level %s -> %s (%.0f%%, %.3fV)",
+                 battery_manager_level_name(s_rtc.state.level), battery_manager_level_name(level),
+                 s_rtc.state.soc_percent, s_rtc.state.filtered_voltage);
+    }
+    s_rtc.state.level = level;
+}
+
+/**
+ * @brief 用能耗账本求上一次被接受的测量以来的平均负载电流（含深度睡眠）
+ * @param fallback_ma 账本快照无效、账本被清零或区间为空时的返回值
+ */
+static float ledger_interval_load_ma(uint64_t charge_ua_ms, uint64_t span_ms, float fallback_ma) {
+    if (!s_rtc.ledger_valid || span_ms <= s_rtc.ledger_span_ms || charge_ua_ms < s_rtc.ledger_charge_ua_ms) {
+        return fallback_ma;
+    }
+    return (float)(charge_ua_ms - s_rtc.ledger_charge_ua_ms) / (float)(span_ms - s_rtc.ledger_span_ms) / 1000.0f;
+}
+
+static battery_result_t feed(float voltage, uint16_t load_ma, float interval_load_ma) {
+    if (!is_initialized) return BATTERY_ERROR_NOT_INIT;
+    if (voltage < 2.0f || voltage > 5.0f) return BATTERY_ERROR_INVALID_PARAM;
+
+    int64_t now = wall_clock_ms();
+    float compensated = voltage + load_ma / 1000.0f * s_resistance_ohm;
+    float r = KF_MEASURE_NOISE;
+    if (load_ma >= BATTERY_LOAD_BASE_MA + BATTERY_LOAD_PUMP_MA) r *= KF_PUMP_NOISE_FACTOR;
+
+    s_rtc.state.raw_voltage = voltage;
+    s_rtc.state.compensated_voltage = compensated;
+    s_rtc.state.load_ma = load_ma;
+
+    if (!s_rtc.state.valid) {
+        s_rtc.state.filtered_voltage = compensated;
+        s_rtc.state.variance = r;
+        s_rtc.state.valid = true;
+        s_rtc.state.updates = 1;
+        s_rtc.last_update_ms = now;
+        update_estimates(0.0f, interval_load_ma);
+        rtc_commit();
+        return BATTERY_OK;
+    }
+
+    // 系统时间被向后校正时按零间隔处理
+    float dt_s = now > s_rtc.last_update_ms ? (now - s_rtc.last_update_ms) / 1000.0f : 0.0f;
+    if (dt_s > KF_MAX_DT_S) dt_s = KF_MAX_DT_S;
+
+    // 预测
+    float p = s_rtc.state.variance + KF_PROCESS_NOISE_PER_S * dt_s;
+
+    // 新息门限：瞬时跌落（电机启动、ADC毛刺）不进入估计
+    float innovation = compensated - s_rtc.state.filtered_voltage;
+    float s = p + r;
+    if (innovation * innovation > KF_GATE_SIGMA * KF_GATE_SIGMA * s) {
+        s_rtc.state.rejected++;
+        if (++s_rtc.consecutive_rejects < KF_MAX_REJECTS) {
+            rtc_commit();
+            LOG_DEBUG("Battery", "Rejected %.3fV (estimate %.3fV)", compensated, s_rtc.state.filtered_voltage);
+            return BATTERY_OK;
+        }
+        // 持续偏离说明电压确实变化了，以当前测量重新初始化
+        LOG_INFO("Battery", "Voltage step %.3fV -> %.3fV, re-initializing filter",
+                 s_rtc.state.filtered_voltage, compensated);
+        s_rtc.state.filtered_voltage = compensated;
+        s_rtc.state.variance = r;
+    } else {
+        float k = p / s;
+        s_rtc.state.filtered_voltage += k * innovation;
+        s_rtc.state.variance = (1.0f - k) * p;
+    }
+
+    s_rtc.consecutive_rejects = 0;
+    s_rtc.state.updates++;
+    s_rtc.last_update_ms = now;
+    update_estimates(dt_s, interval_load_ma);
+    rtc_commit();
+    return BATTERY_OK;
+}
+
+// --- 公共 API ---
+
+battery_result_t battery_manager_init() {
+    bool restored = s_rtc.magic == RTC_STATE_MAGIC && s_rtc.crc == rtc_crc();
+    if (!restored) {
+        memset(&s_rtc, 0, sizeof(s_rtc));
+        rtc_commit();
+    }
+
+    s_curve_len = parse_curve(BATTERY_DEFAULT_SOC_CURVE, s_curve);
+    is_initialized = true;
+
+    if (battery_manager_apply_config() != BATTERY_OK) {
+        LOG_WARN("Battery", "Invalid battery.soc_curve in config, using default curve");
+    }
+
+    LOG_INFO("Battery", "Battery manager initialized (%u points, %umAh, %.0fmOhm, %s)",
+             s_curve_len, s_capacity_mah, s_resistance_ohm * 1000.0f,
+             restored ? "filter state restored" : "no saved filter state");
+    return BATTERY_OK;
+}
+
+battery_result_t battery_manager_apply_config() {
+    if (!is_initialized) return BATTERY_ERROR_NOT_INIT;
+
+    const hydro_battery_config_t& config = ConfigManager::instance().getConfig().battery;
+    s_capacity_mah = config.capacity_mah > 0 ? config.capacity_mah : BATTERY_DEFAULT_CAPACITY_MAH;
+    s_resistance_ohm = config.internal_resistance_mohm / 1000.0f;
+
+    if (config.soc_curve[0] == '\0') {
+        s_curve_len = parse_curve(BATTERY_DEFAULT_SOC_CURVE, s_curve);
+        return BATTERY_OK;
+    }
+    return battery_manager_set_curve(config.soc_curve);
+}
+
+uint16_t battery_manager_estimate_load_ma() {
+    uint16_t load = BATTERY_LOAD_BASE_MA;
+    if (power_sensor_is_enabled()) load += BATTERY_LOAD_SENSOR_MA;
+    if (power_screen_is_enabled()) load += BATTERY_LOAD_SCREEN_MA;
+    if (power_pump_module_is_enabled()) load += BATTERY_LOAD_BOOST_MA;
+    if (actuator_manager_is_pump_running()) load += BATTERY_LOAD_PUMP_MA;
+    return load;
+}
+
+battery_result_t battery_manager_feed(float voltage) {
+    return battery_manager_feed_with_load(voltage, battery_manager_estimate_load_ma());
+}
+
+battery_result_t battery_manager_feed_with_load(float voltage, uint16_t load_ma) {
+    return feed(voltage, load_ma, load_ma);
+}
+
+battery_result_t battery_manager_update(uint32_t max_age_ms) {
+    if (!is_initialized) return BATTERY_ERROR_NOT_INIT;
+
+    float voltage;
+    if (sensor_manager_get_battery_voltage_cached(&voltage, max_age_ms) != SENSOR_OK) {
+        return BATTERY_ERROR_READ_FAILED;
+    }
+    power_ledger_stats_t stats;
+    power_ledger_get_stats(&stats);
+    uint64_t charge_ua_ms = 0;
+    for (int i = 0; i < POWER_LEDGER_COUNT; i++) {
+        charge_ua_ms += stats.entries[i].charge_ua_ms;
+    }
+    uint64_t span_ms = power_ledger_span_ms(&stats);
+
+    uint16_t load_ma = battery_manager_estimate_load_ma();
+    uint32_t updates = s_rtc.state.updates;
+    battery_result_t result = feed(voltage, load_ma, ledger_interval_load_ma(charge_ua_ms, span_ms, load_ma));
+
+    // 被剔除的测量不结算区间，其电荷计入下一次被接受的测量
+    if (s_rtc.state.updates != updates) {
+        s_rtc.ledger_valid = true;
+        s_rtc.ledger_charge_ua_ms = charge_ua_ms;
+        s_rtc.ledger_span_ms = span_ms;
+        rtc_commit();
+    }
+    return result;
+}
+
+battery_result_t battery_manager_get_state(battery_state_t* p_state) {
+    if (p_state == nullptr) return BATTERY_ERROR_INVALID_PARAM;
+    if (!is_initialized) return BATTERY_ERROR_NOT_INIT;
+    *p_state = s_rtc.state;
+    return BATTERY_OK;
+}
+
+battery_level_t battery_manager_get_level() {
+    return s_rtc.state.valid ? s_rtc.state.level : BATTERY_LEVEL_NORMAL;
+}
+
+battery_result_t battery_manager_set_curve(const char* spec) {
+    curve_point_t curve[BATTERY_CURVE_MAX_POINTS];
+    uint8_t len = parse_curve(spec, curve);
+    if (len == 0) return BATTERY_ERROR_INVALID_PARAM;
+
+    memcpy(s_curve, curve, sizeof(curve_point_t) * len);
+    s_curve_len = len;
+    if (s_rtc.state.valid) {
+        update_estimates(0.0f, s_rtc.state.avg_load_ma);
+        rtc_commit();
+    }
+    return BATTERY_OK;
+}
+
+bool battery_manager_curve_valid(const char* spec) {
+    curve_point_t curve[BATTERY_CURVE_MAX_POINTS];
+    return parse_curve(spec, curve) > 0;
+}
+
+float battery_manager_voltage_to_soc(float voltage) {
+    if (s_curve_len < 2) return 0.0f;
+
+    float mv = voltage * 1000.0f;
+    if (mv >= s_curve[0].mv) return s_curve[0].percent;
+    if (mv <= s_curve[s_curve_len - 1].mv) return s_curve[s_curve_len - 1].percent;
+
+    for (uint8_t i = 1; i < s_curve_len; i++) {
+        if (mv >= s_curve[i].mv) {
+            const curve_point_t& hi = s_curve[i - 1];
+            const curve_point_t& lo = s_curve[i];
+            float t = (mv - lo.mv) / (float)(hi.mv - lo.mv);
+            return lo.percent + t * (hi.percent - lo.percent);
+        }
+    }
+    return 0.0f;
+}
+
+void battery_manager_reset() {
+    memset(&s_rtc, 0, sizeof(s_rtc));
+    rtc_commit();
+}
+
+const char* battery_manager_level_name(battery_level_t level) {
+    switch (level) {
+        case BATTERY_LEVEL_LOW:      return "LOW";
+        case BATTERY_LEVEL_CRITICAL: return "CRITICAL";
+        default:                     return "NORMAL";
+    }
+}
@@ -0,0 +1,156 @@
+/**
+ * @file battery_manager.h
+ * @brief 电池模型：电压滤波、负载补偿、剩余电量与续航估计
+ * @details
+ *   电池分压为 4.7MΩ/330kΩ，单次读数噪声大，水泵工作时端电压明显下陷。
+ *   本模块把测得的端电压按当前负载补偿为开路电压（V_ocv = V + I·R_internal），
+ *   负载电流由 power_manager / actuator_manager 的状态查表估算；
+ *   补偿后的电压经一维卡尔曼滤波（带新息门限，剔除瞬时跌落），
+ *   再按可配置的锂电池放电曲线插值出剩余电量百分比，
+ *   并用平均负载电流估算剩余续航时间。
+ *
+ *   滤波、等级迟滞与平均负载状态保存在 RTC 慢速内存中（带校验），跨深度睡眠与软件复位保留。
+ *   深度睡眠时每次唤醒只测量一次，平均负载按能耗账本在两次测量间（含睡眠）的电荷计算，
+ *   而不是唤醒时的瞬时负载。
+ *
+ *   放电曲线格式: "mV:百分比,mV:百分比,..."，按电压从高到低排列，例如
+ *   "4200:100,3800:55,3300:0"；曲线之外的电压截断到 100% / 0%。
+ */
+
+#ifndef BATTERY_MANAGER_H
+#define BATTERY_MANAGER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define BATTERY_CURVE_MAX_POINTS  16
+#define BATTERY_DEFAULT_SOC_CURVE "4200:100,4100:90,4000:80,3900:70,3800:55,3750:45,3700:35,3650:20,3600:10,3500:5,3300:0"
+#define BATTERY_DEFAULT_CAPACITY_MAH   2000
+#define BATTERY_DEFAULT_RESISTANCE_MOHM 150
+
+#define BATTERY_LOW_PERCENT       30    // 低于此值进入 LOW，RUN 模式降低采样与刷新频率
+#define BATTERY_CRITICAL_PERCENT  10    // 低于此值进入 CRITICAL
+
+// 负载电流模型 (mA)，按实测整机电流估计
+#define BATTERY_LOAD_BASE_MA      45    // MCU 工作（含 WiFi 空闲）
+#define BATTERY_LOAD_SENSOR_MA    5     // 传感器电源
+#define BATTERY_LOAD_SCREEN_MA    8     // 墨水屏电源
+#define BATTERY_LOAD_BOOST_MA     20    // 12V 升压模块空载
+#define BATTERY_LOAD_PUMP_MA      250   // 水泵运行（折算到电池侧）
+
+/**
+ * @brief 电池管理器操作结果枚举
+ */
+typedef enum {
+    BATTERY_OK = 0,               ///< 操作成功
+    BATTERY_ERROR_NOT_INIT,       ///< 电池管理器未初始化
+    BATTERY_ERROR_READ_FAILED,    ///< 电压读取失败
+    BATTERY_ERROR_INVALID_PARAM   ///< 无效参数（如曲线格式错误）
+} battery_result_t;
+
+/**
+ * @brief 电量等级
+ */
+typedef enum {
+    BATTERY_LEVEL_NORMAL = 0,     ///< 正常
+    BATTERY_LEVEL_LOW,            ///< 低电量 (< BATTERY_LOW_PERCENT)
+    BATTERY_LEVEL_CRITICAL        ///< 电量严重不足 (< BATTERY_CRITICAL_PERCENT)
+} battery_level_t;
+
+/**
+ * @brief 电池状态
+ */
+typedef struct {
+    bool valid;                   ///< 是否已有有效估计
+    float raw_voltage;            ///< 最近一次测得的端电压 (V)
+    float compensated_voltage;    ///< 负载补偿后的开路电压 (V)
+    float filtered_voltage;       ///< 滤波后的开路电压 (V)
+    float variance;               ///< 滤波估计方差 (V²)
+    uint16_t load_ma;             ///< 最近一次测量时的估计负载电流 (mA)
+    float avg_load_ma;            ///< 平均负载电流 (mA，时间常数1小时，含睡眠期间)
+    float soc_percent;            ///< 剩余电量 (0-100%)
+    float runtime_hours;          ///< 按平均负载估算的剩余续航 (小时)
+    battery_level_t level;        ///< 电量等级
+    uint32_t updates;             ///< 被接受的测量次数
+    uint32_t rejected;            ///< 被新息门限剔除的测量次数
+} battery_state_t;
+
+/**
+ * @brief 初始化电池管理器
+ * @details 从 RTC 内存恢复滤波状态；从 ConfigManager 读取放电曲线、容量与内阻，配置无效时使用默认值
+ * @return battery_result_t 初始化结果
+ */
+battery_result_t battery_manager_init();
+
+/**
+ * @brief 按当前配置重新加载曲线、容量与内阻（不清除滤波状态）
+ * @return BATTERY_ERROR_INVALID_PARAM 曲线无效（保留原曲线）
+ */
+battery_result_t battery_manager_apply_config();
+
+/**
+ * @brief 估算当前负载电流
+ * @details 依据传感器、屏幕、升压模块电源与水泵运行状态查表
+ * @return 负载电流 (mA)
+ */
+uint16_t battery_manager_estimate_load_ma();
+
+/**
+ * @brief 输入一次端电压测量（负载取当前状态估算值）
+ * @param voltage 测得的端电压 (V)
+ * @return BATTERY_ERROR_INVALID_PARAM 电压不在 2.0-5.0V 内
+ */
+battery_result_t battery_manager_feed(float voltage);
+
+/**
+ * @brief 输入一次端电压测量并指定测量时的负载
+ * @param voltage 测得的端电压 (V)
+ * @param load_ma 测量时的负载电流 (mA)
+ */
+battery_result_t battery_manager_feed_with_load(float voltage, uint16_t load_ma);
+
+/**
+ * @brief 读取一次电池电压（经传感器快照缓存）并更新模型
+ * @param max_age_ms 可接受的快照最大年龄
+ */
+battery_result_t battery_manager_update(uint32_t max_age_ms);
+
+/**
+ * @brief 获取当前电池状态
+ */
+battery_result_t battery_manager_get_state(battery_state_t* p_state);
+
+/**
+ * @brief 获取当前电量等级（无有效估计时返回 NORMAL）
+ */
+battery_level_t battery_manager_get_level();
+
+/**
+ * @brief 设置放电曲线（仅运行时生效，持久化请写入 battery.soc_curve 配置）
+ * @param spec "mV:百分比,..." 格式，至少两点，电压严格递减，百分比不增
+ */
+battery_result_t battery_manager_set_curve(const char* spec);
+
+/**
+ * @brief 校验放电曲线字符串
+ */
+bool battery_manager_curve_valid(const char* spec);
+
+/**
+ * @brief 按当前放电曲线把开路电压换算为剩余电量
+ * @param voltage 开路电压 (V)
+ * @return 剩余电量 (0-100%)
+ */
+float battery_manager_voltage_to_soc(float voltage);
+
+/**
+ * @brief 清除滤波状态与统计，下一次测量重新初始化滤波器
+ */
+void battery_manager_reset();
+
+/**
+ * @brief 电量等级名称
+ */
+const char* battery_manager_level_name(battery_level_t level);
+
+#endif // BATTERY_MANAGER_H
@@ -0,0 +1,285 @@
+/**
+ * @file drying_model.cpp
+ * @brief 干燥速率模型与预测性检查间隔实现
+ */
+
+#include "drying_model.h"
+#include "managers/log_manager.h"
+#include "data/timing_constants.h"
+#include "../services/config_manager.h"
+#include <Arduino.h>
+#include <string.h>
+#include <stddef.h>
+#include <time.h>
+#include "esp_crc.h"
+
+#define RTC_STATE_MAGIC   0x4452594D  // "DRYM"
+#define SECONDS_PER_DAY   86400
+#define MAX_SPAN_S        21600       // 相距更久的两次读数不做观测（期间离开了RUN模式）
+#define MIN_RATE          0.1f        // 低于此速率 (ADC/小时) 不用于计算浇水后倍数
+
+// 保存在 RTC 慢速内存中，深度睡眠与软件复位后保留
+typedef struct {
+    uint32_t magic;
+    drying_model_state_t state;
+    uint32_t crc;
+} rtc_drying_state_t;
+
+RTC_DATA_ATTR static rtc_drying_state_t s_rtc;
+
+// --- 私有函数 ---
+
+static uint32_t rtc_crc() {
+    return esp_crc32_le(0, (const uint8_t*)&s_rtc, offsetof(rtc_drying_state_t, crc));
+}
+
+static void rtc_commit() {
+    s_rtc.magic = RTC_STATE_MAGIC;
+    s_rtc.crc = rtc_crc();
+}
+
+static float clampf(float value, float lo, float hi) {
+    return value < lo ? lo : (value > hi ? hi : value);
+}
+
+static uint8_t bucket_of(const drying_model_config_t* p_config, uint32_t t) {
+    int64_t local = (int64_t)t + p_config->utc_offset_s;
+    int32_t second_of_day = (int32_t)(((local % SECONDS_PER_DAY) + SECONDS_PER_DAY) % SECONDS_PER_DAY);
+    return (uint8_t)(second_of_day / (SECONDS_PER_DAY / DRYING_MODEL_BUCKETS));
+}
+
+static bool in_post_window(const drying_model_state_t* p_state, uint32_t t) {
+    return p_state->last_watering != 0 && t >= p_state->last_watering &&
+           t - p_state->last_watering < DRYING_MODEL_POST_WATERING_MS / 1000;
+}
+
+// 时段的基础速率（未观测的时段用平均速率）
+static float base_rate(const drying_model_state_t* p_state, uint8_t bucket) {
+    return p_state->bucket_obs[bucket] > 0 ? p_state->bucket_rate[bucket] : p_state->rate;
+}
+
+static float rate_at(const drying_model_state_t* p_state, const drying_model_config_t* p_config, uint32_t t) {
+    float rate = base_rate(p_state, bucket_of(p_config, t));
+    return in_post_window(p_state, t) ? rate * p_state->post_factor : rate;
+}
+
+static void anchor(drying_model_state_t* p_state, float value, uint32_t now) {
+    p_state->anchored = true;
+    p_state->anchor_value = value;
+    p_state->anchor_time = now;
+}
+
+// --- 纯函数核心 ---
+
+void drying_model_state_init(drying_model_state_t* p_state) {
+    memset(p_state, 0, sizeof(*p_state));
+    p_state->post_factor = 1.0f;
+}
+
+void drying_model_on_watering(drying_model_state_t* p_state, uint32_t now) {
+    p_state->last_watering = now;
+    p_state->anchored = false;
+}
+
+bool drying_model_step(drying_model_state_t* p_state, const drying_model_config_t* p_config,
+                       float value, uint32_t now) {
+    p_state->last_value = value;
+    p_state->last_time = now;
+
+    if (p_state->last_watering != 0 && now >= p_state->last_watering &&
+        now - p_state->last_watering < p_config->soak_s) {
+        p_state->anchored = false;  // 渗透中，读数还在下降
+        return false;
+    }
+    if (!p_state->anchored || now < p_state->anchor_time || now - p_state->anchor_time > MAX_SPAN_S) {
+        anchor(p_state, value, now);
+        return false;
+    }
+    if (value < p_state->anchor_value - DRYING_MODEL_JUMP) {
+        // 手动浇水或下雨：按浇水处理，渗透后重新开始观测
+        drying_model_on_watering(p_state, now);
+        return false;
+    }
+
+    uint32_t span = now - p_state->anchor_time;
+    if (span < DRYING_MODEL_MIN_SPAN_MS / 1000) {
+        return false;
+    }
+
+    float observed = (value - p_state->anchor_value) * 3600.0f / span;
+    if (observed > DRYING_MODEL_MAX_RATE) {
+        return false;  // 尖峰：保留锚点，下次检查再观测
+    }
+    if (observed < 0.0f) {
+        observed = 0.0f;
+    }
+
+    uint32_t middle = p_state->anchor_time + span / 2;
+    uint8_t bucket = bucket_of(p_config, middle);
+    if (in_post_window(p_state, middle) && p_state->observations > 0) {
+        float base = base_rate(p_state, bucket);
+        if (base >= MIN_RATE) {
+            float ratio = clampf(observed / base, DRYING_MODEL_MIN_FACTOR, DRYING_MODEL_MAX_FACTOR);
+            p_state->post_factor += DRYING_MODEL_ALPHA * (ratio - p_state->post_factor);
+            if (p_state->post_observations < UINT16_MAX) {
+                p_state->post_observations++;
+            }
+        }
+        observed /= p_state->post_factor;  // 折算为基础速率
+    }
+
+    if (p_state->bucket_obs[bucket] == 0) {
+        p_state->bucket_rate[bucket] = observed;
+    } else {
+        p_state->bucket_rate[bucket] += DRYING_MODEL_ALPHA * (observed - p_state->bucket_rate[bucket]);
+    }
+    if (p_state->bucket_obs[bucket] < UINT16_MAX) {
+        p_state->bucket_obs[bucket]++;
+    }
+
+    if (p_state->observations == 0) {
+        p_state->rate = observed;
+    } else {
+        p_state->rate += DRYING_MODEL_ALPHA * (observed - p_state->rate);
+    }
+    if (p_state->observations < UINT16_MAX) {
+        p_state->observations++;
+    }
+
+    anchor(p_state, value, now);
+    return true;
+}
+
+void drying_model_predict(const drying_model_state_t* p_state, const drying_model_config_t* p_config,
+                          float value, uint32_t now, uint32_t min_interval_s,
+                          drying_prediction_t* p_prediction) {
+    p_prediction->cross_s = UINT32_MAX;
+    p_prediction->rate = rate_at(p_state, p_config, now);
+    p_prediction->learned = p_state->observations > 0 && p_config->max_interval_s > 0;
+    p_prediction->interval_s = min_interval_s;
+    if (!p_prediction->learned) {
+        return;
+    }
+    if (value >= p_config->threshold) {
+        p_prediction->cross_s = 0;
+        return;
+    }
+
+    // 按各时段速率分步积分，只需看到间隔上限对应的范围
+    uint8_t margin = p_config->margin_pct > DRYING_MODEL_MAX_MARGIN ? DRYING_MODEL_MAX_MARGIN : p_config->margin_pct;
+    uint32_t horizon = (uint32_t)((uint64_t)p_config->max_interval_s * 100 / (100 - margin));
+    uint32_t t = 0;
+    float projected = value;
+    while (t < horizon) {
+        uint32_t step = horizon - t < DRYING_MODEL_PREDICT_STEP_MS / 1000 ? horizon - t : DRYING_MODEL_PREDICT_STEP_MS / 1000;
+        float rate = rate_at(p_state, p_config, now + t + step / 2);
+        float rise = rate * step / 3600.0f;
+        if (projected + rise >= p_config->threshold) {
+            p_prediction->cross_s = t + (uint32_t)((p_config->threshold - projected) / rate * 3600.0f);
+            break;
+        }
+        projected += rise;
+        t += step;
+    }
+
+    uint32_t interval = p_prediction->cross_s == UINT32_MAX ?
+                        p_config->max_interval_s :
+                        (uint32_t)((uint64_t)p_prediction->cross_s * (100 - margin) / 100);
+    if (interval > p_config->max_interval_s) {
+        interval = p_config->max_interval_s;
+    }
+
+    // 渗透结束时再检查一次：观测浇水响应
+    if (p_state->last_watering != 0 && now >= p_state->last_watering &&
+        now - p_state->last_watering < p_config->soak_s) {
+        uint32_t soak_left = p_config->soak_s - (now - p_state->last_watering);
+        if (interval > soak_left) {
+            interval = soak_left;
+        }
+    }
+
+    p_prediction->interval_s = interval < min_interval_s ? min_interval_s : interval;
+}
+
+// --- RUN 模式实例 ---
+
+void drying_model_load_config(drying_model_config_t* p_config) {
+    hydro_config_t& config = ConfigManager::instance().getConfig();
+    p_config->threshold = config.watering.threshold + config.watering.hysteresis / 2.0f;
+    p_config->max_interval_s = config.system.check_max_s;
+    p_config->margin_pct = config.system.check_margin_pct;
+    p_config->soak_s = ADAPTIVE_WATERING_SOAK_MS / 1000;
+
+    time_t now = time(nullptr);
+    struct tm timeinfo;
+    localtime_r(&now, &timeinfo);
+    int32_t offset = (timeinfo.tm_hour * 3600 + timeinfo.tm_min * 60 + timeinfo.tm_sec) -
+                     (int32_t)(now % SECONDS_PER_DAY);
+    if (offset > SECONDS_PER_DAY / 2) {
+        offset -= SECONDS_PER_DAY;
+    } else if (offset <= -SECONDS_PER_DAY / 2) {
+        offset += SECONDS_PER_DAY;
+    }
+    p_config->utc_offset_s = offset;
+}
+
+void drying_model_init() {
+    if (s_rtc.magic == RTC_STATE_MAGIC && s_rtc.crc == rtc_crc()) {
+        LOG_DEBUG("Drying", "Restored drying model (%u observations, %.1f ADC/h)",
+                  s_rtc.state.observations, s_rtc.state.rate);
+        return;
+    }
+    drying_model_state_init(&s_rtc.state);
+    rtc_commit();
+    LOG_DEBUG("Drying", "No saved drying model, starting empty");
+}
+
+void drying_model_notify_watering() {
+    drying_model_on_watering(&s_rtc.state, (uint32_t)time(nullptr));
+    rtc_commit();
+}
+
+void drying_model_update(float value) {
+    drying_model_config_t config;
+    drying_model_load_config(&config);
+    if (drying_model_step(&s_rtc.state, &config, value, (uint32_t)time(nullptr))) {
+        LOG_DEBUG("Drying", "Drying rate %.1f ADC/h (mean %.1f, after watering x%.2f)",
+                  rate_at(&s_rtc.state, &config, s_rtc.state.last_time), s_rtc.state.rate,
+                  s_rtc.state.post_factor);
+    }
+    rtc_commit();
+}
+
+uint32_t drying_model_next_interval_ms(uint32_t base_ms, drying_prediction_t* p_prediction) {
+    drying_prediction_t prediction;
+    memset(&prediction, 0, sizeof(prediction));
+    prediction.cross_s = UINT32_MAX;
+    prediction.interval_s = base_ms / 1000;
+
+    uint32_t interval_ms = base_ms;
+    if (s_rtc.state.last_time != 0) {
+        drying_model_config_t config;
+        drying_model_load_config(&config);
+        drying_model_predict(&s_rtc.state, &config, s_rtc.state.last_value, (uint32_t)time(nullptr),
+                             base_ms / 1000, &prediction);
+        uint64_t predicted_ms = (uint64_t)prediction.interval_s * 1000;
+        if (predicted_ms > interval_ms) {
+            interval_ms = (uint32_t)predicted_ms;
+        }
+    }
+
+    if (p_prediction != nullptr) {
+        *p_prediction = prediction;
+    }
+    return interval_ms;
+}
+
+void drying_model_get_state(drying_model_state_t* p_state) {
+    *p_state = s_rtc.state;
+}
+
+void drying_model_reset() {
+    drying_model_state_init(&s_rtc.state);
+    rtc_commit();
+    LOG_INFO("Drying", "Drying model cleared");
+}
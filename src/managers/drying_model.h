@@ -0,0 +1,149 @@
+/**
+ * @file drying_model.h
+ * @brief 干燥速率模型与预测性检查间隔
+ * @details
+ *   土壤在两次浇水之间干燥得很慢，固定的检查间隔大部分时候只是在确认"还没干"。
+ *   本模块学习湿度读数的上升速率，预测何时越过浇水阈值（滤波判定进入"需要浇水"的
+ *   threshold + hysteresis/2），把下一次检查安排在安全的最晚时刻：
+ *   1. 速率观测：以锚点样本为起点，跨度达到 DRYING_MODEL_MIN_SPAN_MS 后
+ *      用两端的读数差求一次速率 (ADC/小时)，负值（读数噪声、夜间回潮）按 0 计，
+ *      超过 DRYING_MODEL_MAX_RATE 的视为尖峰并保留原锚点。
+ *      输入为每次检查的原始读数而不是滤波输出：检查间隔拉长后滤波窗口跨越数小时，
+ *      中位数滞后且会把真实的上升判为尖峰。
+ *   2. 时段补偿：一天分为 DRYING_MODEL_BUCKETS 个本地时段，各自指数平均；
+ *      尚未观测的时段使用全部时段的平均速率。
+ *   3. 浇水补偿：浇水后的渗透时间内不观测；之后 DRYING_MODEL_POST_WATERING_MS
+ *      内土壤干燥较快，该窗口内的速率按单独学习的倍数修正。读数骤降超过
+ *      DRYING_MODEL_JUMP（手动浇水、下雨）同样视为一次浇水。
+ *   4. 预测：从当前读数按各时段速率分步积分到阈值，得到越过时间 T；
+ *      下一次检查间隔 = T × (1 − 余量)，限制在 [基础间隔, check_max_s] 内。
+ *      渗透中的浇水在渗透结束时再检查一次（自适应浇水观测与传感器响应检测）。
+ *
+ *   模型尚无观测、读数已超过阈值或 check_max_s 为 0 时使用基础间隔（即原先的固定间隔），
+ *   因此越接近阈值检查越密，越过阈值后滤波窗口仍按原频率填满。
+ *   状态保存在 RTC 慢速内存中，跨深度睡眠与软件复位保留；核心为纯函数，
+ *   可离线回放记录的湿度历史（run predict replay）。
+ */
+
+#ifndef DRYING_MODEL_H
+#define DRYING_MODEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define DRYING_MODEL_BUCKETS      6         // 每天的时段数（每段4小时）
+#define DRYING_MODEL_ALPHA        0.3f      // 速率与浇水倍数的平滑系数
+#define DRYING_MODEL_JUMP         100.0f    // 读数下降超过此值视为浇水 (ADC值)
+#define DRYING_MODEL_MAX_RATE     250.0f    // 更快的上升视为尖峰，不做观测 (ADC/小时)
+#define DRYING_MODEL_MIN_FACTOR   0.5f      // 浇水后速率倍数的范围
+#define DRYING_MODEL_MAX_FACTOR   4.0f
+#define DRYING_MODEL_MAX_MARGIN   90        // 安全余量上限 (%)
+
+/**
+ * @brief 模型参数
+ */
+typedef struct {
+    float threshold;            ///< 判定需要浇水的读数 (ADC值，越大越干)
+    uint32_t max_interval_s;    ///< 检查间隔上限 (秒，0 表示不预测)
+    uint8_t margin_pct;         ///< 安全余量 (%)
+    uint32_t soak_s;            ///< 浇水后的渗透时间 (秒)
+    int32_t utc_offset_s;       ///< 本地时间相对系统时钟的偏移 (秒，决定时段)
+} drying_model_config_t;
+
+/**
+ * @brief 模型状态
+ */
+typedef struct {
+    float bucket_rate[DRYING_MODEL_BUCKETS];     ///< 各时段的干燥速率 (ADC/小时)
+    uint16_t bucket_obs[DRYING_MODEL_BUCKETS];   ///< 各时段的观测次数
+    float rate;                 ///< 全部时段的平均速率 (ADC/小时)
+    float post_factor;          ///< 浇水后窗口内速率的倍数
+    uint16_t observations;      ///< 速率观测次数
+    uint16_t post_observations; ///< 浇水后窗口内的观测次数
+    bool anchored;              ///< 已有速率观测的起点
+    float anchor_value;
+    uint32_t anchor_time;
+    uint32_t last_watering;     ///< 最近一次浇水时间 (系统时钟秒，0 表示无)
+    float last_value;           ///< 最近一次读数
+    uint32_t last_time;         ///< 最近一次读数的时间 (0 表示无)
+} drying_model_state_t;
+
+/**
+ * @brief 预测结果
+ */
+typedef struct {
+    uint32_t interval_s;        ///< 下一次检查的间隔 (秒)
+    uint32_t cross_s;           ///< 预计越过阈值的剩余时间 (秒，UINT32_MAX 表示预测范围内不会)
+    float rate;                 ///< 当前时刻的预测速率 (ADC/小时)
+    bool learned;               ///< 是否按学习到的速率预测（否则为基础间隔）
+} drying_prediction_t;
+
+/**
+ * @brief 清空状态
+ */
+void drying_model_state_init(drying_model_state_t* p_state);
+
+/**
+ * @brief 记录一次浇水（纯函数）
+ * @param now 当前时间 (秒)
+ */
+void drying_model_on_watering(drying_model_state_t* p_state, uint32_t now);
+
+/**
+ * @brief 处理一次检查的读数（纯函数）
+ * @param value 本次检查的湿度读数 (ADC值)
+ * @param now 当前时间 (秒)
+ * @return true 本次完成了一次速率观测
+ */
+bool drying_model_step(drying_model_state_t* p_state, const drying_model_config_t* p_config,
+                       float value, uint32_t now);
+
+/**
+ * @brief 预测越过阈值的时间和下一次检查间隔（纯函数）
+ * @param value 当前读数
+ * @param min_interval_s 基础检查间隔 (秒)
+ */
+void drying_model_predict(const drying_model_state_t* p_state, const drying_model_config_t* p_config,
+                          float value, uint32_t now, uint32_t min_interval_s,
+                          drying_prediction_t* p_prediction);
+
+/**
+ * @brief 由当前配置填充模型参数（时段按当前时区计算）
+ */
+void drying_model_load_config(drying_model_config_t* p_config);
+
+/**
+ * @brief 初始化 RUN 模式使用的模型实例
+ * @details 校验 RTC 内存中的状态，无效（冷启动）时清空
+ */
+void drying_model_init();
+
+/**
+ * @brief 记录一次浇水（自动或强制）
+ */
+void drying_model_notify_watering();
+
+/**
+ * @brief 每次湿度检查调用：用本次读数更新模型
+ */
+void drying_model_update(float value);
+
+/**
+ * @brief 下一次检查的间隔
+ * @param base_ms 基础检查间隔 (ms)，也是下限
+ * @param p_prediction 输出预测详情（可为NULL）
+ * @return 间隔 (ms)；尚无读数时为 base_ms
+ */
+uint32_t drying_model_next_interval_ms(uint32_t base_ms, drying_prediction_t* p_prediction);
+
+/**
+ * @brief 获取模型状态副本
+ */
+void drying_model_get_state(drying_model_state_t* p_state);
+
+/**
+ * @brief 清空学习到的速率
+ */
+void drying_model_reset();
+
+#endif // DRYING_MODEL_H
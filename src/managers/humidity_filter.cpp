@@ -0,0 +1,201 @@
+/**
+ * @file humidity_filter.cpp
+ * @brief 湿度滤波流水线实现
+ */
+
+#include "humidity_filter.h"
+#include "managers/log_manager.h"
+#include "managers/ts/ts_store.h"
+#include "data/timing_constants.h"
+#include "../services/config_manager.h"
+#include <Arduino.h>
+#include <string.h>
+#include <stddef.h>
+#include <math.h>
+#include "esp_crc.h"
+
+#define RTC_STATE_MAGIC 0x48464C54  // "HFLT"
+
+// 保存在 RTC 慢速内存中，深度睡眠与软件复位后保留
+typedef struct {
+    uint32_t magic;
+    humidity_filter_state_t state;
+    uint32_t crc;
+} rtc_filter_state_t;
+
+RTC_DATA_ATTR static rtc_filter_state_t s_rtc;
+
+static bool s_restored = false;
+
+// --- 私有函数 ---
+
+static uint32_t rtc_crc() {
+    return esp_crc32_le(0, (const uint8_t*)&s_rtc, offsetof(rtc_filter_state_t, crc));
+}
+
+static void rtc_commit() {
+    s_rtc.magic = RTC_STATE_MAGIC;
+    s_rtc.crc = rtc_crc();
+}
+
+// 插入排序求中位数（窗口不超过 HUMIDITY_FILTER_MAX_WINDOW）
+static float median_of(float* values, uint8_t count) {
+    for (uint8_t i = 1; i < count; i++) {
+        float v = values[i];
+        int j = i - 1;
+        while (j >= 0 && values[j] > v) {
+            values[j + 1] = values[j];
+            j--;
+        }
+        values[j + 1] = v;
+    }
+    return (count & 1) ? values[count / 2] : (values[count / 2 - 1] + values[count / 2]) / 2.0f;
+}
+
+/**
+ * @brief 取最近 n 个样本（从新到旧）
+ * @param skip_outliers 跳过被判定为尖峰的样本；全部被跳过时返回全部样本
+ * @return 实际取到的数量
+ */
+static uint8_t recent_samples(const humidity_filter_state_t* p_state, uint8_t n, bool skip_outliers, float* out) {
+    if (n > p_state->count) n = p_state->count;
+    uint8_t taken = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        uint8_t idx = (p_state->head + HUMIDITY_FILTER_MAX_WINDOW - 1 - i) % HUMIDITY_FILTER_MAX_WINDOW;
+        if (skip_outliers && (p_state->outlier_mask & (1u << idx))) continue;
+        out[taken++] = p_state->samples[idx];
+    }
+    if (taken == 0 && skip_outliers) return recent_samples(p_state, n, false, out);
+    return taken;
+}
+
+// --- 公共 API ---
+
+void humidity_filter_state_init(humidity_filter_state_t* p_state) {
+    memset(p_state, 0, sizeof(*p_state));
+}
+
+bool humidity_filter_step(humidity_filter_state_t* p_state, const humidity_filter_config_t* p_config,
+                          float raw, humidity_filter_result_t* p_result) {
+    uint8_t window = p_config->window;
+    if (window < 1) window = 1;
+    if (window > HUMIDITY_FILTER_MAX_WINDOW) window = HUMIDITY_FILTER_MAX_WINDOW;
+
+    float buf[HUMIDITY_FILTER_MAX_WINDOW];
+    bool outlier = false;
+
+    // 1. Hampel：与包含当前输入的原始样本窗口的中位数比较
+    //    （比较基准用原始样本，信号真实阶跃时几个周期后即不再被判为尖峰）
+    if (p_config->hampel_k > 0.0f && window >= 3) {
+        uint8_t n = recent_samples(p_state, window - 1, false, buf);
+        if (n >= 2) {
+            buf[n++] = raw;
+            float median = median_of(buf, n);
+            for (uint8_t i = 0; i < n; i++) buf[i] = fabsf(buf[i] - median);
+            float mad = median_of(buf, n);
+            if (mad < HUMIDITY_FILTER_MAD_FLOOR) mad = HUMIDITY_FILTER_MAD_FLOOR;
+            if (fabsf(raw - median) > p_config->hampel_k * 1.4826f * mad) {
+                outlier = true;
+                p_state->outliers++;
+            }
+        }
+    }
+
+    float clamped = raw < 0.0f ? 0.0f : (raw > 65535.0f ? 65535.0f : raw);
+    p_state->samples[p_state->head] = (uint16_t)lroundf(clamped);
+    if (outlier) {
+        p_state->outlier_mask |= (1u << p_state->head);
+    } else {
+        p_state->outlier_mask &= ~(1u << p_state->head);
+    }
+    p_state->head = (p_state->head + 1) % HUMIDITY_FILTER_MAX_WINDOW;
+    if (p_state->count < HUMIDITY_FILTER_MAX_WINDOW) p_state->count++;
+    p_state->total++;
+
+    // 2. 滑动中位数（尖峰不参与）
+    uint8_t n = recent_samples(p_state, window, true, buf);
+    float filtered = median_of(buf, n);
+    p_state->last_filtered = filtered;
+    bool ready = (p_state->count < window ? p_state->count : window) >= window / 2 + 1;
+
+    // 3. 迟滞判定
+    bool was_needed = p_state->need_water;
+    if (ready) {
+        float half_band = p_config->hysteresis / 2.0f;
+        if (filtered > p_config->threshold + half_band) {
+            p_state->need_water = true;
+        } else if (filtered < p_config->threshold - half_band || half_band == 0.0f) {
+            p_state->need_water = false;
+        }
+    }
+    bool started = !was_needed && p_state->need_water;
+    if (started) p_state->transitions++;
+
+    if (p_result != nullptr) {
+        p_result->raw = raw;
+        p_result->filtered = filtered;
+        p_result->outlier = outlier;
+        p_result->ready = ready;
+        p_result->need_water = p_state->need_water;
+        p_result->started = started;
+    }
+    return p_state->need_water;
+}
+
+void humidity_filter_load_config(humidity_filter_config_t* p_config) {
+    const hydro_watering_config_t& watering = ConfigManager::instance().getConfig().watering;
+    p_config->threshold = watering.threshold;
+    p_config->window = watering.filter_window;
+    p_config->hampel_k = watering.hampel_k;
+    p_config->hysteresis = watering.hysteresis;
+}
+
+void humidity_filter_init() {
+    s_restored = s_rtc.magic == RTC_STATE_MAGIC && s_rtc.crc == rtc_crc();
+    if (!s_restored) {
+        humidity_filter_state_init(&s_rtc.state);
+        rtc_commit();
+        LOG_DEBUG("HumFilter", "No saved filter state, starting empty");
+        return;
+    }
+
+    uint32_t now = ts_store_now();
+    if (now != 0 && s_rtc.state.last_time != 0 &&
+        (now < s_rtc.state.last_time || (now - s_rtc.state.last_time) * 1000ULL > HUMIDITY_FILTER_STALE_MS)) {
+        // 窗口里的样本已不代表当前土壤状态，保留统计计数
+        LOG_INFO("HumFilter", "Saved filter window is stale (%lus old), discarding samples",
+                 (unsigned long)(now - s_rtc.state.last_time));
+        s_rtc.state.count = 0;
+        s_rtc.state.head = 0;
+        s_rtc.state.outlier_mask = 0;
+        s_rtc.state.need_water = false;
+        rtc_commit();
+        return;
+    }
+
+    LOG_INFO("HumFilter", "Restored filter state (%u samples, filtered=%.0f, need_water=%d)",
+             s_rtc.state.count, s_rtc.state.last_filtered, s_rtc.state.need_water);
+}
+
+bool humidity_filter_update(float raw, humidity_filter_result_t* p_result) {
+    humidity_filter_config_t config;
+    humidity_filter_load_config(&config);
+
+    bool need = humidity_filter_step(&s_rtc.state, &config, raw, p_result);
+    s_rtc.state.last_time = ts_store_now();
+    rtc_commit();
+    return need;
+}
+
+void humidity_filter_get_state(humidity_filter_state_t* p_state) {
+    *p_state = s_rtc.state;
+}
+
+void humidity_filter_reset() {
+    humidity_filter_state_init(&s_rtc.state);
+    rtc_commit();
+}
+
+bool humidity_filter_was_restored() {
+    return s_restored;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file humidity_filter.h
+ * @brief 浇水判定前的湿度滤波流水线
+ * @details
+ *   每次湿度检查的截尾均值依次经过：
+ *   1. Hampel 离群判定：与最近 N 个原始样本的中位数相差超过 k·1.4826·MAD 的样本标记为尖峰；
+ *   2. 滑动中位数：输出窗口内 N 个样本中未标记样本的中位数；
+ *   3. 迟滞判定：滤波值高于 threshold + hysteresis/2 时进入"需要浇水"，
+ *      低于 threshold - hysteresis/2 时退出，其间保持原状态。
+ *
+ *   window=1、hampel_k=0、hysteresis=0 时等价于原先的单次读数比较。
+ *
+ *   运行状态保存在 RTC 慢速内存中（RTC_DATA_ATTR），带校验，跨深度睡眠与软件复位保留；
+ *   掉电冷启动或距上次样本超过 HUMIDITY_FILTER_STALE_MS（需墙钟时间）时重新开始。
+ *   流水线本身是对状态结构的纯函数，回放测试可用独立的状态实例离线运行同一判定逻辑。
+ */
+
+#ifndef HUMIDITY_FILTER_H
+#define HUMIDITY_FILTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define HUMIDITY_FILTER_MAX_WINDOW   9
+#define HUMIDITY_FILTER_MAD_FLOOR    8.0f   // MAD 下限 (ADC计数)，平稳信号下不把量化噪声当作尖峰
+
+/**
+ * @brief 滤波参数
+ */
+typedef struct {
+    uint16_t threshold;       ///< 浇水阈值 (ADC值，越大越干)
+    uint8_t window;           ///< 中位数/Hampel 窗口长度 (1 - HUMIDITY_FILTER_MAX_WINDOW，1 表示不滤波)
+    float hampel_k;           ///< Hampel 阈值倍数 (0 表示不剔除)
+    uint16_t hysteresis;      ///< 迟滞带总宽度 (ADC值，0 表示无迟滞)
+} humidity_filter_config_t;
+
+/**
+ * @brief 滤波状态
+ * @details 环形缓冲始终保存最近 HUMIDITY_FILTER_MAX_WINDOW 个样本，修改窗口长度不需要清空状态
+ */
+typedef struct {
+    uint16_t samples[HUMIDITY_FILTER_MAX_WINDOW]; ///< 原始样本
+    uint16_t outlier_mask;    ///< 被判定为尖峰的样本位图（按 samples 下标）
+    uint8_t head;             ///< 下一个写入位置
+    uint8_t count;            ///< 有效样本数
+    bool need_water;          ///< 迟滞判定的当前状态
+    float last_filtered;      ///< 最近一次滤波输出
+    uint32_t last_time;       ///< 最近一次样本的 Unix 时间（0 表示墙钟未设置）
+    uint32_t total;           ///< 处理的样本总数
+    uint32_t outliers;        ///< 被 Hampel 标记的样本数
+    uint32_t transitions;     ///< need_water 由假变真的次数
+} humidity_filter_state_t;
+
+/**
+ * @brief 单个样本的处理结果
+ */
+typedef struct {
+    float raw;                ///< 输入值
+    float filtered;           ///< 滤波输出
+    bool outlier;             ///< 输入被判定为尖峰
+    bool ready;               ///< 窗口样本数已足够做判定
+    bool need_water;          ///< 迟滞判定结果（ready 为 false 时保持上一状态）
+    bool started;             ///< 本次由"不需要"变为"需要"浇水
+} humidity_filter_result_t;
+
+/**
+ * @brief 清空状态
+ */
+void humidity_filter_state_init(humidity_filter_state_t* p_state);
+
+/**
+ * @brief 处理一个样本（纯函数，不访问硬件和全局状态）
+ * @param p_state 滤波状态
+ * @param p_config 滤波参数
+ * @param raw 湿度 ADC 值
+ * @param p_result 输出结果（可为NULL）
+ * @return 当前是否需要浇水
+ */
+bool humidity_filter_step(humidity_filter_state_t* p_state, const humidity_filter_config_t* p_config,
+                          float raw, humidity_filter_result_t* p_result);
+
+/**
+ * @brief 由当前配置填充滤波参数
+ */
+void humidity_filter_load_config(humidity_filter_config_t* p_config);
+
+/**
+ * @brief 初始化 RUN 模式使用的滤波实例
+ * @details 校验 RTC 内存中的状态，无效（冷启动）或过期时清空
+ */
+void humidity_filter_init();
+
+/**
+ * @brief 用当前配置处理一个 RUN 模式的湿度样本，并更新 RTC 内存中的状态
+ * @return 当前是否需要浇水
+ */
+bool humidity_filter_update(float raw, humidity_filter_result_t* p_result);
+
+/**
+ * @brief 获取 RUN 模式滤波实例的状态副本
+ */
+void humidity_filter_get_state(humidity_filter_state_t* p_state);
+
+/**
+ * @brief 清空 RUN 模式滤波实例
+ */
+void humidity_filter_reset();
+
+/**
+ * @brief 本次启动是否从 RTC 内存恢复了状态
+ */
+bool humidity_filter_was_restored();
+
+#endif // HUMIDITY_FILTER_H
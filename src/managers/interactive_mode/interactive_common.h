@@ -11,6 +11,7 @@
 #include "../log_manager.h"
 #include "../sensor_manager.h"
 #include "../actuator_manager.h"
+#include "../watering_program.h"
 #include "../../ui/ui_manager.h"
 #include "../../services/config_manager.h"
 #include "../../services/wifi_manager.h"
@@ -16,6 +16,9 @@ typedef enum {
     SETTING_INTERVAL,
     SETTING_HUMIDITY_WET,
     SETTING_HUMIDITY_DRY,
+    SETTING_PULSE_COUNT,
+    SETTING_PULSE_GAP,
+    SETTING_PULSE_SAMPLE,
     SETTING_COUNT
 } setting_item_t;
 
@@ -25,7 +28,10 @@ static const char* setting_names[SETTING_COUNT] = {
     "Watering Duration",
     "Min Interval",
     "Humidity Wet",
-    "Humidity Dry"
+    "Humidity Dry",
+    "Soak Pulses",
+    "Soak Gap",
+    "Soak Sampling"
 };
 
 typedef struct {
@@ -41,7 +47,10 @@ static const setting_range_t setting_ranges[SETTING_COUNT] = {
     {1000, 60000, 500, "ms"},    // duration
     {60, 3600, 60, "s"},         // interval
     {100, 3000, 100, "ADC"},     // humidity_wet
-    {100, 3000, 100, "ADC"}      // humidity_dry
+    {100, 3000, 100, "ADC"},     // humidity_dry
+    {1, WATERING_PROGRAM_MAX_PULSES, 1, ""},  // pulse_count
+    {5, 600, 5, "s"},            // pulse_gap_s
+    {0, 1, 1, ""}                // pulse_sample (0=off, 1=on)
 };
 
 // State variables
@@ -60,6 +69,9 @@ static int get_setting_value(const hydro_config_t& config, setting_item_t item)
         case SETTING_INTERVAL: return config.watering.min_interval_s;
         case SETTING_HUMIDITY_WET: return config.watering.humidity_wet;
         case SETTING_HUMIDITY_DRY: return config.watering.humidity_dry;
+        case SETTING_PULSE_COUNT: return config.watering.pulse_count;
+        case SETTING_PULSE_GAP: return config.watering.pulse_gap_s;
+        case SETTING_PULSE_SAMPLE: return config.watering.pulse_sample;
         default: return 0;
     }
 }
@@ -73,6 +85,10 @@ static void set_setting_value(hydro_config_t& config, setting_item_t item, int v
         case SETTING_INTERVAL: config.watering.min_interval_s = value; break;
         case SETTING_HUMIDITY_WET: config.watering.humidity_wet = value; break;
         case SETTING_HUMIDITY_DRY: config.watering.humidity_dry = value; break;
+        case SETTING_PULSE_COUNT: config.watering.pulse_count = value; break;
+        case SETTING_PULSE_GAP: config.watering.pulse_gap_s = value; break;
+        case SETTING_PULSE_SAMPLE: config.watering.pulse_sample = value; break;
+        default: break;
     }
 }
 
@@ -6,6 +6,7 @@
 #include "interactive_watering.h"
 #include "interactive_common.h"
 #include "../../ui/ui_manager.h"
+#include "../../services/watering_scheduler.h"
 
 typedef enum {
     WATERING_CONFIRM,
@@ -18,6 +19,7 @@ static float watering_humidity_before = 0.0f;
 static float watering_humidity_after = 0.0f;
 static uint32_t watering_start_time = 0;
 static uint16_t watering_duration_ms = 0;
+static watering_program_t watering_program;
 static uint8_t watering_power = 0;
 static bool confirm_logged = false;
 static bool progress_logged = false;
@@ -40,6 +42,7 @@ interactive_state_t interactive_watering_handle(interactive_state_t* state) {
             if (!confirm_logged) {
                 watering_power = config.watering.power;
                 watering_duration_ms = config.watering.duration_ms;
+                watering_program_from_config(watering_power, watering_duration_ms, &watering_program);
                 sensor_manager_get_humidity(&watering_humidity_before);
 
                 // Calculate humidity percentage
@@ -56,6 +59,10 @@ interactive_state_t interactive_watering_handle(interactive_state_t* state) {
                 LOG_INFO("Interactive", "=== Watering Confirmation ===");
                 LOG_INFO("Interactive", "Pump Power: %d/255", watering_power);
                 LOG_INFO("Interactive", "Duration: %dms", watering_duration_ms);
+                if (watering_program.pulses > 1) {
+                    LOG_INFO("Interactive", "Soak: %u pulses, %lus gaps", watering_program.pulses,
+                             (unsigned long)(watering_program.gap_ms / 1000));
+                }
                 LOG_INFO("Interactive", "Current Humidity: %.2f ADC", watering_humidity_before);
                 LOG_INFO("Interactive", "Press SINGLE CLICK to start, DOUBLE CLICK to cancel");
 #else
@@ -73,12 +80,15 @@ interactive_state_t interactive_watering_handle(interactive_state_t* state) {
 
             if (input_manager_get_button_clicked()) {
                 LOG_INFO("Interactive", "Watering confirmed, starting pump...");
-                actuator_manager_run_pump_for(watering_power, watering_duration_ms);
-                watering_start_time = millis();
-                watering_substate = WATERING_IN_PROGRESS;
-                confirm_logged = false;
-                progress_logged = false;
-                LOG_DEBUG("Interactive", "Switched to WATERING_IN_PROGRESS");
+                if (watering_program_start(&watering_program) == WATERING_PROGRAM_OK) {
+                    watering_start_time = millis();
+                    watering_substate = WATERING_IN_PROGRESS;
+                    confirm_logged = false;
+                    progress_logged = false;
+                    LOG_DEBUG("Interactive", "Switched to WATERING_IN_PROGRESS");
+                } else {
+                    LOG_ERROR("Interactive", "Failed to start watering");
+                }
             }
 
             if (input_manager_get_button_double_clicked()) {
@@ -92,10 +102,13 @@ interactive_state_t interactive_watering_handle(interactive_state_t* state) {
 
         case WATERING_IN_PROGRESS: {
             actuator_manager_loop();
-            bool pump_running = actuator_manager_is_pump_running();
+            watering_program_loop();
+            watering_program_status_t program_status;
+            watering_program_get_status(&program_status);
 
-            if (pump_running) {
+            if (watering_program_is_running()) {
                 uint32_t elapsed = millis() - watering_start_time;
+                uint32_t total_ms = program_status.total_ms;
 
                 // Calculate humidity percentage for UI
                 float humidity_pct = 0.0f;
@@ -111,7 +124,7 @@ interactive_state_t interactive_watering_handle(interactive_state_t* state) {
 #ifdef TEST_MODE
                 // TEST_MODE: 串口LOG输出（仅一次）
                 if (!progress_logged) {
-                    uint8_t progress = (elapsed * 100) / watering_duration_ms;
+                    uint8_t progress = (elapsed * 100) / total_ms;
                     if (progress > 100) progress = 100;
                     LOG_INFO("Interactive", "Watering in progress... %d%%", progress);
                     progress_logged = true;
@@ -120,12 +133,16 @@ interactive_state_t interactive_watering_handle(interactive_state_t* state) {
                 // 生产环境: 添加UI更新节流，防止队列溢出
                 static uint32_t last_ui_update = 0;
                 if (millis() - last_ui_update >= 500) {  // 每500ms更新一次
-                    ui_manager_show_watering_progress(elapsed, watering_duration_ms, humidity_pct);
+                    ui_manager_show_watering_progress(elapsed, total_ms, humidity_pct);
                     last_ui_update = millis();
                 }
 #endif
             } else {
-                LOG_INFO("Interactive", "Watering completed");
+                // 手动浇水按实际运行时间计入当日预算
+                if (watering_program_poll_done(&program_status) && program_status.pump_ms > 0) {
+                    WateringScheduler::instance().recordWatering(program_status.pump_ms);
+                }
+                LOG_INFO("Interactive", "Watering completed (%lums pump time)", (unsigned long)program_status.pump_ms);
                 sensor_manager_get_humidity(&watering_humidity_after);
                 watering_substate = WATERING_COMPLETE;
                 progress_logged = false;
@@ -25,6 +25,7 @@
 static bool is_initialized = false;
 static interactive_state_t current_state = STATE_MAIN_MENU;
 static bool exit_requested = false;
+static bool s_screen_leased = false;  // Holding a screen rail lease since enter()
 
 // Background WiFi and time sync state
 static bool s_ntp_sync_requested = false;
@@ -48,16 +49,22 @@ interactive_mode_result_t interactive_mode_manager_enter(void) {
     LOG_INFO("Interactive", "Entering interactive mode");
 
 #ifndef TEST_MODE
-    // 1. Enable screen power before any display operations
-    power_result_t power_result = power_screen_enable(true);
-    if (power_result != POWER_OK) {
-        LOG_ERROR("Interactive", "Failed to enable screen power (error %d)", power_result);
-        return INTERACTIVE_MODE_ERR_NOT_INITIALIZED;
+    // 1. Hold the screen rail before any display operations
+    bool was_on = true;
+    if (!s_screen_leased) {
+        power_result_t power_result = power_rail_acquire(POWER_RAIL_SCREEN, &was_on);
+        if (power_result != POWER_OK) {
+            LOG_ERROR("Interactive", "Failed to enable screen power (error %d)", power_result);
+            return INTERACTIVE_MODE_ERR_NOT_INITIALIZED;
+        }
+        s_screen_leased = true;
     }
-    LOG_DEBUG("Interactive", "Screen power enabled, waiting for stabilization");
 
-    // 2. Wait for power to stabilize
-    delay(POWER_STABILIZATION_DELAY_MS);
+    // 2. Wait for power to stabilize (skipped when the rail was still lingering from RUN mode)
+    if (!was_on) {
+        LOG_DEBUG("Interactive", "Screen power enabled, waiting for stabilization");
+        delay(POWER_STABILIZATION_DELAY_MS);
+    }
 
     // 3. Initialize display manager (will check s_initialized internally)
     display_result_t display_result = display_manager_init();
@@ -106,6 +113,15 @@ interactive_mode_result_t interactive_mode_manager_exit(void) {
     // Reset time sync flag for next entry
     s_ntp_sync_requested = false;
 
+    // A soak program would otherwise keep pulsing after leaving the menu
+    watering_program_abort();
+
+    // Release the screen rail; it lingers briefly in case the next mode needs it
+    if (s_screen_leased) {
+        s_screen_leased = false;
+        power_rail_release(POWER_RAIL_SCREEN);
+    }
+
     return INTERACTIVE_MODE_OK;
 }
 
@@ -0,0 +1,420 @@
+/**
+ * @file log_archive.cpp
+ * @brief SPIFFS 压缩日志归档实现
+ */
+
+#include "log_archive.h"
+#include "log_lzss.h"
+#include <SPIFFS.h>
+#include <string.h>
+#include <stdio.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+typedef struct {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t window_bits;
+    uint8_t length_bits;
+    uint8_t source;
+    uint32_t tag;
+    uint32_t reserved;
+} segment_header_t;
+
+typedef struct {
+    uint16_t comp_len;
+    uint16_t raw_len;
+} block_header_t;
+
+static_assert(sizeof(segment_header_t) == LOG_ARCHIVE_HEADER_SIZE, "segment header size mismatch");
+static_assert(sizeof(block_header_t) == LOG_ARCHIVE_BLOCK_HDR, "block header size mismatch");
+static_assert(LZSS_MAX_OUTPUT(LOG_ARCHIVE_BLOCK_SIZE) <= 0xFFFF, "block must fit u16 length");
+
+static SemaphoreHandle_t s_mutex = NULL;
+static bool s_ready = false;
+
+// 分段集合（编号连续递增，s_last_index == 0 表示没有分段）
+static uint32_t s_first_index = 0;
+static uint32_t s_last_index = 0;
+static uint16_t s_segment_count = 0;
+static uint32_t s_total_bytes = 0;
+static uint32_t s_last_size = 0;
+static uint8_t s_last_source = 0;
+static uint32_t s_last_tag = 0;
+
+// 当前数据流
+static bool s_streaming = false;
+static bool s_stream_ok = true;
+static bool s_need_new_segment = false;
+static uint8_t s_stream_source = 0;
+static uint32_t s_stream_tag = 0;
+static uint16_t s_block_raw = 0;
+
+// 压缩工作区（静态分配，约7KB）
+static lzss_encoder_t s_encoder;
+static uint8_t s_block[LZSS_MAX_OUTPUT(LOG_ARCHIVE_BLOCK_SIZE)];
+static uint16_t s_block_len = 0;
+
+// 统计
+static uint32_t s_raw_in = 0;
+static uint32_t s_compressed_out = 0;
+static uint32_t s_blocks_written = 0;
+static uint32_t s_segments_deleted = 0;
+static uint32_t s_write_errors = 0;
+
+// --- 内部工具 ---
+
+void log_archive_segment_path(uint32_t index, char* buf, size_t size) {
+    snprintf(buf, size, "%s/%05lu.lzs", LOG_ARCHIVE_DIR, (unsigned long)index);
+}
+
+/**
+ * @brief 从文件路径解析分段编号
+ * @details SPIFFS 为扁平文件系统，遍历根目录得到的路径可能带或不带开头的 '/'
+ */
+static bool parse_segment_index(const char* path, uint32_t* p_index) {
+    const char* dir = LOG_ARCHIVE_DIR + 1;
+    const char* p = strstr(path, dir);
+    if (p == NULL) return false;
+
+    unsigned long index = 0;
+    int consumed = 0;
+    if (sscanf(p + strlen(dir), "/%lu.lzs%n", &index, &consumed) != 1 || consumed == 0 || index == 0) {
+        return false;
+    }
+    *p_index = (uint32_t)index;
+    return true;
+}
+
+static bool read_segment_header(File& file, segment_header_t* header) {
+    return file.read((uint8_t*)header, sizeof(*header)) == sizeof(*header) &&
+           header->magic == LOG_ARCHIVE_MAGIC &&
+           header->version == LOG_ARCHIVE_VERSION;
+}
+
+static void encoder_output(const uint8_t* data, size_t len, void* ctx) {
+    (void)ctx;
+    // s_block 按最坏情况分配，不会溢出
+    memcpy(s_block + s_block_len, data, len);
+    s_block_len += len;
+}
+
+static void reset_block() {
+    lzss_encoder_init(&s_encoder, encoder_output, NULL);
+    s_block_len = 0;
+    s_block_raw = 0;
+}
+
+/**
+ * @brief 删除最老的分段
+ */
+static void delete_oldest_segment() {
+    char path[LOG_ARCHIVE_PATH_MAX];
+    // 编号可能因中途掉电出现空洞，跳过不存在的文件
+    while (s_first_index < s_last_index) {
+        log_archive_segment_path(s_first_index, path, sizeof(path));
+        s_first_index++;
+        if (SPIFFS.exists(path)) {
+            File file = SPIFFS.open(path, FILE_READ);
+            uint32_t size = file ? file.size() : 0;
+            if (file) file.close();
+            SPIFFS.remove(path);
+            s_total_bytes = (s_total_bytes > size) ? s_total_bytes - size : 0;
+            s_segment_count--;
+            s_segments_deleted++;
+            return;
+        }
+    }
+}
+
+static bool create_segment() {
+    segment_header_t header;
+    header.magic = LOG_ARCHIVE_MAGIC;
+    header.version = LOG_ARCHIVE_VERSION;
+    header.window_bits = LZSS_WINDOW_BITS;
+    header.length_bits = LZSS_LENGTH_BITS;
+    header.source = s_stream_source;
+    header.tag = s_stream_tag;
+    header.reserved = 0;
+
+    uint32_t index = s_last_index + 1;
+    char path[LOG_ARCHIVE_PATH_MAX];
+    log_archive_segment_path(index, path, sizeof(path));
+
+    File file = SPIFFS.open(path, FILE_WRITE);
+    if (!file) return false;
+    size_t written = file.write((const uint8_t*)&header, sizeof(header));
+    file.close();
+    if (written != sizeof(header)) {
+        SPIFFS.remove(path);
+        return false;
+    }
+
+    if (s_segment_count == 0) {
+        s_first_index = index;
+    }
+    s_last_index = index;
+    s_segment_count++;
+    s_total_bytes += sizeof(header);
+    s_last_size = sizeof(header);
+    s_last_source = s_stream_source;
+    s_last_tag = s_stream_tag;
+    return true;
+}
+
+/**
+ * @brief 结束当前压缩块并追加到分段文件
+ */
+static bool store_block() {
+    if (s_block_raw == 0) return true;
+
+    lzss_encoder_finish(&s_encoder);
+
+    block_header_t header;
+    header.comp_len = s_block_len;
+    header.raw_len = s_block_raw;
+    uint32_t block_size = sizeof(header) + s_block_len;
+
+    bool ok = true;
+    bool roll = s_stream_source == LOG_ARCHIVE_SOURCE_SECTORS &&
+                s_last_size + block_size > LOG_ARCHIVE_SEGMENT_BYTES;
+    if (s_need_new_segment || s_last_index == 0 || roll) {
+        ok = create_segment();
+        s_need_new_segment = !ok;
+    }
+
+    if (ok) {
+        char path[LOG_ARCHIVE_PATH_MAX];
+        log_archive_segment_path(s_last_index, path, sizeof(path));
+        File file = SPIFFS.open(path, FILE_APPEND);
+        size_t written = 0;
+        if (file) {
+            written = file.write((const uint8_t*)&header, sizeof(header));
+            written += file.write(s_block, s_block_len);
+            file.close();
+        }
+        // 部分写入的块会被解码器当作截断数据忽略，但仍计入分段大小
+        s_total_bytes += written;
+        s_last_size += written;
+        ok = (written == block_size);
+    }
+
+    if (ok) {
+        s_raw_in += s_block_raw;
+        s_compressed_out += block_size;
+        s_blocks_written++;
+    } else {
+        s_write_errors++;
+    }
+
+    reset_block();
+    return ok;
+}
+
+// --- 公共 API ---
+
+bool log_archive_init() {
+    if (s_mutex == NULL) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (s_mutex == NULL) return false;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    s_first_index = 0;
+    s_last_index = 0;
+    s_segment_count = 0;
+    s_total_bytes = 0;
+
+    File root = SPIFFS.open("/");
+    if (!root) {
+        xSemaphoreGive(s_mutex);
+        return false;
+    }
+
+    File file = root.openNextFile();
+    while (file) {
+        uint32_t index;
+        if (!file.isDirectory() && parse_segment_index(file.path(), &index)) {
+            if (s_first_index == 0 || index < s_first_index) s_first_index = index;
+            if (index > s_last_index) {
+                s_last_index = index;
+                s_last_size = file.size();
+            }
+            s_segment_count++;
+            s_total_bytes += file.size();
+        }
+        file.close();
+        file = root.openNextFile();
+    }
+    root.close();
+
+    // 最新分段的来源与标记决定下一块能否继续追加
+    if (s_last_index != 0) {
+        char path[LOG_ARCHIVE_PATH_MAX];
+        log_archive_segment_path(s_last_index, path, sizeof(path));
+        File last = SPIFFS.open(path, FILE_READ);
+        segment_header_t header;
+        if (last && read_segment_header(last, &header)) {
+            s_last_source = header.source;
+            s_last_tag = header.tag;
+        } else {
+            s_last_source = 0;
+        }
+        if (last) last.close();
+    }
+
+    s_ready = true;
+    xSemaphoreGive(s_mutex);
+    return true;
+}
+
+bool log_archive_begin(log_archive_source_t source, uint32_t tag, bool new_segment) {
+    if (!s_ready) return false;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_streaming = true;
+    s_stream_ok = true;
+    s_stream_source = source;
+    s_stream_tag = tag;
+    s_need_new_segment = new_segment || s_last_source != source || s_last_tag != tag;
+    reset_block();
+    return true;
+}
+
+void log_archive_write(const uint8_t* data, size_t len) {
+    if (!s_streaming) return;
+
+    while (len > 0) {
+        size_t n = LOG_ARCHIVE_BLOCK_SIZE - s_block_raw;
+        if (n > len) n = len;
+        lzss_encoder_write(&s_encoder, data, n);
+        s_block_raw += n;
+        data += n;
+        len -= n;
+
+        if (s_block_raw == LOG_ARCHIVE_BLOCK_SIZE && !store_block()) {
+            s_stream_ok = false;
+        }
+    }
+}
+
+bool log_archive_end() {
+    if (!s_streaming) return false;
+
+    if (!store_block()) {
+        s_stream_ok = false;
+    }
+
+    // 执行字节预算，始终保留最新的分段
+    while (s_total_bytes > LOG_ARCHIVE_BUDGET_BYTES && s_segment_count > 1) {
+        delete_oldest_segment();
+    }
+
+    bool ok = s_stream_ok;
+    s_streaming = false;
+    xSemaphoreGive(s_mutex);
+    return ok;
+}
+
+bool log_archive_add_file(const char* path, uint32_t tag) {
+    File file = SPIFFS.open(path, FILE_READ);
+    if (!file) return false;
+
+    if (!log_archive_begin(LOG_ARCHIVE_SOURCE_FILE, tag, true)) {
+        file.close();
+        return false;
+    }
+
+    uint8_t chunk[256];
+    size_t n;
+    while ((n = file.read(chunk, sizeof(chunk))) > 0) {
+        log_archive_write(chunk, n);
+    }
+    file.close();
+
+    return log_archive_end();
+}
+
+uint16_t log_archive_list(log_archive_segment_t* out, uint16_t max) {
+    if (!s_ready) return 0;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    uint16_t count = 0;
+    char path[LOG_ARCHIVE_PATH_MAX];
+    for (uint32_t index = s_first_index; index != 0 && index <= s_last_index; index++) {
+        log_archive_segment_path(index, path, sizeof(path));
+        if (!SPIFFS.exists(path)) continue;
+
+        if (count < max) {
+            log_archive_segment_t* seg = &out[count];
+            memset(seg, 0, sizeof(*seg));
+            seg->index = index;
+
+            File file = SPIFFS.open(path, FILE_READ);
+            segment_header_t header;
+            if (file) {
+                seg->size = file.size();
+                if (read_segment_header(file, &header)) {
+                    seg->source = header.source;
+                    seg->tag = header.tag;
+
+                    // 只遍历块头，统计完整块的原始长度
+                    uint32_t pos = sizeof(header);
+                    block_header_t block;
+                    while (pos + sizeof(block) <= seg->size &&
+                           file.seek(pos) &&
+                           file.read((uint8_t*)&block, sizeof(block)) == sizeof(block) &&
+                           pos + sizeof(block) + block.comp_len <= seg->size) {
+                        seg->raw_bytes += block.raw_len;
+                        seg->blocks++;
+                        pos += sizeof(block) + block.comp_len;
+                    }
+                }
+                file.close();
+            }
+        }
+        count++;
+    }
+
+    xSemaphoreGive(s_mutex);
+    return count;
+}
+
+void log_archive_clear() {
+    if (!s_ready) return;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    char path[LOG_ARCHIVE_PATH_MAX];
+    for (uint32_t index = s_first_index; index != 0 && index <= s_last_index; index++) {
+        log_archive_segment_path(index, path, sizeof(path));
+        if (SPIFFS.exists(path)) {
+            SPIFFS.remove(path);
+            s_segments_deleted++;
+        }
+    }
+    // 编号继续递增，避免主机端把新旧分段混淆
+    s_first_index = 0;
+    s_segment_count = 0;
+    s_total_bytes = 0;
+    s_last_size = 0;
+    s_last_source = 0;
+    s_need_new_segment = true;
+    xSemaphoreGive(s_mutex);
+}
+
+void log_archive_get_stats(log_archive_stats_t* p_stats) {
+    if (p_stats == NULL) return;
+
+    p_stats->ready = s_ready;
+    p_stats->segment_count = s_segment_count;
+    p_stats->first_index = s_first_index;
+    p_stats->last_index = s_last_index;
+    p_stats->total_bytes = s_total_bytes;
+    p_stats->raw_in = s_raw_in;
+    p_stats->compressed_out = s_compressed_out;
+    p_stats->blocks_written = s_blocks_written;
+    p_stats->segments_deleted = s_segments_deleted;
+    p_stats->write_errors = s_write_errors;
+}
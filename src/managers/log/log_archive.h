@@ -0,0 +1,126 @@
+/**
+ * @file log_archive.h
+ * @brief SPIFFS 上的压缩日志归档（编号分段 + 总字节预算）
+ * @details
+ *   即将被覆盖的日志（日志分区最老的扇区，或 SPIFFS 后备路径中写满的日志文件）
+ *   经 LZSS（log/log_lzss.h）压缩后追加到编号递增的分段文件 LOG_ARCHIVE_DIR/NNNNN.lzs，
+ *   所有分段总大小超过 LOG_ARCHIVE_BUDGET_BYTES 时删除最老的分段。
+ *
+ *   分段文件布局:
+ *   - 文件头 16 字节: magic "HLZA", 版本, 窗口位数, 长度位数, 数据来源, 格式标记, 保留
+ *   - 之后为连续的压缩块: [压缩长度 u16][原始长度 u16][LZSS 数据]
+ *   每个块独立压缩（原始长度不超过 LOG_ARCHIVE_BLOCK_SIZE），掉电只会丢失最后一个不完整的块。
+ *
+ *   来源为日志分区扇区时，解压结果是扇区镜像，可直接交给 log_decode.py --archive；
+ *   来源为日志文件时，解压结果按顺序拼接即为原文件内容。
+ */
+
+#ifndef LOG_ARCHIVE_H
+#define LOG_ARCHIVE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define LOG_ARCHIVE_DIR           "/spiffs/logarc"
+#define LOG_ARCHIVE_BLOCK_SIZE    4096            // 单个压缩块的最大原始长度
+#define LOG_ARCHIVE_SEGMENT_BYTES (32 * 1024)     // 扇区归档的分段大小（压缩后）
+#define LOG_ARCHIVE_BUDGET_BYTES  (384 * 1024)    // 全部分段的总字节预算
+#define LOG_ARCHIVE_PATH_MAX      32
+
+#define LOG_ARCHIVE_MAGIC         0x415A4C48      // "HLZA"
+#define LOG_ARCHIVE_VERSION       1
+#define LOG_ARCHIVE_HEADER_SIZE   16
+#define LOG_ARCHIVE_BLOCK_HDR     4
+
+/**
+ * @brief 归档数据来源
+ */
+typedef enum {
+    LOG_ARCHIVE_SOURCE_SECTORS = 1,  ///< 日志分区扇区镜像
+    LOG_ARCHIVE_SOURCE_FILE = 2      ///< SPIFFS 日志文件内容
+} log_archive_source_t;
+
+/**
+ * @brief 分段信息
+ */
+typedef struct {
+    uint32_t index;          ///< 分段编号
+    uint32_t size;           ///< 文件大小（压缩后，含文件头）
+    uint32_t raw_bytes;      ///< 解压后的字节数
+    uint16_t blocks;         ///< 完整压缩块数
+    uint8_t source;          ///< log_archive_source_t
+    uint32_t tag;            ///< 格式标记（同日志分区扇区头）
+} log_archive_segment_t;
+
+/**
+ * @brief 归档统计
+ */
+typedef struct {
+    bool ready;
+    uint16_t segment_count;
+    uint32_t first_index;
+    uint32_t last_index;
+    uint32_t total_bytes;       ///< 全部分段大小
+    uint32_t raw_in;            ///< 本次启动以来压缩的原始字节数
+    uint32_t compressed_out;    ///< 本次启动以来写入的压缩字节数
+    uint32_t blocks_written;
+    uint32_t segments_deleted;
+    uint32_t write_errors;
+} log_archive_stats_t;
+
+/**
+ * @brief 扫描已有分段，准备归档（需在 SPIFFS 挂载后调用）
+ * @return true 成功
+ */
+bool log_archive_init();
+
+/**
+ * @brief 开始一段归档数据流
+ * @param source 数据来源
+ * @param tag 格式标记；来源或标记与当前分段不同时自动开始新分段
+ * @param new_segment 是否强制开始新分段（日志文件每次滚动独占一个分段）
+ * @return true 成功
+ */
+bool log_archive_begin(log_archive_source_t source, uint32_t tag, bool new_segment);
+
+/**
+ * @brief 写入原始数据，每满 LOG_ARCHIVE_BLOCK_SIZE 字节压缩并落盘一个块
+ */
+void log_archive_write(const uint8_t* data, size_t len);
+
+/**
+ * @brief 压缩剩余数据并结束数据流，然后执行字节预算
+ * @return true 本数据流全部写入成功
+ */
+bool log_archive_end();
+
+/**
+ * @brief 将整个文件压缩进归档（独占一个新分段）
+ * @return true 成功
+ */
+bool log_archive_add_file(const char* path, uint32_t tag);
+
+/**
+ * @brief 列出分段（从旧到新）
+ * @param out 输出数组
+ * @param max 数组容量
+ * @return 分段总数（可能大于 max）
+ */
+uint16_t log_archive_list(log_archive_segment_t* out, uint16_t max);
+
+/**
+ * @brief 获取分段文件路径
+ */
+void log_archive_segment_path(uint32_t index, char* buf, size_t size);
+
+/**
+ * @brief 删除全部分段
+ */
+void log_archive_clear();
+
+/**
+ * @brief 获取归档统计
+ */
+void log_archive_get_stats(log_archive_stats_t* p_stats);
+
+#endif // LOG_ARCHIVE_H
@@ -0,0 +1,350 @@
+/**
+ * @file log_binary.cpp
+ * @brief 二进制日志记录编解码实现
+ */
+
+#include "log_binary.h"
+#include <string.h>
+#include <stdio.h>
+#include "soc/soc_memory_layout.h"
+
+// 文件头中记录此字符串地址，主机解码器读取ELF中同一地址校验固件是否匹配
+static const char s_log_anchor[] = "HydroSense binary log v1";
+
+// --- 格式说明符解析 ---
+
+typedef enum {
+    ARG_NONE = 0,   // %% 或不支持的转换
+    ARG_INT32,
+    ARG_INT64,
+    ARG_DOUBLE,
+    ARG_LDOUBLE,
+    ARG_STRING,
+    ARG_PTR
+} arg_kind_t;
+
+typedef struct {
+    arg_kind_t kind;
+    char conv;            // 转换字符
+    uint8_t stars;        // '*' 宽度/精度占用的int参数个数
+    const char* body;     // '%' 之后、长度修饰符之前的部分（flags/width/precision）
+    uint8_t body_len;
+} fmt_spec_t;
+
+/**
+ * @brief 解析一个格式说明符
+ * @param p 指向 '%'
+ * @return 指向说明符之后的字符
+ */
+static const char* parse_spec(const char* p, fmt_spec_t* spec) {
+    p++;  // 跳过 '%'
+    spec->body = p;
+    spec->stars = 0;
+
+    while (*p && strchr("-+ #0", *p)) p++;
+    if (*p == '*') { spec->stars++; p++; }
+    while (*p >= '0' && *p <= '9') p++;
+    if (*p == '.') {
+        p++;
+        if (*p == '*') { spec->stars++; p++; }
+        while (*p >= '0' && *p <= '9') p++;
+    }
+    spec->body_len = (uint8_t)(p - spec->body);
+
+    // 长度修饰符
+    int size = 4;
+    bool long_double = false;
+    if (*p == 'h') {
+        p++;
+        if (*p == 'h') p++;
+    } else if (*p == 'l') {
+        p++;
+        if (*p == 'l') { size = 8; p++; } else { size = sizeof(long); }
+    } else if (*p == 'j' || *p == 'q') {
+        size = 8; p++;
+    } else if (*p == 'z' || *p == 't') {
+        size = sizeof(size_t); p++;
+    } else if (*p == 'L') {
+        long_double = true; p++;
+    }
+
+    spec->conv = *p;
+    switch (*p) {
+        case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+            spec->kind = (size == 8) ? ARG_INT64 : ARG_INT32;
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            spec->kind = long_double ? ARG_LDOUBLE : ARG_DOUBLE;
+            break;
+        case 's':
+            spec->kind = ARG_STRING;
+            break;
+        case 'p':
+            spec->kind = ARG_PTR;
+            break;
+        default:
+            spec->kind = ARG_NONE;
+            break;
+    }
+    return *p ? p + 1 : p;
+}
+
+// --- 字节读写辅助 ---
+
+static inline void put_u32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static inline uint32_t get_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static bool put_str(uint8_t** pp, const uint8_t* end, const char* s) {
+    size_t len = strlen(s);
+    if (len > LOG_BINARY_MAX_STR_LEN) len = LOG_BINARY_MAX_STR_LEN;
+    if (*pp + 1 + len > end) return false;
+    **pp = (uint8_t)len;
+    memcpy(*pp + 1, s, len);
+    *pp += 1 + len;
+    return true;
+}
+
+// --- 编码 ---
+
+size_t log_binary_encode(uint8_t* out, size_t out_size, uint8_t level, const char* module,
+                         uint32_t tick_ms, const char* format, va_list args) {
+    if (out_size < LOG_BINARY_RECORD_HDR) return 0;
+
+    uint8_t* p = out + LOG_BINARY_RECORD_HDR;
+    const uint8_t* end = out + (out_size > LOG_BINARY_RECORD_HDR + 255 ? LOG_BINARY_RECORD_HDR + 255 : out_size);
+
+    // 模块名不在只读数据段（如CLI传入的栈缓冲区）时内联保存
+    bool inline_module = !esp_ptr_in_drom(module);
+    if (inline_module) {
+        put_str(&p, end, module);
+    }
+
+    for (const char* f = format; *f; ) {
+        if (*f != '%') { f++; continue; }
+
+        fmt_spec_t spec;
+        f = parse_spec(f, &spec);
+
+        // 参数区已满时停止编码，剩余参数在展开时显示为 '?'
+        for (uint8_t i = 0; i < spec.stars; i++) {
+            int v = va_arg(args, int);
+            if (p + 4 > end) goto done;
+            put_u32(p, (uint32_t)v);
+            p += 4;
+        }
+
+        switch (spec.kind) {
+            case ARG_INT32: {
+                uint32_t v = va_arg(args, uint32_t);
+                if (p + 4 > end) goto done;
+                put_u32(p, v);
+                p += 4;
+                break;
+            }
+            case ARG_INT64: {
+                uint64_t v = va_arg(args, uint64_t);
+                if (p + 8 > end) goto done;
+                put_u32(p, (uint32_t)v);
+                put_u32(p + 4, (uint32_t)(v >> 32));
+                p += 8;
+                break;
+            }
+            case ARG_DOUBLE:
+            case ARG_LDOUBLE: {
+                double v = (spec.kind == ARG_DOUBLE) ? va_arg(args, double) : (double)va_arg(args, long double);
+                if (p + 8 > end) goto done;
+                memcpy(p, &v, 8);
+                p += 8;
+                break;
+            }
+            case ARG_STRING: {
+                const char* s = va_arg(args, const char*);
+                if (!put_str(&p, end, s ? s : "(null)")) goto done;
+                break;
+            }
+            case ARG_PTR: {
+                uintptr_t v = (uintptr_t)va_arg(args, void*);
+                if (p + 4 > end) goto done;
+                put_u32(p, (uint32_t)v);
+                p += 4;
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+done:
+    out[0] = (uint8_t)((LOG_RECORD_TYPE_LOG << 4) | (inline_module ? LOG_RECORD_FLAG_INLINE_MODULE : 0) | (level & 0x07));
+    out[1] = (uint8_t)(p - out - LOG_BINARY_RECORD_HDR);
+    put_u32(out + 2, tick_ms);
+    put_u32(out + 6, (uint32_t)(uintptr_t)format);
+    put_u32(out + 10, inline_module ? 0 : (uint32_t)(uintptr_t)module);
+    return p - out;
+}
+
+size_t log_binary_encode_anchor(uint8_t* out, uint32_t tick_ms, uint32_t unix_time) {
+    out[0] = (uint8_t)(LOG_RECORD_TYPE_ANCHOR << 4);
+    out[1] = 0;
+    put_u32(out + 2, tick_ms);
+    put_u32(out + 6, unix_time);
+    put_u32(out + 10, 0);
+    return LOG_BINARY_RECORD_HDR;
+}
+
+void log_binary_write_header(uint8_t* out) {
+    memcpy(out, LOG_BINARY_MAGIC, 4);
+    out[4] = LOG_BINARY_VERSION;
+    out[5] = 0;
+    out[6] = 0;
+    out[7] = 0;
+    put_u32(out + 8, log_binary_anchor_address());
+    put_u32(out + 12, 0);
+}
+
+uint32_t log_binary_anchor_address() {
+    return (uint32_t)(uintptr_t)s_log_anchor;
+}
+
+// --- 记录访问 ---
+
+size_t log_binary_record_size(const uint8_t* rec, size_t avail) {
+    if (avail < LOG_BINARY_RECORD_HDR) return 0;
+    return LOG_BINARY_RECORD_HDR + rec[1];
+}
+
+uint32_t log_binary_record_tick(const uint8_t* rec) {
+    return get_u32(rec + 2);
+}
+
+uint8_t log_binary_record_level(const uint8_t* rec) {
+    return rec[0] & 0x07;
+}
+
+uint8_t log_binary_record_type(const uint8_t* rec) {
+    return rec[0] >> 4;
+}
+
+uint32_t log_binary_record_anchor_time(const uint8_t* rec) {
+    return get_u32(rec + 6);
+}
+
+const char* log_binary_record_module(const uint8_t* rec, char* buf, size_t buf_size) {
+    if (!(rec[0] & LOG_RECORD_FLAG_INLINE_MODULE)) {
+        const char* module = (const char*)(uintptr_t)get_u32(rec + 10);
+        return esp_ptr_in_drom(module) ? module : "?";
+    }
+    size_t len = rec[LOG_BINARY_RECORD_HDR];
+    if (len >= buf_size) len = buf_size - 1;
+    memcpy(buf, rec + LOG_BINARY_RECORD_HDR + 1, len);
+    buf[len] = '\0';
+    return buf;
+}
+
+// --- 设备端展开 ---
+
+size_t log_binary_render_message(const uint8_t* rec, size_t rec_len, char* out, size_t out_size) {
+    if (out_size == 0) return 0;
+    if (rec_len < LOG_BINARY_RECORD_HDR || log_binary_record_type(rec) != LOG_RECORD_TYPE_LOG) {
+        out[0] = '\0';
+        return 0;
+    }
+
+    const char* format = (const char*)(uintptr_t)get_u32(rec + 6);
+    if (!esp_ptr_in_drom(format)) {
+        int n = snprintf(out, out_size, "<format 0x%08lx>", (unsigned long)(uintptr_t)format);
+        return (n < 0) ? 0 : ((size_t)n < out_size ? (size_t)n : out_size - 1);
+    }
+    const uint8_t* p = rec + LOG_BINARY_RECORD_HDR;
+    const uint8_t* end = rec + rec_len;
+    if (rec[0] & LOG_RECORD_FLAG_INLINE_MODULE) {
+        p += 1 + *p;
+    }
+
+    size_t n = 0;
+    for (const char* f = format; *f && n < out_size - 1; ) {
+        if (*f != '%') {
+            out[n++] = *f++;
+            continue;
+        }
+
+        fmt_spec_t spec;
+        f = parse_spec(f, &spec);
+        if (spec.kind == ARG_NONE) {
+            if (spec.conv == '%') out[n++] = '%';
+            continue;
+        }
+
+        // 重建单参数说明符：'*' 替换为记录中的数值，长度修饰符按参数类型重新生成
+        char one[32];
+        size_t k = 0;
+        one[k++] = '%';
+        for (uint8_t i = 0; i < spec.body_len && k < sizeof(one) - 8; i++) {
+            if (spec.body[i] == '*') {
+                if (p + 4 > end) break;
+                k += snprintf(one + k, sizeof(one) - k, "%d", (int)get_u32(p));
+                p += 4;
+            } else {
+                one[k++] = spec.body[i];
+            }
+        }
+        if (spec.kind == ARG_INT64) { one[k++] = 'l'; one[k++] = 'l'; }
+        one[k++] = spec.conv;
+        one[k] = '\0';
+
+        size_t room = out_size - n;
+        int written = 0;
+        switch (spec.kind) {
+            case ARG_INT32:
+                if (p + 4 > end) { written = snprintf(out + n, room, "?"); break; }
+                written = snprintf(out + n, room, one, get_u32(p));
+                p += 4;
+                break;
+            case ARG_INT64:
+                if (p + 8 > end) { written = snprintf(out + n, room, "?"); break; }
+                written = snprintf(out + n, room, one,
+                                   (unsigned long long)get_u32(p) | ((unsigned long long)get_u32(p + 4) << 32));
+                p += 8;
+                break;
+            case ARG_DOUBLE:
+            case ARG_LDOUBLE: {
+                if (p + 8 > end) { written = snprintf(out + n, room, "?"); break; }
+                double v;
+                memcpy(&v, p, 8);
+                written = snprintf(out + n, room, one, v);
+                p += 8;
+                break;
+            }
+            case ARG_STRING: {
+                if (p + 1 > end || p + 1 + *p > end) { written = snprintf(out + n, room, "?"); break; }
+                char s[LOG_BINARY_MAX_STR_LEN + 1];
+                memcpy(s, p + 1, *p);
+                s[*p] = '\0';
+                written = snprintf(out + n, room, one, s);
+                p += 1 + *p;
+                break;
+            }
+            case ARG_PTR:
+                if (p + 4 > end) { written = snprintf(out + n, room, "?"); break; }
+                written = snprintf(out + n, room, one, (void*)(uintptr_t)get_u32(p));
+                p += 4;
+                break;
+            default:
+                break;
+        }
+        if (written > 0) {
+            n += ((size_t)written < room) ? (size_t)written : room - 1;
+        }
+    }
+
+    out[n] = '\0';
+    return n;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file log_binary.h
+ * @brief 二进制日志记录编解码（延迟格式化）
+ * @details
+ *   记录中只保存格式字符串地址、模块名地址、时间戳和原始参数，
+ *   文本展开推迟到主机端解码器（log_decode.py）或 log_manager_get_recent_logs()。
+ *
+ *   记录布局（小端，紧凑排列）:
+ *   | 偏移 | 长度 | 字段                                                  |
+ *   |------|------|-------------------------------------------------------|
+ *   | 0    | 1    | 高4位: 记录类型; bit3: 模块名内联; 低3位: 日志级别      |
+ *   | 1    | 1    | 参数区长度 (字节)                                     |
+ *   | 2    | 4    | tick_ms (启动后毫秒) / 锚点记录为 tick_ms              |
+ *   | 6    | 4    | 格式字符串地址 / 锚点记录为 Unix 时间戳                |
+ *   | 10   | 4    | 模块名地址 (内联时为0)                                 |
+ *   | 14   | N    | 参数区: [内联模块名] + 按格式字符串顺序排列的参数       |
+ *
+ *   参数编码: 整数/指针/字符 4字节, ll/j 8字节, 浮点 8字节(double),
+ *   字符串为 1字节长度 + 内容(不含结尾0)。
+ */
+
+#ifndef LOG_BINARY_H
+#define LOG_BINARY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+
+// --- 文件头与记录常量 ---
+#define LOG_BINARY_MAGIC        "HLOG"
+#define LOG_BINARY_VERSION      1
+#define LOG_BINARY_HEADER_SIZE  16
+#define LOG_BINARY_RECORD_HDR   14
+#define LOG_BINARY_MAX_STR_LEN  96   // 单个 %s 参数的最大内联长度
+
+#define LOG_RECORD_TYPE_LOG     0    // 普通日志记录
+#define LOG_RECORD_TYPE_ANCHOR  1    // 时间锚点：把 tick_ms 对应到 Unix 时间
+
+#define LOG_RECORD_FLAG_INLINE_MODULE 0x08
+
+/**
+ * @brief 编码一条日志记录
+ * @param out 输出缓冲区
+ * @param out_size 缓冲区大小
+ * @param level 日志级别 (log_level_t)
+ * @param module 模块名
+ * @param tick_ms 时间戳（启动后毫秒）
+ * @param format 格式字符串（必须为常量字符串）
+ * @param args 可变参数
+ * @return 记录总长度；参数超出缓冲区时截断剩余参数
+ */
+size_t log_binary_encode(uint8_t* out, size_t out_size, uint8_t level, const char* module,
+                         uint32_t tick_ms, const char* format, va_list args);
+
+/**
+ * @brief 编码一条时间锚点记录
+ * @return 记录总长度
+ */
+size_t log_binary_encode_anchor(uint8_t* out, uint32_t tick_ms, uint32_t unix_time);
+
+/**
+ * @brief 生成文件头（LOG_BINARY_HEADER_SIZE 字节）
+ * @details 文件头中包含一个锚点字符串的地址，解码器据此校验 ELF 是否匹配
+ */
+void log_binary_write_header(uint8_t* out);
+
+/**
+ * @brief 获取锚点字符串地址（与文件头中的校验字段相同）
+ * @details 用作日志分区扇区头的格式标记，用于识别写入该扇区的固件
+ */
+uint32_t log_binary_anchor_address();
+
+/**
+ * @brief 获取记录总长度
+ * @return 记录长度，数据不足一个记录头时返回0
+ */
+size_t log_binary_record_size(const uint8_t* rec, size_t avail);
+
+/**
+ * @brief 读取记录中的时间戳与级别
+ */
+uint32_t log_binary_record_tick(const uint8_t* rec);
+uint8_t log_binary_record_level(const uint8_t* rec);
+uint8_t log_binary_record_type(const uint8_t* rec);
+
+/**
+ * @brief 读取时间锚点记录中的Unix时间
+ */
+uint32_t log_binary_record_anchor_time(const uint8_t* rec);
+
+/**
+ * @brief 获取记录的模块名
+ * @details 模块名地址不在只读数据段（来自其他固件的记录）时返回 "?"
+ * @param buf 内联模块名的拷贝缓冲区
+ * @return 指向模块名的指针（可能指向buf）
+ */
+const char* log_binary_record_module(const uint8_t* rec, char* buf, size_t buf_size);
+
+/**
+ * @brief 在设备端将记录展开为消息文本（不含时间戳/级别/模块前缀）
+ * @details 格式字符串与模块名地址只在同一固件内有效；地址不在只读数据段时只输出地址
+ * @return 写入的字符数
+ */
+size_t log_binary_render_message(const uint8_t* rec, size_t rec_len, char* out, size_t out_size);
+
+#endif // LOG_BINARY_H
@@ -0,0 +1,160 @@
+/**
+ * @file log_lzss.cpp
+ * @brief 流式 LZSS 编解码实现
+ */
+
+#include "log_lzss.h"
+#include <string.h>
+
+#define BACKREF_BITS (1 + LZSS_WINDOW_BITS + LZSS_LENGTH_BITS)
+
+// --- 编码器 ---
+
+static void enc_flush_output(lzss_encoder_t* enc) {
+    if (enc->out_len > 0) {
+        enc->output(enc->out, enc->out_len, enc->ctx);
+        enc->bytes_out += enc->out_len;
+        enc->out_len = 0;
+    }
+}
+
+static void enc_put_bits(lzss_encoder_t* enc, uint32_t value, uint8_t bits) {
+    enc->bit_acc = (enc->bit_acc << bits) | (value & ((1UL << bits) - 1));
+    enc->bit_count += bits;
+    while (enc->bit_count >= 8) {
+        enc->bit_count -= 8;
+        enc->out[enc->out_len++] = (uint8_t)(enc->bit_acc >> enc->bit_count);
+        if (enc->out_len == sizeof(enc->out)) {
+            enc_flush_output(enc);
+        }
+    }
+}
+
+/**
+ * @brief 编码 pos 处的一个记号（最长匹配，窗口内暴力搜索）
+ * @param avail pos 之后可用的字节数
+ */
+static void enc_step(lzss_encoder_t* enc, uint16_t avail) {
+    const uint8_t* cur = enc->buf + enc->pos;
+    uint16_t max_len = (avail < LZSS_MAX_MATCH) ? avail : LZSS_MAX_MATCH;
+    uint16_t best_len = 0;
+    uint16_t best_dist = 0;
+
+    if (max_len >= LZSS_MIN_MATCH) {
+        uint16_t start = (enc->pos > LZSS_WINDOW_SIZE) ? enc->pos - LZSS_WINDOW_SIZE : 0;
+        // 从近到远搜索，相同长度时优先较近的匹配
+        for (int32_t cand = enc->pos - 1; cand >= start; cand--) {
+            const uint8_t* p = enc->buf + cand;
+            if (p[0] != cur[0] || p[1] != cur[1]) continue;
+            uint16_t len = 2;
+            while (len < max_len && p[len] == cur[len]) len++;
+            if (len > best_len) {
+                best_len = len;
+                best_dist = enc->pos - cand;
+                if (len == max_len) break;
+            }
+        }
+    }
+
+    if (best_len >= LZSS_MIN_MATCH) {
+        enc_put_bits(enc, 0, 1);
+        enc_put_bits(enc, best_dist - 1, LZSS_WINDOW_BITS);
+        enc_put_bits(enc, best_len - LZSS_MIN_MATCH, LZSS_LENGTH_BITS);
+        enc->pos += best_len;
+    } else {
+        enc_put_bits(enc, 0x100 | cur[0], 9);
+        enc->pos += 1;
+    }
+}
+
+void lzss_encoder_init(lzss_encoder_t* enc, lzss_output_fn output, void* ctx) {
+    memset(enc, 0, sizeof(*enc));
+    enc->output = output;
+    enc->ctx = ctx;
+}
+
+void lzss_encoder_write(lzss_encoder_t* enc, const uint8_t* data, size_t len) {
+    enc->bytes_in += len;
+    while (len > 0) {
+        // 缓冲区满时丢弃最老的一个窗口
+        if (enc->fill == sizeof(enc->buf)) {
+            memmove(enc->buf, enc->buf + LZSS_WINDOW_SIZE, LZSS_WINDOW_SIZE);
+            enc->fill -= LZSS_WINDOW_SIZE;
+            enc->pos -= LZSS_WINDOW_SIZE;
+        }
+
+        size_t n = sizeof(enc->buf) - enc->fill;
+        if (n > len) n = len;
+        memcpy(enc->buf + enc->fill, data, n);
+        enc->fill += n;
+        data += n;
+        len -= n;
+
+        // 保留一个最长匹配的前瞻，剩余部分等待更多输入或 finish
+        while (enc->fill - enc->pos >= LZSS_MAX_MATCH) {
+            enc_step(enc, enc->fill - enc->pos);
+        }
+    }
+}
+
+void lzss_encoder_finish(lzss_encoder_t* enc) {
+    while (enc->pos < enc->fill) {
+        enc_step(enc, enc->fill - enc->pos);
+    }
+    if (enc->bit_count > 0) {
+        enc_put_bits(enc, 0, 8 - enc->bit_count);
+    }
+    enc_flush_output(enc);
+}
+
+// --- 解码器 ---
+
+static void dec_emit(lzss_decoder_t* dec, uint8_t byte) {
+    dec->window[dec->window_pos] = byte;
+    dec->window_pos = (dec->window_pos + 1) & (LZSS_WINDOW_SIZE - 1);
+    dec->out[dec->out_len++] = byte;
+    if (dec->out_len == sizeof(dec->out)) {
+        dec->output(dec->out, dec->out_len, dec->ctx);
+        dec->bytes_out += dec->out_len;
+        dec->out_len = 0;
+    }
+}
+
+void lzss_decoder_init(lzss_decoder_t* dec, lzss_output_fn output, void* ctx) {
+    memset(dec, 0, sizeof(*dec));
+    dec->output = output;
+    dec->ctx = ctx;
+}
+
+void lzss_decoder_write(lzss_decoder_t* dec, const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        dec->bit_acc = (dec->bit_acc << 8) | data[i];
+        dec->bit_count += 8;
+
+        while (dec->bit_count > 0) {
+            bool literal = (dec->bit_acc >> (dec->bit_count - 1)) & 1;
+            uint8_t need = literal ? 9 : BACKREF_BITS;
+            if (dec->bit_count < need) break;
+
+            dec->bit_count -= need;
+            uint32_t token = (dec->bit_acc >> dec->bit_count) & ((1UL << need) - 1);
+            if (literal) {
+                dec_emit(dec, (uint8_t)token);
+            } else {
+                uint16_t dist = ((token >> LZSS_LENGTH_BITS) & (LZSS_WINDOW_SIZE - 1)) + 1;
+                uint16_t count = (token & ((1 << LZSS_LENGTH_BITS) - 1)) + LZSS_MIN_MATCH;
+                for (uint16_t k = 0; k < count; k++) {
+                    dec_emit(dec, dec->window[(dec->window_pos - dist) & (LZSS_WINDOW_SIZE - 1)]);
+                }
+            }
+        }
+    }
+}
+
+void lzss_decoder_finish(lzss_decoder_t* dec) {
+    if (dec->out_len > 0) {
+        dec->output(dec->out, dec->out_len, dec->ctx);
+        dec->bytes_out += dec->out_len;
+        dec->out_len = 0;
+    }
+}
@@ -0,0 +1,91 @@
+/**
+ * @file log_lzss.h
+ * @brief 流式 LZSS 压缩编解码（heatshrink 类，用于日志归档）
+ * @details
+ *   位流格式（高位在前）:
+ *   - 1 + 8位            : 字面量字节
+ *   - 0 + 10位距离 + 4位长度: 回溯引用，距离 = 值 + 1 (1-1024)，长度 = 值 + 2 (2-17)
+ *   流结束时用0补齐最后一个字节（不足一个完整记号，解码器自然忽略）。
+ *
+ *   编码器与解码器均为推送式：调用者分块写入输入，输出通过回调分块交付，
+ *   内存占用只与窗口大小有关（编码器约2KB，解码器约1KB），不需要完整的输入或输出缓冲区。
+ *   主机端实现见 log_decode.py。
+ */
+
+#ifndef LOG_LZSS_H
+#define LOG_LZSS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define LZSS_WINDOW_BITS  10
+#define LZSS_LENGTH_BITS  4
+#define LZSS_WINDOW_SIZE  (1 << LZSS_WINDOW_BITS)
+#define LZSS_MIN_MATCH    2
+#define LZSS_MAX_MATCH    (LZSS_MIN_MATCH + (1 << LZSS_LENGTH_BITS) - 1)
+
+// 最坏情况（全部为字面量）下的压缩输出长度
+#define LZSS_MAX_OUTPUT(n) (((n) * 9 + 7) / 8)
+
+/**
+ * @brief 输出回调
+ */
+typedef void (*lzss_output_fn)(const uint8_t* data, size_t len, void* ctx);
+
+/**
+ * @brief 编码器状态
+ */
+typedef struct {
+    uint8_t buf[2 * LZSS_WINDOW_SIZE];  ///< 滑动窗口 + 待编码数据
+    uint16_t fill;                      ///< buf 中的字节数
+    uint16_t pos;                       ///< 下一个待编码位置
+    uint32_t bit_acc;
+    uint8_t bit_count;
+    uint8_t out[64];
+    uint8_t out_len;
+    uint32_t bytes_in;
+    uint32_t bytes_out;
+    lzss_output_fn output;
+    void* ctx;
+} lzss_encoder_t;
+
+/**
+ * @brief 解码器状态
+ */
+typedef struct {
+    uint8_t window[LZSS_WINDOW_SIZE];
+    uint16_t window_pos;
+    uint32_t bit_acc;
+    uint8_t bit_count;
+    uint8_t out[64];
+    uint8_t out_len;
+    uint32_t bytes_out;
+    lzss_output_fn output;
+    void* ctx;
+} lzss_decoder_t;
+
+void lzss_encoder_init(lzss_encoder_t* enc, lzss_output_fn output, void* ctx);
+
+/**
+ * @brief 写入待压缩数据（可多次调用）
+ */
+void lzss_encoder_write(lzss_encoder_t* enc, const uint8_t* data, size_t len);
+
+/**
+ * @brief 编码剩余数据并输出最后的不完整字节
+ */
+void lzss_encoder_finish(lzss_encoder_t* enc);
+
+void lzss_decoder_init(lzss_decoder_t* dec, lzss_output_fn output, void* ctx);
+
+/**
+ * @brief 写入压缩数据（可多次调用，每个完整记号立即解码）
+ */
+void lzss_decoder_write(lzss_decoder_t* dec, const uint8_t* data, size_t len);
+
+/**
+ * @brief 交付解码器中缓存的输出
+ */
+void lzss_decoder_finish(lzss_decoder_t* dec);
+
+#endif // LOG_LZSS_H
@@ -0,0 +1,416 @@
+/**
+ * @file log_store.cpp
+ * @brief 原始分区循环日志存储实现
+ */
+
+#include "log_store.h"
+#include <string.h>
+#include <stddef.h>
+#include "esp_partition.h"
+#include "esp_crc.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#define SECTOR_MAGIC   0x31534C48  // "HLS1"
+#define FRAME_ERASED   0xFFFF
+#define ALIGN4(x)      (((x) + 3) & ~(uint32_t)3)
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;   // 扇区序号，每次换扇区加1
+    uint32_t tag;   // 记录格式标记（由调用者提供）
+    uint32_t crc;   // 前12字节的CRC32
+} sector_header_t;
+
+typedef struct {
+    uint16_t len;
+    uint16_t crc;   // payload CRC32 的低16位
+} frame_header_t;
+
+#define DATA_START  ((uint32_t)sizeof(sector_header_t))
+
+static_assert(sizeof(sector_header_t) == 16, "sector header must be 16 bytes");
+static_assert(sizeof(frame_header_t) == 4, "frame header must be 4 bytes");
+
+static const esp_partition_t* s_partition = NULL;
+static SemaphoreHandle_t s_mutex = NULL;
+static bool s_mounted = false;
+static uint32_t s_tag = 0;
+static uint16_t s_sector_count = 0;
+
+// 写入位置：head 扇区内的偏移；head 的下一个扇区始终为已擦除的备用扇区
+static uint16_t s_head = 0;
+static uint16_t s_tail = 0;
+static uint32_t s_head_seq = 0;
+static uint32_t s_write_offset = DATA_START;
+
+static log_store_evict_cb_t s_evict_cb = NULL;
+static void* s_evict_ctx = NULL;
+
+// 统计
+static uint32_t s_records_appended = 0;
+static uint32_t s_sectors_erased = 0;
+static uint32_t s_torn_records = 0;
+
+// --- 扇区操作 ---
+
+static inline uint32_t sector_addr(uint16_t sector) {
+    return (uint32_t)sector * LOG_STORE_SECTOR_SIZE;
+}
+
+static inline uint16_t next_sector(uint16_t sector) {
+    return (uint16_t)((sector + 1) % s_sector_count);
+}
+
+static bool read_sector_header(uint16_t sector, sector_header_t* header) {
+    if (esp_partition_read(s_partition, sector_addr(sector), header, sizeof(*header)) != ESP_OK) {
+        return false;
+    }
+    return header->magic == SECTOR_MAGIC &&
+           header->crc == esp_crc32_le(0, (const uint8_t*)header, offsetof(sector_header_t, crc));
+}
+
+static bool erase_sector(uint16_t sector) {
+    s_sectors_erased++;
+    return esp_partition_erase_range(s_partition, sector_addr(sector), LOG_STORE_SECTOR_SIZE) == ESP_OK;
+}
+
+/**
+ * @brief 检查扇区是否全部为擦除态（0xFF）
+ */
+static bool sector_is_erased(uint16_t sector) {
+    uint32_t chunk[16];
+    for (uint32_t off = 0; off < LOG_STORE_SECTOR_SIZE; off += sizeof(chunk)) {
+        if (esp_partition_read(s_partition, sector_addr(sector) + off, chunk, sizeof(chunk)) != ESP_OK) {
+            return false;
+        }
+        for (size_t i = 0; i < sizeof(chunk) / sizeof(chunk[0]); i++) {
+            if (chunk[i] != 0xFFFFFFFF) return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 在已擦除的扇区写入扇区头，使其成为新的 head
+ */
+static bool open_sector(uint16_t sector, uint32_t seq) {
+    sector_header_t header;
+    header.magic = SECTOR_MAGIC;
+    header.seq = seq;
+    header.tag = s_tag;
+    header.crc = esp_crc32_le(0, (const uint8_t*)&header, offsetof(sector_header_t, crc));
+    if (esp_partition_write(s_partition, sector_addr(sector), &header, sizeof(header)) != ESP_OK) {
+        return false;
+    }
+    s_head = sector;
+    s_head_seq = seq;
+    s_write_offset = DATA_START;
+    return true;
+}
+
+/**
+ * @brief 将即将擦除的扇区交给淘汰回调
+ */
+static void evict_sector(uint16_t sector) {
+    sector_header_t header;
+    if (s_evict_cb == NULL || !read_sector_header(sector, &header)) return;
+
+    uint8_t chunk[256];
+    for (uint32_t off = 0; off < LOG_STORE_SECTOR_SIZE; off += sizeof(chunk)) {
+        if (esp_partition_read(s_partition, sector_addr(sector) + off, chunk, sizeof(chunk)) != ESP_OK) {
+            memset(chunk, 0xFF, sizeof(chunk));
+        }
+        s_evict_cb(off, chunk, sizeof(chunk), s_evict_ctx);
+    }
+}
+
+/**
+ * @brief 切换到备用扇区，并擦除新的备用扇区
+ * @details 备用扇区若为最老扇区，则最老的一个扇区的日志先交给淘汰回调，然后被丢弃
+ */
+static bool advance_sector() {
+    if (!open_sector(next_sector(s_head), s_head_seq + 1)) {
+        return false;
+    }
+    uint16_t spare = next_sector(s_head);
+    if (spare == s_tail) {
+        evict_sector(spare);
+        s_tail = next_sector(s_tail);
+    }
+    return erase_sector(spare);
+}
+
+// --- 记录帧 ---
+
+/**
+ * @brief 读取并校验 offset 处的记录帧
+ * @param payload 输出缓冲区（可为NULL，仅校验）
+ * @param p_len 输出记录长度
+ * @return true 有效帧, false 空闲区或损坏帧
+ */
+static bool read_frame(uint16_t sector, uint32_t offset, uint8_t* payload, size_t payload_size, uint16_t* p_len) {
+    if (offset + sizeof(frame_header_t) > LOG_STORE_SECTOR_SIZE) return false;
+
+    frame_header_t frame;
+    uint32_t addr = sector_addr(sector) + offset;
+    if (esp_partition_read(s_partition, addr, &frame, sizeof(frame)) != ESP_OK) return false;
+    if (frame.len == FRAME_ERASED || frame.len == 0 || frame.len > LOG_STORE_MAX_RECORD) return false;
+    if (offset + sizeof(frame) + frame.len > LOG_STORE_SECTOR_SIZE) return false;
+
+    // 分块计算CRC，同时拷贝到输出缓冲区
+    uint32_t crc = 0;
+    uint8_t chunk[64];
+    addr += sizeof(frame);
+    for (uint16_t done = 0; done < frame.len; ) {
+        uint16_t n = (frame.len - done < (int)sizeof(chunk)) ? (uint16_t)(frame.len - done) : (uint16_t)sizeof(chunk);
+        if (esp_partition_read(s_partition, addr + done, chunk, n) != ESP_OK) return false;
+        crc = esp_crc32_le(crc, chunk, n);
+        if (payload != NULL && done < payload_size) {
+            memcpy(payload + done, chunk, (payload_size - done < n) ? payload_size - done : n);
+        }
+        done += n;
+    }
+    if ((uint16_t)crc != frame.crc) return false;
+
+    *p_len = frame.len;
+    return true;
+}
+
+/**
+ * @brief 扫描扇区，返回第一个无效帧的偏移
+ * @param p_torn 输出：无效帧是否为损坏帧（而非擦除区）
+ */
+static uint32_t scan_sector(uint16_t sector, bool* p_torn) {
+    uint32_t offset = DATA_START;
+    uint16_t len;
+    while (read_frame(sector, offset, NULL, 0, &len)) {
+        offset += ALIGN4(sizeof(frame_header_t) + len);
+    }
+
+    *p_torn = false;
+    if (offset + sizeof(frame_header_t) <= LOG_STORE_SECTOR_SIZE) {
+        frame_header_t frame;
+        if (esp_partition_read(s_partition, sector_addr(sector) + offset, &frame, sizeof(frame)) == ESP_OK) {
+            *p_torn = (frame.len != FRAME_ERASED || frame.crc != FRAME_ERASED);
+        }
+    }
+    return offset;
+}
+
+// --- 挂载与格式化 ---
+
+static bool format_locked(bool full_erase) {
+    if (full_erase) {
+        if (esp_partition_erase_range(s_partition, 0, sector_addr(s_sector_count)) != ESP_OK) return false;
+        s_sectors_erased += s_sector_count;
+    } else {
+        // 分区中没有任何有效扇区头，只需准备 head 与备用扇区
+        if (!erase_sector(0) || !erase_sector(1)) return false;
+    }
+    s_tail = 0;
+    return open_sector(0, 1);
+}
+
+static bool mount_locked() {
+    bool found = false;
+    uint32_t max_seq = 0;
+    sector_header_t header;
+
+    for (uint16_t s = 0; s < s_sector_count; s++) {
+        if (read_sector_header(s, &header) && (!found || (int32_t)(header.seq - max_seq) > 0)) {
+            found = true;
+            max_seq = header.seq;
+            s_head = s;
+        }
+    }
+    if (!found) {
+        return format_locked(false);
+    }
+    s_head_seq = max_seq;
+
+    // 最老扇区：排除备用扇区后序号最小者
+    uint16_t spare = next_sector(s_head);
+    s_tail = s_head;
+    uint32_t min_seq = max_seq;
+    for (uint16_t s = 0; s < s_sector_count; s++) {
+        if (s != spare && read_sector_header(s, &header) && (int32_t)(header.seq - min_seq) < 0) {
+            min_seq = header.seq;
+            s_tail = s;
+        }
+    }
+
+    // 掉电可能发生在扇区头写入之后、备用扇区擦除完成之前
+    if (!sector_is_erased(spare) && !erase_sector(spare)) {
+        return false;
+    }
+
+    // 在 head 扇区中找到写入位置；遇到损坏帧（写入中途掉电）则关闭该扇区
+    bool torn;
+    s_write_offset = scan_sector(s_head, &torn);
+    if (torn) {
+        s_torn_records++;
+        return advance_sector();
+    }
+    return true;
+}
+
+// --- Public API ---
+
+bool log_store_init(uint32_t tag) {
+    s_partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                           (esp_partition_subtype_t)LOG_STORE_PARTITION_SUBTYPE,
+                                           LOG_STORE_PARTITION_LABEL);
+    if (s_partition == NULL) {
+        return false;
+    }
+
+    s_sector_count = (uint16_t)(s_partition->size / LOG_STORE_SECTOR_SIZE);
+    if (s_sector_count < 3) {
+        return false;
+    }
+
+    if (s_mutex == NULL) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (s_mutex == NULL) return false;
+    }
+
+    s_tag = tag;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_mounted = mount_locked();
+    xSemaphoreGive(s_mutex);
+    return s_mounted;
+}
+
+bool log_store_is_mounted() {
+    return s_mounted;
+}
+
+bool log_store_append(const uint8_t* data, size_t len) {
+    if (!s_mounted || len == 0 || len > LOG_STORE_MAX_RECORD) return false;
+
+    // 帧头与内容合并为一次写入
+    uint8_t frame[sizeof(frame_header_t) + LOG_STORE_MAX_RECORD];
+    frame_header_t* header = (frame_header_t*)frame;
+    header->len = (uint16_t)len;
+    header->crc = (uint16_t)esp_crc32_le(0, data, len);
+    memcpy(frame + sizeof(frame_header_t), data, len);
+    uint32_t frame_len = sizeof(frame_header_t) + len;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    bool ok = true;
+    if (s_write_offset + ALIGN4(frame_len) > LOG_STORE_SECTOR_SIZE) {
+        ok = advance_sector();
+    }
+    if (ok) {
+        ok = esp_partition_write(s_partition, sector_addr(s_head) + s_write_offset, frame, frame_len) == ESP_OK;
+        // 写入失败时同样跳过该区域，避免在未擦除的位置重复写入
+        s_write_offset += ALIGN4(frame_len);
+        if (ok) s_records_appended++;
+    }
+    xSemaphoreGive(s_mutex);
+    return ok;
+}
+
+/**
+ * @brief 将游标定位到最老扇区的起始位置（调用者持有互斥锁）
+ */
+static void cursor_seek_tail(log_store_cursor_t* cursor) {
+    sector_header_t header;
+    cursor->sector = s_tail;
+    cursor->offset = DATA_START;
+    if (read_sector_header(s_tail, &header)) {
+        cursor->seq = header.seq;
+        cursor->tag = header.tag;
+    } else {
+        cursor->seq = s_head_seq;
+        cursor->tag = s_tag;
+    }
+}
+
+void log_store_cursor_begin(log_store_cursor_t* cursor) {
+    cursor->done = !s_mounted;
+    if (!s_mounted) return;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    cursor_seek_tail(cursor);
+    xSemaphoreGive(s_mutex);
+}
+
+int log_store_next(log_store_cursor_t* cursor, uint8_t* buf, size_t buf_size) {
+    if (!s_mounted || cursor->done) return -1;
+
+    int result = -1;
+    sector_header_t header;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    // 读取者落后一整圈：游标所在扇区已被覆盖，从当前最老扇区重新开始
+    if (!read_sector_header(cursor->sector, &header) || header.seq != cursor->seq) {
+        cursor_seek_tail(cursor);
+    }
+
+    while (true) {
+        if (cursor->sector == s_head && cursor->offset >= s_write_offset) {
+            cursor->done = true;
+            break;
+        }
+
+        uint16_t len;
+        if (read_frame(cursor->sector, cursor->offset, buf, buf_size, &len)) {
+            cursor->offset += ALIGN4(sizeof(frame_header_t) + len);
+            result = (len < buf_size) ? len : (int)buf_size;
+            break;
+        }
+
+        // 扇区结束（或遇到损坏帧），进入下一个扇区
+        if (cursor->sector == s_head) {
+            cursor->done = true;
+            break;
+        }
+        cursor->sector = next_sector(cursor->sector);
+        cursor->offset = DATA_START;
+        cursor->seq++;
+        if (!read_sector_header(cursor->sector, &header) || header.seq != cursor->seq) {
+            cursor->done = true;
+            break;
+        }
+        cursor->tag = header.tag;
+    }
+
+    xSemaphoreGive(s_mutex);
+    return result;
+}
+
+void log_store_set_evict_handler(log_store_evict_cb_t cb, void* ctx) {
+    if (s_mutex != NULL) xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_evict_cb = cb;
+    s_evict_ctx = ctx;
+    if (s_mutex != NULL) xSemaphoreGive(s_mutex);
+}
+
+bool log_store_format() {
+    if (s_partition == NULL || s_mutex == NULL) return false;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_mounted = format_locked(true);
+    xSemaphoreGive(s_mutex);
+    return s_mounted;
+}
+
+void log_store_get_stats(log_store_stats_t* p_stats) {
+    if (p_stats == nullptr) return;
+    memset(p_stats, 0, sizeof(*p_stats));
+    p_stats->mounted = s_mounted;
+    if (s_partition == NULL) return;
+
+    p_stats->partition_size = s_partition->size;
+    p_stats->sector_count = s_sector_count;
+    p_stats->head_sector = s_head;
+    p_stats->tail_sector = s_tail;
+    p_stats->head_seq = s_head_seq;
+    p_stats->used_bytes = (uint32_t)((s_head + s_sector_count - s_tail) % s_sector_count) * LOG_STORE_SECTOR_SIZE +
+                          s_write_offset;
+    p_stats->records_appended = s_records_appended;
+    p_stats->sectors_erased = s_sectors_erased;
+    p_stats->torn_records = s_torn_records;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file log_store.h
+ * @brief 基于原始 `logs` 分区的循环日志存储
+ * @details
+ *   直接在分区表中预留的 `logs` 分区 (data, subtype 0x82) 上以扇区为单位组织循环日志，
+ *   不经过文件系统，追加操作只是一次 esp_partition_write。
+ *
+ *   扇区布局:
+ *   - 扇区头 16 字节: magic, 扇区序号(单调递增), 格式标记, CRC32
+ *   - 之后为连续的记录帧: [len u16][crc16 u16][payload]，按4字节对齐
+ *   - 未写入区域保持擦除态 0xFF，len == 0xFFFF 表示扇区内数据结束
+ *
+ *   掉电恢复: 挂载时扫描所有扇区头，序号最大者为写入扇区(head)，最小者为最老扇区(tail)；
+ *   在 head 扇区内逐帧校验 CRC 找到写入位置。head 之后始终保留一个已擦除的备用扇区，
+ *   使换扇区时无需等待擦除。
+ */
+
+#ifndef LOG_STORE_H
+#define LOG_STORE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define LOG_STORE_PARTITION_LABEL   "logs"
+#define LOG_STORE_PARTITION_SUBTYPE 0x82
+#define LOG_STORE_SECTOR_SIZE       4096
+#define LOG_STORE_MAX_RECORD        252   // 单条记录最大长度（帧头+内容一次写入）
+
+/**
+ * @brief 日志存储统计信息
+ */
+typedef struct {
+    bool mounted;              ///< 是否已挂载
+    uint32_t partition_size;   ///< 分区大小 (字节)
+    uint16_t sector_count;     ///< 扇区总数
+    uint16_t head_sector;      ///< 当前写入扇区
+    uint16_t tail_sector;      ///< 最老数据所在扇区
+    uint32_t head_seq;         ///< 当前写入扇区序号
+    uint32_t used_bytes;       ///< 已使用字节数（近似）
+    uint32_t records_appended; ///< 本次启动以来追加的记录数
+    uint32_t sectors_erased;   ///< 本次启动以来擦除的扇区数
+    uint32_t torn_records;     ///< 挂载时发现的损坏记录数
+} log_store_stats_t;
+
+/**
+ * @brief 读取游标（从最老记录向最新记录遍历）
+ */
+typedef struct {
+    uint16_t sector;
+    uint16_t offset;
+    uint32_t seq;
+    uint32_t tag;   ///< 当前扇区的格式标记
+    bool done;
+} log_store_cursor_t;
+
+/**
+ * @brief 扇区淘汰回调
+ * @details 最老扇区即将被擦除前，以分块方式交付整个扇区镜像（offset 从0递增到 LOG_STORE_SECTOR_SIZE）。
+ *          在日志存储的互斥锁内调用，回调中不得调用 log_store_* 函数。
+ */
+typedef void (*log_store_evict_cb_t)(uint32_t offset, const uint8_t* data, size_t len, void* ctx);
+
+/**
+ * @brief 挂载日志分区并恢复读写位置
+ * @param tag 写入新扇区头的格式标记，读取时可据此跳过其他固件写入的扇区
+ * @return true 成功, false 分区不存在或访问失败
+ */
+bool log_store_init(uint32_t tag);
+
+/**
+ * @brief 查询是否已挂载
+ */
+bool log_store_is_mounted();
+
+/**
+ * @brief 追加一条记录
+ * @param data 记录内容
+ * @param len 记录长度 (1 - LOG_STORE_MAX_RECORD)
+ * @return true 成功, false 失败
+ */
+bool log_store_append(const uint8_t* data, size_t len);
+
+/**
+ * @brief 将游标定位到最老的记录
+ */
+void log_store_cursor_begin(log_store_cursor_t* cursor);
+
+/**
+ * @brief 读取游标处的记录并前进
+ * @param cursor 游标
+ * @param buf 输出缓冲区
+ * @param buf_size 缓冲区大小（超长记录会被截断）
+ * @return 记录长度；-1 表示已读到最新记录
+ */
+int log_store_next(log_store_cursor_t* cursor, uint8_t* buf, size_t buf_size);
+
+/**
+ * @brief 设置扇区淘汰回调（用于归档即将被覆盖的日志）
+ * @param cb 回调，NULL 表示取消
+ * @param ctx 传给回调的上下文
+ */
+void log_store_set_evict_handler(log_store_evict_cb_t cb, void* ctx);
+
+/**
+ * @brief 擦除整个日志分区并重新初始化
+ * @return true 成功, false 失败
+ */
+bool log_store_format();
+
+/**
+ * @brief 获取统计信息
+ */
+void log_store_get_stats(log_store_stats_t* p_stats);
+
+#endif // LOG_STORE_H
@@ -1,58 +1,251 @@
 /**
  * @file log_manager.cpp
- * @brief 日志管理器实现（RAM缓冲 + FreeRTOS异步写入）
+ * @brief 日志管理器实现（无锁RAM环形缓冲 + FreeRTOS异步写入）
  */
 
 #include "log_manager.h"
+#include "log/log_binary.h"
+#include "log/log_store.h"
+#include "log/log_archive.h"
 #include "../services/time_manager.h"
 #include <SPIFFS.h>
 #include <stdio.h>
 #include <stdarg.h>
 #include <time.h>
+#include <atomic>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
+#include <freertos/semphr.h>
 
 static bool spiffs_initialized = false;
-
-// --- RAM环形缓冲区 ---
-#define LOG_RAM_BUFFER_SIZE 100
-static String log_ram_buffer[LOG_RAM_BUFFER_SIZE];
-static uint16_t log_ram_head = 0;
-static uint16_t log_ram_count = 0;
-static portMUX_TYPE log_ram_mux = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t s_store_tag = 0;  // 日志分区扇区头与归档分段的格式标记
+
+// --- RAM环形缓冲区（固定槽位、多生产者/单消费者、无锁） ---
+//
+// 采用按槽位序号同步的有界队列：生产者/消费者各自通过CAS推进位置，
+// 再通过槽位序号发布数据，全程不关中断、不分配堆内存。
+// 序号以"圈基准"存储（pos 去掉低位槽位下标），使零初始化即为合法的空状态，
+// 因此 log_manager_init() 之前产生的日志也能安全入队。
+//   seq == base      : 槽位空闲，可由位置 pos 的生产者写入
+//   seq == base + 1  : 已提交，等待消费
+//   seq == base + N  : 已消费，数据仍保留（供 get_recent_logs 读取），可供下一圈写入
+#define LOG_RAM_MASK (LOG_RAM_BUFFER_SIZE - 1)
+static_assert((LOG_RAM_BUFFER_SIZE & LOG_RAM_MASK) == 0, "LOG_RAM_BUFFER_SIZE must be a power of 2");
+static_assert(LOG_RAM_SLOT_SIZE <= LOG_STORE_MAX_RECORD, "log slot must fit in one log store record");
+
+typedef struct {
+    std::atomic<uint32_t> seq;
+    uint16_t len;
+    uint8_t data[LOG_RAM_SLOT_SIZE];  // 文本行，或 LOG_BINARY_MODE 下的二进制记录
+} log_slot_t;
+
+static log_slot_t log_ring[LOG_RAM_BUFFER_SIZE];
+static std::atomic<uint32_t> log_enqueue_pos(0);
+static std::atomic<uint32_t> log_dequeue_pos(0);
+
+// --- 统计计数 ---
+static std::atomic<uint32_t> s_records_logged(0);
+static std::atomic<uint32_t> s_records_dropped(0);
+
+static uint32_t s_flush_count = 0;
+static uint32_t s_bytes_written = 0;
+static uint64_t s_flash_io_us = 0;
 
 // --- FreeRTOS后台写入任务 ---
+// 写入任务平时阻塞在任务通知上，不做周期轮询：
+//   LOG_NOTIFY_ARM        : 环形缓冲区由空变为非空，启动最大延迟计时
+//   LOG_NOTIFY_HIGH_WATER : 待写入条数达到高水位，立即写入
+//   LOG_NOTIFY_FLUSH      : log_manager_flush_now() 请求，写入后通过信号量应答
+#define LOG_NOTIFY_ARM        (1UL << 0)
+#define LOG_NOTIFY_HIGH_WATER (1UL << 1)
+#define LOG_NOTIFY_FLUSH      (1UL << 2)
+
 static TaskHandle_t s_log_write_task_handle = NULL;
-static volatile bool s_flush_requested = false;
+static SemaphoreHandle_t s_flush_done_semaphore = NULL;
+static SemaphoreHandle_t s_flush_mutex = NULL;
+static std::atomic<bool> s_writer_armed(false);
+static volatile uint32_t s_max_latency_ms = LOG_FLUSH_MAX_LATENCY_MS;
+
+/**
+ * @brief 将一条日志写入环形缓冲区
+ * @return true 成功, false 缓冲区已满
+ */
+static bool ring_push(const uint8_t* data, size_t len) {
+    if (len > LOG_RAM_SLOT_SIZE) len = LOG_RAM_SLOT_SIZE;
+
+    uint32_t pos = log_enqueue_pos.load(std::memory_order_relaxed);
+    while (true) {
+        log_slot_t* slot = &log_ring[pos & LOG_RAM_MASK];
+        uint32_t base = pos & ~(uint32_t)LOG_RAM_MASK;
+        int32_t diff = (int32_t)(slot->seq.load(std::memory_order_acquire) - base);
+
+        if (diff == 0) {
+            // 槽位空闲，尝试占用
+            if (log_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                memcpy(slot->data, data, len);
+                slot->len = (uint16_t)len;
+                slot->seq.store(base + 1, std::memory_order_release);
+                return true;
+            }
+            // CAS失败时pos已被更新为最新值，重试
+        } else if (diff < 0) {
+            // 上一圈的数据尚未被消费：缓冲区满
+            return false;
+        } else {
+            // 其他生产者已占用该位置
+            pos = log_enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief 从环形缓冲区取出最老的一条日志
+ * @param out 输出缓冲区（至少LOG_RAM_SLOT_SIZE字节），为NULL时仅丢弃
+ * @param p_len 输出长度（可为NULL）
+ * @return true 取到一条, false 缓冲区为空
+ */
+static bool ring_pop(uint8_t* out, uint16_t* p_len) {
+    uint32_t pos = log_dequeue_pos.load(std::memory_order_relaxed);
+    while (true) {
+        log_slot_t* slot = &log_ring[pos & LOG_RAM_MASK];
+        uint32_t base = pos & ~(uint32_t)LOG_RAM_MASK;
+        int32_t diff = (int32_t)(slot->seq.load(std::memory_order_acquire) - (base + 1));
+
+        if (diff == 0) {
+            if (log_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                uint16_t len = slot->len;
+                if (out != NULL) memcpy(out, slot->data, len);
+                if (p_len != NULL) *p_len = len;
+                slot->seq.store(base + LOG_RAM_BUFFER_SIZE, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            // 为空，或该位置的生产者尚未提交
+            return false;
+        } else {
+            pos = log_dequeue_pos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief 无锁读取指定位置的日志（用于最近日志查询，不消费）
+ * @details 拷贝前后两次读取序号，若期间被生产者覆盖则视为无效
+ * @return 拷贝的长度，0表示该位置无有效数据
+ */
+static uint16_t ring_peek(uint32_t pos, uint8_t* out) {
+    log_slot_t* slot = &log_ring[pos & LOG_RAM_MASK];
+    uint32_t base = pos & ~(uint32_t)LOG_RAM_MASK;
+
+    uint32_t seq_before = slot->seq.load(std::memory_order_acquire);
+    if (seq_before != base + 1 && seq_before != base + LOG_RAM_BUFFER_SIZE) {
+        return 0;
+    }
+
+    uint16_t len = slot->len;
+    if (len > LOG_RAM_SLOT_SIZE) return 0;
+    memcpy(out, slot->data, len);
+
+    // 序号未变且该槽位尚未被下一圈的生产者占用，拷贝才有效
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot->seq.load(std::memory_order_relaxed) != seq_before) {
+        return 0;
+    }
+    if (log_enqueue_pos.load(std::memory_order_relaxed) - pos > LOG_RAM_BUFFER_SIZE) {
+        return 0;
+    }
+    return len;
+}
+
+static inline uint16_t ring_pending() {
+    uint32_t pending = log_enqueue_pos.load(std::memory_order_relaxed) -
+                       log_dequeue_pos.load(std::memory_order_relaxed);
+    return pending > LOG_RAM_BUFFER_SIZE ? LOG_RAM_BUFFER_SIZE : (uint16_t)pending;
+}
+
+static const char* const LEVEL_NAMES[] = {"ERROR", "WARN", "INFO", "DEBUG"};
+
+/**
+ * @brief 将级别字符串转换为枚举（只比较首字母）
+ */
+static log_level_t level_from_string(const char* level) {
+    switch (level[0]) {
+        case 'E': return LOG_LEVEL_ERROR;
+        case 'W': return LOG_LEVEL_WARN;
+        case 'D': return LOG_LEVEL_DEBUG;
+        default:  return LOG_LEVEL_INFO;
+    }
+}
+
+// --- 运行时级别表 ---
+// 条目只追加不删除：先写入模块名与级别，再以 release 语义发布条目数，读取方无需加锁。
+// 恢复默认级别时将该条目的级别置为 LOG_LEVEL_INHERIT。写入方仅为初始化与CLI（单写者）。
+#define LOG_LEVEL_INHERIT 0xFF
+#define LOG_DEFAULT_LEVEL (LOG_COMPILE_LEVEL < LOG_LEVEL_DEBUG ? LOG_COMPILE_LEVEL : LOG_LEVEL_DEBUG)
+
+typedef struct {
+    char module[LOG_MODULE_NAME_MAX];
+    std::atomic<uint8_t> level;
+} log_module_level_t;
+
+static log_module_level_t s_module_levels[LOG_MODULE_LEVEL_MAX];
+static std::atomic<uint8_t> s_module_level_count(0);
+static std::atomic<uint8_t> s_default_level(LOG_DEFAULT_LEVEL);
+// 默认级别与所有模块级别中的最低者：不高于此级别的日志无需查表
+static std::atomic<uint8_t> s_fast_pass_level(LOG_DEFAULT_LEVEL);
+
+static void update_fast_pass_level() {
+    uint8_t lowest = s_default_level.load(std::memory_order_relaxed);
+    uint8_t count = s_module_level_count.load(std::memory_order_relaxed);
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t level = s_module_levels[i].level.load(std::memory_order_relaxed);
+        if (level != LOG_LEVEL_INHERIT && level < lowest) lowest = level;
+    }
+    s_fast_pass_level.store(lowest, std::memory_order_relaxed);
+}
+
+/**
+ * @brief 将本次启动的 tick 换算为Unix时间
+ * @return Unix时间；时间未同步时返回0
+ */
+static uint32_t live_unix_time(uint32_t tick_ms) {
+    TimeManager& time_mgr = TimeManager::instance();
+    if (!time_mgr.isTimeSynced()) return 0;
+    return (uint32_t)(time_mgr.getTimestamp() - (time_t)((millis() - tick_ms) / 1000));
+}
 
 /**
  * @brief 格式化时间戳字符串
  * @param buffer 输出缓冲区
  * @param size 缓冲区大小
+ * @param tick_ms 日志产生时的 millis()
+ * @param unix_time 日志产生时的Unix时间，0表示未知
  */
-static void format_timestamp(char* buffer, size_t size) {
-    TimeManager& time_mgr = TimeManager::instance();
-    
-    if (time_mgr.isTimeSynced()) {
-        // 时间已同步，显示绝对时间 HH:MM:SS
-        time_t now = time_mgr.getTimestamp();
+static void format_entry_time(char* buffer, size_t size, uint32_t tick_ms, uint32_t unix_time) {
+    if (unix_time != 0) {
+        // 时间已知，显示绝对时间
+        time_t now = (time_t)unix_time;
         struct tm timeinfo;
         localtime_r(&now, &timeinfo);
         strftime(buffer, size, "%Y-%m-%d %H:%M:%S", &timeinfo);
     } else {
         // 时间未同步，显示启动后相对时间 +HH:MM:SS
-        unsigned long ms = millis();
+        unsigned long ms = tick_ms;
         unsigned long seconds = ms / 1000;
         unsigned long minutes = seconds / 60;
         unsigned long hours = minutes / 60;
-        
+
         seconds %= 60;
         minutes %= 60;
-        
+
         snprintf(buffer, size, "+%02lu:%02lu:%02lu", hours, minutes, seconds);
     }
 }
 
+static inline void format_timestamp(char* buffer, size_t size, uint32_t tick_ms) {
+    format_entry_time(buffer, size, tick_ms, live_unix_time(tick_ms));
+}
+
 /**
  * @brief 检查日志文件大小，执行滚动策略
  */
@@ -67,6 +260,12 @@ static void check_and_rotate_log() {
 
     // 超过500KB，执行滚动
     if (fileSize >= LOG_MAX_FILE_SIZE) {
+        // 压缩进归档；归档不可用时退回只保留一个旧备份
+        if (log_archive_add_file(LOG_FILE_PATH, s_store_tag)) {
+            SPIFFS.remove(LOG_FILE_PATH);
+            return;
+        }
+
         // 删除旧备份
         if (SPIFFS.exists(LOG_FILE_OLD_PATH)) {
             SPIFFS.remove(LOG_FILE_OLD_PATH);
@@ -80,35 +279,78 @@ static void check_and_rotate_log() {
 }
 
 /**
- * @brief 将RAM缓冲区批量写入SPIFFS（后台任务调用）
+ * @brief 日志分区淘汰最老扇区前将其压缩进归档
  */
-static void flush_ram_to_spiffs() {
-    if (!spiffs_initialized) return;
-    if (log_ram_count == 0) return;
+static void archive_evicted_sector(uint32_t offset, const uint8_t* data, size_t len, void* ctx) {
+    (void)ctx;
+    if (offset == 0) {
+        log_archive_begin(LOG_ARCHIVE_SOURCE_SECTORS, s_store_tag, false);
+    }
+    log_archive_write(data, len);
+    if (offset + len >= LOG_STORE_SECTOR_SIZE) {
+        log_archive_end();
+    }
+}
 
-    // 临界区：复制待写入的数据到临时缓冲区
-    String temp_buffer[LOG_RAM_BUFFER_SIZE];
-    uint16_t count_to_write = 0;
+/**
+ * @brief 将RAM缓冲区逐条追加到日志分区（后台任务调用）
+ */
+static void flush_ram_to_store() {
+    if (ring_pending() == 0) return;
 
-    portENTER_CRITICAL(&log_ram_mux);
-    count_to_write = log_ram_count;
-    uint16_t start_idx = (log_ram_head - log_ram_count + LOG_RAM_BUFFER_SIZE) % LOG_RAM_BUFFER_SIZE;
+#ifdef LOG_BINARY_MODE
+    // 时间已同步时追加时间锚点，供解码器换算绝对时间
+    TimeManager& time_mgr = TimeManager::instance();
+    if (time_mgr.isTimeSynced()) {
+        uint8_t anchor[LOG_BINARY_RECORD_HDR];
+        size_t anchor_len = log_binary_encode_anchor(anchor, millis(), (uint32_t)time_mgr.getTimestamp());
+        if (log_store_append(anchor, anchor_len)) {
+            s_bytes_written += anchor_len;
+        }
+    }
+#endif
 
-    // 复制String（在临界区内，但不做文件操作）
-    for (uint16_t i = 0; i < count_to_write; i++) {
-        uint16_t idx = (start_idx + i) % LOG_RAM_BUFFER_SIZE;
-        temp_buffer[i] = log_ram_buffer[idx];
+    uint8_t record[LOG_RAM_SLOT_SIZE];
+    uint16_t len;
+    while (ring_pop(record, &len)) {
+        if (log_store_append(record, len)) {
+            s_bytes_written += len;
+        }
     }
+}
 
-    log_ram_count = 0; // 清空已复制的
-    portEXIT_CRITICAL(&log_ram_mux);
+/**
+ * @brief 将RAM缓冲区批量写入SPIFFS（日志分区不可用时的后备路径）
+ */
+static void flush_ram_to_spiffs() {
+    if (!spiffs_initialized) return;
 
-    // 临界区外：批量写入文件（不持有锁）
     File file = SPIFFS.open(LOG_FILE_PATH, FILE_APPEND);
     if (!file) return;
 
-    for (uint16_t i = 0; i < count_to_write; i++) {
-        file.println(temp_buffer[i]);
+#ifdef LOG_BINARY_MODE
+    // 新文件写入文件头；时间已同步时追加时间锚点，供解码器换算绝对时间
+    if (file.size() == 0) {
+        uint8_t header[LOG_BINARY_HEADER_SIZE];
+        log_binary_write_header(header);
+        s_bytes_written += file.write(header, sizeof(header));
+    }
+    TimeManager& time_mgr = TimeManager::instance();
+    if (time_mgr.isTimeSynced()) {
+        uint8_t anchor[LOG_BINARY_RECORD_HDR];
+        size_t anchor_len = log_binary_encode_anchor(anchor, millis(), (uint32_t)time_mgr.getTimestamp());
+        s_bytes_written += file.write(anchor, anchor_len);
+    }
+#endif
+
+    // 逐条消费：每次只复制一个槽位，不持有任何锁
+    uint8_t record[LOG_RAM_SLOT_SIZE];
+    uint16_t len;
+    while (ring_pop(record, &len)) {
+        s_bytes_written += file.write(record, len);
+#ifndef LOG_BINARY_MODE
+        s_bytes_written += file.write('\n');
+#endif
     }
 
     file.close();
@@ -118,43 +360,120 @@ static void flush_ram_to_spiffs() {
 }
 
 /**
- * @brief FreeRTOS后台日志写入任务
+ * @brief 将RAM缓冲区写入Flash并更新统计
+ */
+static void flush_ram() {
+    if (ring_pending() == 0) return;
+
+    uint32_t start = micros();
+    if (log_store_is_mounted()) {
+        flush_ram_to_store();
+    } else {
+        flush_ram_to_spiffs();
+    }
+    s_flash_io_us += (uint32_t)(micros() - start);
+    s_flush_count++;
+}
+
+/**
+ * @brief FreeRTOS后台日志写入任务（事件驱动）
+ * @details 环形缓冲区为空时无限期阻塞，不产生任何唤醒；
+ *          有数据时最多等待 s_max_latency_ms 后写入
  */
 static void log_write_task(void* parameter) {
-    TickType_t last_flush = xTaskGetTickCount();
-    const TickType_t flush_interval = pdMS_TO_TICKS(10000); // 10秒自动写入
+    bool timer_running = false;
+    TickType_t deadline = 0;
+
+    // 任务创建前产生的日志
+    if (ring_pending() > 0 && !s_writer_armed.exchange(true)) {
+        timer_running = true;
+        deadline = xTaskGetTickCount() + pdMS_TO_TICKS(s_max_latency_ms);
+    }
 
     while (true) {
+        TickType_t wait = portMAX_DELAY;
+        if (timer_running) {
+            TickType_t now = xTaskGetTickCount();
+            wait = ((int32_t)(deadline - now) > 0) ? deadline - now : 0;
+        }
+
+        uint32_t events = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &events, wait);
         TickType_t now = xTaskGetTickCount();
 
-        // 触发条件：手动请求 OR 10秒超时 OR RAM缓冲区>80%满
-        bool should_flush = s_flush_requested ||
-                           (now - last_flush >= flush_interval) ||
-                           (log_ram_count >= LOG_RAM_BUFFER_SIZE * 0.8);
+        if ((events & LOG_NOTIFY_ARM) && !timer_running) {
+            timer_running = true;
+            deadline = now + pdMS_TO_TICKS(s_max_latency_ms);
+        }
 
+        // 触发条件：手动请求 OR 高水位 OR 最大延迟到期
+        bool should_flush = (events & (LOG_NOTIFY_FLUSH | LOG_NOTIFY_HIGH_WATER)) ||
+                            (timer_running && (int32_t)(now - deadline) >= 0);
         if (should_flush) {
-            flush_ram_to_spiffs();
-            s_flush_requested = false;
-            last_flush = now;
+            flush_ram();
+
+            // 先解除武装再检查，避免与生产者的竞争导致日志滞留
+            timer_running = false;
+            s_writer_armed.store(false);
+            if (ring_pending() > 0 && !s_writer_armed.exchange(true)) {
+                timer_running = true;
+                deadline = now + pdMS_TO_TICKS(s_max_latency_ms);
+            }
         }
 
-        vTaskDelay(pdMS_TO_TICKS(1000)); // 每秒检查一次
+        if (events & LOG_NOTIFY_FLUSH) {
+            xSemaphoreGive(s_flush_done_semaphore);
+        }
     }
 }
 
 
 void log_manager_init() {
+    // 挂载日志分区，扇区头记录格式标记（二进制模式为锚点地址）
+#ifdef LOG_BINARY_MODE
+    s_store_tag = log_binary_anchor_address();
+#endif
+    if (log_store_init(s_store_tag)) {
+        log_store_stats_t store_stats;
+        log_store_get_stats(&store_stats);
+        Serial.printf("[INFO][LogManager] Log partition mounted (%u/%lu bytes used)\r\n",
+                      (unsigned)store_stats.used_bytes, (unsigned long)store_stats.partition_size);
+    } else {
+        Serial.println("[WARN][LogManager] Log partition not found, falling back to SPIFFS");
+    }
+
     // 初始化SPIFFS
     if (!SPIFFS.begin(true)) {
         Serial.println("[ERROR][LogManager] SPIFFS mount failed");
-        return;
+    } else {
+        spiffs_initialized = true;
+        Serial.println("[INFO][LogManager] SPIFFS initialized");
+
+        // 压缩归档：保存即将被覆盖的日志分区扇区或滚动的日志文件
+        if (log_archive_init()) {
+            log_archive_stats_t archive_stats;
+            log_archive_get_stats(&archive_stats);
+            Serial.printf("[INFO][LogManager] Log archive ready (%u segments, %lu bytes)\r\n",
+                          archive_stats.segment_count, (unsigned long)archive_stats.total_bytes);
+            if (log_store_is_mounted()) {
+                log_store_set_evict_handler(archive_evicted_sector, NULL);
+            }
+        }
+
+        // 检查日志文件大小
+        check_and_rotate_log();
     }
 
-    spiffs_initialized = true;
-    Serial.println("[INFO][LogManager] SPIFFS initialized");
+    if (!log_store_is_mounted() && !spiffs_initialized) {
+        return;
+    }
 
-    // 检查日志文件大小
-    check_and_rotate_log();
+    s_flush_done_semaphore = xSemaphoreCreateBinary();
+    s_flush_mutex = xSemaphoreCreateMutex();
+    if (s_flush_done_semaphore == NULL || s_flush_mutex == NULL) {
+        Serial.println("[ERROR][LogManager] Failed to create flush semaphores");
+        return;
+    }
 
     // 创建FreeRTOS后台日志写入任务
     BaseType_t task_created = xTaskCreate(
@@ -173,13 +492,87 @@ void log_manager_init() {
     }
 }
 
+/**
+ * @brief 将日志写入RAM环形缓冲区（无锁，仅一次memcpy）
+ */
+static void store_record(const uint8_t* data, size_t len) {
+    if (!ring_push(data, len)) {
+        // 缓冲区满：丢弃最老的一条未写入日志，保证最近日志始终可见
+        if (ring_pop(NULL, NULL)) {
+            s_records_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (!ring_push(data, len)) {
+            s_records_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    s_records_logged.fetch_add(1, std::memory_order_relaxed);
+
+    // 唤醒写入任务：达到高水位立即写入；由空变为非空时启动最大延迟计时
+    TaskHandle_t writer = s_log_write_task_handle;
+    if (writer == NULL) return;
+    if (ring_pending() >= LOG_FLUSH_HIGH_WATER) {
+        xTaskNotify(writer, LOG_NOTIFY_HIGH_WATER, eSetBits);
+    } else if (!s_writer_armed.exchange(true)) {
+        xTaskNotify(writer, LOG_NOTIFY_ARM, eSetBits);
+    }
+}
+
+#ifdef LOG_BINARY_MODE
+/**
+ * @brief 将二进制记录展开为完整日志行 "[时间][级别][模块] 消息"
+ */
+static size_t render_record_line(const uint8_t* record, size_t len, uint32_t unix_time, char* out, size_t out_size) {
+    char timestamp[32];
+    char module_buf[32];
+    format_entry_time(timestamp, sizeof(timestamp), log_binary_record_tick(record), unix_time);
+    const char* module = log_binary_record_module(record, module_buf, sizeof(module_buf));
+
+    int n = snprintf(out, out_size, "[%s][%s][%s] ", timestamp,
+                     LEVEL_NAMES[log_binary_record_level(record) & 0x03], module);
+    if (n < 0 || (size_t)n >= out_size) return out_size - 1;
+    return n + log_binary_render_message(record, len, out + n, out_size - n);
+}
+#endif
+
 void log_manager_log(const char* level, const char* module, const char* format, ...) {
+    log_level_t level_id = level_from_string(level);
+
+    // 级别过滤在任何格式化之前完成
+    if (!log_manager_level_enabled(module, level_id)) {
+        return;
+    }
+
+#ifdef LOG_BINARY_MODE
+    // 二进制模式：只保存格式字符串地址和原始参数，不做任何文本格式化
+    uint8_t record[LOG_RAM_SLOT_SIZE];
+    va_list args;
+    va_start(args, format);
+    size_t len = log_binary_encode(record, sizeof(record), level_id, module, millis(), format, args);
+    va_end(args);
+
+#ifdef TEST_MODE
+    // HIL测试依赖串口文本输出，测试模式下仍立即展开
+    if (Serial) {
+        char line[LOG_BUFFER_SIZE + 64];
+        render_record_line(record, len, live_unix_time(millis()), line, sizeof(line));
+        Serial.println(line);
+    }
+#endif
+
+    // DEBUG日志不写入RAM/SPIFFS
+    if (level_id == LOG_LEVEL_DEBUG) {
+        return;
+    }
+
+    store_record(record, len);
+#else
     char timestamp[32];
     char log_message[LOG_BUFFER_SIZE];
     char final_log[LOG_BUFFER_SIZE + 64];
 
     // 格式化时间戳
-    format_timestamp(timestamp, sizeof(timestamp));
+    format_timestamp(timestamp, sizeof(timestamp), millis());
 
     // 格式化可变参数
     va_list args;
@@ -188,8 +581,10 @@ void log_manager_log(const char* level, const char* module, const char* format,
     va_end(args);
 
     // 组合最终的日志字符串
-    snprintf(final_log, sizeof(final_log), "[%s][%s][%s] %s",
-             timestamp, level, module, log_message);
+    int len = snprintf(final_log, sizeof(final_log), "[%s][%s][%s] %s",
+                       timestamp, level, module, log_message);
+    if (len < 0) return;
+    if (len >= (int)sizeof(final_log)) len = sizeof(final_log) - 1;
 
     // 输出到串口（立即）
     if (Serial) {
@@ -197,42 +592,394 @@ void log_manager_log(const char* level, const char* module, const char* format,
     }
 
     // DEBUG日志不写入RAM/SPIFFS，只在串口输出
-    if (strcmp(level, "DEBUG") == 0) {
+    if (level_id == LOG_LEVEL_DEBUG) {
+        return;
+    }
+
+    store_record((const uint8_t*)final_log, len);
+#endif
+}
+
+// --- 日志查询 ---
+
+typedef struct {
+    const log_query_t* query;
+    log_query_visitor_t visitor;
+    void* ctx;
+    bool render;           // false: 第一遍，只统计匹配条数
+    bool stop;
+    uint32_t skip;         // 第二遍跳过的最老匹配条数（用于 limit）
+    uint32_t matched;
+    uint32_t visited;
+    // Flash中二进制记录的时间锚点
+    bool anchor_valid;
+    uint32_t anchor_tick;
+    uint32_t anchor_unix;
+    uint32_t last_tick;    // 上一条日志记录的 tick（用于检测重启）
+} query_state_t;
+
+#ifndef LOG_BINARY_MODE
+/**
+ * @brief 从文本日志行 "[时间][级别][模块] 消息" 中解析元数据
+ */
+static bool parse_text_line(const char* line, log_level_t* p_level, char* module, uint32_t* p_tick, uint32_t* p_unix) {
+    char ts[24];
+    char level[8];
+    if (sscanf(line, "[%23[^]]][%7[^]]][%23[^]]]", ts, level, module) != 3) {
+        return false;
+    }
+    *p_level = level_from_string(level);
+
+    unsigned long h, m, sec;
+    struct tm tm_info = {};
+    if (sscanf(ts, "+%lu:%lu:%lu", &h, &m, &sec) == 3) {
+        *p_tick = (uint32_t)((h * 3600 + m * 60 + sec) * 1000);
+        *p_unix = 0;
+    } else if (sscanf(ts, "%d-%d-%d %d:%d:%d", &tm_info.tm_year, &tm_info.tm_mon, &tm_info.tm_mday,
+                      &tm_info.tm_hour, &tm_info.tm_min, &tm_info.tm_sec) == 6) {
+        tm_info.tm_year -= 1900;
+        tm_info.tm_mon -= 1;
+        tm_info.tm_isdst = -1;
+        *p_tick = 0;
+        *p_unix = (uint32_t)mktime(&tm_info);
+    } else {
+        return false;
+    }
+    return true;
+}
+#endif
+
+/**
+ * @brief 对一条原始记录应用过滤条件，必要时展开并交给访问者
+ */
+static void query_visit_record(query_state_t* st, const uint8_t* record, size_t len, bool from_flash) {
+    const log_query_t* q = st->query;
+    log_entry_t entry;
+    char module_buf[LOG_MODULE_NAME_MAX];
+    char line[LOG_BUFFER_SIZE + 64];
+
+#ifdef LOG_BINARY_MODE
+    if (len < LOG_BINARY_RECORD_HDR) return;
+    uint32_t tick = log_binary_record_tick(record);
+
+    if (log_binary_record_type(record) == LOG_RECORD_TYPE_ANCHOR) {
+        // 锚点在每次写入的开头，其后同批记录的 tick 可能早于锚点
+        st->anchor_valid = true;
+        st->anchor_tick = tick;
+        st->anchor_unix = log_binary_record_anchor_time(record);
+        st->last_tick = 0;
         return;
     }
+    if (log_binary_record_type(record) != LOG_RECORD_TYPE_LOG) return;
+
+    uint32_t unix_time;
+    if (from_flash) {
+        // 相邻记录的 tick 回退说明跨越了一次重启，之前的锚点失效
+        if (tick < st->last_tick) st->anchor_valid = false;
+        st->last_tick = tick;
+        unix_time = st->anchor_valid ? st->anchor_unix + (int32_t)(tick - st->anchor_tick) / 1000 : 0;
+    } else {
+        unix_time = live_unix_time(tick);
+    }
 
-    // 写入RAM缓冲区（快速，临界区保护）
-    portENTER_CRITICAL(&log_ram_mux);
-    log_ram_buffer[log_ram_head] = String(final_log);
-    log_ram_head = (log_ram_head + 1) % LOG_RAM_BUFFER_SIZE;
-    if (log_ram_count < LOG_RAM_BUFFER_SIZE) {
-        log_ram_count++;
+    entry.level = (log_level_t)(log_binary_record_level(record) & 0x03);
+    entry.module = log_binary_record_module(record, module_buf, sizeof(module_buf));
+#else
+    size_t n = (len < sizeof(line)) ? len : sizeof(line) - 1;
+    memcpy(line, record, n);
+    line[n] = '\0';
+
+    uint32_t tick, unix_time;
+    if (!parse_text_line(line, &entry.level, module_buf, &tick, &unix_time)) return;
+    entry.module = module_buf;
+#endif
+
+    // 过滤
+    if ((int)entry.level > q->max_level) return;
+    if (q->module != nullptr && strcmp(q->module, entry.module) != 0) return;
+    if ((q->since != 0 || q->until != 0) && unix_time == 0) return;
+    if (q->since != 0 && unix_time < q->since) return;
+    if (q->until != 0 && unix_time > q->until) return;
+
+    st->matched++;
+    if (!st->render || st->matched <= st->skip) return;
+
+#ifdef LOG_BINARY_MODE
+    entry.line_len = render_record_line(record, len, unix_time, line, sizeof(line));
+#else
+    entry.line_len = n;
+#endif
+    entry.line = line;
+    entry.tick_ms = tick;
+    entry.timestamp = unix_time;
+    entry.from_flash = from_flash;
+
+    st->visited++;
+    if (!st->visitor(&entry, st->ctx)) {
+        st->stop = true;
     }
-    // 缓冲区满时，最老的日志会被覆盖（丢弃）
-    portEXIT_CRITICAL(&log_ram_mux);
 }
 
-String log_manager_get_recent_logs(int count) {
-    String result = "";
+/**
+ * @brief 按位置区间遍历RAM环形缓冲区（逐槽拷贝，不持锁）
+ */
+static void query_scan_ring(query_state_t* st, uint32_t start, uint32_t end) {
+    uint8_t record[LOG_RAM_SLOT_SIZE];
+    for (uint32_t pos = start; pos != end && !st->stop; pos++) {
+        uint16_t len = ring_peek(pos, record);
+        if (len == 0) continue;
+        query_visit_record(st, record, len, false);
+    }
+}
+
+/**
+ * @brief 按时间顺序遍历所有数据源
+ */
+static void query_scan(query_state_t* st) {
+    st->anchor_valid = false;
+    st->last_tick = 0;
+    st->matched = 0;
+
+    uint8_t sources = st->query->sources;
+    if ((sources & LOG_QUERY_SOURCE_FLASH) && log_store_is_mounted()) {
+#ifdef LOG_BINARY_MODE
+        uint32_t expected_tag = log_binary_anchor_address();
+#else
+        uint32_t expected_tag = 0;
+#endif
+        log_store_cursor_t cursor;
+        uint8_t record[LOG_STORE_MAX_RECORD];
+        int len;
+        log_store_cursor_begin(&cursor);
+        while (!st->stop && (len = log_store_next(&cursor, record, sizeof(record))) >= 0) {
+            // 其他固件（或另一种日志格式）写入的扇区无法在设备端展开
+            if (cursor.tag != expected_tag) continue;
+            query_visit_record(st, record, len, true);
+        }
+
+        // 尚未写入Flash的记录
+        if (sources & LOG_QUERY_SOURCE_RAM) {
+            query_scan_ring(st, log_dequeue_pos.load(std::memory_order_acquire),
+                            log_enqueue_pos.load(std::memory_order_acquire));
+        }
+    } else if (sources & LOG_QUERY_SOURCE_RAM) {
+        uint32_t end = log_enqueue_pos.load(std::memory_order_acquire);
+        query_scan_ring(st, end - LOG_RAM_BUFFER_SIZE, end);
+    }
+}
+
+void log_manager_query_init(log_query_t* query) {
+    query->max_level = LOG_LEVEL_DEBUG;
+    query->module = nullptr;
+    query->since = 0;
+    query->until = 0;
+    query->limit = 0;
+    query->sources = LOG_QUERY_SOURCE_RAM;
+}
 
-    portENTER_CRITICAL(&log_ram_mux);
-    int available = min(count, (int)log_ram_count);
+uint32_t log_manager_query(const log_query_t* query, log_query_visitor_t visitor, void* ctx) {
+    if (query == nullptr || visitor == nullptr) return 0;
 
-    // 从最新到最旧读取
-    for (int i = 0; i < available; i++) {
-        int idx = (log_ram_head - 1 - i + LOG_RAM_BUFFER_SIZE) % LOG_RAM_BUFFER_SIZE;
-        result = log_ram_buffer[idx] + "\n" + result;
+    query_state_t st = {};
+    st.query = query;
+    st.visitor = visitor;
+    st.ctx = ctx;
+
+    // 需要"最新N条"时先统计匹配总数，第二遍跳过较老的记录
+    if (query->limit > 0) {
+        query_scan(&st);
+        st.skip = (st.matched > query->limit) ? st.matched - query->limit : 0;
     }
-    portEXIT_CRITICAL(&log_ram_mux);
+
+    st.render = true;
+    query_scan(&st);
+    return st.visited;
+}
+
+typedef struct {
+    char* buf;
+    size_t size;
+    size_t used;
+} buffer_writer_t;
+
+static bool buffer_visitor(const log_entry_t* entry, void* ctx) {
+    buffer_writer_t* w = (buffer_writer_t*)ctx;
+    // 只写入完整的行
+    if (w->used + entry->line_len + 2 > w->size) return false;
+    memcpy(w->buf + w->used, entry->line, entry->line_len);
+    w->used += entry->line_len;
+    w->buf[w->used++] = '\n';
+    w->buf[w->used] = '\0';
+    return true;
+}
+
+size_t log_manager_query_to_buffer(const log_query_t* query, char* buf, size_t size) {
+    if (buf == nullptr || size == 0) return 0;
+    buf[0] = '\0';
+    buffer_writer_t writer = {buf, size, 0};
+    log_manager_query(query, buffer_visitor, &writer);
+    return writer.used;
+}
+
+static bool string_visitor(const log_entry_t* entry, void* ctx) {
+    String* result = (String*)ctx;
+    *result += entry->line;
+    *result += "\n";
+    return true;
+}
+
+String log_manager_get_recent_logs(int count) {
+    if (count <= 0) return "No logs in RAM";
+
+    log_query_t query;
+    log_manager_query_init(&query);
+    query.limit = (count > LOG_RAM_BUFFER_SIZE) ? LOG_RAM_BUFFER_SIZE : count;
+
+    String result;
+    result.reserve(query.limit * 96);
+    log_manager_query(&query, string_visitor, &result);
 
     return result.length() > 0 ? result : "No logs in RAM";
 }
 
-void log_manager_flush_now() {
-    s_flush_requested = true;
-    // 可选：等待写入完成（最多1秒）
-    unsigned long start = millis();
-    while (s_flush_requested && (millis() - start < 1000)) {
-        delay(10);
+bool log_manager_flush_now(uint32_t timeout_ms) {
+    if (s_log_write_task_handle == NULL) return false;
+    // 写入任务自身调用时无法等待自己
+    if (xTaskGetCurrentTaskHandle() == s_log_write_task_handle) return false;
+
+    TickType_t timeout = pdMS_TO_TICKS(timeout_ms);
+    if (xSemaphoreTake(s_flush_mutex, timeout) != pdTRUE) return false;
+
+    // 清除上一次超时后迟到的应答
+    xSemaphoreTake(s_flush_done_semaphore, 0);
+    xTaskNotify(s_log_write_task_handle, LOG_NOTIFY_FLUSH, eSetBits);
+    bool acked = xSemaphoreTake(s_flush_done_semaphore, timeout) == pdTRUE;
+
+    xSemaphoreGive(s_flush_mutex);
+    return acked;
+}
+
+void log_manager_set_max_latency(uint32_t latency_ms) {
+    if (latency_ms < LOG_FLUSH_MIN_LATENCY_MS) latency_ms = LOG_FLUSH_MIN_LATENCY_MS;
+    s_max_latency_ms = latency_ms;
+}
+
+uint32_t log_manager_get_max_latency() {
+    return s_max_latency_ms;
+}
+
+bool log_manager_level_enabled(const char* module, log_level_t level) {
+    if ((uint8_t)level <= s_fast_pass_level.load(std::memory_order_relaxed)) {
+        return true;
+    }
+
+    uint8_t count = s_module_level_count.load(std::memory_order_acquire);
+    for (uint8_t i = 0; i < count; i++) {
+        if (strcmp(s_module_levels[i].module, module) == 0) {
+            uint8_t module_level = s_module_levels[i].level.load(std::memory_order_relaxed);
+            if (module_level != LOG_LEVEL_INHERIT) {
+                return (uint8_t)level <= module_level;
+            }
+            break;
+        }
     }
+    return (uint8_t)level <= s_default_level.load(std::memory_order_relaxed);
+}
+
+void log_manager_set_default_level(log_level_t level) {
+    s_default_level.store((uint8_t)level, std::memory_order_relaxed);
+    update_fast_pass_level();
+}
+
+bool log_manager_set_module_level(const char* module, int level) {
+    if (module == nullptr || module[0] == '\0') return false;
+    uint8_t value = (level < 0) ? LOG_LEVEL_INHERIT :
+                    (uint8_t)(level > LOG_LEVEL_DEBUG ? LOG_LEVEL_DEBUG : level);
+
+    uint8_t count = s_module_level_count.load(std::memory_order_relaxed);
+    for (uint8_t i = 0; i < count; i++) {
+        if (strcmp(s_module_levels[i].module, module) == 0) {
+            s_module_levels[i].level.store(value, std::memory_order_relaxed);
+            update_fast_pass_level();
+            return true;
+        }
+    }
+
+    // 未配置过的模块本来就使用默认级别
+    if (value == LOG_LEVEL_INHERIT) return true;
+    if (count >= LOG_MODULE_LEVEL_MAX) return false;
+
+    log_module_level_t* entry = &s_module_levels[count];
+    strncpy(entry->module, module, sizeof(entry->module) - 1);
+    entry->module[sizeof(entry->module) - 1] = '\0';
+    entry->level.store(value, std::memory_order_relaxed);
+    s_module_level_count.store(count + 1, std::memory_order_release);
+    update_fast_pass_level();
+    return true;
+}
+
+int log_manager_parse_level(const char* name) {
+    for (int i = 0; i <= LOG_LEVEL_DEBUG; i++) {
+        if (strcasecmp(name, LEVEL_NAMES[i]) == 0) return i;
+    }
+    return -1;
+}
+
+const char* log_manager_level_name(log_level_t level) {
+    return LEVEL_NAMES[level & 0x03];
+}
+
+String log_manager_get_level_spec() {
+    String spec = "*=";
+    spec += LEVEL_NAMES[s_default_level.load(std::memory_order_relaxed) & 0x03];
+
+    uint8_t count = s_module_level_count.load(std::memory_order_acquire);
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t level = s_module_levels[i].level.load(std::memory_order_relaxed);
+        if (level == LOG_LEVEL_INHERIT) continue;
+        spec += ",";
+        spec += s_module_levels[i].module;
+        spec += "=";
+        spec += LEVEL_NAMES[level & 0x03];
+    }
+    return spec;
+}
+
+int log_manager_apply_level_spec(const char* spec) {
+    if (spec == nullptr) return 0;
+
+    char buffer[160];
+    strncpy(buffer, spec, sizeof(buffer) - 1);
+    buffer[sizeof(buffer) - 1] = '\0';
+
+    int applied = 0;
+    char* save_ptr = nullptr;
+    for (char* item = strtok_r(buffer, ", ", &save_ptr); item != nullptr; item = strtok_r(nullptr, ", ", &save_ptr)) {
+        char* eq = strchr(item, '=');
+        if (eq == nullptr) continue;
+        *eq = '\0';
+
+        int level = log_manager_parse_level(eq + 1);
+        if (strcmp(item, "*") == 0) {
+            if (level < 0) continue;
+            log_manager_set_default_level((log_level_t)level);
+        } else if (level < 0 && strcasecmp(eq + 1, "default") != 0) {
+            continue;
+        } else if (!log_manager_set_module_level(item, level)) {
+            continue;
+        }
+        applied++;
+    }
+    return applied;
+}
+
+void log_manager_get_stats(log_stats_t* p_stats) {
+    if (p_stats == nullptr) return;
+    p_stats->records_logged = s_records_logged.load(std::memory_order_relaxed);
+    p_stats->records_dropped = s_records_dropped.load(std::memory_order_relaxed);
+    p_stats->ring_capacity = LOG_RAM_BUFFER_SIZE;
+    p_stats->ring_pending = ring_pending();
+    p_stats->flush_count = s_flush_count;
+    p_stats->bytes_written = s_bytes_written;
+    p_stats->flash_io_us = s_flash_io_us;
 }
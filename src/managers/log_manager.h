@@ -1,7 +1,10 @@
 /**
  * @file log_manager.h
- * @brief 日志管理器（带时间戳和SPIFFS持久化）
- * @details 统一管理系统日志输出，支持分级、模块化、时间戳和文件存储
+ * @brief 日志管理器（带时间戳和Flash持久化）
+ * @details 统一管理系统日志输出，支持分级、模块化、时间戳和文件存储。
+ *          日志优先写入 `logs` 原始分区的循环日志（log/log_store.h），
+ *          分区不存在时退回 SPIFFS 文件 LOG_FILE_PATH。
+ *          即将被覆盖的日志压缩后保存在 SPIFFS 归档中（log/log_archive.h）。
  */
 
 #ifndef LOG_MANAGER_H
@@ -11,11 +14,93 @@
 #include <Arduino.h>
 
 // --- 配置常量 ---
+// LOG_FILE_PATH / LOG_MAX_FILE_SIZE 仅用于日志分区不可用时的SPIFFS后备路径
+// 定义 LOG_BINARY_MODE 时启用二进制日志：RAM/Flash 中只保存格式字符串地址与原始参数，
+// 文本展开由主机端 log_decode.py（需配套 firmware.elf）或 log_manager_get_recent_logs() 完成
+#ifdef LOG_BINARY_MODE
+#define LOG_FILE_PATH "/spiffs/system.blog"
+#define LOG_FILE_OLD_PATH "/spiffs/system.blog.old"
+#else
 #define LOG_FILE_PATH "/spiffs/system.log"
 #define LOG_FILE_OLD_PATH "/spiffs/system.log.old"
+#endif
 #define LOG_MAX_FILE_SIZE (500 * 1024)  // 500KB
 #define LOG_BUFFER_SIZE 256
 
+// 运行时级别表：按模块名覆盖默认级别
+#define LOG_MODULE_LEVEL_MAX 16
+#define LOG_MODULE_NAME_MAX 24
+
+// RAM环形缓冲区：固定槽位、预分配，槽数必须为2的幂
+#define LOG_RAM_BUFFER_SIZE 128
+#define LOG_RAM_SLOT_SIZE 192  // 单条日志在RAM/SPIFFS中的最大长度（串口输出不截断）
+
+// 后台写入触发条件
+#define LOG_FLUSH_HIGH_WATER (LOG_RAM_BUFFER_SIZE * 3 / 4)  // 待写入条数达到此值立即写入
+#define LOG_FLUSH_MAX_LATENCY_MS 10000                     // 日志在RAM中停留的默认最长时间
+#define LOG_FLUSH_MIN_LATENCY_MS 100
+
+/**
+ * @brief 日志级别（数值越小越严重）
+ */
+typedef enum {
+    LOG_LEVEL_ERROR = 0,
+    LOG_LEVEL_WARN,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_DEBUG
+} log_level_t;
+
+/**
+ * @brief 日志系统运行统计
+ */
+typedef struct {
+    uint32_t records_logged;   ///< 成功进入RAM环形缓冲区的日志条数
+    uint32_t records_dropped;  ///< 因缓冲区满而丢弃（未能持久化）的日志条数
+    uint16_t ring_capacity;    ///< 环形缓冲区槽位数
+    uint16_t ring_pending;     ///< 当前等待写入Flash的日志条数
+    uint32_t flush_count;      ///< 后台写入次数
+    uint32_t bytes_written;    ///< 写入Flash的字节数
+    uint64_t flash_io_us;      ///< 写入Flash累计耗时 (微秒)
+} log_stats_t;
+
+/**
+ * @brief 日志查询数据源
+ */
+#define LOG_QUERY_SOURCE_RAM   0x01  ///< RAM环形缓冲区（同时查询Flash时只取尚未写入的记录）
+#define LOG_QUERY_SOURCE_FLASH 0x02  ///< 日志分区中的历史记录
+#define LOG_QUERY_SOURCE_ALL   (LOG_QUERY_SOURCE_RAM | LOG_QUERY_SOURCE_FLASH)
+
+/**
+ * @brief 日志查询条件
+ */
+typedef struct {
+    int8_t max_level;          ///< 最高级别（含），如 LOG_LEVEL_WARN 只返回 ERROR/WARN
+    const char* module;        ///< 模块名过滤，nullptr 表示全部
+    uint32_t since;            ///< 起始Unix时间（含），0 表示不限；设置后时间未知的记录被排除
+    uint32_t until;            ///< 结束Unix时间（含），0 表示不限
+    uint16_t limit;            ///< 只返回最新的 limit 条匹配记录，0 表示不限
+    uint8_t sources;           ///< LOG_QUERY_SOURCE_* 组合
+} log_query_t;
+
+/**
+ * @brief 查询结果中的一条日志
+ */
+typedef struct {
+    log_level_t level;
+    const char* module;
+    uint32_t tick_ms;          ///< 产生时的启动后毫秒数（来自Flash时为当时那次启动）
+    uint32_t timestamp;        ///< Unix时间，0 表示未知
+    const char* line;          ///< 完整日志行（不含换行，仅在回调期间有效）
+    size_t line_len;
+    bool from_flash;
+} log_entry_t;
+
+/**
+ * @brief 查询访问者回调
+ * @return true 继续, false 停止遍历
+ */
+typedef bool (*log_query_visitor_t)(const log_entry_t* entry, void* ctx);
+
 // --- 公共 API ---
 
 /**
@@ -41,29 +126,124 @@ void log_manager_log(const char* level, const char* module, const char* format,
 String log_manager_get_recent_logs(int count = 20);
 
 /**
- * @brief 立即将RAM缓冲区的日志写入SPIFFS
+ * @brief 以默认条件初始化查询（全部级别、全部模块、仅RAM）
+ */
+void log_manager_query_init(log_query_t* query);
+
+/**
+ * @brief 按时间顺序（从旧到新）流式遍历匹配的日志
+ * @details 逐条拷贝到调用者栈上后再回调，遍历期间不持有任何锁。
+ *          设置 limit 时会先统计匹配条数，遍历期间新产生的日志可能使返回条数略多于 limit。
+ * @param query 查询条件
+ * @param visitor 每条匹配日志的回调
+ * @param ctx 传给回调的上下文
+ * @return 回调的日志条数
+ */
+uint32_t log_manager_query(const log_query_t* query, log_query_visitor_t visitor, void* ctx);
+
+/**
+ * @brief 将匹配的日志逐行写入调用者提供的缓冲区
+ * @details 只写入完整的行，缓冲区不足时停止
+ * @return 写入的字节数（不含结尾0）
+ */
+size_t log_manager_query_to_buffer(const log_query_t* query, char* buf, size_t size);
+
+/**
+ * @brief 立即将RAM缓冲区的日志写入Flash，并等待写入任务应答
  * @details 用于关键时刻（如OFF模式）手动触发持久化
+ * @param timeout_ms 最长等待时间
+ * @return true 写入完成, false 超时或写入任务未运行
+ */
+bool log_manager_flush_now(uint32_t timeout_ms = 1000);
+
+/**
+ * @brief 设置日志在RAM中停留的最长时间
+ * @details 环形缓冲区为空时写入任务不计时、不唤醒
+ * @param latency_ms 最大延迟（毫秒，不小于 LOG_FLUSH_MIN_LATENCY_MS）
  */
-void log_manager_flush_now();
+void log_manager_set_max_latency(uint32_t latency_ms);
 
+/**
+ * @brief 获取当前最大写入延迟（毫秒）
+ */
+uint32_t log_manager_get_max_latency();
 
-// --- 日志宏定义 ---
+/**
+ * @brief 设置默认运行时日志级别（未单独配置的模块使用此级别）
+ */
+void log_manager_set_default_level(log_level_t level);
 
-// ERROR 级别日志 (始终启用)
-#define LOG_ERROR(module, format, ...) log_manager_log("ERROR", module, format, ##__VA_ARGS__)
+/**
+ * @brief 设置指定模块的运行时日志级别
+ * @param module 模块标签（与日志宏中的 module 参数一致）
+ * @param level 日志级别；小于0表示恢复为默认级别
+ * @return true 成功, false 模块表已满
+ */
+bool log_manager_set_module_level(const char* module, int level);
 
-// WARN 级别日志 (始终启用)
-#define LOG_WARN(module, format, ...) log_manager_log("WARN", module, format, ##__VA_ARGS__)
+/**
+ * @brief 判断指定模块、级别的日志是否输出
+ * @details log_manager_log() 在任何格式化之前调用此函数
+ */
+bool log_manager_level_enabled(const char* module, log_level_t level);
+
+/**
+ * @brief 以 "*=INFO,Display=WARN" 形式导出当前级别表（用于持久化）
+ */
+String log_manager_get_level_spec();
 
-// INFO 级别日志 (始终启用)
-#define LOG_INFO(module, format, ...) log_manager_log("INFO", module, format, ##__VA_ARGS__)
+/**
+ * @brief 应用 "*=INFO,Display=WARN" 形式的级别表
+ * @details 条目间以逗号分隔，"*" 表示默认级别；无法解析的条目被忽略
+ * @return 成功应用的条目数
+ */
+int log_manager_apply_level_spec(const char* spec);
 
-// DEBUG 级别日志 (仅在 TEST_MODE 下启用)
-#ifdef TEST_MODE
-    #define LOG_DEBUG(module, format, ...) log_manager_log("DEBUG", module, format, ##__VA_ARGS__)
-#else
-    #define LOG_DEBUG(module, format, ...) (void)0
+/**
+ * @brief 解析级别名称 ("error"/"warn"/"info"/"debug"，不区分大小写)
+ * @return 级别；无法解析时返回-1
+ */
+int log_manager_parse_level(const char* name);
+
+/**
+ * @brief 获取级别名称
+ */
+const char* log_manager_level_name(log_level_t level);
+
+/**
+ * @brief 获取日志系统运行统计
+ * @param p_stats 输出统计信息的结构体指针
+ */
+void log_manager_get_stats(log_stats_t* p_stats);
+
+
+// --- 日志宏定义 ---
+
+// 编译期最低级别：高于此级别的调用点在编译时整体删除（格式字符串也不会进入固件）
+// 0=ERROR 1=WARN 2=INFO 3=DEBUG，可在 platformio.ini 中通过 -D LOG_COMPILE_LEVEL=<n> 覆盖
+#ifndef LOG_COMPILE_LEVEL
+    #ifdef TEST_MODE
+        #define LOG_COMPILE_LEVEL 3
+    #else
+        #define LOG_COMPILE_LEVEL 2
+    #endif
 #endif
 
+// ERROR 级别日志
+#define LOG_ERROR(module, format, ...) \
+    do { if (LOG_COMPILE_LEVEL >= 0) log_manager_log("ERROR", module, format, ##__VA_ARGS__); } while (0)
+
+// WARN 级别日志
+#define LOG_WARN(module, format, ...) \
+    do { if (LOG_COMPILE_LEVEL >= 1) log_manager_log("WARN", module, format, ##__VA_ARGS__); } while (0)
+
+// INFO 级别日志
+#define LOG_INFO(module, format, ...) \
+    do { if (LOG_COMPILE_LEVEL >= 2) log_manager_log("INFO", module, format, ##__VA_ARGS__); } while (0)
+
+// DEBUG 级别日志 (默认仅在 TEST_MODE 下编译)
+#define LOG_DEBUG(module, format, ...) \
+    do { if (LOG_COMPILE_LEVEL >= 3) log_manager_log("DEBUG", module, format, ##__VA_ARGS__); } while (0)
+
 
 #endif // LOG_MANAGER_H
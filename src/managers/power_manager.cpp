@@ -7,6 +7,24 @@
 #include "hal/hal_config.h"
 #include "hal/hal_gpio.h"
 #include "managers/log_manager.h"
+#include "data/timing_constants.h"
+#include "../services/config_manager.h"
+#include <Arduino.h>
+#include <Preferences.h>
+#include <string.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <sys/time.h>
+#include <time.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "esp_crc.h"
+#include "esp_timer.h"
+
+#define LEDGER_MAGIC      0x50574C47  // "PWLG"
+#define NVS_NAMESPACE     "power"
+#define NVS_KEY_LEDGER    "ledger"
+#define SUMMARY_TOP_N     3           // 摘要中列出的条目数
 
 // --- 私有状态变量 ---
 static bool is_sensor_powered = false;
@@ -14,6 +32,41 @@ static bool is_pump_module_powered = false;
 static bool is_screen_powered = false;
 static bool is_initialized = false;  // 初始化标志
 
+// 电源轨租约
+typedef struct {
+    uint8_t leases;
+    bool lingering;
+    uint32_t release_time;      ///< 最后一个租约释放的时刻 (millis)
+    uint32_t acquires;
+    uint32_t power_ups;
+} rail_lease_t;
+
+static rail_lease_t s_rails[POWER_RAIL_COUNT];
+static SemaphoreHandle_t s_rail_mutex = NULL;  // 租约可能来自显示刷新任务
+
+// 能耗账本保存在 RTC 慢速内存中，深度睡眠与软件复位后保留
+typedef struct {
+    uint32_t magic;
+    power_ledger_stats_t stats;
+    bool sleeping;              ///< 已进入深度睡眠，下一次启动时计入睡眠时长
+    int64_t sleep_start_ms;     ///< 进入深度睡眠时的系统时钟 (ms)
+    uint64_t saved_span_ms;     ///< 最近一次保存到 NVS 时的统计总时长
+    uint32_t crc;
+} rtc_power_ledger_t;
+
+// NVS 中的副本（断电后恢复）
+typedef struct {
+    uint32_t magic;
+    power_ledger_stats_t stats;
+} nvs_power_ledger_t;
+
+RTC_DATA_ATTR static rtc_power_ledger_t s_rtc;
+static int64_t s_since_us[POWER_LEDGER_COUNT];      // 打开区间的开始时刻 (esp_timer us)
+static uint32_t s_current_ua[POWER_LEDGER_COUNT];   // 各条目的估计电流 (uA)
+static uint8_t s_active_mask = 0;
+static bool s_ledger_ready = false;
+static portMUX_TYPE s_ledger_mux = portMUX_INITIALIZER_UNLOCKED;
+
 // --- 私有辅助函数 ---
 static const char* power_result_to_string(power_result_t result) {
     switch (result) {
@@ -25,6 +78,120 @@ static const char* power_result_to_string(power_result_t result) {
     }
 }
 
+// --- 能耗账本私有函数 ---
+
+static uint32_t rtc_crc() {
+    return esp_crc32_le(0, (const uint8_t*)&s_rtc, offsetof(rtc_power_ledger_t, crc));
+}
+
+static void rtc_commit() {
+    s_rtc.magic = LEDGER_MAGIC;
+    s_rtc.crc = rtc_crc();
+}
+
+static int64_t wall_clock_ms() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+static void load_currents() {
+    const hydro_power_config_t& power = ConfigManager::instance().getConfig().power;
+    s_current_ua[POWER_LEDGER_SENSOR] = power.sensor_ua;
+    s_current_ua[POWER_LEDGER_BOOST] = power.boost_ua;
+    s_current_ua[POWER_LEDGER_SCREEN] = power.screen_ua;
+    s_current_ua[POWER_LEDGER_PUMP] = power.pump_ua;
+    s_current_ua[POWER_LEDGER_CPU] = power.cpu_ua;
+    s_current_ua[POWER_LEDGER_WIFI] = power.wifi_ua;
+    s_current_ua[POWER_LEDGER_SLEEP] = power.sleep_ua;
+}
+
+static void add_interval(power_ledger_entry_t* p_entry, power_ledger_t id, uint64_t ms) {
+    p_entry->on_ms += ms;
+    p_entry->charge_ua_ms += ms * s_current_ua[id];
+}
+
+// 把打开区间已经过的整毫秒计入账本，区间继续（调用者持有锁）
+static void fold_locked(power_ledger_t id, int64_t now_us) {
+    uint64_t ms = (uint64_t)((now_us - s_since_us[id]) / 1000);
+    add_interval(&s_rtc.stats.entries[id], id, ms);
+    s_since_us[id] += (int64_t)ms * 1000;
+}
+
+static void fold_all_locked(int64_t now_us) {
+    for (int i = 0; i < POWER_LEDGER_COUNT; i++) {
+        if (s_active_mask & (1u << i)) {
+            fold_locked((power_ledger_t)i, now_us);
+        }
+    }
+}
+
+static void note_start_time() {
+    if (s_rtc.stats.start_time == 0) {
+        time_t now = time(nullptr);
+        if (now >= 1577836800) {  // 时钟已同步 (2020-01-01 之后)
+            s_rtc.stats.start_time = (uint32_t)now;
+        }
+    }
+}
+
+static void write_nvs(const power_ledger_stats_t* p_stats) {
+    nvs_power_ledger_t saved;
+    saved.magic = LEDGER_MAGIC;
+    saved.stats = *p_stats;
+
+    Preferences prefs;
+    if (!prefs.begin(NVS_NAMESPACE, false)) {
+        LOG_ERROR("Power", "Failed to open NVS namespace");
+        return;
+    }
+    if (prefs.putBytes(NVS_KEY_LEDGER, &saved, sizeof(saved)) != sizeof(saved)) {
+        LOG_ERROR("Power", "Failed to save energy ledger");
+    }
+    prefs.end();
+}
+
+// 首次使用时恢复账本：RTC 内存有效则沿用并计入睡眠时长，否则从 NVS 恢复
+static void ledger_restore() {
+    if (s_ledger_ready) {
+        return;
+    }
+    load_currents();
+
+    if (s_rtc.magic == LEDGER_MAGIC && s_rtc.crc == rtc_crc()) {
+        if (s_rtc.sleeping) {
+            int64_t slept_ms = wall_clock_ms() - s_rtc.sleep_start_ms;
+            if (slept_ms > 0) {
+                add_interval(&s_rtc.stats.entries[POWER_LEDGER_SLEEP], POWER_LEDGER_SLEEP, (uint64_t)slept_ms);
+            }
+        }
+    } else {
+        memset(&s_rtc, 0, sizeof(s_rtc));
+        nvs_power_ledger_t saved;
+        Preferences prefs;
+        if (prefs.begin(NVS_NAMESPACE, true)) {
+            if (prefs.getBytesLength(NVS_KEY_LEDGER) == sizeof(saved) &&
+                prefs.getBytes(NVS_KEY_LEDGER, &saved, sizeof(saved)) == sizeof(saved) &&
+                saved.magic == LEDGER_MAGIC) {
+                s_rtc.stats = saved.stats;
+                LOG_INFO("Power", "Energy ledger restored from NVS");
+            }
+            prefs.end();
+        }
+        s_rtc.saved_span_ms = power_ledger_span_ms(&s_rtc.stats);
+    }
+    s_rtc.sleeping = false;
+    s_rtc.stats.boots++;
+
+    // CPU 从上电起处于唤醒状态
+    s_rtc.stats.entries[POWER_LEDGER_CPU].switches++;
+    s_since_us[POWER_LEDGER_CPU] = 0;
+    s_active_mask |= 1u << POWER_LEDGER_CPU;
+
+    rtc_commit();
+    s_ledger_ready = true;
+}
+
 power_result_t power_manager_init() {
     // 1. 初始化所有电源门控引脚为输出模式
     hal_gpio_pin_mode(PIN_POWER_GATE_PUMP, OUTPUT);
@@ -44,6 +211,18 @@ power_result_t power_manager_init() {
     // 4. 标记为已初始化
     is_initialized = true;
 
+    // 5. 租约互斥锁（门控已全部关闭，清除租约）
+    if (s_rail_mutex == NULL) {
+        s_rail_mutex = xSemaphoreCreateMutex();
+        if (s_rail_mutex == NULL) {
+            LOG_ERROR("Power", "Failed to create rail lease mutex");
+        }
+    }
+    memset(s_rails, 0, sizeof(s_rails));
+
+    // 6. 恢复能耗账本
+    ledger_restore();
+
     LOG_DEBUG("Power", "Power manager initialized successfully");
 
     return POWER_OK;
@@ -64,6 +243,7 @@ power_result_t power_sensor_enable(bool enable) {
 
     // 更新软件状态
     is_sensor_powered = enable;
+    power_ledger_set_active(POWER_LEDGER_SENSOR, enable);
 
     LOG_DEBUG("Power", "Sensor power %s", enable ? "ON" : "OFF");
 
@@ -81,6 +261,7 @@ power_result_t power_pump_module_enable(bool enable) {
 
     hal_gpio_write(PIN_POWER_GATE_PUMP, enable ? POWER_ON : POWER_OFF);
     is_pump_module_powered = enable;
+    power_ledger_set_active(POWER_LEDGER_BOOST, enable);
 
     LOG_DEBUG("Power", "Pump module power %s", enable ? "ON" : "OFF");
 
@@ -98,6 +279,7 @@ power_result_t power_screen_enable(bool enable) {
 
     hal_gpio_write(PIN_POWER_GATE_DISPLAY, enable ? POWER_ON : POWER_OFF);
     is_screen_powered = enable;
+    power_ledger_set_active(POWER_LEDGER_SCREEN, enable);
 
     LOG_DEBUG("Power", "Screen power %s", enable ? "ON" : "OFF");
 
@@ -117,4 +299,321 @@ bool power_screen_is_enabled() {
     return is_screen_powered;
 }
 
+/* ========== 电源轨租约 ========== */
+
+static power_result_t rail_set(power_rail_t rail, bool enable) {
+    switch (rail) {
+        case POWER_RAIL_SENSOR: return power_sensor_enable(enable);
+        case POWER_RAIL_BOOST:  return power_pump_module_enable(enable);
+        case POWER_RAIL_SCREEN: return power_screen_enable(enable);
+        default: return POWER_ERROR_INVALID_PARAM;
+    }
+}
+
+static bool rail_is_on(power_rail_t rail) {
+    switch (rail) {
+        case POWER_RAIL_SENSOR: return is_sensor_powered;
+        case POWER_RAIL_BOOST:  return is_pump_module_powered;
+        case POWER_RAIL_SCREEN: return is_screen_powered;
+        default: return false;
+    }
+}
+
+static uint32_t rail_linger_ms(power_rail_t rail) {
+    const hydro_power_config_t& power = ConfigManager::instance().getConfig().power;
+    switch (rail) {
+        case POWER_RAIL_SENSOR: return power.sensor_linger_ms;
+        case POWER_RAIL_BOOST:  return power.boost_linger_ms;
+        case POWER_RAIL_SCREEN: return power.screen_linger_ms;
+        default: return 0;
+    }
+}
+
+power_result_t power_rail_acquire(power_rail_t rail, bool* p_was_on) {
+    if (rail >= POWER_RAIL_COUNT) {
+        return POWER_ERROR_INVALID_PARAM;
+    }
+    if (!is_initialized || s_rail_mutex == NULL) {
+        return POWER_ERROR_NOT_INIT;
+    }
+
+    xSemaphoreTake(s_rail_mutex, portMAX_DELAY);
+    rail_lease_t* lease = &s_rails[rail];
+    bool was_on = rail_is_on(rail);
+    power_result_t result = POWER_OK;
+    if (!was_on) {
+        result = rail_set(rail, true);
+        if (result == POWER_OK) {
+            lease->power_ups++;
+        }
+    } else if (lease->lingering) {
+        LOG_DEBUG("Power", "%s rail shared while lingering", power_rail_name(rail));
+    }
+    if (result == POWER_OK) {
+        lease->leases++;
+        lease->acquires++;
+        lease->lingering = false;
+    }
+    xSemaphoreGive(s_rail_mutex);
+
+    if (p_was_on != nullptr) {
+        *p_was_on = was_on;
+    }
+    return result;
+}
+
+power_result_t power_rail_release(power_rail_t rail) {
+    if (rail >= POWER_RAIL_COUNT) {
+        return POWER_ERROR_INVALID_PARAM;
+    }
+    if (!is_initialized || s_rail_mutex == NULL) {
+        return POWER_ERROR_NOT_INIT;
+    }
+
+    xSemaphoreTake(s_rail_mutex, portMAX_DELAY);
+    rail_lease_t* lease = &s_rails[rail];
+    power_result_t result = POWER_OK;
+    if (lease->leases == 0) {
+        result = POWER_ERROR_INVALID_PARAM;
+    } else if (--lease->leases == 0) {
+        if (rail_linger_ms(rail) == 0) {
+            result = rail_set(rail, false);
+        } else {
+            lease->lingering = true;
+            lease->release_time = millis();
+        }
+    }
+    xSemaphoreGive(s_rail_mutex);
+
+    if (result == POWER_ERROR_INVALID_PARAM) {
+        LOG_WARN("Power", "%s rail released without a lease", power_rail_name(rail));
+    }
+    return result;
+}
+
+void power_manager_loop() {
+    if (!is_initialized || s_rail_mutex == NULL) {
+        return;
+    }
+
+    uint32_t now = millis();
+    for (int i = 0; i < POWER_RAIL_COUNT; i++) {
+        if (!s_rails[i].lingering) {
+            continue;
+        }
+        power_rail_t rail = (power_rail_t)i;
+        xSemaphoreTake(s_rail_mutex, portMAX_DELAY);
+        rail_lease_t* lease = &s_rails[i];
+        if (lease->lingering && lease->leases == 0 && now - lease->release_time >= rail_linger_ms(rail)) {
+            lease->lingering = false;
+            if (rail_set(rail, false) != POWER_OK) {
+                LOG_ERROR("Power", "Failed to power off %s rail after linger", power_rail_name(rail));
+            }
+        }
+        xSemaphoreGive(s_rail_mutex);
+    }
+}
+
+void power_rail_get_status(power_rail_t rail, power_rail_status_t* p_status) {
+    memset(p_status, 0, sizeof(*p_status));
+    if (rail >= POWER_RAIL_COUNT) {
+        return;
+    }
+    const rail_lease_t* lease = &s_rails[rail];
+    p_status->powered = rail_is_on(rail);
+    p_status->leases = lease->leases;
+    p_status->lingering = lease->lingering;
+    p_status->linger_ms = rail_linger_ms(rail);
+    p_status->acquires = lease->acquires;
+    p_status->power_ups = lease->power_ups;
+}
+
+const char* power_rail_name(power_rail_t rail) {
+    switch (rail) {
+        case POWER_RAIL_SENSOR: return "sensor";
+        case POWER_RAIL_BOOST:  return "boost12v";
+        case POWER_RAIL_SCREEN: return "screen";
+        default: return "unknown";
+    }
+}
+
+/* ========== 能耗账本 ========== */
+
+void power_manager_apply_config() {
+    portENTER_CRITICAL(&s_ledger_mux);
+    // 已经过的部分按旧电流结算
+    if (s_ledger_ready) {
+        fold_all_locked(esp_timer_get_time());
+        rtc_commit();
+    }
+    load_currents();
+    portEXIT_CRITICAL(&s_ledger_mux);
+}
+
+void power_ledger_set_active(power_ledger_t id, bool active) {
+    if (id >= POWER_LEDGER_COUNT) {
+        return;
+    }
+    ledger_restore();
+
+    int64_t now_us = esp_timer_get_time();
+    uint8_t bit = 1u << id;
+    portENTER_CRITICAL(&s_ledger_mux);
+    if (((s_active_mask & bit) != 0) != active) {
+        if (active) {
+            s_since_us[id] = now_us;
+            s_active_mask |= bit;
+            s_rtc.stats.entries[id].switches++;
+        } else {
+            fold_locked(id, now_us);
+            s_active_mask &= ~bit;
+        }
+        rtc_commit();
+    }
+    portEXIT_CRITICAL(&s_ledger_mux);
+}
+
+void power_ledger_get_stats(power_ledger_stats_t* p_stats) {
+    ledger_restore();
+
+    int64_t now_us = esp_timer_get_time();
+    portENTER_CRITICAL(&s_ledger_mux);
+    *p_stats = s_rtc.stats;
+    for (int i = 0; i < POWER_LEDGER_COUNT; i++) {
+        if (s_active_mask & (1u << i)) {
+            add_interval(&p_stats->entries[i], (power_ledger_t)i, (uint64_t)((now_us - s_since_us[i]) / 1000));
+        }
+    }
+    portEXIT_CRITICAL(&s_ledger_mux);
+}
+
+uint64_t power_ledger_span_ms(const power_ledger_stats_t* p_stats) {
+    return p_stats->entries[POWER_LEDGER_CPU].on_ms + p_stats->entries[POWER_LEDGER_SLEEP].on_ms;
+}
+
+uint32_t power_ledger_current_ua(power_ledger_t id) {
+    if (id >= POWER_LEDGER_COUNT) {
+        return 0;
+    }
+    ledger_restore();
+    return s_current_ua[id];
+}
+
+const char* power_ledger_name(power_ledger_t id) {
+    switch (id) {
+        case POWER_LEDGER_SENSOR: return "sensor";
+        case POWER_LEDGER_BOOST:  return "boost12v";
+        case POWER_LEDGER_SCREEN: return "screen";
+        case POWER_LEDGER_PUMP:   return "pump";
+        case POWER_LEDGER_CPU:    return "cpu";
+        case POWER_LEDGER_WIFI:   return "wifi";
+        case POWER_LEDGER_SLEEP:  return "sleep";
+        default: return "unknown";
+    }
+}
+
+size_t power_ledger_format_summary(char* buffer, size_t size) {
+    if (buffer == nullptr || size == 0) {
+        return 0;
+    }
+    power_ledger_stats_t stats;
+    power_ledger_get_stats(&stats);
+
+    uint64_t span_ms = power_ledger_span_ms(&stats);
+    uint64_t total = 0;
+    for (int i = 0; i < POWER_LEDGER_COUNT; i++) {
+        total += stats.entries[i].charge_ua_ms;
+    }
+    if (span_ms == 0 || total == 0) {
+        return snprintf(buffer, size, "no data");
+    }
+
+    int written = snprintf(buffer, size, "avg %luuA over %.1fh",
+                           (unsigned long)(total / span_ms), span_ms / 3600000.0);
+
+    // 按电荷占比列出前几项
+    bool listed[POWER_LEDGER_COUNT] = {false};
+    for (int n = 0; n < SUMMARY_TOP_N; n++) {
+        int best = -1;
+        for (int i = 0; i < POWER_LEDGER_COUNT; i++) {
+            if (!listed[i] && stats.entries[i].charge_ua_ms > 0 &&
+                (best < 0 || stats.entries[i].charge_ua_ms > stats.entries[best].charge_ua_ms)) {
+                best = i;
+            }
+        }
+        if (best < 0 || written < 0 || (size_t)written >= size) {
+            break;
+        }
+        listed[best] = true;
+        written += snprintf(buffer + written, size - written, "%s %s %.0f%%", n == 0 ? ";" : ",",
+                            power_ledger_name((power_ledger_t)best),
+                            stats.entries[best].charge_ua_ms * 100.0 / total);
+    }
+    if (written < 0) {
+        buffer[0] = '\0';
+        return 0;
+    }
+    return (size_t)written < size ? (size_t)written : size - 1;
+}
+
+void power_ledger_suspend() {
+    ledger_restore();
+
+    int64_t now_us = esp_timer_get_time();
+    portENTER_CRITICAL(&s_ledger_mux);
+    fold_all_locked(now_us);
+    s_active_mask = 0;
+    s_rtc.sleeping = true;
+    s_rtc.sleep_start_ms = wall_clock_ms();
+    note_start_time();
+    rtc_commit();
+    portEXIT_CRITICAL(&s_ledger_mux);
+
+    if (power_ledger_span_ms(&s_rtc.stats) - s_rtc.saved_span_ms >= POWER_LEDGER_SAVE_INTERVAL_MS) {
+        power_ledger_save();
+    }
+}
+
+void power_ledger_save() {
+    ledger_restore();
+
+    power_ledger_stats_t stats;
+    portENTER_CRITICAL(&s_ledger_mux);
+    fold_all_locked(esp_timer_get_time());
+    note_start_time();
+    s_rtc.saved_span_ms = power_ledger_span_ms(&s_rtc.stats);
+    rtc_commit();
+    stats = s_rtc.stats;
+    portEXIT_CRITICAL(&s_ledger_mux);
+
+    write_nvs(&stats);
+    LOG_DEBUG("Power", "Energy ledger saved (%lu boots)", (unsigned long)stats.boots);
+}
+
+void power_ledger_reset() {
+    ledger_restore();
+
+    int64_t now_us = esp_timer_get_time();
+    portENTER_CRITICAL(&s_ledger_mux);
+    memset(&s_rtc.stats, 0, sizeof(s_rtc.stats));
+    for (int i = 0; i < POWER_LEDGER_COUNT; i++) {
+        if (s_active_mask & (1u << i)) {
+            s_since_us[i] = now_us;
+            s_rtc.stats.entries[i].switches = 1;
+        }
+    }
+    s_rtc.stats.boots = 1;
+    s_rtc.saved_span_ms = 0;
+    note_start_time();
+    rtc_commit();
+    portEXIT_CRITICAL(&s_ledger_mux);
+
+    Preferences prefs;
+    if (prefs.begin(NVS_NAMESPACE, false)) {
+        prefs.remove(NVS_KEY_LEDGER);
+        prefs.end();
+    }
+    LOG_INFO("Power", "Energy ledger reset");
+}
+
 /* 兼容性函数已移除 */
\ No newline at end of file
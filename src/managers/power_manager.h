@@ -2,12 +2,30 @@
  * @file power_manager.h
  * @brief 电源管理器
  * @details 负责系统电源门控和功耗管理控制
+ *
+ *   能耗账本：记录各电源轨与耗电状态的累计导通时间、打开次数和估计电荷，
+ *   用于找出超出微安预算的功能。
+ *   1. 三个门控电源轨在 power_*_enable() 中自动记账；水泵（12V之上的负载）、
+ *      WiFi 射频由各自的模块调用 power_ledger_set_active() 记账。
+ *   2. 电荷按区间结束时的配置电流 (power.*_ua) 乘以区间时长累加；
+ *      CPU 从上电起计为唤醒，深度睡眠时长在下一次启动时按 sleep_ua 计入。
+ *   3. 账本保存在 RTC 慢速内存中，跨深度睡眠与软件复位保留；
+ *      每隔 POWER_LEDGER_SAVE_INTERVAL_MS 及关机前另存一份到 NVS，断电后从 NVS 恢复。
+ *   ULP 哨兵在睡眠期间对传感器的短暂供电不单独计账，包含在睡眠电流中。
+ *
+ *   电源轨租约：共享同一电源轨的使用者（传感器读取、显示刷新任务与 RUN/交互模式、
+ *   水泵）通过 power_rail_acquire()/power_rail_release() 引用计数。最后一个租约释放后
+ *   电源再保持 power.*_linger_ms 才关闭（由 power_manager_loop() 执行），
+ *   期间到来的使用者直接共享已稳定的电源，省去重复的上电冲击与稳定等待。
+ *   power_*_enable() 仍直接控制门控，用于关机、睡眠前的强制断电和调试命令。
  */
 
 #ifndef POWER_MANAGER_H
 #define POWER_MANAGER_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 /**
  * @brief 电源管理器操作结果枚举
@@ -19,6 +37,60 @@ typedef enum {
     POWER_ERROR_NOT_INIT       ///< 电源管理器未初始化
 } power_result_t;
 
+/**
+ * @brief 可租用的电源轨
+ */
+typedef enum {
+    POWER_RAIL_SENSOR = 0,     ///< 传感器电源
+    POWER_RAIL_BOOST,          ///< 12V升压模块
+    POWER_RAIL_SCREEN,         ///< 墨水屏电源
+    POWER_RAIL_COUNT
+} power_rail_t;
+
+/**
+ * @brief 电源轨租约状态
+ */
+typedef struct {
+    bool powered;              ///< 电源已打开
+    uint8_t leases;            ///< 当前租约数
+    bool lingering;            ///< 租约已全部释放，等待保持时间结束后关闭
+    uint32_t linger_ms;        ///< 保持时间 (配置)
+    uint32_t acquires;         ///< 租约获取次数
+    uint32_t power_ups;        ///< 因租约而上电的次数（其余获取共享了已打开的电源）
+} power_rail_status_t;
+
+/**
+ * @brief 能耗账本条目
+ */
+typedef enum {
+    POWER_LEDGER_SENSOR = 0,   ///< 传感器电源
+    POWER_LEDGER_BOOST,        ///< 12V升压模块（空载）
+    POWER_LEDGER_SCREEN,       ///< 墨水屏电源
+    POWER_LEDGER_PUMP,         ///< 水泵运行
+    POWER_LEDGER_CPU,          ///< 主CPU唤醒
+    POWER_LEDGER_WIFI,         ///< WiFi射频工作
+    POWER_LEDGER_SLEEP,        ///< 深度睡眠
+    POWER_LEDGER_COUNT
+} power_ledger_t;
+
+/**
+ * @brief 单个条目的累计值
+ */
+typedef struct {
+    uint64_t on_ms;            ///< 累计导通时间 (ms)
+    uint64_t charge_ua_ms;     ///< 估计消耗的电荷 (uA·ms)
+    uint32_t switches;         ///< 打开次数
+} power_ledger_entry_t;
+
+/**
+ * @brief 能耗账本
+ */
+typedef struct {
+    power_ledger_entry_t entries[POWER_LEDGER_COUNT];
+    uint32_t boots;            ///< 统计期间的启动次数
+    uint32_t start_time;       ///< 统计开始的系统时钟 (秒，0 表示时钟未同步)
+} power_ledger_stats_t;
+
 /**
  * @brief 初始化电源管理器
  * @details 设置所有电源门控GPIO为输出模式，并默认关闭所有外设电源
@@ -65,6 +137,91 @@ bool power_pump_module_is_enabled();
  */
 bool power_screen_is_enabled();
 
+/**
+ * @brief 获取电源轨租约，电源关闭时打开
+ * @details 可在不同任务中调用；电源关闭后新打开的需要调用者自行等待稳定
+ * @param p_was_on 输出电源在获取前是否已经打开（已稳定，无需等待），可为NULL
+ * @return power_result_t 操作结果，失败时不持有租约
+ */
+power_result_t power_rail_acquire(power_rail_t rail, bool* p_was_on);
+
+/**
+ * @brief 释放电源轨租约
+ * @details 最后一个租约释放后电源保持 linger 时间再关闭（保持时间为 0 时立即关闭）
+ * @return POWER_ERROR_INVALID_PARAM 未持有租约
+ */
+power_result_t power_rail_release(power_rail_t rail);
+
+/**
+ * @brief 获取电源轨租约状态
+ */
+void power_rail_get_status(power_rail_t rail, power_rail_status_t* p_status);
+
+/**
+ * @brief 电源轨名称
+ */
+const char* power_rail_name(power_rail_t rail);
+
+/**
+ * @brief 电源管理器的循环函数
+ * @details 应在主循环中周期性调用，关闭保持时间已结束的电源轨
+ */
+void power_manager_loop();
+
+/**
+ * @brief 重新读取各条目的电流配置 (power.*_ua)
+ * @details 已经过的区间先按旧电流结算
+ */
+void power_manager_apply_config();
+
+/**
+ * @brief 记录一个账本条目的打开/关闭
+ * @details 状态未改变时不做任何事；可在定时器回调中调用
+ */
+void power_ledger_set_active(power_ledger_t id, bool active);
+
+/**
+ * @brief 获取账本（包含尚未结束的区间）
+ */
+void power_ledger_get_stats(power_ledger_stats_t* p_stats);
+
+/**
+ * @brief 账本统计的总时长（唤醒 + 睡眠，ms）
+ */
+uint64_t power_ledger_span_ms(const power_ledger_stats_t* p_stats);
+
+/**
+ * @brief 按当前配置估计的条目电流 (uA)
+ */
+uint32_t power_ledger_current_ua(power_ledger_t id);
+
+/**
+ * @brief 条目名称
+ */
+const char* power_ledger_name(power_ledger_t id);
+
+/**
+ * @brief 生成一行能耗摘要（平均电流与占比最高的条目）
+ * @return 写入的字符数
+ */
+size_t power_ledger_format_summary(char* buffer, size_t size);
+
+/**
+ * @brief 结束所有打开的区间并记录睡眠开始时刻，应在进入深度睡眠前调用
+ * @details 距上次 NVS 保存超过 POWER_LEDGER_SAVE_INTERVAL_MS 时同时保存
+ */
+void power_ledger_suspend();
+
+/**
+ * @brief 立即把账本保存到 NVS（关机前调用）
+ */
+void power_ledger_save();
+
+/**
+ * @brief 清空账本（RTC 与 NVS）
+ */
+void power_ledger_reset();
+
 /* 兼容性函数已移除 */
 
 #endif // POWER_MANAGER_H
\ No newline at end of file
@@ -8,28 +8,82 @@
 #include "actuator_manager.h"
 #include "log_manager.h"
 #include "power_manager.h"
+#include "battery_manager.h"
+#include "humidity_filter.h"
+#include "watering_controller.h"
+#include "drying_model.h"
+#include "watering_program.h"
+#include "ulp_manager.h"
+#include "ts/ts_store.h"
 #include "ui/ui_manager.h"
 #include "ui/display_manager.h"
 #include "../services/config_manager.h"
+#include "../services/watering_scheduler.h"
+#include "../data/timing_constants.h"
+#include "../hal/hal_rtc.h"
 #include <Arduino.h>
 #include <stdio.h>
+#include <stddef.h>
+#include <sys/time.h>
 #include <lvgl.h>
+#include "esp_sleep.h"
+#include "esp_crc.h"
 
 // Internal timing constants (not user-configurable)
 static const uint32_t CHECK_INTERVAL_MS = 5000;      // Check humidity every 5 seconds
+static const uint32_t SENSOR_MAX_AGE_MS = 1000;      // Consumers within one check share one acquisition
+static const uint32_t RTC_STATE_MAGIC = 0x52554E53;  // "RUNS"
+static const int64_t RUN_CLOCK_MAX_GAP_MS = 30LL * 24 * 3600 * 1000;  // Longer gaps mean the wall clock jumped
+static const uint32_t SLEEP_MIN_MS = 1000;
+
+/**
+ * @brief State that survives deep sleep and software resets
+ *
+ * Timestamps are on the run clock (see run_clock_ms()), which keeps counting
+ * across deep sleep, so intervals such as the full-refresh period and the
+ * "last watering" display stay correct from one wake to the next. The state
+ * is only trusted after rtc_commit(); anything else (power loss, crash)
+ * fails the CRC and starts fresh.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t clock_ms;               // Run clock at the last commit
+    int64_t wall_ms;                 // Wall clock at the last commit
+    uint32_t watering_count;         // Total watering events
+    uint32_t last_watering_time;     // Run clock of last watering event
+    uint32_t last_history_time;      // Run clock of last time-series sample
+    bool history_started;
+    // Display update state (for smart refresh mechanism)
+    float last_displayed_humidity;   // Last displayed humidity percentage
+    float last_displayed_voltage;    // Last displayed battery voltage
+    uint8_t partial_refresh_count;   // Counter for partial refreshes
+    uint32_t last_full_refresh_time; // Run clock of last full refresh
+    bool last_pump_state;            // Last known pump state
+    uint32_t last_displayed_faults;  // Sensor faults shown on the dashboard
+    bool sleeping;                   // Went to sleep through run_mode_manager_sleep()
+    run_sleep_stats_t stats;
+    uint32_t crc;
+} rtc_run_state_t;
+
+RTC_DATA_ATTR static rtc_run_state_t s_rtc;
 
 // State variables
 static bool s_initialized = false;
+static uint32_t s_clock_base_ms = 0;        // Run clock at millis() == 0
 static uint32_t s_last_check_time = 0;
-static uint32_t s_watering_count = 0;  // Total watering events this session
-
-// Display update state (for smart refresh mechanism)
-static float s_last_displayed_humidity = -1.0f;  // Last displayed humidity percentage
-static float s_last_displayed_voltage = -1.0f;   // Last displayed battery voltage
-static uint8_t s_partial_refresh_count = 0;      // Counter for partial refreshes
-static uint32_t s_last_full_refresh_time = 0;    // Timestamp of last full refresh
-static uint32_t s_last_watering_time = 0;        // Timestamp of last watering event (millis)
-static bool s_last_pump_state = false;           // Last known pump state
+static uint32_t s_check_interval_ms = CHECK_INTERVAL_MS;  // Awake polling interval until the next check
+static bool s_acquisition_pending = false;  // Async sensor acquisition in flight
+static uint32_t s_acquisition_start = 0;    // millis() when the current check started
+static bool s_program_active = false;       // Watering program started by this mode, not yet recorded
+static float s_program_before = 0.0f;       // Humidity the running program was planned from
+static uint8_t s_program_duty = 0;          // Duty of the running program
+
+// Deep-sleep cycle state
+static bool s_woke_from_sleep = false;      // This boot resumed a RUN mode deep sleep
+static uint32_t s_cycle_start = 0;          // millis() when this cycle started (0 after a wake)
+static bool s_check_due = false;            // Run the next check without waiting for the interval
+static bool s_cycle_done = false;           // This wake's check has completed
+static bool s_screen_leased = false;        // Holding a screen rail lease since enter()
 
 // Display update configuration
 static const float HUMIDITY_CHANGE_THRESHOLD = 5.0f;  // Trigger update if humidity changes by 5%
@@ -37,6 +91,51 @@ static const float VOLTAGE_CHANGE_THRESHOLD = 0.1f;   // Trigger update if volta
 static const uint8_t PARTIAL_REFRESH_LIMIT = 10;      // Full refresh every 10 partial refreshes
 static const uint32_t FULL_REFRESH_INTERVAL_MS = 1800000;  // Full refresh every 30 minutes
 
+/**
+ * @brief Milliseconds on the run clock
+ *
+ * millis() restarts from zero on every wake, so timestamps that must span a
+ * deep sleep are taken from this clock instead. It is re-based from the wall
+ * clock at boot (the RTC keeps it running while asleep).
+ */
+static uint32_t run_clock_ms(void) {
+    return s_clock_base_ms + millis();
+}
+
+static int64_t wall_clock_ms(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+static uint32_t rtc_crc(void) {
+    return esp_crc32_le(0, (const uint8_t*)&s_rtc, offsetof(rtc_run_state_t, crc));
+}
+
+static bool rtc_valid(void) {
+    return s_rtc.magic == RTC_STATE_MAGIC && s_rtc.crc == rtc_crc();
+}
+
+static void rtc_commit(void) {
+    s_rtc.clock_ms = run_clock_ms();
+    s_rtc.wall_ms = wall_clock_ms();
+    s_rtc.magic = RTC_STATE_MAGIC;
+    s_rtc.crc = rtc_crc();
+}
+
+static void reset_display_state(void) {
+    s_rtc.last_displayed_humidity = -1.0f;
+    s_rtc.last_displayed_voltage = -1.0f;
+    s_rtc.partial_refresh_count = 0;
+    s_rtc.last_full_refresh_time = run_clock_ms();
+    s_rtc.last_pump_state = false;
+}
+
+static run_sleep_mode_t sleep_mode(void) {
+    uint8_t mode = ConfigManager::instance().getConfig().system.run_sleep;
+    return mode <= RUN_SLEEP_SENTINEL ? (run_sleep_mode_t)mode : RUN_SLEEP_NONE;
+}
+
 /**
  * @brief Internal helper to convert ADC to humidity percentage
  * @param adc_value Raw ADC reading
@@ -49,6 +148,65 @@ static float adc_to_humidity_percent(uint16_t adc_value, uint16_t adc_wet, uint1
     return 100.0f - ((float)(adc_value - adc_wet) * 100.0f) / (adc_dry - adc_wet);
 }
 
+/**
+ * @brief Humidity check interval for the current battery level
+ */
+static uint32_t check_interval_ms(void) {
+    switch (battery_manager_get_level()) {
+        case BATTERY_LEVEL_LOW:      return RUN_CHECK_INTERVAL_LOW_BATTERY_MS;
+        case BATTERY_LEVEL_CRITICAL: return RUN_CHECK_INTERVAL_CRITICAL_BATTERY_MS;
+        default:                     return CHECK_INTERVAL_MS;
+    }
+}
+
+/**
+ * @brief Deep-sleep check interval for the current battery level
+ */
+static uint32_t sleep_interval_ms(void) {
+    switch (battery_manager_get_level()) {
+        case BATTERY_LEVEL_LOW:      return RUN_SLEEP_INTERVAL_LOW_BATTERY_MS;
+        case BATTERY_LEVEL_CRITICAL: return RUN_SLEEP_INTERVAL_CRITICAL_BATTERY_MS;
+        default:                     return RUN_SLEEP_INTERVAL_MS;
+    }
+}
+
+/**
+ * @brief Interval to the next check: the battery-level base, stretched by the drying forecast
+ *
+ * A suspect sensor keeps the base interval, since the forecast is built on
+ * its readings.
+ */
+static uint32_t next_check_interval_ms(uint32_t base_ms) {
+    if (sensor_manager_get_faults() != SENSOR_FAULT_NONE) {
+        return base_ms;
+    }
+    return drying_model_next_interval_ms(base_ms, nullptr);
+}
+
+/**
+ * @brief Periodic full-refresh interval for the current battery level
+ */
+static uint32_t full_refresh_interval_ms(void) {
+    switch (battery_manager_get_level()) {
+        case BATTERY_LEVEL_LOW:      return RUN_FULL_REFRESH_LOW_BATTERY_MS;
+        case BATTERY_LEVEL_CRITICAL: return RUN_FULL_REFRESH_CRITICAL_BATTERY_MS;
+        default:                     return FULL_REFRESH_INTERVAL_MS;
+    }
+}
+
+/**
+ * @brief Battery voltage to display: the filtered open-circuit estimate when available
+ */
+static float display_battery_voltage(void) {
+    battery_state_t battery;
+    if (battery_manager_get_state(&battery) == BATTERY_OK && battery.valid) {
+        return battery.filtered_voltage;
+    }
+    float voltage = 0.0f;
+    sensor_manager_get_battery_voltage_cached(&voltage, SENSOR_MAX_AGE_MS);
+    return voltage;
+}
+
 /**
  * @brief Format relative time string for "last watering" display
  */
@@ -58,7 +216,7 @@ static void format_time_ago(uint32_t timestamp_ms, char* buf, size_t buf_size) {
         return;
     }
 
-    uint32_t elapsed_ms = millis() - timestamp_ms;
+    uint32_t elapsed_ms = run_clock_ms() - timestamp_ms;
     uint32_t elapsed_sec = elapsed_ms / 1000;
 
     if (elapsed_sec < 60) {
@@ -70,21 +228,34 @@ static void format_time_ago(uint32_t timestamp_ms, char* buf, size_t buf_size) {
     }
 }
 
+/**
+ * @brief Pump running, or a soak program between its pulses
+ */
+static bool watering_active(void) {
+    return actuator_manager_is_pump_running() || watering_program_is_running();
+}
+
 /**
  * @brief Update dashboard display with current system state
  * @param force_full_refresh If true, performs full refresh; otherwise decides based on counters
  */
 static void update_dashboard(bool force_full_refresh) {
+    // After a deep-sleep wake the display is brought up only when something changed
+    bool sleeping_mode = sleep_mode() != RUN_SLEEP_NONE;
+    uint32_t display_start = millis();
+    if (ui_manager_init() != UI_OK) {
+        LOG_ERROR("RunMode", "Display unavailable, dashboard not updated");
+        return;
+    }
+
     // Get configuration
     ConfigManager& config_mgr = ConfigManager::instance();
     hydro_config_t config = config_mgr.getConfig();
 
     // Read current sensor data
     float humidity_raw = 0.0f;
-    float battery_voltage = 0.0f;
-
-    sensor_manager_get_humidity(&humidity_raw);
-    sensor_manager_get_battery_voltage(&battery_voltage);
+    sensor_manager_get_humidity_cached(&humidity_raw, SENSOR_MAX_AGE_MS);
+    float battery_voltage = display_battery_voltage();
 
     // Convert to displayable values
     float humidity_pct = adc_to_humidity_percent((uint16_t)humidity_raw,
@@ -93,13 +264,14 @@ static void update_dashboard(bool force_full_refresh) {
     float threshold_pct = adc_to_humidity_percent(config.watering.threshold,
                                                    config.watering.humidity_wet,
                                                    config.watering.humidity_dry);
-    bool pump_running = actuator_manager_is_pump_running();
+    bool pump_running = watering_active();
 
     // Format time and status strings
     char time_buf[16];
-    format_time_ago(s_last_watering_time, time_buf, sizeof(time_buf));
+    format_time_ago(s_rtc.last_watering_time, time_buf, sizeof(time_buf));
 
-    const char* status_str = pump_running ? "Watering..." : "Monitoring...";
+    const char* status_str = pump_running ? "Watering..." :
+                             (sensor_manager_get_faults() != SENSOR_FAULT_NONE ? "Sensor fault" : "Monitoring...");
 
     // Update LVGL dashboard
     ui_manager_show_run_dashboard(humidity_pct, threshold_pct, battery_voltage, time_buf, status_str);
@@ -107,26 +279,38 @@ static void update_dashboard(bool force_full_refresh) {
     // Force LVGL to complete rendering synchronously
     lv_refr_now(NULL);
 
-    // Smart refresh strategy: mix partial and full refresh
-    bool do_full_refresh = force_full_refresh ||
-                          (s_partial_refresh_count >= PARTIAL_REFRESH_LIMIT) ||
-                          ((millis() - s_last_full_refresh_time) >= FULL_REFRESH_INTERVAL_MS);
+    // Smart refresh strategy: mix partial and full refresh. In sleep mode the
+    // panel loses power between cycles, so every refresh is a full one and
+    // it has to finish before the rails go off.
+    bool do_full_refresh = force_full_refresh || sleeping_mode ||
+                          (s_rtc.partial_refresh_count >= PARTIAL_REFRESH_LIMIT) ||
+                          ((run_clock_ms() - s_rtc.last_full_refresh_time) >= full_refresh_interval_ms());
+
+    ts_store_append(TS_SERIES_REFRESH, ts_store_now(), do_full_refresh ? 1 : 0);
 
-    if (do_full_refresh) {
+    if (sleeping_mode) {
+        if (display_manager_refresh_blocking(true, RUN_SLEEP_REFRESH_TIMEOUT_MS) != DISPLAY_OK) {
+            LOG_WARN("RunMode", "Dashboard refresh did not finish within %dms", RUN_SLEEP_REFRESH_TIMEOUT_MS);
+        }
+        s_rtc.partial_refresh_count = 0;
+        s_rtc.last_full_refresh_time = run_clock_ms();
+        s_rtc.stats.last_display_ms += millis() - display_start;
+    } else if (do_full_refresh) {
         LOG_INFO("RunMode", "Before full display refresh");
         display_manager_refresh(true);
         LOG_INFO("RunMode", "After full display refresh");
-        s_partial_refresh_count = 0;
-        s_last_full_refresh_time = millis();
+        s_rtc.partial_refresh_count = 0;
+        s_rtc.last_full_refresh_time = run_clock_ms();
     } else {
         display_manager_refresh(false);
-        s_partial_refresh_count++;
+        s_rtc.partial_refresh_count++;
     }
 
     // Update cached values
-    s_last_displayed_humidity = humidity_pct;
-    s_last_displayed_voltage = battery_voltage;
-    s_last_pump_state = pump_running;
+    s_rtc.last_displayed_humidity = humidity_pct;
+    s_rtc.last_displayed_voltage = battery_voltage;
+    s_rtc.last_pump_state = pump_running;
+    s_rtc.last_displayed_faults = sensor_manager_get_faults();
 }
 
 /**
@@ -145,7 +329,7 @@ static run_mode_result_t execute_watering_sequence(bool force) {
     float humidity = 0.0f;
 
     // Step 1: Read humidity sensor
-    sensor_result_t sensor_result = sensor_manager_get_humidity(&humidity);
+    sensor_result_t sensor_result = sensor_manager_get_humidity_cached(&humidity, SENSOR_MAX_AGE_MS);
     if (sensor_result != SENSOR_OK) {
         LOG_ERROR("RunMode", "Failed to read humidity sensor (error %d)", sensor_result);
         return RUN_MODE_ERR_SENSOR_READ_FAILED;
@@ -154,44 +338,295 @@ static run_mode_result_t execute_watering_sequence(bool force) {
     LOG_DEBUG("RunMode", "Humidity reading: %.2f ADC units", humidity);
 
     // Step 2: Check if watering is needed
-    // Capacitive sensor: higher value = drier soil
-    bool should_water = force || (humidity > config.watering.threshold);
+    // Capacitive sensor: higher value = drier soil. The reading goes through
+    // spike rejection, a running median and a hysteresis band first; forced
+    // runs skip the filter so the same snapshot is not counted twice.
+    bool should_water = force;
+    if (!force) {
+        humidity_filter_result_t filtered;
+        should_water = humidity_filter_update(humidity, &filtered);
+        if (filtered.outlier) {
+            LOG_INFO("RunMode", "Humidity spike rejected (%.0f, median %.0f)", humidity, filtered.filtered);
+        }
+        humidity = filtered.filtered;
+
+        // Learn from the last watering once it has soaked in; the dose was
+        // planned from the filtered reading, so the response is measured on it too
+        if (filtered.ready) {
+            watering_controller_observe(humidity);
+        }
+    }
 
     if (!should_water) {
-        LOG_DEBUG("RunMode", "Humidity OK (%.2f <= %d), no watering needed", humidity, config.watering.threshold);
+        LOG_DEBUG("RunMode", "Humidity OK (%.2f, threshold %d), no watering needed", humidity, config.watering.threshold);
         return RUN_MODE_OK;
     }
 
-    // Step 3: Execute watering
-    LOG_INFO("RunMode", "Humidity LOW (%.2f > %d), starting watering cycle", humidity, config.watering.threshold);
+    // Sensor faults: an untrustworthy reading must not drive the pump, and a
+    // probe that never responds to water only gets a retry every few hours
+    if (!force) {
+        uint32_t faults = sensor_manager_get_faults();
+        if (faults & SENSOR_FAULT_BLOCKS_WATERING) {
+            LOG_DEBUG("RunMode", "Watering suppressed, sensor fault 0x%02lx", (unsigned long)faults);
+            return RUN_MODE_OK;
+        }
+        if ((faults & SENSOR_FAULT_NO_RESPONSE) && s_rtc.watering_count > 0 &&
+            run_clock_ms() - s_rtc.last_watering_time < SENSOR_HEALTH_NO_RESPONSE_RETRY_MS) {
+            LOG_DEBUG("RunMode", "Watering deferred, no response to previous watering");
+            return RUN_MODE_OK;
+        }
+    }
+
+    // Closed-loop dose: duty and duration from the learned soil response
+    uint8_t duty = config.watering.power;
+    uint32_t duration_ms = config.watering.duration_ms;
+    if (!force && watering_controller_enabled()) {
+        watering_ctrl_plan_t plan;
+        watering_controller_plan(humidity, &plan);
+        duty = plan.duty;
+        duration_ms = plan.duration_ms;
+        LOG_INFO("RunMode", "Dose for deficit %.0f: duty=%d/255, %lums, expected drop %.0f%s",
+                 plan.deficit, duty, (unsigned long)duration_ms, plan.expected_drop,
+                 plan.learned ? "" : " (fixed, learning)");
+    }
 
-    actuator_manager_run_pump_for(config.watering.power, config.watering.duration_ms);
+    // Spacing, daily budget and quiet hours; the scheduler logs its reasons.
+    // Forced runs bypass it but still count towards the budget.
+    WateringScheduler& scheduler = WateringScheduler::instance();
+    if (!force && scheduler.check(duration_ms, &duration_ms) != WateringDecision::ALLOWED) {
+        return RUN_MODE_OK;
+    }
 
-    // Step 4: Log watering event and record timestamp
-    s_watering_count++;
-    s_last_watering_time = millis();  // Record when watering started
-    LOG_INFO("RunMode", "Watering event #%lu: humidity=%.2f, duration=%dms, duty=%d/255",
-             s_watering_count, humidity, config.watering.duration_ms, config.watering.power);
+    // Step 3: Execute watering, split into soak pulses when configured
+    LOG_INFO("RunMode", "Humidity LOW (%.2f, threshold %d), starting watering cycle", humidity, config.watering.threshold);
+
+    watering_program_t program;
+    watering_program_from_config(duty, duration_ms, &program);
+    if (watering_program_start(&program) != WATERING_PROGRAM_OK) {
+        LOG_ERROR("RunMode", "Failed to start watering program");
+        return RUN_MODE_ERR_ACTUATOR_FAILED;
+    }
+    sensor_manager_notify_watering();
+    drying_model_notify_watering();
+    s_program_active = true;
+    s_program_before = humidity;
+    s_program_duty = program.duty;
+
+    // Step 4: Record timestamp; the dose is recorded once the program ends
+    s_rtc.watering_count++;
+    s_rtc.last_watering_time = run_clock_ms();  // Record when watering started
+    LOG_INFO("RunMode", "Watering event #%lu: humidity=%.2f, dose=%lums in %u pulse(s), duty=%d/255",
+             s_rtc.watering_count, humidity, (unsigned long)duration_ms, program.pulses, duty);
 
     return RUN_MODE_OK;
 }
 
+/**
+ * @brief Record the dose actually delivered by the finished watering program
+ *
+ * A soak program that reached the target early ran fewer pulses than
+ * planned; the budget and the adaptive model see the real pump time.
+ */
+static void record_watering_program(void) {
+    watering_program_status_t status;
+    if (!s_program_active || !watering_program_poll_done(&status)) {
+        return;
+    }
+    s_program_active = false;
+    if (status.pump_ms == 0) {
+        return;
+    }
+
+    WateringScheduler::instance().recordWatering(status.pump_ms);
+    watering_controller_begin(s_program_before, s_program_duty, status.pump_ms);
+    ts_store_append(TS_SERIES_PUMP, ts_store_now(), status.pump_ms);
+    LOG_INFO("RunMode", "Watering done: %lums pump time in %u/%u pulses%s",
+             (unsigned long)status.pump_ms, status.pulses_done, status.pulses,
+             status.stopped_early ? ", target reached early" : "");
+}
+
+/**
+ * @brief Append humidity and battery samples to the time-series store
+ *
+ * Rate-limited to SENSOR_HISTORY_INTERVAL_MS. In sleep mode every check is
+ * already at least one history interval apart and is recorded. Skipped while
+ * the wall clock is not set, since samples are keyed by Unix time.
+ */
+static void record_history(void) {
+    uint32_t now_ms = run_clock_ms();
+    if (sleep_mode() == RUN_SLEEP_NONE && s_rtc.history_started &&
+        now_ms - s_rtc.last_history_time < SENSOR_HISTORY_INTERVAL_MS) {
+        return;
+    }
+
+    uint32_t ts = ts_store_now();
+    if (ts == 0) {
+        return;
+    }
+
+    float humidity = 0.0f;
+    float battery_voltage = 0.0f;
+    if (sensor_manager_get_humidity_cached(&humidity, SENSOR_MAX_AGE_MS) == SENSOR_OK) {
+        ts_store_append(TS_SERIES_HUMIDITY, ts, lroundf(humidity));
+    }
+    if (sensor_manager_get_battery_voltage_cached(&battery_voltage, SENSOR_MAX_AGE_MS) == SENSOR_OK) {
+        ts_store_append(TS_SERIES_BATTERY_MV, ts, lroundf(battery_voltage * 1000.0f));
+    }
+
+    s_rtc.last_history_time = now_ms;
+    s_rtc.history_started = true;
+}
+
+/**
+ * @brief Periodic check body: change detection, watering decision, dashboard update
+ *
+ * Runs after a fresh acquisition, so the cached reads below hit the snapshot
+ * instead of powering the sensor again.
+ */
+static void run_periodic_check(void) {
+    // Get configuration
+    ConfigManager& config_mgr = ConfigManager::instance();
+    hydro_config_t config = config_mgr.getConfig();
+
+    // Read current sensor values for change detection
+    float humidity_raw = 0.0f;
+    bool humidity_ok = sensor_manager_get_humidity_cached(&humidity_raw, SENSOR_MAX_AGE_MS) == SENSOR_OK;
+
+    // Feed the battery model; change detection uses the filtered voltage so
+    // ADC noise and pump sag no longer trigger refreshes
+    battery_level_t previous_level = battery_manager_get_level();
+    battery_manager_update(SENSOR_MAX_AGE_MS);
+    battery_level_t level = battery_manager_get_level();
+    if (level != previous_level) {
+        LOG_WARN("RunMode", "Battery %s - check interval now %lums",
+                 battery_manager_level_name(level), check_interval_ms());
+    }
+    float battery_voltage = display_battery_voltage();
+
+    float humidity_pct = adc_to_humidity_percent((uint16_t)humidity_raw,
+                                                  config.watering.humidity_wet,
+                                                  config.watering.humidity_dry);
+    bool pump_running = watering_active();
+
+    // Detect significant changes
+    bool humidity_changed = (s_rtc.last_displayed_humidity < 0) ||
+                           (fabs(humidity_pct - s_rtc.last_displayed_humidity) >= HUMIDITY_CHANGE_THRESHOLD);
+    bool voltage_changed = (s_rtc.last_displayed_voltage < 0) ||
+                          (fabs(battery_voltage - s_rtc.last_displayed_voltage) >= VOLTAGE_CHANGE_THRESHOLD);
+    bool pump_state_changed = (pump_running != s_rtc.last_pump_state);
+    bool faults_changed = (sensor_manager_get_faults() != s_rtc.last_displayed_faults);
+
+    // Execute watering sequence (will only water if humidity is low)
+    run_mode_result_t result = execute_watering_sequence(false);
+    if (result != RUN_MODE_OK) {
+        LOG_ERROR("RunMode", "Watering sequence failed (error %d)", result);
+    }
+
+    // Update dashboard if significant change detected
+    if (humidity_changed || voltage_changed || pump_state_changed || faults_changed) {
+        LOG_INFO("RunMode", "Significant change detected - updating dashboard (H:%d V:%d P:%d F:%d)",
+                 humidity_changed, voltage_changed, pump_state_changed, faults_changed);
+        update_dashboard(false);  // Smart refresh (may be partial or full)
+    }
+
+    record_history();
+
+    // Learn the drying rate and push the next check out to just before the
+    // threshold is expected to be crossed
+    if (humidity_ok && sensor_manager_get_faults() == SENSOR_FAULT_NONE) {
+        drying_model_update(humidity_raw);
+    }
+    s_check_interval_ms = next_check_interval_ms(check_interval_ms());
+    if (sleep_mode() == RUN_SLEEP_NONE && s_check_interval_ms > check_interval_ms()) {
+        LOG_DEBUG("RunMode", "Next check in %lus (drying forecast)", s_check_interval_ms / 1000);
+    }
+}
+
+/**
+ * @brief Start a periodic check: async acquisition, or a synchronous read as fallback
+ */
+static void start_check(void) {
+    s_last_check_time = millis();
+    s_acquisition_start = s_last_check_time;
+
+    LOG_INFO("RunMode", "Periodic humidity check triggered");
+
+    // Sensor warm-up runs in the acquisition task; the loop keeps serving
+    // LVGL and the pump timer until the result is ready
+    if (sensor_manager_start_async(nullptr, nullptr) == SENSOR_OK) {
+        s_acquisition_pending = true;
+    } else {
+        LOG_WARN("RunMode", "Async acquisition unavailable, reading synchronously");
+        run_periodic_check();
+        s_cycle_done = sleep_mode() != RUN_SLEEP_NONE;
+    }
+}
+
+/**
+ * @brief Feed the sentinel's readings from the last sleep into the humidity filter
+ *
+ * After a ULP wake the median window would otherwise only hold samples from
+ * before the sleep; the newest sentinel readings fill it up to one slot short
+ * of the window, leaving the last slot for the live reading.
+ */
+static void replay_sentinel_history(void) {
+    if (ulp_manager_get_wake_reason() == ULP_SENTINEL_WAKE_NONE) {
+        return;
+    }
+
+    uint16_t history[ULP_SENTINEL_HISTORY_LEN];
+    uint8_t count = ulp_manager_get_history(history, ULP_SENTINEL_HISTORY_LEN);
+    uint8_t window = ConfigManager::instance().getConfig().watering.filter_window;
+    uint8_t replay = window > 1 ? window - 1 : 0;
+    if (replay > count) {
+        replay = count;
+    }
+    for (uint8_t i = count - replay; i < count; i++) {
+        humidity_filter_update(history[i], nullptr);
+    }
+    LOG_DEBUG("RunMode", "Replayed %u of %u sentinel readings (wake: %s)",
+              replay, count, ulp_sentinel_wake_name(ulp_manager_get_wake_reason()));
+}
+
 run_mode_result_t run_mode_manager_init(void) {
     if (s_initialized) {
         LOG_DEBUG("RunMode", "Run mode manager already initialized");
         return RUN_MODE_OK;
     }
 
+    if (rtc_valid()) {
+        // Re-base the run clock on the time spent asleep or resetting
+        int64_t elapsed = wall_clock_ms() - s_rtc.wall_ms;
+        if (elapsed < 0 || elapsed > RUN_CLOCK_MAX_GAP_MS) {
+            elapsed = 0;
+        }
+        s_clock_base_ms = s_rtc.clock_ms + (uint32_t)elapsed - millis();
+
+        s_woke_from_sleep = s_rtc.sleeping && esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_UNDEFINED;
+        if (s_rtc.sleeping) {
+            s_rtc.stats.last_sleep_ms = (uint32_t)elapsed;
+            s_rtc.stats.total_sleep_ms += (uint64_t)elapsed;
+            s_rtc.stats.last_wake_cause = (uint8_t)esp_sleep_get_wakeup_cause();
+            s_rtc.sleeping = false;
+        }
+        LOG_DEBUG("RunMode", "Restored RUN state (%lu waterings, %lu sleep cycles)",
+                  s_rtc.watering_count, s_rtc.stats.cycles);
+    } else {
+        memset(&s_rtc, 0, sizeof(s_rtc));
+        s_clock_base_ms = 0;
+        reset_display_state();
+    }
+    rtc_commit();
+
     s_last_check_time = 0;
-    s_watering_count = 0;
     s_initialized = true;
 
     // Get configuration for logging
     ConfigManager& config_mgr = ConfigManager::instance();
     hydro_config_t config = config_mgr.getConfig();
 
-    LOG_INFO("RunMode", "Run mode manager initialized (check_interval=%lums, threshold=%d)",
-             CHECK_INTERVAL_MS, config.watering.threshold);
+    LOG_INFO("RunMode", "Run mode manager initialized (check_interval=%lums, threshold=%d, sleep=%d)",
+             CHECK_INTERVAL_MS, config.watering.threshold, config.system.run_sleep);
 
     return RUN_MODE_OK;
 }
@@ -204,21 +639,31 @@ run_mode_result_t run_mode_manager_enter(void) {
 
     LOG_INFO("RunMode", "Entering RUN mode - automatic watering active");
 
-    // Start timer from now, first periodic check after CHECK_INTERVAL_MS
+    // Start timer from now, first periodic check after CHECK_INTERVAL_MS;
+    // in sleep mode check at once and go to sleep afterwards
     s_last_check_time = millis();
-
-    // Power on display
-    power_result_t power_result = power_screen_enable(true);
-    if (power_result != POWER_OK) {
-        LOG_ERROR("RunMode", "Failed to power on display (error %d)", power_result);
+    s_check_interval_ms = check_interval_ms();
+    s_acquisition_pending = false;
+    s_check_due = sleep_mode() != RUN_SLEEP_NONE;
+    s_cycle_done = false;
+    s_cycle_start = millis();
+    s_rtc.stats.last_boot_ms = 0;
+    s_rtc.stats.last_check_ms = 0;
+    s_rtc.stats.last_display_ms = 0;
+
+    // Hold the screen rail while in RUN mode (shared with a lingering rail
+    // from the previous mode, so no extra power-up)
+    if (!s_screen_leased) {
+        power_result_t power_result = power_rail_acquire(POWER_RAIL_SCREEN, nullptr);
+        if (power_result != POWER_OK) {
+            LOG_ERROR("RunMode", "Failed to power on display (error %d)", power_result);
+        } else {
+            s_screen_leased = true;
+        }
     }
 
     // Initialize display update state
-    s_last_displayed_humidity = -1.0f;
-    s_last_displayed_voltage = -1.0f;
-    s_partial_refresh_count = 0;
-    s_last_full_refresh_time = millis();
-    s_last_pump_state = false;
+    reset_display_state();
 
     // Show initial dashboard with full refresh
     LOG_INFO("RunMode", "Displaying initial dashboard");
@@ -227,6 +672,29 @@ run_mode_result_t run_mode_manager_enter(void) {
     return RUN_MODE_OK;
 }
 
+run_mode_result_t run_mode_manager_resume(void) {
+    if (!s_initialized) {
+        LOG_ERROR("RunMode", "Run mode manager not initialized");
+        return RUN_MODE_ERR_NOT_INITIALIZED;
+    }
+
+    s_cycle_start = 0;
+    s_rtc.stats.last_boot_ms = millis();
+    s_rtc.stats.last_check_ms = 0;
+    s_rtc.stats.last_display_ms = 0;
+    LOG_DEBUG("RunMode", "Resuming RUN mode after %lums asleep (cause %d)",
+              s_rtc.stats.last_sleep_ms, s_rtc.stats.last_wake_cause);
+
+    replay_sentinel_history();
+
+    // Dashboard on the panel is still current; it is redrawn only on change
+    s_acquisition_pending = false;
+    s_check_due = true;
+    s_cycle_done = false;
+
+    return RUN_MODE_OK;
+}
+
 run_mode_result_t run_mode_manager_loop(void) {
     if (!s_initialized) {
         return RUN_MODE_ERR_NOT_INITIALIZED;
@@ -240,47 +708,41 @@ run_mode_result_t run_mode_manager_loop(void) {
     }
 
     // Check if it's time for periodic humidity check
-    if (current_time - s_last_check_time >= CHECK_INTERVAL_MS) {
-        s_last_check_time = current_time;
-
-        LOG_INFO("RunMode", "Periodic humidity check triggered");
-
-        // Get configuration
-        ConfigManager& config_mgr = ConfigManager::instance();
-        hydro_config_t config = config_mgr.getConfig();
-
-        // Read current sensor values for change detection
-        float humidity_raw = 0.0f;
-        float battery_voltage = 0.0f;
-        sensor_manager_get_humidity(&humidity_raw);
-        sensor_manager_get_battery_voltage(&battery_voltage);
-
-        float humidity_pct = adc_to_humidity_percent((uint16_t)humidity_raw,
-                                                      config.watering.humidity_wet,
-                                                      config.watering.humidity_dry);
-        bool pump_running = actuator_manager_is_pump_running();
-
-        // Detect significant changes
-        bool humidity_changed = (s_last_displayed_humidity < 0) ||
-                               (fabs(humidity_pct - s_last_displayed_humidity) >= HUMIDITY_CHANGE_THRESHOLD);
-        bool voltage_changed = (s_last_displayed_voltage < 0) ||
-                              (fabs(battery_voltage - s_last_displayed_voltage) >= VOLTAGE_CHANGE_THRESHOLD);
-        bool pump_state_changed = (pump_running != s_last_pump_state);
-
-        // Execute watering sequence (will only water if humidity is low)
-        run_mode_result_t result = execute_watering_sequence(false);
-        if (result != RUN_MODE_OK) {
-            LOG_ERROR("RunMode", "Watering sequence failed (error %d)", result);
-        }
+    // No check while a soak program runs: its gap samples share the acquisition task
+    if (!s_acquisition_pending && !s_cycle_done && !watering_program_is_running() &&
+        (s_check_due || current_time - s_last_check_time >= s_check_interval_ms)) {
+        s_check_due = false;
+        start_check();
+    }
 
-        // Update dashboard if significant change detected
-        if (humidity_changed || voltage_changed || pump_state_changed) {
-            LOG_INFO("RunMode", "Significant change detected - updating dashboard (H:%d V:%d P:%d)",
-                     humidity_changed, voltage_changed, pump_state_changed);
-            update_dashboard(false);  // Smart refresh (may be partial or full)
+    if (s_acquisition_pending) {
+        sensor_async_result_t acquisition;
+        if (sensor_manager_poll_async(&acquisition)) {
+            s_acquisition_pending = false;
+            LOG_DEBUG("RunMode", "Acquisition finished in %lums", acquisition.duration_ms);
+
+            uint32_t display_before = s_rtc.stats.last_display_ms;
+            if (acquisition.humidity_result == SENSOR_OK) {
+                run_periodic_check();
+            } else {
+                LOG_ERROR("RunMode", "Humidity acquisition failed (error %d), skipping check",
+                          acquisition.humidity_result);
+            }
+            s_rtc.stats.last_check_ms = millis() - s_acquisition_start -
+                                        (s_rtc.stats.last_display_ms - display_before);
+            s_cycle_done = sleep_mode() != RUN_SLEEP_NONE;
         }
     }
 
+    record_watering_program();
+
+    // Show the pump as stopped right away: in sleep mode before the panel is
+    // frozen, awake because the next check may be a long way off
+    if (s_rtc.last_pump_state && !watering_active()) {
+        update_dashboard(false);
+        s_rtc.last_pump_state = false;
+    }
+
     return RUN_MODE_OK;
 }
 
@@ -289,18 +751,32 @@ run_mode_result_t run_mode_manager_exit(void) {
         return RUN_MODE_ERR_NOT_INITIALIZED;
     }
 
-    LOG_INFO("RunMode", "Exiting RUN mode - %lu watering events this session", s_watering_count);
+    LOG_INFO("RunMode", "Exiting RUN mode - %lu watering events so far", s_rtc.watering_count);
 
-    // Stop any ongoing pump operation
+    // Drop any in-flight acquisition result (the task finishes on its own)
+    sensor_manager_poll_async(nullptr);
+    s_acquisition_pending = false;
+    s_check_due = false;
+    s_cycle_done = false;
+
+    // Stop any ongoing pump operation; a cut-short program still counts
+    watering_program_abort();
+    record_watering_program();
     actuator_manager_stop_pump();
 
-    // Power off display without calling display_manager_sleep()
-    // (GxEPD2 static object state issue prevents proper reinitialization)
-    power_result_t power_result = power_screen_enable(false);
-    if (power_result != POWER_OK) {
-        LOG_ERROR("RunMode", "Failed to power off display (error %d)", power_result);
+    // Release the display rail without calling display_manager_sleep()
+    // (GxEPD2 static object state issue prevents proper reinitialization).
+    // An in-flight refresh holds its own lease, so the frame is not cut off;
+    // the rail lingers briefly in case the next mode needs the screen.
+    if (s_screen_leased) {
+        s_screen_leased = false;
+        power_result_t power_result = power_rail_release(POWER_RAIL_SCREEN);
+        if (power_result != POWER_OK) {
+            LOG_ERROR("RunMode", "Failed to power off display (error %d)", power_result);
+        }
     }
 
+    rtc_commit();
     return RUN_MODE_OK;
 }
 
@@ -315,3 +791,73 @@ run_mode_result_t run_mode_manager_force_water(void) {
     // Execute watering sequence with force flag (bypasses threshold check)
     return execute_watering_sequence(true);
 }
+
+bool run_mode_manager_woke_from_sleep(void) {
+    if (!s_initialized) {
+        return rtc_valid() && s_rtc.sleeping && esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_UNDEFINED;
+    }
+    return s_woke_from_sleep;
+}
+
+bool run_mode_manager_sleep_pending(void) {
+    return s_initialized && s_cycle_done && !s_acquisition_pending &&
+           !watering_active() && !s_program_active && !s_rtc.last_pump_state;
+}
+
+void run_mode_manager_sleep(void) {
+    run_sleep_mode_t mode = sleep_mode();
+    uint32_t awake_ms = millis() - s_cycle_start;
+
+    run_sleep_stats_t* stats = &s_rtc.stats;
+    stats->cycles++;
+    stats->last_awake_ms = awake_ms;
+    stats->total_awake_ms += awake_ms;
+    if (awake_ms > stats->max_awake_ms) {
+        stats->max_awake_ms = awake_ms;
+    }
+
+    // Keep the check period steady: the awake time counts towards the interval
+    uint32_t interval_ms = next_check_interval_ms(sleep_interval_ms());
+    uint32_t sleep_ms = interval_ms > awake_ms + SLEEP_MIN_MS ? interval_ms - awake_ms : SLEEP_MIN_MS;
+
+    // Everything off before the ULP takes the sensor gate
+    sensor_manager_poll_async(nullptr);
+    actuator_manager_stop_pump();
+    power_sensor_enable(false);
+    power_pump_module_enable(false);
+    power_screen_enable(false);
+
+    bool ulp_armed = false;
+    if (mode == RUN_SLEEP_SENTINEL) {
+        ulp_sentinel_params_t params;
+        ulp_manager_default_params(&params);
+        ulp_result_t result = ulp_manager_arm(&params);
+        ulp_armed = result == ULP_OK;
+        if (!ulp_armed) {
+            LOG_WARN("RunMode", "Sentinel unavailable (error %d), using timer sleep", result);
+        }
+    }
+
+    LOG_INFO("RunMode", "Cycle #%lu awake %lums (boot %lu, check %lu, display %lu), %s",
+             stats->cycles, awake_ms, stats->last_boot_ms, stats->last_check_ms, stats->last_display_ms,
+             ulp_armed ? "sentinel armed" : "sleeping");
+    if (!ulp_armed) {
+        LOG_DEBUG("RunMode", "Next check in %lus", sleep_ms / 1000);
+    }
+
+    s_rtc.sleeping = true;
+    rtc_commit();
+    power_ledger_suspend();
+    ts_store_suspend();
+    log_manager_flush_now();
+
+    hal_rtc_enter_run_sleep(ulp_armed ? 0 : (uint64_t)sleep_ms * 1000ULL, ulp_armed);
+}
+
+run_mode_result_t run_mode_manager_get_sleep_stats(run_sleep_stats_t* p_stats) {
+    if (p_stats == NULL) {
+        return RUN_MODE_ERR_INVALID_PARAM;
+    }
+    *p_stats = s_rtc.stats;
+    return RUN_MODE_OK;
+}
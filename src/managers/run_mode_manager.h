@@ -4,11 +4,18 @@
  *
  * This manager encapsulates all business logic for SYSTEM_MODE_RUN,
  * including periodic humidity checking and automatic watering decisions.
+ *
+ * With system.run_sleep enabled the device deep-sleeps between checks:
+ * each wake runs one check and goes back to sleep. Counters, timestamps
+ * and the last displayed values live in RTC memory so they carry over.
  */
 
 #ifndef RUN_MODE_MANAGER_H
 #define RUN_MODE_MANAGER_H
 
+#include <stdint.h>
+#include <stdbool.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -24,6 +31,34 @@ typedef enum {
     RUN_MODE_ERR_INVALID_PARAM
 } run_mode_result_t;
 
+/**
+ * @brief What RUN mode does between checks (system.run_sleep)
+ */
+typedef enum {
+    RUN_SLEEP_NONE = 0,      ///< Stay awake and poll every few seconds
+    RUN_SLEEP_TIMER,         ///< Deep-sleep on the RTC timer between checks
+    RUN_SLEEP_SENTINEL       ///< Deep-sleep while the ULP sentinel watches the sensor
+} run_sleep_mode_t;
+
+/**
+ * @brief Deep-sleep cycle statistics (kept in RTC memory)
+ *
+ * Awake times are measured from app start, so they exclude the ROM and
+ * second-stage bootloader time.
+ */
+typedef struct {
+    uint32_t cycles;           ///< Completed wake-check-sleep cycles
+    uint32_t last_awake_ms;    ///< App start to sleep, last cycle
+    uint32_t last_boot_ms;     ///< App start to resume (setup), last cycle
+    uint32_t last_check_ms;    ///< Acquisition and watering decision, last cycle
+    uint32_t last_display_ms;  ///< Dashboard refresh, last cycle (0 if unchanged)
+    uint32_t max_awake_ms;     ///< Longest awake time of any cycle
+    uint64_t total_awake_ms;   ///< Sum of awake times
+    uint64_t total_sleep_ms;   ///< Sum of measured sleep times
+    uint32_t last_sleep_ms;    ///< Measured length of the last sleep
+    uint8_t last_wake_cause;   ///< esp_sleep_wakeup_cause_t of the last wake
+} run_sleep_stats_t;
+
 /**
  * @brief Initialize the run mode manager
  *
@@ -48,7 +83,8 @@ run_mode_result_t run_mode_manager_enter(void);
  *
  * Must be called repeatedly in the main loop when in SYSTEM_MODE_RUN.
  * Implements non-blocking periodic humidity checks and watering logic:
- * - Every 5 seconds, reads soil moisture
+ * - Every 5 seconds, starts an asynchronous sensor acquisition and
+ *   evaluates it once the sensor task reports completion
  * - If moisture below threshold, triggers watering
  * - Logs all watering events
  *
@@ -77,6 +113,50 @@ run_mode_result_t run_mode_manager_exit(void);
  */
 run_mode_result_t run_mode_manager_force_water(void);
 
+/**
+ * @brief Whether this boot is a wake from a RUN mode deep sleep
+ *
+ * Reads only RTC memory and the wake cause, so it can be called before any
+ * other manager is initialized to decide on the short boot path.
+ *
+ * @return true if the previous boot went to sleep through run_mode_manager_sleep()
+ */
+bool run_mode_manager_woke_from_sleep(void);
+
+/**
+ * @brief Continue RUN mode after a deep-sleep wake
+ *
+ * Used instead of run_mode_manager_enter() on the short boot path: no initial
+ * dashboard refresh, the check runs immediately.
+ *
+ * @return RUN_MODE_OK on success, error code otherwise
+ */
+run_mode_result_t run_mode_manager_resume(void);
+
+/**
+ * @brief Whether the current cycle is finished and the system may sleep
+ *
+ * True only when system.run_sleep is enabled, the check of this cycle has
+ * completed, the pump has stopped and the dashboard is up to date.
+ */
+bool run_mode_manager_sleep_pending(void);
+
+/**
+ * @brief Save RUN mode state to RTC memory and deep-sleep until the next check
+ *
+ * Turns off all rails, flushes logs and the time-series tails, then sleeps on
+ * the RTC timer or, in sentinel mode, with the ULP armed. Leaving RUN mode
+ * wakes the CPU at any time. Does not return.
+ */
+void run_mode_manager_sleep(void);
+
+/**
+ * @brief Get deep-sleep cycle statistics
+ * @param p_stats Output
+ * @return RUN_MODE_OK on success, RUN_MODE_ERR_INVALID_PARAM if p_stats is NULL
+ */
+run_mode_result_t run_mode_manager_get_sleep_stats(run_sleep_stats_t* p_stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,240 @@
+/**
+ * @file sensor_health.cpp
+ * @brief 土壤湿度传感器健康监测实现
+ */
+
+#include "sensor_health.h"
+#include "managers/log_manager.h"
+#include "data/timing_constants.h"
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <math.h>
+#include <string.h>
+#include <stdio.h>
+#include <stddef.h>
+#include "esp_crc.h"
+
+#define RTC_STATE_MAGIC 0x53484C54  // "SHLT"
+
+// 保存在 RTC 慢速内存中，深度睡眠与软件复位后保留
+typedef struct {
+    uint32_t magic;
+    sensor_health_t health;
+    float noise_ms;   // 差分平方的指数滑动均值
+    bool has_value;
+    uint32_t crc;
+} rtc_health_state_t;
+
+RTC_DATA_ATTR static rtc_health_state_t s_rtc;
+
+// 采集任务与主循环都会访问状态
+static portMUX_TYPE s_health_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// --- 私有函数 ---
+
+static uint32_t rtc_crc() {
+    return esp_crc32_le(0, (const uint8_t*)&s_rtc, offsetof(rtc_health_state_t, crc));
+}
+
+// 调用者持有 s_health_mux
+static void rtc_commit() {
+    s_rtc.magic = RTC_STATE_MAGIC;
+    s_rtc.crc = rtc_crc();
+}
+
+static void set_fault(uint32_t* p_faults, uint32_t fault, bool active) {
+    if (active) {
+        *p_faults |= fault;
+    } else {
+        *p_faults &= ~fault;
+    }
+}
+
+// 在临界区外记录故障变化
+static void report_change(uint32_t before, uint32_t after) {
+    if (before == after) return;
+    char buf[64];
+    if (after & ~before) {
+        LOG_WARN("SensorHealth", "Sensor fault: %s", sensor_health_format(after, buf, sizeof(buf)));
+    } else {
+        LOG_INFO("SensorHealth", "Sensor faults now: %s", sensor_health_format(after, buf, sizeof(buf)));
+    }
+}
+
+// --- 公共 API ---
+
+void sensor_health_init() {
+    portENTER_CRITICAL(&s_health_mux);
+    bool restored = s_rtc.magic == RTC_STATE_MAGIC && s_rtc.crc == rtc_crc();
+    if (!restored) {
+        memset(&s_rtc, 0, sizeof(s_rtc));
+        rtc_commit();
+    }
+    sensor_health_t health = s_rtc.health;
+    portEXIT_CRITICAL(&s_health_mux);
+
+    if (restored) {
+        char buf[64];
+        LOG_DEBUG("SensorHealth", "Restored sensor health (%lu samples, faults: %s)",
+                  (unsigned long)health.samples, sensor_health_format(health.faults, buf, sizeof(buf)));
+    } else {
+        LOG_DEBUG("SensorHealth", "No saved sensor health, starting empty");
+    }
+}
+
+void sensor_health_reset() {
+    portENTER_CRITICAL(&s_health_mux);
+    memset(&s_rtc, 0, sizeof(s_rtc));
+    rtc_commit();
+    portEXIT_CRITICAL(&s_health_mux);
+}
+
+void sensor_health_on_sample(float value, float burst_variance, uint32_t now_s) {
+    portENTER_CRITICAL(&s_health_mux);
+    sensor_health_t* h = &s_rtc.health;
+    uint32_t before = h->faults;
+
+    h->samples++;
+    h->consecutive_failures = 0;
+    set_fault(&h->faults, SENSOR_FAULT_READ_FAILED, false);
+
+    float burst_std = sqrtf(burst_variance > 0.0f ? burst_variance : 0.0f);
+    h->burst_std = h->samples == 1 ? burst_std
+                                   : h->burst_std + SENSOR_HEALTH_NOISE_ALPHA * (burst_std - h->burst_std);
+
+    if (s_rtc.has_value) {
+        float delta = value - h->last_value;
+
+        // 变化速率：跳变样本计入漏桶，不参与噪声估计
+        bool jump = delta > SENSOR_HEALTH_MAX_RISE ||
+                    (delta < -SENSOR_HEALTH_MAX_DROP && !h->response_pending);
+        h->jump_score *= SENSOR_HEALTH_JUMP_DECAY;
+        if (jump) {
+            h->jump_score += 1.0f;
+            h->jumps++;
+        } else {
+            s_rtc.noise_ms += SENSOR_HEALTH_NOISE_ALPHA * (delta * delta - s_rtc.noise_ms);
+        }
+        h->noise_std = sqrtf(s_rtc.noise_ms / 2.0f);
+
+        if (h->jump_score > SENSOR_HEALTH_JUMP_SET) {
+            set_fault(&h->faults, SENSOR_FAULT_RATE, true);
+        } else if (h->jump_score < SENSOR_HEALTH_JUMP_CLEAR) {
+            set_fault(&h->faults, SENSOR_FAULT_RATE, false);
+        }
+
+        if (h->samples >= SENSOR_HEALTH_NOISE_MIN_SAMPLES) {
+            if (h->noise_std > SENSOR_HEALTH_NOISE_SET) {
+                set_fault(&h->faults, SENSOR_FAULT_NOISY, true);
+            } else if (h->noise_std < SENSOR_HEALTH_NOISE_CLEAR) {
+                set_fault(&h->faults, SENSOR_FAULT_NOISY, false);
+            }
+        }
+
+        // 读数停滞
+        if (fabsf(delta) < SENSOR_HEALTH_STUCK_EPSILON) {
+            if (h->stuck_run < UINT16_MAX) h->stuck_run++;
+        } else {
+            h->stuck_run = 0;
+        }
+        set_fault(&h->faults, SENSOR_FAULT_STUCK, h->stuck_run >= SENSOR_HEALTH_STUCK_RUN);
+    }
+
+    // 浇水响应
+    if (h->response_pending) {
+        if (value < h->response_min) h->response_min = value;
+        if (now_s < h->watering_time) h->watering_time = now_s;  // 系统时间被向后校正，重新计时
+        if (h->response_baseline - h->response_min >= SENSOR_HEALTH_RESPONSE_DROP) {
+            h->response_pending = false;
+            h->unresponsive_waterings = 0;
+            set_fault(&h->faults, SENSOR_FAULT_NO_RESPONSE, false);
+        } else if ((now_s - h->watering_time) * 1000ULL >= SENSOR_HEALTH_RESPONSE_WINDOW_MS) {
+            h->response_pending = false;
+            if (h->unresponsive_waterings < UINT8_MAX) h->unresponsive_waterings++;
+            if (h->unresponsive_waterings >= SENSOR_HEALTH_NO_RESPONSE_LIMIT) {
+                set_fault(&h->faults, SENSOR_FAULT_NO_RESPONSE, true);
+            }
+        }
+    }
+
+    h->last_value = value;
+    s_rtc.has_value = true;
+    uint32_t after = h->faults;
+    if (after != before) h->fault_changes++;
+    rtc_commit();
+    portEXIT_CRITICAL(&s_health_mux);
+
+    report_change(before, after);
+}
+
+void sensor_health_on_failure(uint32_t now_s) {
+    (void)now_s;
+    portENTER_CRITICAL(&s_health_mux);
+    sensor_health_t* h = &s_rtc.health;
+    uint32_t before = h->faults;
+    h->failures++;
+    if (h->consecutive_failures < UINT8_MAX) h->consecutive_failures++;
+    if (h->consecutive_failures >= SENSOR_HEALTH_FAIL_LIMIT) {
+        h->faults |= SENSOR_FAULT_READ_FAILED;
+    }
+    uint32_t after = h->faults;
+    if (after != before) h->fault_changes++;
+    rtc_commit();
+    portEXIT_CRITICAL(&s_health_mux);
+
+    report_change(before, after);
+}
+
+void sensor_health_on_watering(uint32_t now_s) {
+    portENTER_CRITICAL(&s_health_mux);
+    if (s_rtc.has_value) {
+        sensor_health_t* h = &s_rtc.health;
+        h->response_pending = true;
+        h->response_baseline = h->last_value;
+        h->response_min = h->last_value;
+        h->watering_time = now_s;
+        rtc_commit();
+    }
+    portEXIT_CRITICAL(&s_health_mux);
+}
+
+void sensor_health_get(sensor_health_t* p_health) {
+    portENTER_CRITICAL(&s_health_mux);
+    *p_health = s_rtc.health;
+    portEXIT_CRITICAL(&s_health_mux);
+}
+
+uint32_t sensor_health_faults() {
+    portENTER_CRITICAL(&s_health_mux);
+    uint32_t faults = s_rtc.health.faults;
+    portEXIT_CRITICAL(&s_health_mux);
+    return faults;
+}
+
+const char* sensor_health_format(uint32_t faults, char* buf, size_t size) {
+    static const struct {
+        uint32_t fault;
+        const char* name;
+    } names[] = {
+        {SENSOR_FAULT_READ_FAILED, "read_failed"},
+        {SENSOR_FAULT_NOISY, "noisy"},
+        {SENSOR_FAULT_STUCK, "stuck"},
+        {SENSOR_FAULT_RATE, "rate"},
+        {SENSOR_FAULT_NO_RESPONSE, "no_response"},
+    };
+
+    if (size == 0) return buf;
+    buf[0] = '\0';
+    if (faults == SENSOR_FAULT_NONE) {
+        snprintf(buf, size, "ok");
+        return buf;
+    }
+    size_t len = 0;
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (!(faults & names[i].fault)) continue;
+        int n = snprintf(buf + len, size - len, "%s%s", len ? "," : "", names[i].name);
+        if (n < 0 || (size_t)n >= size - len) break;
+        len += n;
+    }
+    return buf;
+}
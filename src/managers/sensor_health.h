@@ -0,0 +1,125 @@
+/**
+ * @file sensor_health.h
+ * @brief 土壤湿度传感器健康监测
+ * @details
+ *   每次湿度采集（成功或失败）增量更新一次，O(1) 时间与常数内存：
+ *   - 连续采集失败（多数样本落在量程两端，短路或断路）→ READ_FAILED
+ *   - 相邻读数差分的指数滑动均方（MSSD，对缓慢趋势不敏感）估计噪声，
+ *     过大说明探头悬空或接触不良 → NOISY
+ *   - 读数长时间几乎不变（截尾均值为浮点，正常情况下不会逐次相同）→ STUCK
+ *   - 不合理的变化速率（土壤不会在一个检查周期内迅速变干；
+ *     非浇水引起的大幅下降同样可疑），以漏桶计分 → RATE
+ *   - 浇水后响应窗口内读数没有下降（探头不在土中、水箱空或管路堵塞），
+ *     连续出现 → NO_RESPONSE
+ *   故障条件消失后对应位自动清除（NO_RESPONSE 在下一次有响应的浇水后清除）。
+ *
+ *   RUN 模式深度睡眠时每次唤醒只有一次读数，上述检测都依赖跨读数的历史，
+ *   因此状态保存在 RTC 慢速内存中（RTC_DATA_ATTR），带校验，跨深度睡眠与软件复位保留；
+ *   时间戳取系统时间（秒），睡眠期间由 RTC 继续计时。
+ */
+
+#ifndef SENSOR_HEALTH_H
+#define SENSOR_HEALTH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// 判定参数（单位均为湿度ADC计数）
+#define SENSOR_HEALTH_FAIL_LIMIT        3       // 连续失败次数
+#define SENSOR_HEALTH_NOISE_ALPHA       0.1f    // 噪声估计的平滑系数
+#define SENSOR_HEALTH_NOISE_SET         80.0f   // 噪声标准差超过此值置位 NOISY
+#define SENSOR_HEALTH_NOISE_CLEAR       60.0f   // 低于此值清除 NOISY
+#define SENSOR_HEALTH_NOISE_MIN_SAMPLES 8       // 噪声估计需要的最少样本数
+#define SENSOR_HEALTH_STUCK_EPSILON     1.0f    // 相邻读数差小于此值视为未变化
+#define SENSOR_HEALTH_STUCK_RUN         20      // 连续未变化次数
+#define SENSOR_HEALTH_MAX_RISE          300.0f  // 单个周期内变干的最大合理幅度
+#define SENSOR_HEALTH_MAX_DROP          800.0f  // 非浇水时单个周期内变湿的最大合理幅度
+#define SENSOR_HEALTH_JUMP_DECAY        0.9f    // 跳变计分每个样本的衰减
+#define SENSOR_HEALTH_JUMP_SET          2.5f    // 计分超过此值置位 RATE（约10个样本内3次跳变）
+#define SENSOR_HEALTH_JUMP_CLEAR        0.5f
+#define SENSOR_HEALTH_RESPONSE_DROP     50.0f   // 浇水后读数至少下降此值视为有响应
+#define SENSOR_HEALTH_NO_RESPONSE_LIMIT 2       // 连续无响应浇水次数
+
+/**
+ * @brief 故障类型（位掩码）
+ */
+typedef enum {
+    SENSOR_FAULT_NONE        = 0,
+    SENSOR_FAULT_READ_FAILED = 1 << 0,  ///< 连续采集失败
+    SENSOR_FAULT_NOISY       = 1 << 1,  ///< 读数噪声过大（探头悬空或接触不良）
+    SENSOR_FAULT_STUCK       = 1 << 2,  ///< 读数长时间不变
+    SENSOR_FAULT_RATE        = 1 << 3,  ///< 频繁出现不合理的变化速率
+    SENSOR_FAULT_NO_RESPONSE = 1 << 4   ///< 浇水后读数无变化
+} sensor_fault_t;
+
+// 这些故障下读数不可信，RUN 模式暂停自动浇水
+#define SENSOR_FAULT_BLOCKS_WATERING (SENSOR_FAULT_READ_FAILED | SENSOR_FAULT_NOISY | SENSOR_FAULT_STUCK)
+
+/**
+ * @brief 健康监测状态
+ */
+typedef struct {
+    uint32_t faults;              ///< 当前故障位掩码 (sensor_fault_t)
+    uint32_t samples;             ///< 成功采集次数
+    uint32_t failures;            ///< 失败采集次数
+    uint8_t consecutive_failures;
+    float last_value;             ///< 最近一次读数
+    float noise_std;              ///< 差分噪声估计 (sqrt(EWMA(Δ²)/2))
+    float burst_std;              ///< 单次突发采集内的标准差 (EWMA)
+    uint16_t stuck_run;           ///< 连续未变化次数
+    float jump_score;             ///< 跳变漏桶计分
+    uint32_t jumps;               ///< 跳变总数
+    bool response_pending;        ///< 正在等待浇水响应
+    float response_baseline;      ///< 浇水前的读数
+    float response_min;           ///< 浇水后的最低读数
+    uint32_t watering_time;       ///< 最近一次浇水时刻 (系统时间，秒)
+    uint8_t unresponsive_waterings; ///< 连续无响应的浇水次数
+    uint32_t fault_changes;       ///< 故障掩码变化次数
+} sensor_health_t;
+
+/**
+ * @brief 从 RTC 内存恢复状态，无有效状态时从空开始
+ */
+void sensor_health_init();
+
+/**
+ * @brief 清空状态与故障
+ */
+void sensor_health_reset();
+
+/**
+ * @brief 记录一次成功的湿度采集
+ * @param value 湿度ADC截尾均值
+ * @param burst_variance 本次突发采集的样本方差
+ * @param now_s 采集时刻 (系统时间，秒)
+ */
+void sensor_health_on_sample(float value, float burst_variance, uint32_t now_s);
+
+/**
+ * @brief 记录一次失败的湿度采集
+ */
+void sensor_health_on_failure(uint32_t now_s);
+
+/**
+ * @brief 记录一次浇水，开始等待读数响应
+ */
+void sensor_health_on_watering(uint32_t now_s);
+
+/**
+ * @brief 获取状态副本
+ */
+void sensor_health_get(sensor_health_t* p_health);
+
+/**
+ * @brief 获取当前故障位掩码
+ */
+uint32_t sensor_health_faults();
+
+/**
+ * @brief 把故障位掩码格式化为 "stuck,noisy" 形式
+ * @return buf；无故障时为 "ok"
+ */
+const char* sensor_health_format(uint32_t faults, char* buf, size_t size);
+
+#endif // SENSOR_HEALTH_H
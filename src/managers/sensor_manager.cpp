@@ -8,10 +8,72 @@
 #include "managers/log_manager.h"
 #include "hal/hal_config.h"
 #include "hal/hal_adc.h"
+#include "data/timing_constants.h"
+#include "managers/ts/ts_store.h"
 #include <Arduino.h>
+#include <Preferences.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+// 学习到的稳定时间保存在独立的NVS命名空间中
+#define SETTLE_NVS_NAMESPACE    "sensor"
+#define SETTLE_NVS_KEY          "settle_ms"
+#define SETTLE_PERSIST_DELTA_MS 5   // 学习值变化超过此值才写入NVS，减少Flash磨损
 
 static bool is_initialized = false;
 
+// 物理采集互斥：主循环与异步采集任务共用传感器电源和采集状态
+static SemaphoreHandle_t s_acq_mutex = nullptr;
+
+// 各通道的采集配置与最近一次的统计结果
+static hal_adc_sample_config_t s_sampling[SENSOR_CHANNEL_COUNT];
+static hal_adc_stats_t s_last_stats[SENSOR_CHANNEL_COUNT];
+static bool s_has_stats[SENSOR_CHANNEL_COUNT] = {false};
+
+// 快照缓存：每通道最近一次成功采集的值与时刻
+typedef struct {
+    float value;
+    uint32_t time_ms;
+    bool valid;
+} sensor_snapshot_t;
+
+static sensor_snapshot_t s_snapshot[SENSOR_CHANNEL_COUNT];
+static sensor_cache_stats_t s_cache_stats;
+static portMUX_TYPE s_snapshot_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// 异步采集状态
+typedef enum {
+    ASYNC_IDLE = 0,
+    ASYNC_PENDING,
+    ASYNC_DONE
+} async_state_t;
+
+static TaskHandle_t s_async_task_handle = nullptr;
+static volatile async_state_t s_async_state = ASYNC_IDLE;
+static sensor_async_result_t s_async_result;
+static sensor_async_cb_t s_async_cb = nullptr;
+static void* s_async_ctx = nullptr;
+static uint32_t s_async_start_ms = 0;
+static portMUX_TYPE s_async_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// 预热状态与统计
+static sensor_warmup_mode_t s_warmup_mode = SENSOR_WARMUP_ADAPTIVE;
+static uint16_t s_learned_settle_ms = 0;
+static uint16_t s_persisted_settle_ms = 0;
+static uint16_t s_last_settle_ms = 0;
+static uint32_t s_readings = 0;
+static uint32_t s_settle_timeouts = 0;
+static uint64_t s_rail_on_base_ms = 0;  // 启动时能耗账本中的传感器电源导通时间
+
+// 收敛判断用的快速采样：4个样本取四分位均值，不额外间隔
+static const hal_adc_sample_config_t SETTLE_PROBE_CONFIG = {
+    4, HAL_ADC_REJECT_TRIM, 25, HAL_ADC_DEFAULT_MAD_K, 0
+};
+
 /* ========== 私有辅助函数 ========== */
 
 // 检查管理器是否已初始化
@@ -24,10 +86,193 @@ static inline sensor_result_t validate_pointer(void* ptr) {
     return ptr != nullptr ? SENSOR_OK : SENSOR_ERROR_READ_FAILED;
 }
 
+// 按通道配置进行一次多样本采集并保存统计结果
+static bool sample_channel(sensor_channel_t channel, uint8_t pin, hal_adc_stats_t* p_stats) {
+    bool ok = hal_adc_sample(pin, &s_sampling[channel], p_stats);
+    s_last_stats[channel] = *p_stats;
+    s_has_stats[channel] = true;
+    return ok;
+}
+
+static void persist_settle_time() {
+    Preferences prefs;
+    if (prefs.begin(SETTLE_NVS_NAMESPACE, false)) {
+        prefs.putUShort(SETTLE_NVS_KEY, s_learned_settle_ms);
+        prefs.end();
+        s_persisted_settle_ms = s_learned_settle_ms;
+    }
+}
+
+// 以 1/4 权重的指数平均更新学习到的稳定时间
+static void learn_settle_time(uint16_t observed_ms) {
+    if (s_learned_settle_ms == 0) {
+        s_learned_settle_ms = observed_ms > 0 ? observed_ms : 1;
+    } else {
+        int32_t delta = (int32_t)observed_ms - (int32_t)s_learned_settle_ms;
+        s_learned_settle_ms = (uint16_t)(s_learned_settle_ms + (delta >= 0 ? (delta + 2) / 4 : (delta - 2) / 4));
+        if (s_learned_settle_ms == 0) s_learned_settle_ms = 1;
+    }
+
+    if (abs((int)s_learned_settle_ms - (int)s_persisted_settle_ms) >= SETTLE_PERSIST_DELTA_MS) {
+        persist_settle_time();
+    }
+}
+
+/**
+ * @brief 等待湿度传感器上电后读数稳定
+ * @details 自适应模式下先等待学习值的3/4（此前读数通常仍在变化），然后每隔
+ *          SENSOR_SETTLE_POLL_MS 快速采样一次，连续 SENSOR_SETTLE_STABLE_COUNT 次
+ *          相邻读数之差不超过 SENSOR_SETTLE_TOLERANCE 即视为稳定，最长等待 SENSOR_SETTLE_MAX_MS。
+ *          稳定时间取这组收敛读数中第一次采样的时刻。
+ * @return 稳定时间 (ms)
+ */
+static uint16_t wait_for_settle() {
+    if (s_warmup_mode == SENSOR_WARMUP_FIXED) {
+        delay(SENSOR_SETTLE_MAX_MS);
+        return SENSOR_SETTLE_MAX_MS;
+    }
+
+    uint32_t start = millis();
+    if (s_learned_settle_ms > 0) {
+        delay(s_learned_settle_ms * 3 / 4);
+    }
+
+    float previous = -1.0f;
+    uint8_t stable = 0;
+    uint32_t run_start_ms = 0;
+    while (true) {
+        hal_adc_stats_t probe;
+        hal_adc_sample(PIN_SENSOR_HUMIDITY, &SETTLE_PROBE_CONFIG, &probe);
+        uint32_t elapsed = millis() - start;
+
+        if (previous >= 0.0f && fabsf(probe.mean - previous) <= SENSOR_SETTLE_TOLERANCE) {
+            if (++stable >= SENSOR_SETTLE_STABLE_COUNT) {
+                learn_settle_time((uint16_t)run_start_ms);
+                return (uint16_t)run_start_ms;
+            }
+        } else {
+            stable = 0;
+            run_start_ms = elapsed;
+        }
+        previous = probe.mean;
+
+        if (elapsed >= SENSOR_SETTLE_MAX_MS) {
+            s_settle_timeouts++;
+            learn_settle_time(SENSOR_SETTLE_MAX_MS);
+            return SENSOR_SETTLE_MAX_MS;
+        }
+        delay(SENSOR_SETTLE_POLL_MS);
+    }
+}
+
+static void store_snapshot(sensor_channel_t channel, float value) {
+    uint32_t now = millis();
+    portENTER_CRITICAL(&s_snapshot_mux);
+    s_snapshot[channel].value = value;
+    s_snapshot[channel].time_ms = now;
+    s_snapshot[channel].valid = true;
+    portEXIT_CRITICAL(&s_snapshot_mux);
+}
+
+// 快照未过期时返回 true 并输出缓存值（同时计入一次请求）
+static bool read_snapshot(sensor_channel_t channel, uint32_t max_age_ms, float* p_value) {
+    uint32_t now = millis();
+    bool hit = false;
+    portENTER_CRITICAL(&s_snapshot_mux);
+    const sensor_snapshot_t* snap = &s_snapshot[channel];
+    if (snap->valid && now - snap->time_ms <= max_age_ms) {
+        *p_value = snap->value;
+        s_cache_stats.requests[channel]++;
+        hit = true;
+    }
+    portEXIT_CRITICAL(&s_snapshot_mux);
+    return hit;
+}
+
+// 实际采集计数（请求与采集各加一）
+static void count_acquisition(sensor_channel_t channel) {
+    portENTER_CRITICAL(&s_snapshot_mux);
+    s_cache_stats.requests[channel]++;
+    s_cache_stats.acquisitions[channel]++;
+    portEXIT_CRITICAL(&s_snapshot_mux);
+}
+
+/**
+ * @brief 异步采集任务
+ * @details 平时阻塞在任务通知上；每收到一次通知依次采集湿度与电池电压，
+ *          结果写入 s_async_result 后置为完成状态，再调用回调。
+ */
+static void async_acquisition_task(void* param) {
+    (void)param;
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        sensor_async_result_t result;
+        memset(&result, 0, sizeof(result));
+        result.humidity_result = sensor_manager_get_humidity(&result.humidity);
+        result.battery_result = sensor_manager_get_battery_voltage(&result.battery_voltage);
+
+        portENTER_CRITICAL(&s_async_mux);
+        result.duration_ms = millis() - s_async_start_ms;
+        s_async_result = result;
+        sensor_async_cb_t cb = s_async_cb;
+        void* ctx = s_async_ctx;
+        s_async_state = ASYNC_DONE;
+        portEXIT_CRITICAL(&s_async_mux);
+
+        if (cb != nullptr) {
+            cb(&result, ctx);
+        }
+    }
+}
+
 sensor_result_t sensor_manager_init() {
     hal_adc_init();
+    for (int i = 0; i < SENSOR_CHANNEL_COUNT; i++) {
+        hal_adc_default_config(&s_sampling[i]);
+    }
+    if (!hal_adc_is_calibrated()) {
+        LOG_WARN("Sensor", "ADC eFuse calibration not available, using typical curve");
+    }
+
+    // 读取学习到的稳定时间（命名空间不存在时保持为0）
+    Preferences prefs;
+    if (prefs.begin(SETTLE_NVS_NAMESPACE, true)) {
+        s_learned_settle_ms = prefs.getUShort(SETTLE_NVS_KEY, 0);
+        prefs.end();
+    }
+    s_persisted_settle_ms = s_learned_settle_ms;
+
+    // 电源开启时间取自能耗账本（含租约释放后的保持时间），与读取次数一样从本次启动算起
+    power_ledger_stats_t ledger;
+    power_ledger_get_stats(&ledger);
+    s_rail_on_base_ms = ledger.entries[POWER_LEDGER_SENSOR].on_ms;
+
+    if (s_acq_mutex == nullptr) {
+        s_acq_mutex = xSemaphoreCreateMutex();
+        if (s_acq_mutex == nullptr) {
+            // 采集互斥锁不可用时保持未初始化，读取接口返回 SENSOR_ERROR_NOT_INIT
+            LOG_ERROR("Sensor", "Failed to create acquisition mutex");
+            return SENSOR_ERROR_NOT_INIT;
+        }
+    }
+    if (s_async_task_handle == nullptr) {
+        BaseType_t task_created = xTaskCreate(
+            async_acquisition_task,
+            "SensorAcq",
+            4096,  // Stack size（含日志格式化）
+            NULL,
+            1,     // 与 loop 任务同级，预热期间的 delay() 让出CPU
+            &s_async_task_handle
+        );
+        if (task_created != pdPASS) {
+            s_async_task_handle = nullptr;
+            LOG_ERROR("Sensor", "Failed to create async acquisition task");
+        }
+    }
+
     is_initialized = true;
-    LOG_INFO("Sensor", "Sensor manager initialized");
+    LOG_INFO("Sensor", "Sensor manager initialized (learned settle time %u ms)", s_learned_settle_ms);
     return SENSOR_OK;
 }
 
@@ -51,62 +296,78 @@ sensor_result_t sensor_manager_read_all(sensor_data_t* p_sensor_data) {
         return result;
     }
 
-    // 填充时间戳 (暂时为0)
-    p_sensor_data->timestamp = 0;
+    // 填充时间戳（系统时间未设置时为0）
+    p_sensor_data->timestamp = ts_store_now();
 
     return SENSOR_OK;
 }
 
-sensor_result_t sensor_manager_get_humidity(float* p_humidity) {
-    sensor_result_t result = ensure_initialized();
-    if (result != SENSOR_OK) return result;
+// 湿度采集主体，调用者持有 s_acq_mutex
+static sensor_result_t acquire_humidity(float* p_humidity) {
+    count_acquisition(SENSOR_CHANNEL_HUMIDITY);
 
-    result = validate_pointer(p_humidity);
-    if (result != SENSOR_OK) return result;
-
-    // 1. 打开传感器电源
-    if (power_sensor_enable(true) != POWER_OK) {
+    // 1. 获取传感器电源租约（电源仍在保持或已由他处打开时无需再等待稳定）
+    bool was_powered = false;
+    if (power_rail_acquire(POWER_RAIL_SENSOR, &was_powered) != POWER_OK) {
         LOG_ERROR("Sensor", "Failed to enable sensor power");
+        sensor_health_on_failure((uint32_t)time(nullptr));
         return SENSOR_ERROR_POWER_FAILED;
     }
 
-    // 2. 延时等待传感器稳定
-    delay(200); // 等待200ms
+    // 2. 等待传感器读数稳定
+    s_last_settle_ms = was_powered ? 0 : wait_for_settle();
+
+    // 3. 多样本采集湿度传感器ADC值
+    hal_adc_stats_t stats;
+    bool adc_success = sample_channel(SENSOR_CHANNEL_HUMIDITY, PIN_SENSOR_HUMIDITY, &stats);
 
-    // 3. 读取湿度传感器ADC值
-    bool adc_success;
-    uint16_t adc_value = hal_adc_read(PIN_SENSOR_HUMIDITY, &adc_success);
+    // 4. 释放租约（ADC读取失败时同样释放）；电源保持片刻后关闭
+    power_result_t power_off_result = power_rail_release(POWER_RAIL_SENSOR);
+    s_readings++;
 
     // 检查ADC读取是否成功
     if (!adc_success) {
         LOG_ERROR("Sensor", "ADC read failed for humidity sensor");
-        // 尝试关闭电源，即使ADC读取失败
-        power_sensor_enable(false);
+        sensor_health_on_failure((uint32_t)time(nullptr));
         return SENSOR_ERROR_READ_FAILED;
     }
 
-    // 4. 关闭传感器电源
-    if (power_sensor_enable(false) != POWER_OK) {
+    if (power_off_result != POWER_OK) {
         // 即使关闭失败，也返回成功，因为数据已经读到
-        LOG_WARN("Sensor", "Failed to disable sensor power after reading");
+        LOG_WARN("Sensor", "Failed to release sensor power after reading");
     }
 
-    // 5. 转换为湿度值（直接返回ADC值，待后续标定）
-    *p_humidity = (float)adc_value;
+    // 5. 转换为湿度值（直接返回ADC截尾均值，待后续标定）
+    *p_humidity = stats.mean;
+    store_snapshot(SENSOR_CHANNEL_HUMIDITY, *p_humidity);
+    sensor_health_on_sample(stats.mean, stats.variance, (uint32_t)time(nullptr));
+    LOG_DEBUG("Sensor", "Humidity mean=%.1f median=%u var=%.1f used=%u/%u in %luus",
+              stats.mean, stats.median, stats.variance, stats.used, stats.taken,
+              (unsigned long)stats.duration_us);
 
     return SENSOR_OK;
 }
 
-sensor_result_t sensor_manager_get_battery_voltage(float* p_voltage) {
+sensor_result_t sensor_manager_get_humidity(float* p_humidity) {
     sensor_result_t result = ensure_initialized();
     if (result != SENSOR_OK) return result;
 
-    result = validate_pointer(p_voltage);
+    result = validate_pointer(p_humidity);
     if (result != SENSOR_OK) return result;
 
-    // 直接读取电池电压ADC值，无需控制传感器电源
-    bool adc_success;
-    uint16_t adc_value = hal_adc_read(PIN_SENSOR_BATTERY_ADC, &adc_success);
+    xSemaphoreTake(s_acq_mutex, portMAX_DELAY);
+    result = acquire_humidity(p_humidity);
+    xSemaphoreGive(s_acq_mutex);
+    return result;
+}
+
+// 电池电压采集主体，调用者持有 s_acq_mutex
+static sensor_result_t acquire_battery_voltage(float* p_voltage) {
+    count_acquisition(SENSOR_CHANNEL_BATTERY);
+
+    // 直接采集电池电压ADC值，无需控制传感器电源
+    hal_adc_stats_t stats;
+    bool adc_success = sample_channel(SENSOR_CHANNEL_BATTERY, PIN_SENSOR_BATTERY_ADC, &stats);
 
     // 检查ADC读取是否成功
     if (!adc_success) {
@@ -115,7 +376,8 @@ sensor_result_t sensor_manager_get_battery_voltage(float* p_voltage) {
     }
 
     // 转换为实际电压
-    float v_out = adc_value * (ADC_REFERENCE_VOLTAGE / 4095.0);
+    // 分压电阻为兆欧级，沿用实测标定的 ADC_REFERENCE_VOLTAGE 而非 eFuse 校准曲线
+    float v_out = stats.mean * (ADC_REFERENCE_VOLTAGE / 4095.0);
     *p_voltage = v_out * VOLTAGE_DIVIDER_RATIO;
 
     // 电压范围合理性检查（锂电池正常范围：2.7V - 4.3V）
@@ -124,5 +386,186 @@ sensor_result_t sensor_manager_get_battery_voltage(float* p_voltage) {
         return SENSOR_ERROR_READ_FAILED;
     }
 
+    store_snapshot(SENSOR_CHANNEL_BATTERY, *p_voltage);
+    return SENSOR_OK;
+}
+
+sensor_result_t sensor_manager_get_battery_voltage(float* p_voltage) {
+    sensor_result_t result = ensure_initialized();
+    if (result != SENSOR_OK) return result;
+
+    result = validate_pointer(p_voltage);
+    if (result != SENSOR_OK) return result;
+
+    xSemaphoreTake(s_acq_mutex, portMAX_DELAY);
+    result = acquire_battery_voltage(p_voltage);
+    xSemaphoreGive(s_acq_mutex);
+    return result;
+}
+
+sensor_result_t sensor_manager_set_sampling(sensor_channel_t channel, const hal_adc_sample_config_t* p_config) {
+    if (channel >= SENSOR_CHANNEL_COUNT || !hal_adc_config_valid(p_config)) {
+        return SENSOR_ERROR_INVALID_PARAM;
+    }
+    s_sampling[channel] = *p_config;
+    return SENSOR_OK;
+}
+
+void sensor_manager_get_sampling(sensor_channel_t channel, hal_adc_sample_config_t* p_config) {
+    if (channel >= SENSOR_CHANNEL_COUNT || p_config == nullptr) return;
+    *p_config = s_sampling[channel];
+}
+
+bool sensor_manager_get_last_stats(sensor_channel_t channel, hal_adc_stats_t* p_stats) {
+    if (channel >= SENSOR_CHANNEL_COUNT || p_stats == nullptr || !s_has_stats[channel]) return false;
+    *p_stats = s_last_stats[channel];
+    return true;
+}
+
+sensor_result_t sensor_manager_get_humidity_cached(float* p_humidity, uint32_t max_age_ms) {
+    sensor_result_t result = ensure_initialized();
+    if (result != SENSOR_OK) return result;
+
+    result = validate_pointer(p_humidity);
+    if (result != SENSOR_OK) return result;
+
+    if (read_snapshot(SENSOR_CHANNEL_HUMIDITY, max_age_ms, p_humidity)) {
+        return SENSOR_OK;
+    }
+
+    // 等待期间异步采集可能刚好刷新了快照，取得锁后再检查一次
+    xSemaphoreTake(s_acq_mutex, portMAX_DELAY);
+    if (read_snapshot(SENSOR_CHANNEL_HUMIDITY, max_age_ms, p_humidity)) {
+        result = SENSOR_OK;
+    } else {
+        result = acquire_humidity(p_humidity);
+    }
+    xSemaphoreGive(s_acq_mutex);
+    return result;
+}
+
+sensor_result_t sensor_manager_get_battery_voltage_cached(float* p_voltage, uint32_t max_age_ms) {
+    sensor_result_t result = ensure_initialized();
+    if (result != SENSOR_OK) return result;
+
+    result = validate_pointer(p_voltage);
+    if (result != SENSOR_OK) return result;
+
+    if (read_snapshot(SENSOR_CHANNEL_BATTERY, max_age_ms, p_voltage)) {
+        return SENSOR_OK;
+    }
+
+    // 等待期间异步采集可能刚好刷新了快照，取得锁后再检查一次
+    xSemaphoreTake(s_acq_mutex, portMAX_DELAY);
+    if (read_snapshot(SENSOR_CHANNEL_BATTERY, max_age_ms, p_voltage)) {
+        result = SENSOR_OK;
+    } else {
+        result = acquire_battery_voltage(p_voltage);
+    }
+    xSemaphoreGive(s_acq_mutex);
+    return result;
+}
+
+sensor_result_t sensor_manager_start_async(sensor_async_cb_t cb, void* ctx) {
+    sensor_result_t result = ensure_initialized();
+    if (result != SENSOR_OK) return result;
+    if (s_async_task_handle == nullptr) return SENSOR_ERROR_NOT_INIT;
+
+    // 已完成但未取回的结果被新的提交覆盖
+    portENTER_CRITICAL(&s_async_mux);
+    if (s_async_state == ASYNC_PENDING) {
+        portEXIT_CRITICAL(&s_async_mux);
+        return SENSOR_ERROR_BUSY;
+    }
+    s_async_state = ASYNC_PENDING;
+    s_async_cb = cb;
+    s_async_ctx = ctx;
+    s_async_start_ms = millis();
+    portEXIT_CRITICAL(&s_async_mux);
+
+    xTaskNotifyGive(s_async_task_handle);
     return SENSOR_OK;
-}
\ No newline at end of file
+}
+
+bool sensor_manager_poll_async(sensor_async_result_t* p_result) {
+    bool done = false;
+    portENTER_CRITICAL(&s_async_mux);
+    if (s_async_state == ASYNC_DONE) {
+        if (p_result != nullptr) {
+            *p_result = s_async_result;
+        }
+        s_async_state = ASYNC_IDLE;
+        done = true;
+    }
+    portEXIT_CRITICAL(&s_async_mux);
+    return done;
+}
+
+bool sensor_manager_async_busy() {
+    return s_async_state == ASYNC_PENDING;
+}
+
+void sensor_manager_invalidate_cache() {
+    portENTER_CRITICAL(&s_snapshot_mux);
+    for (int i = 0; i < SENSOR_CHANNEL_COUNT; i++) {
+        s_snapshot[i].valid = false;
+    }
+    portEXIT_CRITICAL(&s_snapshot_mux);
+}
+
+void sensor_manager_get_cache_stats(sensor_cache_stats_t* p_stats) {
+    if (p_stats == nullptr) return;
+    portENTER_CRITICAL(&s_snapshot_mux);
+    *p_stats = s_cache_stats;
+    portEXIT_CRITICAL(&s_snapshot_mux);
+}
+
+void sensor_manager_reset_cache_stats() {
+    portENTER_CRITICAL(&s_snapshot_mux);
+    memset(&s_cache_stats, 0, sizeof(s_cache_stats));
+    portEXIT_CRITICAL(&s_snapshot_mux);
+}
+
+void sensor_manager_set_warmup_mode(sensor_warmup_mode_t mode) {
+    s_warmup_mode = mode;
+}
+
+void sensor_manager_reset_warmup() {
+    s_learned_settle_ms = 0;
+    persist_settle_time();
+}
+
+void sensor_manager_get_warmup_stats(sensor_warmup_stats_t* p_stats) {
+    if (p_stats == nullptr) return;
+
+    p_stats->mode = s_warmup_mode;
+    p_stats->learned_settle_ms = s_learned_settle_ms;
+    p_stats->last_settle_ms = s_last_settle_ms;
+    p_stats->readings = s_readings;
+    p_stats->settle_timeouts = s_settle_timeouts;
+
+    power_ledger_stats_t ledger;
+    power_ledger_get_stats(&ledger);
+    uint64_t on_ms = ledger.entries[POWER_LEDGER_SENSOR].on_ms;
+    // 账本被清零后从零重新计
+    if (on_ms < s_rail_on_base_ms) s_rail_on_base_ms = 0;
+    p_stats->rail_on_us = (on_ms - s_rail_on_base_ms) * 1000ULL;
+    p_stats->avg_rail_on_us = s_readings > 0 ? (uint32_t)(p_stats->rail_on_us / s_readings) : 0;
+}
+
+void sensor_manager_get_health(sensor_health_t* p_health) {
+    if (p_health == nullptr) return;
+    sensor_health_get(p_health);
+}
+
+uint32_t sensor_manager_get_faults() {
+    return sensor_health_faults();
+}
+
+void sensor_manager_notify_watering() {
+    sensor_health_on_watering((uint32_t)time(nullptr));
+}
+
+void sensor_manager_reset_health() {
+    sensor_health_reset();
+}
@@ -9,6 +9,8 @@
 
 #include <stdint.h>
 #include "data/data_models.h"
+#include "hal/hal_adc.h"
+#include "managers/sensor_health.h"
 
 /**
  * @brief 传感器管理器操作结果枚举
@@ -17,9 +19,67 @@ typedef enum {
     SENSOR_OK = 0,              ///< 操作成功
     SENSOR_ERROR_NOT_INIT,      ///< 管理器未初始化
     SENSOR_ERROR_POWER_FAILED,  ///< 传感器电源操作失败
-    SENSOR_ERROR_READ_FAILED    ///< 传感器读数失败
+    SENSOR_ERROR_READ_FAILED,   ///< 传感器读数失败
+    SENSOR_ERROR_INVALID_PARAM, ///< 无效参数
+    SENSOR_ERROR_BUSY           ///< 上一次异步采集尚未完成
 } sensor_result_t;
 
+/**
+ * @brief 模拟量采集通道
+ */
+typedef enum {
+    SENSOR_CHANNEL_HUMIDITY = 0,  ///< 土壤湿度
+    SENSOR_CHANNEL_BATTERY,       ///< 电池电压
+    SENSOR_CHANNEL_COUNT
+} sensor_channel_t;
+
+/**
+ * @brief 湿度传感器上电预热方式
+ */
+typedef enum {
+    SENSOR_WARMUP_FIXED = 0,   ///< 固定等待 SENSOR_SETTLE_MAX_MS
+    SENSOR_WARMUP_ADAPTIVE     ///< 轮询读数，收敛即开始采集（不超过 SENSOR_SETTLE_MAX_MS）
+} sensor_warmup_mode_t;
+
+/**
+ * @brief 预热与传感器电源统计
+ */
+typedef struct {
+    sensor_warmup_mode_t mode;
+    uint16_t learned_settle_ms;   ///< 学习到的典型稳定时间（保存在NVS，0表示尚未学习）
+    uint16_t last_settle_ms;      ///< 最近一次的稳定时间
+    uint32_t readings;            ///< 湿度读取次数（传感器上电次数）
+    uint32_t settle_timeouts;     ///< 达到上限仍未收敛的次数
+    uint64_t rail_on_us;          ///< 传感器电源累计开启时间，含保持时间 (微秒，取自能耗账本)
+    uint32_t avg_rail_on_us;      ///< 每次读取的平均电源开启时间 (微秒)
+} sensor_warmup_stats_t;
+
+/**
+ * @brief 快照缓存计数（每通道）
+ */
+typedef struct {
+    uint32_t requests[SENSOR_CHANNEL_COUNT];      ///< 读取请求次数（含命中缓存的请求）
+    uint32_t acquisitions[SENSOR_CHANNEL_COUNT];  ///< 实际硬件采集次数
+} sensor_cache_stats_t;
+
+/**
+ * @brief 一次异步采集的结果
+ * @details 两个通道分别报告结果，电池读数异常不影响湿度读数的使用
+ */
+typedef struct {
+    sensor_result_t humidity_result;
+    sensor_result_t battery_result;
+    float humidity;               ///< 湿度ADC截尾均值（humidity_result 为 SENSOR_OK 时有效）
+    float battery_voltage;        ///< 电池电压 (V)（battery_result 为 SENSOR_OK 时有效）
+    uint32_t duration_ms;         ///< 从提交到完成的耗时
+} sensor_async_result_t;
+
+/**
+ * @brief 异步采集完成回调
+ * @details 在采集任务的上下文中调用，不应执行耗时操作
+ */
+typedef void (*sensor_async_cb_t)(const sensor_async_result_t* p_result, void* ctx);
+
 /**
  * @brief 初始化传感器管理器
  * @return sensor_result_t 初始化结果
@@ -36,7 +96,7 @@ sensor_result_t sensor_manager_read_all(sensor_data_t* p_sensor_data);
 
 /**
  * @brief 读取土壤湿度传感器数据
- * @details 这是一个阻塞操作，会打开传感器电源，读取数据，然后关闭电源
+ * @details 这是一个阻塞操作，会打开传感器电源，等待读数稳定后采集，然后关闭电源
  * @param p_humidity 指向用于存储湿度值的指针
  * @return sensor_result_t 操作结果
  */
@@ -50,4 +110,114 @@ sensor_result_t sensor_manager_get_humidity(float* p_humidity);
  */
 sensor_result_t sensor_manager_get_battery_voltage(float* p_voltage);
 
+/**
+ * @brief 读取土壤湿度，允许使用不超过 max_age_ms 的快照
+ * @details 同一周期内的多个使用者共享一次采集；快照过期或不存在时执行一次实际采集
+ * @param p_humidity 指向用于存储湿度值的指针
+ * @param max_age_ms 可接受的快照最大年龄 (毫秒)
+ * @return sensor_result_t 操作结果
+ */
+sensor_result_t sensor_manager_get_humidity_cached(float* p_humidity, uint32_t max_age_ms);
+
+/**
+ * @brief 读取电池电压，允许使用不超过 max_age_ms 的快照
+ * @param p_voltage 指向用于存储电压值的指针
+ * @param max_age_ms 可接受的快照最大年龄 (毫秒)
+ * @return sensor_result_t 操作结果
+ */
+sensor_result_t sensor_manager_get_battery_voltage_cached(float* p_voltage, uint32_t max_age_ms);
+
+/**
+ * @brief 使快照失效（如浇水后需要重新采集湿度）
+ */
+void sensor_manager_invalidate_cache();
+
+/**
+ * @brief 获取快照缓存计数
+ */
+void sensor_manager_get_cache_stats(sensor_cache_stats_t* p_stats);
+
+/**
+ * @brief 清零快照缓存计数
+ */
+void sensor_manager_reset_cache_stats();
+
+/**
+ * @brief 提交一次异步采集（湿度 + 电池电压）
+ * @details 采集在独立的 FreeRTOS 任务中进行，调用立即返回；传感器预热期间主循环不被阻塞。
+ *          完成后结果写入快照缓存，可通过 sensor_manager_poll_async() 取回，
+ *          或由回调在采集任务中接收。同一时刻只允许一次异步采集。
+ * @param cb 完成回调（可为NULL）
+ * @param ctx 回调参数
+ * @return SENSOR_OK 已提交, SENSOR_ERROR_BUSY 上一次尚未完成
+ */
+sensor_result_t sensor_manager_start_async(sensor_async_cb_t cb, void* ctx);
+
+/**
+ * @brief 查询异步采集是否完成，完成时取回结果
+ * @param p_result 输出结果（可为NULL，仅确认完成）
+ * @return true 已完成（结果只能取回一次）, false 进行中或未提交
+ */
+bool sensor_manager_poll_async(sensor_async_result_t* p_result);
+
+/**
+ * @brief 是否有异步采集正在进行
+ */
+bool sensor_manager_async_busy();
+
+/**
+ * @brief 设置通道的多样本采集配置（样本数、剔除策略等）
+ * @param channel 采集通道
+ * @param p_config 采集配置
+ * @return sensor_result_t 操作结果
+ */
+sensor_result_t sensor_manager_set_sampling(sensor_channel_t channel, const hal_adc_sample_config_t* p_config);
+
+/**
+ * @brief 获取通道当前的采集配置
+ */
+void sensor_manager_get_sampling(sensor_channel_t channel, hal_adc_sample_config_t* p_config);
+
+/**
+ * @brief 获取通道最近一次采集的统计结果（中位数、方差、耗时等）
+ * @return true 有数据, false 尚未采集
+ */
+bool sensor_manager_get_last_stats(sensor_channel_t channel, hal_adc_stats_t* p_stats);
+
+/**
+ * @brief 设置湿度传感器预热方式
+ */
+void sensor_manager_set_warmup_mode(sensor_warmup_mode_t mode);
+
+/**
+ * @brief 清除学习到的稳定时间（包括NVS中的记录）
+ */
+void sensor_manager_reset_warmup();
+
+/**
+ * @brief 获取预热与传感器电源统计
+ */
+void sensor_manager_get_warmup_stats(sensor_warmup_stats_t* p_stats);
+
+/**
+ * @brief 获取湿度传感器健康状态
+ * @details 每次湿度采集后增量更新（见 sensor_health.h）
+ */
+void sensor_manager_get_health(sensor_health_t* p_health);
+
+/**
+ * @brief 获取当前传感器故障位掩码 (sensor_fault_t)
+ */
+uint32_t sensor_manager_get_faults();
+
+/**
+ * @brief 通知已开始浇水，健康监测据此检查读数是否响应
+ */
+void sensor_manager_notify_watering();
+
+/**
+ * @brief 清除健康监测状态与故障
+ */
+void sensor_manager_reset_health();
+
 #endif // SENSOR_MANAGER_H
\ No newline at end of file
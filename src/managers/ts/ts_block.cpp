@@ -0,0 +1,177 @@
+/**
+ * @file ts_block.cpp
+ * @brief 时间序列定长块编解码实现
+ */
+
+#include "ts_block.h"
+#include <string.h>
+#include <stddef.h>
+#include "esp_crc.h"
+
+static_assert(sizeof(ts_block_header_t) == TS_BLOCK_HEADER_SIZE, "block header must be 28 bytes");
+static_assert(sizeof(ts_block_t) == TS_BLOCK_SIZE, "block must be TS_BLOCK_SIZE bytes");
+
+#define PAYLOAD_BITS (TS_BLOCK_PAYLOAD_SIZE * 8)
+
+static const uint8_t DOD_WIDTHS[3] = {7, 9, 12};
+static const uint8_t VALUE_WIDTHS[3] = {4, 8, 12};
+
+static inline uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t z) {
+    return (int32_t)(z >> 1) ^ -(int32_t)(z & 1);
+}
+
+// 编码 z 所需的位数（前缀 + 数据）
+static uint8_t code_bits(uint32_t z, const uint8_t* widths) {
+    if (z == 0) return 1;
+    for (uint8_t i = 0; i < 3; i++) {
+        if (z < (1UL << widths[i])) return (uint8_t)(i + 2 + widths[i]);
+    }
+    return 4 + 32;
+}
+
+static void put_bits(ts_block_t* block, uint32_t value, uint8_t bits) {
+    uint16_t pos = block->header.bits;
+    for (int8_t i = bits - 1; i >= 0; i--, pos++) {
+        if ((value >> i) & 1) {
+            block->payload[pos >> 3] |= (uint8_t)(0x80 >> (pos & 7));
+        }
+    }
+    block->header.bits = pos;
+}
+
+static void put_code(ts_block_t* block, uint32_t z, const uint8_t* widths) {
+    if (z == 0) {
+        put_bits(block, 0, 1);
+        return;
+    }
+    for (uint8_t i = 0; i < 3; i++) {
+        if (z < (1UL << widths[i])) {
+            put_bits(block, (1UL << (i + 2)) - 2, (uint8_t)(i + 2));  // 10 / 110 / 1110
+            put_bits(block, z, widths[i]);
+            return;
+        }
+    }
+    put_bits(block, 0xF, 4);
+    put_bits(block, z, 32);
+}
+
+void ts_block_start(ts_block_writer_t* writer, uint8_t series, uint32_t ts, int32_t value) {
+    memset(writer, 0, sizeof(*writer));
+    ts_block_header_t* header = &writer->block.header;
+    header->magic = TS_BLOCK_MAGIC;
+    header->series = series;
+    header->version = TS_BLOCK_VERSION;
+    header->count = 1;
+    header->t_first = ts;
+    header->t_last = ts;
+    header->v_first = value;
+    writer->prev_ts = ts;
+    writer->prev_value = value;
+}
+
+bool ts_block_append(ts_block_writer_t* writer, uint32_t ts, int32_t value) {
+    ts_block_t* block = &writer->block;
+    if (ts < writer->prev_ts || block->header.count == UINT16_MAX) return false;
+
+    int32_t delta = (int32_t)(ts - writer->prev_ts);
+    uint32_t z_time = zigzag(delta - writer->prev_delta);
+    uint32_t z_value = zigzag((int32_t)((uint32_t)value - (uint32_t)writer->prev_value));
+
+    uint16_t need = code_bits(z_time, DOD_WIDTHS) + code_bits(z_value, VALUE_WIDTHS);
+    if (block->header.bits + need > PAYLOAD_BITS) return false;
+
+    put_code(block, z_time, DOD_WIDTHS);
+    put_code(block, z_value, VALUE_WIDTHS);
+
+    block->header.count++;
+    block->header.t_last = ts;
+    writer->prev_ts = ts;
+    writer->prev_delta = delta;
+    writer->prev_value = value;
+    return true;
+}
+
+static uint32_t block_crc(const ts_block_t* block) {
+    uint32_t crc = esp_crc32_le(0, (const uint8_t*)&block->header, offsetof(ts_block_header_t, crc));
+    return esp_crc32_le(crc, block->payload, (block->header.bits + 7) / 8);
+}
+
+void ts_block_seal(ts_block_t* block, uint32_t seq) {
+    block->header.seq = seq;
+    block->header.crc = block_crc(block);
+}
+
+bool ts_block_valid(const ts_block_t* block) {
+    const ts_block_header_t* header = &block->header;
+    return header->magic == TS_BLOCK_MAGIC &&
+           header->version == TS_BLOCK_VERSION &&
+           header->count > 0 &&
+           header->bits <= PAYLOAD_BITS &&
+           header->crc == block_crc(block);
+}
+
+size_t ts_block_used_bytes(const ts_block_t* block) {
+    return TS_BLOCK_HEADER_SIZE + (block->header.bits + 7) / 8;
+}
+
+// --- 解码 ---
+
+static bool get_bits(ts_block_reader_t* reader, uint8_t bits, uint32_t* p_value) {
+    if (reader->bit_pos + bits > reader->block->header.bits) return false;
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < bits; i++, reader->bit_pos++) {
+        uint8_t byte = reader->block->payload[reader->bit_pos >> 3];
+        value = (value << 1) | ((byte >> (7 - (reader->bit_pos & 7))) & 1);
+    }
+    *p_value = value;
+    return true;
+}
+
+static bool get_code(ts_block_reader_t* reader, const uint8_t* widths, uint32_t* p_z) {
+    uint8_t ones = 0;
+    uint32_t bit = 0;
+    while (ones < 4) {
+        if (!get_bits(reader, 1, &bit)) return false;
+        if (bit == 0) break;
+        ones++;
+    }
+    if (ones == 0) {
+        *p_z = 0;
+        return true;
+    }
+    return get_bits(reader, ones < 4 ? widths[ones - 1] : 32, p_z);
+}
+
+void ts_block_reader_init(ts_block_reader_t* reader, const ts_block_t* block) {
+    memset(reader, 0, sizeof(*reader));
+    reader->block = block;
+}
+
+bool ts_block_next(ts_block_reader_t* reader, uint32_t* p_ts, int32_t* p_value) {
+    const ts_block_header_t* header = &reader->block->header;
+    if (reader->index >= header->count) return false;
+
+    if (reader->index == 0) {
+        reader->ts = header->t_first;
+        reader->value = header->v_first;
+    } else {
+        uint32_t z_time = 0;
+        uint32_t z_value = 0;
+        if (!get_code(reader, DOD_WIDTHS, &z_time) || !get_code(reader, VALUE_WIDTHS, &z_value)) {
+            reader->index = header->count;  // 位流损坏，停止读取
+            return false;
+        }
+        reader->delta += unzigzag(z_time);
+        reader->ts += (uint32_t)reader->delta;
+        reader->value = (int32_t)((uint32_t)reader->value + (uint32_t)unzigzag(z_value));
+    }
+
+    reader->index++;
+    *p_ts = reader->ts;
+    *p_value = reader->value;
+    return true;
+}
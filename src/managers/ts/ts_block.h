@@ -0,0 +1,117 @@
+/**
+ * @file ts_block.h
+ * @brief 时间序列定长块编解码（时间戳二阶差分 + 数值一阶差分）
+ * @details
+ *   每个块固定 TS_BLOCK_SIZE 字节，只保存一条序列的连续样本：
+ *   - 块头 28 字节: magic, 序列号, 版本, 样本数, 有效位数, 块序号, 首/末时间戳, 首个数值, CRC32
+ *   - 首个样本保存在块头中，之后每个样本依次写入位流（高位在前）:
+ *     时间戳写二阶差分 dod = (t[i] - t[i-1]) - (t[i-1] - t[i-2])，数值写一阶差分 v[i] - v[i-1]。
+ *
+ *   差分先做 zigzag 映射为无符号数 z，再按变长前缀编码:
+ *   - 0                  : z == 0
+ *   - 10   + widths[0]位 : z <  2^widths[0]
+ *   - 110  + widths[1]位 : z <  2^widths[1]
+ *   - 1110 + widths[2]位 : z <  2^widths[2]
+ *   - 1111 + 32位        : 其他
+ *   时间戳位宽 {7, 9, 12}，数值位宽 {4, 8, 12}。固定采样周期的时间戳每个只占1位，
+ *   缓慢变化的ADC读数通常为6~12位。
+ *
+ *   块内时间戳必须单调不减；数值按32位环绕运算，任意 int32 均可无损还原。
+ */
+
+#ifndef TS_BLOCK_H
+#define TS_BLOCK_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define TS_BLOCK_SIZE         512
+#define TS_BLOCK_HEADER_SIZE  28
+#define TS_BLOCK_PAYLOAD_SIZE (TS_BLOCK_SIZE - TS_BLOCK_HEADER_SIZE)
+#define TS_BLOCK_MAGIC        0x5354    // "TS"
+#define TS_BLOCK_VERSION      1
+
+/**
+ * @brief 块头（与闪存中的布局一致）
+ */
+typedef struct {
+    uint16_t magic;
+    uint8_t series;      ///< 序列编号
+    uint8_t version;
+    uint16_t count;      ///< 样本数（含块头中的首个样本）
+    uint16_t bits;       ///< 位流有效位数
+    uint32_t seq;        ///< 块序号（写入闪存时分配，单调递增）
+    uint32_t t_first;    ///< 首个样本时间戳
+    uint32_t t_last;     ///< 最后一个样本时间戳
+    int32_t v_first;     ///< 首个样本数值
+    uint32_t crc;        ///< 块头（不含本字段）与位流的 CRC32
+} ts_block_header_t;
+
+/**
+ * @brief 一个完整的块
+ */
+typedef struct {
+    ts_block_header_t header;
+    uint8_t payload[TS_BLOCK_PAYLOAD_SIZE];
+} ts_block_t;
+
+/**
+ * @brief 块编码器（追加写入的尾块）
+ */
+typedef struct {
+    ts_block_t block;
+    uint32_t prev_ts;
+    int32_t prev_delta;
+    int32_t prev_value;
+} ts_block_writer_t;
+
+/**
+ * @brief 块解码器
+ */
+typedef struct {
+    const ts_block_t* block;
+    uint16_t index;      ///< 已读出的样本数
+    uint16_t bit_pos;
+    uint32_t ts;
+    int32_t delta;
+    int32_t value;
+} ts_block_reader_t;
+
+/**
+ * @brief 以第一个样本开始一个新块
+ */
+void ts_block_start(ts_block_writer_t* writer, uint8_t series, uint32_t ts, int32_t value);
+
+/**
+ * @brief 追加一个样本
+ * @return true 成功, false 块已满或时间戳倒退（调用者应封存当前块并开始新块）
+ */
+bool ts_block_append(ts_block_writer_t* writer, uint32_t ts, int32_t value);
+
+/**
+ * @brief 封存块：写入块序号并计算 CRC，之后块内容不再改变
+ */
+void ts_block_seal(ts_block_t* block, uint32_t seq);
+
+/**
+ * @brief 校验块头与 CRC
+ */
+bool ts_block_valid(const ts_block_t* block);
+
+/**
+ * @brief 块实际占用的字节数（块头 + 位流）
+ */
+size_t ts_block_used_bytes(const ts_block_t* block);
+
+/**
+ * @brief 初始化解码器
+ */
+void ts_block_reader_init(ts_block_reader_t* reader, const ts_block_t* block);
+
+/**
+ * @brief 读出下一个样本
+ * @return true 成功, false 已读完或位流损坏
+ */
+bool ts_block_next(ts_block_reader_t* reader, uint32_t* p_ts, int32_t* p_value);
+
+#endif // TS_BLOCK_H
@@ -0,0 +1,269 @@
+/**
+ * @file ts_rollup.cpp
+ * @brief 时间序列多分辨率汇总实现
+ */
+
+#include "ts_rollup.h"
+#include <string.h>
+#include <stdlib.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#define ROLLUP_TIERS 2   // 1小时层与1天层（不含原始层）
+
+// 桶：和用 int32 足够（4095 × 每天 17280 个5秒样本 ≈ 7e7）
+typedef struct {
+    int32_t min;
+    int32_t max;
+    int32_t sum;
+    uint32_t count;
+} bucket_t;
+
+// 环形桶数组；槽位 = (桶起始时间 / span) % len，head 为最新桶的起始时间
+typedef struct {
+    bucket_t* buckets;
+    uint16_t len;
+    uint32_t span;
+    uint32_t head_start;
+    bool has_head;
+} ring_t;
+
+static const uint32_t TIER_SPANS[TS_TIER_COUNT] = {0, 3600, 86400};
+static const uint16_t TIER_LENGTHS[TS_TIER_COUNT] = {0, TS_ROLLUP_HOUR_BUCKETS, TS_ROLLUP_DAY_BUCKETS};
+static const char* const TIER_NAMES[TS_TIER_COUNT] = {"raw", "hour", "day"};
+
+static ring_t s_rings[TS_ROLLUP_SERIES_COUNT][ROLLUP_TIERS];
+static SemaphoreHandle_t s_mutex = NULL;
+static bool s_ready = false;
+
+// --- 环形桶 ---
+
+static inline ring_t* ring_of(ts_series_t series, ts_tier_t tier) {
+    return &s_rings[series][tier - TS_TIER_HOUR];
+}
+
+static inline bucket_t* slot_of(ring_t* ring, uint32_t start) {
+    return &ring->buckets[(start / ring->span) % ring->len];
+}
+
+static inline uint32_t oldest_start(const ring_t* ring) {
+    uint32_t reach = (uint32_t)(ring->len - 1) * ring->span;
+    return ring->head_start > reach ? ring->head_start - reach : 0;
+}
+
+static void ring_clear(ring_t* ring) {
+    memset(ring->buckets, 0, sizeof(bucket_t) * ring->len);
+    ring->has_head = false;
+    ring->head_start = 0;
+}
+
+static void ring_add(ring_t* ring, uint32_t ts, int32_t value) {
+    uint32_t start = ts - ts % ring->span;
+
+    if (!ring->has_head) {
+        ring->head_start = start;
+        ring->has_head = true;
+    } else if (start > ring->head_start) {
+        // 新桶：清空跳过的桶（超过一圈时全部清空）
+        uint32_t steps = (start - ring->head_start) / ring->span;
+        if (steps >= ring->len) {
+            memset(ring->buckets, 0, sizeof(bucket_t) * ring->len);
+        } else {
+            for (uint32_t k = 1; k <= steps; k++) {
+                memset(slot_of(ring, ring->head_start + k * ring->span), 0, sizeof(bucket_t));
+            }
+        }
+        ring->head_start = start;
+    } else if (start < oldest_start(ring)) {
+        return;   // 早于保留期（系统时间回拨）
+    }
+
+    bucket_t* bucket = slot_of(ring, start);
+    if (bucket->count == 0) {
+        bucket->min = value;
+        bucket->max = value;
+    } else {
+        if (value < bucket->min) bucket->min = value;
+        if (value > bucket->max) bucket->max = value;
+    }
+    bucket->sum += value;
+    bucket->count++;
+}
+
+static inline bool ring_covers(const ring_t* ring, uint32_t t_from) {
+    return !ring->has_head || t_from >= oldest_start(ring);
+}
+
+// --- 列合并 ---
+
+typedef struct {
+    ts_rollup_point_t* out;
+    uint16_t width;
+    uint32_t t_from;
+    uint32_t col_span;
+} column_ctx_t;
+
+static void merge_column(ts_rollup_point_t* point, int32_t min, int32_t max, float sum, uint32_t count) {
+    if (point->count == 0) {
+        point->min = min;
+        point->max = max;
+    } else {
+        if (min < point->min) point->min = min;
+        if (max > point->max) point->max = max;
+    }
+    // 先累加和，查询结束后再换算为均值
+    point->mean += sum;
+    point->count += count;
+}
+
+static inline uint16_t column_of(const column_ctx_t* ctx, uint32_t ts) {
+    uint32_t col = ts < ctx->t_from ? 0 : (ts - ctx->t_from) / ctx->col_span;
+    return (uint16_t)(col < ctx->width ? col : ctx->width - 1);
+}
+
+static bool raw_visit(uint32_t ts, int32_t value, void* arg) {
+    column_ctx_t* ctx = (column_ctx_t*)arg;
+    merge_column(&ctx->out[column_of(ctx, ts)], value, value, (float)value, 1);
+    return true;
+}
+
+static bool rebuild_visit(uint32_t ts, int32_t value, void* arg) {
+    ts_rollup_add((ts_series_t)(uintptr_t)arg, ts, value);
+    return true;
+}
+
+// --- Public API ---
+
+bool ts_rollup_init() {
+    if (s_mutex == NULL) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (s_mutex == NULL) return false;
+    }
+
+    for (uint8_t series = 0; series < TS_ROLLUP_SERIES_COUNT; series++) {
+        for (uint8_t tier = TS_TIER_HOUR; tier < TS_TIER_COUNT; tier++) {
+            ring_t* ring = ring_of((ts_series_t)series, (ts_tier_t)tier);
+            if (ring->buckets == NULL) {
+                ring->buckets = (bucket_t*)calloc(TIER_LENGTHS[tier], sizeof(bucket_t));
+                if (ring->buckets == NULL) return false;
+            }
+            ring->len = TIER_LENGTHS[tier];
+            ring->span = TIER_SPANS[tier];
+            ring_clear(ring);
+        }
+    }
+    s_ready = true;
+
+    // 从闪存中的原始样本重建（查询回调在存储锁内调用 ts_rollup_add，锁顺序与追加时一致）
+    for (uint8_t series = 0; series < TS_ROLLUP_SERIES_COUNT; series++) {
+        ts_store_query((ts_series_t)series, 0, UINT32_MAX, rebuild_visit, (void*)(uintptr_t)series);
+    }
+    return true;
+}
+
+void ts_rollup_add(ts_series_t series, uint32_t ts, int32_t value) {
+    if (!s_ready || series >= TS_ROLLUP_SERIES_COUNT) return;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    for (uint8_t tier = TS_TIER_HOUR; tier < TS_TIER_COUNT; tier++) {
+        ring_add(ring_of(series, (ts_tier_t)tier), ts, value);
+    }
+    xSemaphoreGive(s_mutex);
+}
+
+void ts_rollup_reset() {
+    if (!s_ready) return;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    for (uint8_t series = 0; series < TS_ROLLUP_SERIES_COUNT; series++) {
+        for (uint8_t tier = TS_TIER_HOUR; tier < TS_TIER_COUNT; tier++) {
+            ring_clear(ring_of((ts_series_t)series, (ts_tier_t)tier));
+        }
+    }
+    xSemaphoreGive(s_mutex);
+}
+
+uint32_t ts_rollup_tier_span(ts_tier_t tier) {
+    return tier < TS_TIER_COUNT ? TIER_SPANS[tier] : 0;
+}
+
+const char* ts_rollup_tier_name(ts_tier_t tier) {
+    return tier < TS_TIER_COUNT ? TIER_NAMES[tier] : "auto";
+}
+
+ts_tier_t ts_rollup_pick_tier(ts_series_t series, uint32_t t_from, uint32_t t_to, uint16_t width) {
+    if (!s_ready && ts_store_is_mounted()) {
+        ts_rollup_init();
+    }
+    if (!s_ready || series >= TS_ROLLUP_SERIES_COUNT || width == 0 || t_from > t_to) {
+        return TS_TIER_RAW;
+    }
+
+    uint64_t col_span = ((uint64_t)t_to - t_from + 1) / width;
+    ts_tier_t tier = TS_TIER_RAW;
+    for (uint8_t t = TS_TIER_HOUR; t < TS_TIER_COUNT; t++) {
+        if (TIER_SPANS[t] <= col_span) tier = (ts_tier_t)t;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (tier == TS_TIER_HOUR && !ring_covers(ring_of(series, TS_TIER_HOUR), t_from)) {
+        tier = ring_covers(ring_of(series, TS_TIER_DAY), t_from) ? TS_TIER_DAY : TS_TIER_RAW;
+    } else if (tier == TS_TIER_DAY && !ring_covers(ring_of(series, TS_TIER_DAY), t_from)) {
+        tier = TS_TIER_RAW;
+    }
+    xSemaphoreGive(s_mutex);
+    return tier;
+}
+
+uint16_t ts_rollup_query(ts_series_t series, uint32_t t_from, uint32_t t_to, uint16_t width,
+                         ts_tier_t tier, ts_rollup_point_t* out, ts_tier_t* p_used_tier) {
+    if (out == NULL || width == 0 || t_from > t_to || series >= TS_SERIES_COUNT) return 0;
+
+    if (tier == TS_TIER_AUTO) {
+        tier = ts_rollup_pick_tier(series, t_from, t_to, width);
+    } else if (tier != TS_TIER_RAW && !s_ready && ts_store_is_mounted()) {
+        ts_rollup_init();
+    }
+    if (tier >= TS_TIER_COUNT || (tier != TS_TIER_RAW && (!s_ready || series >= TS_ROLLUP_SERIES_COUNT))) {
+        tier = TS_TIER_RAW;
+    }
+    if (p_used_tier != NULL) *p_used_tier = tier;
+
+    column_ctx_t ctx;
+    ctx.out = out;
+    ctx.width = width;
+    ctx.t_from = t_from;
+    ctx.col_span = (uint32_t)((((uint64_t)t_to - t_from + 1) + width - 1) / width);
+    for (uint16_t i = 0; i < width; i++) {
+        memset(&out[i], 0, sizeof(out[i]));
+        out[i].start = t_from + (uint32_t)i * ctx.col_span;
+    }
+
+    if (tier == TS_TIER_RAW) {
+        ts_store_query(series, t_from, t_to, raw_visit, &ctx);
+    } else {
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        ring_t* ring = ring_of(series, tier);
+        if (ring->has_head) {
+            uint32_t first = t_from - t_from % ring->span;
+            if (first < oldest_start(ring)) first = oldest_start(ring);
+            uint32_t last = t_to < ring->head_start ? t_to : ring->head_start;
+            for (uint64_t start = first; start <= last; start += ring->span) {
+                const bucket_t* bucket = slot_of(ring, (uint32_t)start);
+                if (bucket->count == 0) continue;
+                merge_column(&out[column_of(&ctx, (uint32_t)start)], bucket->min, bucket->max,
+                             (float)bucket->sum, bucket->count);
+            }
+        }
+        xSemaphoreGive(s_mutex);
+    }
+
+    uint16_t filled = 0;
+    for (uint16_t i = 0; i < width; i++) {
+        if (out[i].count > 0) {
+            out[i].mean /= out[i].count;
+            filled++;
+        }
+    }
+    return filled;
+}
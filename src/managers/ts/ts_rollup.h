@@ -0,0 +1,94 @@
+/**
+ * @file ts_rollup.h
+ * @brief 时间序列多分辨率汇总（1小时 / 1天，最小值 / 最大值 / 均值 / 样本数）
+ * @details
+ *   每个汇总层是内存中的环形桶数组，桶按 Unix 时间对齐。ts_store_append() 每追加一个样本
+ *   就更新各层当前桶，开销为 O(1)（跨越空档时清空中间的桶，均摊仍为 O(1)）。
+ *   首次查询时从闪存中的原始样本重建汇总，不单独持久化（RUN 模式的短暂唤醒不需要汇总，
+ *   推迟重建省去每次启动解码全部样本的时间和约45KB堆内存）；重建之前追加的样本由重建覆盖。
+ *
+ *   查询时按目标像素宽度选择层：每列跨度 = 时间范围 / 宽度，选桶长不超过列跨度的
+ *   最粗一层；该层保留期不足以覆盖起点时改用更粗的层，都不满足时退回原始样本。
+ *   选中层的桶再合并为 width 列输出。
+ *
+ *   只对数值序列（湿度、电池电压）汇总；事件序列的查询始终使用原始样本。
+ */
+
+#ifndef TS_ROLLUP_H
+#define TS_ROLLUP_H
+
+#include <stdint.h>
+#include "ts_store.h"
+
+#define TS_ROLLUP_SERIES_COUNT 2          // 汇总前两个序列：TS_SERIES_HUMIDITY, TS_SERIES_BATTERY_MV
+#define TS_ROLLUP_HOUR_BUCKETS (31 * 24)  // 1小时层保留31天
+#define TS_ROLLUP_DAY_BUCKETS  400        // 1天层保留400天
+
+/**
+ * @brief 数据层
+ */
+typedef enum {
+    TS_TIER_RAW = 0,   ///< 原始样本
+    TS_TIER_HOUR,      ///< 1小时桶
+    TS_TIER_DAY,       ///< 1天桶
+    TS_TIER_COUNT,
+    TS_TIER_AUTO = 0xFF
+} ts_tier_t;
+
+/**
+ * @brief 一列（或一个桶）的汇总值
+ */
+typedef struct {
+    uint32_t start;    ///< 列起始时间
+    int32_t min;
+    int32_t max;
+    float mean;
+    uint32_t count;    ///< 样本数（0表示该列无数据）
+} ts_rollup_point_t;
+
+/**
+ * @brief 分配汇总缓冲区并从存储重建（首次查询时自动调用）
+ * @return true 成功, false 内存不足
+ */
+bool ts_rollup_init();
+
+/**
+ * @brief 追加一个样本到各汇总层（ts_store_append 内部调用）
+ */
+void ts_rollup_add(ts_series_t series, uint32_t ts, int32_t value);
+
+/**
+ * @brief 清空全部汇总
+ */
+void ts_rollup_reset();
+
+/**
+ * @brief 层的桶长度 (秒)；原始层返回0
+ */
+uint32_t ts_rollup_tier_span(ts_tier_t tier);
+
+/**
+ * @brief 层名称
+ */
+const char* ts_rollup_tier_name(ts_tier_t tier);
+
+/**
+ * @brief 为时间范围和像素宽度选择数据层
+ */
+ts_tier_t ts_rollup_pick_tier(ts_series_t series, uint32_t t_from, uint32_t t_to, uint16_t width);
+
+/**
+ * @brief 按像素宽度查询汇总
+ * @param series 序列
+ * @param t_from 起始时间（含）
+ * @param t_to 结束时间（含）
+ * @param width 列数（输出数组长度）
+ * @param tier 数据层；TS_TIER_AUTO 自动选择
+ * @param out 输出数组，长度不小于 width
+ * @param p_used_tier 实际使用的层（可为NULL）
+ * @return 有数据的列数
+ */
+uint16_t ts_rollup_query(ts_series_t series, uint32_t t_from, uint32_t t_to, uint16_t width,
+                         ts_tier_t tier, ts_rollup_point_t* out, ts_tier_t* p_used_tier);
+
+#endif // TS_ROLLUP_H
@@ -0,0 +1,393 @@
+/**
+ * @file ts_store.cpp
+ * @brief 传感器时间序列存储实现
+ */
+
+#include "ts_store.h"
+#include "ts_block.h"
+#include "ts_rollup.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <time.h>
+#include "esp_partition.h"
+#include "esp_attr.h"
+#include "esp_crc.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#define BLOCKS_PER_SECTOR (TS_STORE_SECTOR_SIZE / TS_BLOCK_SIZE)
+#define HEADER_ERASED     0xFFFF
+#define ALIGN4(x)         (((x) + 3) & ~(uint32_t)3)
+#define RTC_TAILS_MAGIC   0x54535441  // "TSTA"
+
+typedef enum {
+    BLOCK_EMPTY = 0,   // 擦除态，可写入
+    BLOCK_VALID,
+    BLOCK_CORRUPT      // 已写入但校验失败（掉电中断的写入），等待随扇区擦除
+} block_state_t;
+
+// 块索引（常驻内存，每块16字节）
+typedef struct {
+    uint32_t t_first;
+    uint32_t t_last;
+    uint16_t count;
+    uint16_t bytes;
+    uint8_t series;
+    uint8_t state;
+} block_index_t;
+
+static const char* const SERIES_NAMES[TS_SERIES_COUNT] = {
+    "humidity", "battery_mv", "pump", "refresh"
+};
+
+static const esp_partition_t* s_partition = NULL;
+static SemaphoreHandle_t s_mutex = NULL;
+static bool s_mounted = false;
+static block_index_t* s_index = NULL;
+static uint16_t s_block_count = 0;
+static uint16_t s_next_block = 0;   // 下一个写入位置；从这里循环向后即为从旧到新
+static uint32_t s_next_seq = 0;
+
+// 各序列的内存尾块
+static ts_block_writer_t s_tails[TS_SERIES_COUNT];
+static bool s_tail_active[TS_SERIES_COUNT] = {false};
+
+// 深度睡眠前的尾块副本（RTC 慢速内存，约2KB），唤醒后挂载时恢复
+typedef struct {
+    uint32_t magic;
+    ts_block_writer_t tails[TS_SERIES_COUNT];
+    bool active[TS_SERIES_COUNT];
+    uint32_t crc;
+} rtc_tails_t;
+
+RTC_DATA_ATTR static rtc_tails_t s_rtc_tails;
+
+// 统计
+static uint32_t s_samples_appended = 0;
+static uint32_t s_blocks_written = 0;
+static uint32_t s_sectors_erased = 0;
+static uint32_t s_corrupt_blocks = 0;
+
+// --- 块操作 ---
+
+static inline uint32_t block_addr(uint16_t block) {
+    return (uint32_t)block * TS_BLOCK_SIZE;
+}
+
+static void index_block(uint16_t block, const ts_block_t* data) {
+    block_index_t* entry = &s_index[block];
+    entry->state = BLOCK_VALID;
+    entry->series = data->header.series;
+    entry->count = data->header.count;
+    entry->bytes = (uint16_t)ts_block_used_bytes(data);
+    entry->t_first = data->header.t_first;
+    entry->t_last = data->header.t_last;
+}
+
+static bool erase_sector_of(uint16_t block) {
+    uint16_t first = block - block % BLOCKS_PER_SECTOR;
+    s_sectors_erased++;
+    for (uint16_t i = first; i < first + BLOCKS_PER_SECTOR && i < s_block_count; i++) {
+        memset(&s_index[i], 0, sizeof(block_index_t));
+    }
+    return esp_partition_erase_range(s_partition, block_addr(first), TS_STORE_SECTOR_SIZE) == ESP_OK;
+}
+
+/**
+ * @brief 确定下一个可写块（调用者持有互斥锁）
+ * @details 到达扇区起点时擦除整个扇区（淘汰其中最老的块）；扇区内跳过掉电遗留的损坏块
+ */
+static bool prepare_next_block() {
+    for (uint16_t tries = 0; tries < s_block_count; tries++) {
+        if (s_next_block % BLOCKS_PER_SECTOR == 0) {
+            return erase_sector_of(s_next_block);
+        }
+        if (s_index[s_next_block].state == BLOCK_EMPTY) {
+            return true;
+        }
+        s_next_block = (uint16_t)((s_next_block + 1) % s_block_count);
+    }
+    return false;
+}
+
+/**
+ * @brief 封存尾块并写入分区（调用者持有互斥锁）
+ */
+static bool write_tail(uint8_t series) {
+    if (!s_tail_active[series]) return true;
+    s_tail_active[series] = false;
+
+    if (!prepare_next_block()) return false;
+
+    ts_block_t* block = &s_tails[series].block;
+    ts_block_seal(block, s_next_seq++);
+    uint16_t block_no = s_next_block;
+    uint32_t len = ALIGN4(ts_block_used_bytes(block));
+    bool ok = esp_partition_write(s_partition, block_addr(block_no), block, len) == ESP_OK;
+
+    // 写入失败时同样跳过该块，避免在未擦除的位置重复写入
+    if (ok) {
+        index_block(block_no, block);
+        s_blocks_written++;
+    } else {
+        s_index[block_no].state = BLOCK_CORRUPT;
+    }
+    s_next_block = (uint16_t)((block_no + 1) % s_block_count);
+    return ok;
+}
+
+/**
+ * @brief 扫描全部块建立索引并确定写入位置（调用者持有互斥锁）
+ */
+static bool mount_locked() {
+    static ts_block_t block;   // 只在挂载时使用，避免占用任务栈
+    bool found = false;
+    uint32_t newest_seq = 0;
+    uint16_t newest_block = 0;
+
+    for (uint16_t b = 0; b < s_block_count; b++) {
+        block_index_t* entry = &s_index[b];
+        memset(entry, 0, sizeof(*entry));
+
+        if (esp_partition_read(s_partition, block_addr(b), &block.header, sizeof(block.header)) != ESP_OK) {
+            return false;
+        }
+        if (block.header.magic == HEADER_ERASED) {
+            continue;
+        }
+
+        uint32_t payload_len = block.header.bits <= TS_BLOCK_PAYLOAD_SIZE * 8 ? (block.header.bits + 7) / 8 : 0;
+        bool ok = payload_len == 0 ||
+                  esp_partition_read(s_partition, block_addr(b) + TS_BLOCK_HEADER_SIZE,
+                                     block.payload, payload_len) == ESP_OK;
+        if (ok && ts_block_valid(&block)) {
+            index_block(b, &block);
+            if (!found || (int32_t)(block.header.seq - newest_seq) > 0) {
+                found = true;
+                newest_seq = block.header.seq;
+                newest_block = b;
+            }
+        } else {
+            entry->state = BLOCK_CORRUPT;
+            s_corrupt_blocks++;
+        }
+    }
+
+    if (found) {
+        s_next_block = (uint16_t)((newest_block + 1) % s_block_count);
+        s_next_seq = newest_seq + 1;
+    } else {
+        s_next_block = 0;
+        s_next_seq = 0;
+    }
+    return true;
+}
+
+static uint32_t rtc_tails_crc() {
+    return esp_crc32_le(0, (const uint8_t*)&s_rtc_tails, offsetof(rtc_tails_t, crc));
+}
+
+/**
+ * @brief 恢复 ts_store_suspend() 保存的尾块
+ * @details 副本只使用一次：恢复后立即作废，避免之后的复位把已封存的样本再恢复一遍
+ */
+static void restore_tails_locked() {
+    if (s_rtc_tails.magic != RTC_TAILS_MAGIC || s_rtc_tails.crc != rtc_tails_crc()) return;
+    s_rtc_tails.magic = 0;
+
+    for (uint8_t series = 0; series < TS_SERIES_COUNT; series++) {
+        if (!s_rtc_tails.active[series] || s_rtc_tails.tails[series].block.header.series != series) continue;
+        s_tails[series] = s_rtc_tails.tails[series];
+        s_tail_active[series] = true;
+    }
+}
+
+// --- Public API ---
+
+bool ts_store_init() {
+    if (s_mounted) return true;
+
+    s_partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                           (esp_partition_subtype_t)TS_STORE_PARTITION_SUBTYPE,
+                                           TS_STORE_PARTITION_LABEL);
+    if (s_partition == NULL) {
+        return false;
+    }
+
+    // 至少两个扇区：写入扇区之外始终保留一个扇区的历史
+    s_block_count = (uint16_t)(s_partition->size / TS_STORE_SECTOR_SIZE * BLOCKS_PER_SECTOR);
+    if (s_block_count < 2 * BLOCKS_PER_SECTOR) {
+        return false;
+    }
+
+    if (s_mutex == NULL) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (s_mutex == NULL) return false;
+    }
+    if (s_index == NULL) {
+        s_index = (block_index_t*)malloc(sizeof(block_index_t) * s_block_count);
+        if (s_index == NULL) return false;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_mounted = mount_locked();
+    if (s_mounted) {
+        restore_tails_locked();
+    }
+    xSemaphoreGive(s_mutex);
+
+    // 汇总在首次图表查询时重建（见 ts_rollup.h），不可用时仍可按原始样本查询
+    return s_mounted;
+}
+
+bool ts_store_is_mounted() {
+    return s_mounted;
+}
+
+uint32_t ts_store_now() {
+    time_t now = time(nullptr);
+    return now >= (time_t)TS_STORE_MIN_VALID_TIME ? (uint32_t)now : 0;
+}
+
+bool ts_store_append(ts_series_t series, uint32_t ts, int32_t value) {
+    if (!s_mounted || series >= TS_SERIES_COUNT || ts == 0) return false;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    bool ok = true;
+    ts_block_writer_t* tail = &s_tails[series];
+    if (s_tail_active[series] && !ts_block_append(tail, ts, value)) {
+        // 尾块已满或时间倒退：封存后以该样本开始新块
+        ok = write_tail(series);
+    }
+    if (!s_tail_active[series]) {
+        ts_block_start(tail, (uint8_t)series, ts, value);
+        s_tail_active[series] = true;
+    }
+    s_samples_appended++;
+    ts_rollup_add(series, ts, value);
+    xSemaphoreGive(s_mutex);
+    return ok;
+}
+
+bool ts_store_flush() {
+    if (!s_mounted) return false;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    bool ok = true;
+    for (uint8_t series = 0; series < TS_SERIES_COUNT; series++) {
+        ok = write_tail(series) && ok;
+    }
+    xSemaphoreGive(s_mutex);
+    return ok;
+}
+
+void ts_store_suspend() {
+    if (!s_mounted) return;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    memcpy(s_rtc_tails.tails, s_tails, sizeof(s_tails));
+    memcpy(s_rtc_tails.active, s_tail_active, sizeof(s_tail_active));
+    s_rtc_tails.magic = RTC_TAILS_MAGIC;
+    s_rtc_tails.crc = rtc_tails_crc();
+    xSemaphoreGive(s_mutex);
+}
+
+/**
+ * @brief 将一个块中落在范围内的样本交给回调
+ * @return false 回调要求停止
+ */
+static bool visit_block(const ts_block_t* block, uint32_t t_from, uint32_t t_to,
+                        ts_store_visit_fn visit, void* ctx, uint32_t* p_count) {
+    ts_block_reader_t reader;
+    ts_block_reader_init(&reader, block);
+    uint32_t ts;
+    int32_t value;
+    while (ts_block_next(&reader, &ts, &value)) {
+        if (ts < t_from || ts > t_to) continue;
+        (*p_count)++;
+        if (!visit(ts, value, ctx)) return false;
+    }
+    return true;
+}
+
+uint32_t ts_store_query(ts_series_t series, uint32_t t_from, uint32_t t_to,
+                        ts_store_visit_fn visit, void* ctx) {
+    if (!s_mounted || series >= TS_SERIES_COUNT || visit == NULL || t_from > t_to) return 0;
+
+    static ts_block_t block;   // 互斥锁保护，避免占用调用者的任务栈
+    uint32_t count = 0;
+    bool more = true;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    for (uint16_t i = 0; i < s_block_count && more; i++) {
+        uint16_t b = (uint16_t)((s_next_block + i) % s_block_count);
+        const block_index_t* entry = &s_index[b];
+        if (entry->state != BLOCK_VALID || entry->series != series ||
+            entry->t_last < t_from || entry->t_first > t_to) {
+            continue;
+        }
+        if (esp_partition_read(s_partition, block_addr(b), &block, entry->bytes) != ESP_OK ||
+            !ts_block_valid(&block)) {
+            continue;
+        }
+        more = visit_block(&block, t_from, t_to, visit, ctx, &count);
+    }
+
+    if (more && s_tail_active[series]) {
+        visit_block(&s_tails[series].block, t_from, t_to, visit, ctx, &count);
+    }
+    xSemaphoreGive(s_mutex);
+    return count;
+}
+
+bool ts_store_clear() {
+    if (!s_mounted) return false;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    bool ok = esp_partition_erase_range(s_partition, 0, (uint32_t)s_block_count * TS_BLOCK_SIZE) == ESP_OK;
+    memset(s_index, 0, sizeof(block_index_t) * s_block_count);
+    memset(s_tail_active, 0, sizeof(s_tail_active));
+    s_rtc_tails.magic = 0;
+    s_next_block = 0;
+    s_sectors_erased += s_block_count / BLOCKS_PER_SECTOR;
+    ts_rollup_reset();
+    xSemaphoreGive(s_mutex);
+    return ok;
+}
+
+void ts_store_get_stats(ts_store_stats_t* p_stats) {
+    if (p_stats == NULL) return;
+    memset(p_stats, 0, sizeof(*p_stats));
+    p_stats->mounted = s_mounted;
+    p_stats->samples_appended = s_samples_appended;
+    p_stats->blocks_written = s_blocks_written;
+    p_stats->sectors_erased = s_sectors_erased;
+    p_stats->corrupt_blocks = s_corrupt_blocks;
+    if (!s_mounted) return;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    p_stats->partition_size = s_partition->size;
+    p_stats->block_count = s_block_count;
+    for (uint16_t b = 0; b < s_block_count; b++) {
+        const block_index_t* entry = &s_index[b];
+        if (entry->state != BLOCK_VALID) continue;
+        p_stats->used_blocks++;
+        p_stats->flash_samples += entry->count;
+        p_stats->flash_bytes += entry->bytes;
+        if (p_stats->oldest_ts == 0 || entry->t_first < p_stats->oldest_ts) p_stats->oldest_ts = entry->t_first;
+        if (entry->t_last > p_stats->newest_ts) p_stats->newest_ts = entry->t_last;
+    }
+    for (uint8_t series = 0; series < TS_SERIES_COUNT; series++) {
+        if (!s_tail_active[series]) continue;
+        const ts_block_header_t* header = &s_tails[series].block.header;
+        p_stats->tail_samples[series] = header->count;
+        if (p_stats->oldest_ts == 0 || header->t_first < p_stats->oldest_ts) p_stats->oldest_ts = header->t_first;
+        if (header->t_last > p_stats->newest_ts) p_stats->newest_ts = header->t_last;
+    }
+    xSemaphoreGive(s_mutex);
+}
+
+const char* ts_store_series_name(ts_series_t series) {
+    return series < TS_SERIES_COUNT ? SERIES_NAMES[series] : "unknown";
+}
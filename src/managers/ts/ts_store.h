@@ -0,0 +1,136 @@
+/**
+ * @file ts_store.h
+ * @brief 基于原始 `tsdb` 分区的传感器时间序列存储
+ * @details
+ *   样本按序列追加到内存中的尾块（ts/ts_block.h），尾块写满后封存并整块写入分区，
+ *   追加为 O(1)。分区按 TS_BLOCK_SIZE 划分为块，循环使用：写到扇区起点时先擦除该扇区，
+ *   最老的数据随之淘汰。
+ *
+ *   挂载时读取全部块头建立内存索引（每块的序列、首末时间戳），按时间范围查询时
+ *   只读取时间范围重叠的块，最后再扫描内存尾块。
+ *
+ *   按像素宽度取图表数据时使用 ts/ts_rollup.h 的多分辨率汇总，避免逐点扫描。
+ *
+ *   掉电会丢失尚未封存的尾块；进入 OFF 模式前调用 ts_store_flush() 将尾块提前封存。
+ *   RUN 模式的周期性深度睡眠前调用 ts_store_suspend() 把尾块保存到 RTC 内存，
+ *   唤醒后由 ts_store_init() 恢复，不必每个周期都封存一个几乎为空的块。
+ *   5分钟一个样本时，湿度与电池电压每年各约 10.5 万个样本，编码后通常各占 100~200KB。
+ */
+
+#ifndef TS_STORE_H
+#define TS_STORE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define TS_STORE_PARTITION_LABEL   "tsdb"
+#define TS_STORE_PARTITION_SUBTYPE 0x83
+#define TS_STORE_SECTOR_SIZE       4096
+
+// 早于此时刻（2020-01-01）的系统时间视为未设置
+#define TS_STORE_MIN_VALID_TIME    1577836800UL
+
+/**
+ * @brief 序列编号
+ */
+typedef enum {
+    TS_SERIES_HUMIDITY = 0,   ///< 土壤湿度ADC截尾均值
+    TS_SERIES_BATTERY_MV,     ///< 电池电压 (mV)
+    TS_SERIES_PUMP,           ///< 浇水事件，数值为计划时长 (ms)
+    TS_SERIES_REFRESH,        ///< 屏幕刷新事件，数值 1=全刷 0=局刷
+    TS_SERIES_COUNT
+} ts_series_t;
+
+/**
+ * @brief 存储统计
+ */
+typedef struct {
+    bool mounted;
+    uint32_t partition_size;
+    uint16_t block_count;                      ///< 分区中的块数
+    uint16_t used_blocks;                      ///< 有效块数
+    uint32_t flash_samples;                    ///< 闪存中的样本数
+    uint32_t flash_bytes;                      ///< 有效块实际占用的字节数（块头+位流）
+    uint16_t tail_samples[TS_SERIES_COUNT];    ///< 各序列内存尾块中的样本数
+    uint32_t oldest_ts;                        ///< 最早样本时间戳（0表示无数据）
+    uint32_t newest_ts;                        ///< 最新样本时间戳
+    uint32_t samples_appended;                 ///< 本次启动以来追加的样本数
+    uint32_t blocks_written;                   ///< 本次启动以来写入的块数
+    uint32_t sectors_erased;
+    uint32_t corrupt_blocks;                   ///< 挂载时发现的损坏块数
+} ts_store_stats_t;
+
+/**
+ * @brief 查询回调
+ * @details 在存储的互斥锁内调用，回调中不得调用 ts_store_* 函数
+ * @return true 继续, false 停止查询
+ */
+typedef bool (*ts_store_visit_fn)(uint32_t ts, int32_t value, void* ctx);
+
+/**
+ * @brief 挂载 tsdb 分区并建立块索引
+ * @return true 成功, false 分区不存在或内存不足
+ */
+bool ts_store_init();
+
+/**
+ * @brief 查询是否已挂载
+ */
+bool ts_store_is_mounted();
+
+/**
+ * @brief 当前墙上时间（Unix秒）
+ * @return 时间戳；系统时间未设置时返回0
+ */
+uint32_t ts_store_now();
+
+/**
+ * @brief 追加一个样本
+ * @param series 序列
+ * @param ts 时间戳 (Unix秒)，同一序列内应单调不减（倒退时自动开始新块）
+ * @param value 数值
+ * @return true 成功, false 未挂载、参数无效或写入失败
+ */
+bool ts_store_append(ts_series_t series, uint32_t ts, int32_t value);
+
+/**
+ * @brief 封存所有非空尾块并写入分区
+ * @return true 全部写入成功
+ */
+bool ts_store_flush();
+
+/**
+ * @brief 深度睡眠前把内存尾块保存到 RTC 慢速内存
+ * @details 下次 ts_store_init() 时恢复；保存后到睡眠前不应再追加样本
+ */
+void ts_store_suspend();
+
+/**
+ * @brief 按时间范围查询（从旧到新）
+ * @param series 序列
+ * @param t_from 起始时间（含）
+ * @param t_to 结束时间（含）
+ * @param visit 样本回调
+ * @param ctx 回调参数
+ * @return 交付给回调的样本数
+ */
+uint32_t ts_store_query(ts_series_t series, uint32_t t_from, uint32_t t_to,
+                        ts_store_visit_fn visit, void* ctx);
+
+/**
+ * @brief 擦除全部数据（包括内存尾块）
+ * @return true 成功
+ */
+bool ts_store_clear();
+
+/**
+ * @brief 获取存储统计
+ */
+void ts_store_get_stats(ts_store_stats_t* p_stats);
+
+/**
+ * @brief 序列名称
+ */
+const char* ts_store_series_name(ts_series_t series);
+
+#endif // TS_STORE_H
@@ -4,4 +4,322 @@
  * @details 大致职责是在主CPU进入休眠前，加载并启动ULP程序；在主CPU被唤醒后，解析ULP的唤醒原因
  */
 
-#include "ulp_manager.h"
\ No newline at end of file
+#include "ulp_manager.h"
+#include "managers/log_manager.h"
+#include "hal/hal_config.h"
+#include "hal/hal_adc.h"
+#include "data/timing_constants.h"
+#include "../services/config_manager.h"
+#include <Arduino.h>
+#include <string.h>
+#include "esp_sleep.h"
+#include "driver/adc.h"
+#include "driver/rtc_io.h"
+#include "soc/rtc_cntl_reg.h"
+#include "soc/rtc_io_reg.h"
+#include "esp32s3/ulp.h"
+
+// 固件的 sdkconfig 需要启用 ULP 协处理器（FSM）并保留足够的 RTC 慢速内存
+#if defined(CONFIG_ESP32S3_ULP_COPROC_ENABLED) && CONFIG_ESP32S3_ULP_COPROC_ENABLED
+#define ULP_SENTINEL_SUPPORTED 1
+#else
+#define ULP_SENTINEL_SUPPORTED 0
+#endif
+
+#define DEFAULT_CONFIRM 2  // 连续两次超过阈值才唤醒，单个尖峰不会叫醒主CPU
+
+// 程序标号
+enum {
+    LBL_SETTLE = 1,
+    LBL_SAMPLE,
+    LBL_ADC,
+    LBL_DRY,
+    LBL_BUDGET,
+    LBL_BUDGET_OUT,
+    LBL_WAKE,
+    LBL_NOT_READY,
+    LBL_IDLE
+};
+
+static ulp_sentinel_params_t s_params;
+static bool s_params_valid = false;
+static ulp_sentinel_wake_t s_wake_reason = ULP_SENTINEL_WAKE_NONE;
+
+// --- 私有函数 ---
+
+// 采样周期拆成的定时器子周期数，每个子周期不超过 ULP_SENTINEL_TIMER_MAX_MS
+static uint32_t period_ticks(uint32_t period_ms) {
+    return (period_ms + ULP_SENTINEL_TIMER_MAX_MS - 1) / ULP_SENTINEL_TIMER_MAX_MS;
+}
+
+static uint16_t read_var(uint32_t offset) {
+    return (uint16_t)(RTC_SLOW_MEM[offset] & 0xFFFF);
+}
+
+static void write_var(uint32_t offset, uint16_t value) {
+    RTC_SLOW_MEM[offset] = value;
+}
+
+static bool program_loaded() {
+    return read_var(ULP_SENTINEL_VAR_MAGIC) == ULP_SENTINEL_MAGIC;
+}
+
+// --- 公共 API ---
+
+void ulp_manager_init() {
+    s_wake_reason = ULP_SENTINEL_WAKE_NONE;
+#if ULP_SENTINEL_SUPPORTED
+    // 模式开关唤醒时哨兵仍在周期运行，先停下再把引脚交还给 power_manager
+    ulp_manager_stop();
+    rtc_gpio_deinit((gpio_num_t)PIN_POWER_GATE_SENSOR);
+
+    if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_ULP && program_loaded()) {
+        s_wake_reason = (ulp_sentinel_wake_t)read_var(ULP_SENTINEL_VAR_WAKE_REASON);
+        LOG_INFO("ULP", "Woken by sentinel: %s (last=%u after %u samples)",
+                 ulp_sentinel_wake_name(s_wake_reason), read_var(ULP_SENTINEL_VAR_LAST),
+                 read_var(ULP_SENTINEL_VAR_COUNT));
+    }
+#endif
+}
+
+ulp_result_t ulp_manager_load() {
+#if ULP_SENTINEL_SUPPORTED
+    int8_t channel = digitalPinToAnalogChannel(PIN_SENSOR_HUMIDITY);
+    int rtcio = rtc_io_number_get((gpio_num_t)PIN_POWER_GATE_SENSOR);
+    if (channel < 0 || channel >= ADC1_CHANNEL_MAX || rtcio < 0) {
+        LOG_ERROR("ULP", "Sensor pins are not reachable from the ULP");
+        return ULP_ERROR_UNSUPPORTED;
+    }
+
+    // 电源门控低电平有效：W1TC 上电，W1TS 断电
+    const uint32_t gate_on_bit = RTC_GPIO_OUT_DATA_W1TC_S + rtcio;
+    const uint32_t gate_off_bit = RTC_GPIO_OUT_DATA_W1TS_S + rtcio;
+    static_assert(POWER_ON == LOW, "ULP sentinel assumes an active-low sensor gate");
+
+    // 逐段对应 ulp_sentinel_model_step()；R3 固定为数据区基址 0
+    const ulp_insn_t program[] = {
+        I_MOVI(R3, 0),
+        I_LD(R0, R3, ULP_SENTINEL_VAR_WAKE_REASON),
+        M_BGE(LBL_WAKE, 1),                               // 上次唤醒未送达，直接重试
+
+        // 子周期计数：定时器周期有上限，每 ticks 次启动才采样一次
+        I_LD(R0, R3, ULP_SENTINEL_VAR_TICK),
+        I_SUBI(R0, R0, 1),
+        I_ST(R0, R3, ULP_SENTINEL_VAR_TICK),
+        M_BGE(LBL_IDLE, 1),
+        I_LD(R0, R3, ULP_SENTINEL_VAR_TICKS),
+        I_ST(R0, R3, ULP_SENTINEL_VAR_TICK),
+
+        // 上电并等待稳定
+        I_WR_REG(RTC_GPIO_OUT_W1TC_REG, gate_on_bit, gate_on_bit, 1),
+        I_LD(R0, R3, ULP_SENTINEL_VAR_SETTLE_MS),
+        M_LABEL(LBL_SETTLE),
+        M_BL(LBL_SAMPLE, 1),
+        I_DELAY(ULP_FSM_CYCLES_PER_MS),
+        I_SUBI(R0, R0, 1),
+        M_BX(LBL_SETTLE),
+
+        // 过采样求平均 (R1)
+        M_LABEL(LBL_SAMPLE),
+        I_MOVI(R1, 0),
+        I_MOVI(R2, ULP_SENTINEL_OVERSAMPLE),
+        M_LABEL(LBL_ADC),
+        I_ADC(R0, 0, (uint32_t)channel),
+        I_ADDR(R1, R1, R0),
+        I_SUBI(R2, R2, 1),
+        I_MOVR(R0, R2),
+        M_BGE(LBL_ADC, 1),
+        I_RSHI(R1, R1, ULP_SENTINEL_OVERSAMPLE_SHIFT),
+        I_WR_REG(RTC_GPIO_OUT_W1TS_REG, gate_off_bit, gate_off_bit, 1),
+
+        // 记录读数
+        I_ST(R1, R3, ULP_SENTINEL_VAR_LAST),
+        I_LD(R2, R3, ULP_SENTINEL_VAR_HIST_IDX),
+        I_ST(R1, R2, ULP_SENTINEL_HISTORY_OFFSET),
+        I_ADDI(R2, R2, 1),
+        I_ANDI(R2, R2, ULP_SENTINEL_HISTORY_LEN - 1),
+        I_ST(R2, R3, ULP_SENTINEL_VAR_HIST_IDX),
+        I_LD(R0, R3, ULP_SENTINEL_VAR_COUNT),
+        I_ADDI(R0, R0, 1),
+        I_ST(R0, R3, ULP_SENTINEL_VAR_COUNT),
+
+        // threshold - reading 借位即读数超过阈值
+        I_LD(R2, R3, ULP_SENTINEL_VAR_THRESHOLD),
+        I_SUBR(R0, R2, R1),
+        M_BXF(LBL_DRY),
+        I_MOVI(R0, 0),
+        I_ST(R0, R3, ULP_SENTINEL_VAR_ABOVE),
+        M_BX(LBL_BUDGET),
+        M_LABEL(LBL_DRY),
+        I_LD(R0, R3, ULP_SENTINEL_VAR_ABOVE),
+        I_ADDI(R0, R0, 1),
+        I_ST(R0, R3, ULP_SENTINEL_VAR_ABOVE),
+        I_LD(R2, R3, ULP_SENTINEL_VAR_CONFIRM),
+        I_SUBR(R0, R0, R2),
+        M_BXF(LBL_BUDGET),                                // above < confirm
+        I_MOVI(R0, ULP_SENTINEL_WAKE_THRESHOLD),
+        I_ST(R0, R3, ULP_SENTINEL_VAR_WAKE_REASON),
+        M_BX(LBL_WAKE),
+
+        // 采样预算
+        M_LABEL(LBL_BUDGET),
+        I_LD(R0, R3, ULP_SENTINEL_VAR_BUDGET),
+        M_BL(LBL_BUDGET_OUT, 2),
+        I_SUBI(R0, R0, 1),
+        I_ST(R0, R3, ULP_SENTINEL_VAR_BUDGET),
+        I_HALT(),
+        M_LABEL(LBL_BUDGET_OUT),
+        I_MOVI(R0, 0),
+        I_ST(R0, R3, ULP_SENTINEL_VAR_BUDGET),
+        I_MOVI(R0, ULP_SENTINEL_WAKE_BUDGET),
+        I_ST(R0, R3, ULP_SENTINEL_VAR_WAKE_REASON),
+
+        // 主CPU已进入休眠时唤醒并停止定时器；否则保留原因，下个周期重试
+        M_LABEL(LBL_WAKE),
+        I_RD_REG(RTC_CNTL_LOW_POWER_ST_REG, RTC_CNTL_RDY_FOR_WAKEUP_S, RTC_CNTL_RDY_FOR_WAKEUP_S),
+        M_BL(LBL_NOT_READY, 1),
+        I_WAKE(),
+        I_END(),
+        M_LABEL(LBL_NOT_READY),
+        M_LABEL(LBL_IDLE),
+        I_HALT(),
+    };
+
+    ulp_manager_stop();
+    memset(RTC_SLOW_MEM, 0, ULP_SENTINEL_PROGRAM_OFFSET * sizeof(uint32_t));
+
+    size_t size = sizeof(program) / sizeof(ulp_insn_t);
+    esp_err_t err = ulp_process_macros_and_load(ULP_SENTINEL_PROGRAM_OFFSET, program, &size);
+    if (err != ESP_OK) {
+        LOG_ERROR("ULP", "Failed to load sentinel program: %s", esp_err_to_name(err));
+        return ULP_ERROR_LOAD_FAILED;
+    }
+    write_var(ULP_SENTINEL_VAR_MAGIC, ULP_SENTINEL_MAGIC);
+
+    LOG_DEBUG("ULP", "Sentinel loaded (%u words, ADC1 ch%d, RTC GPIO %d)",
+              (unsigned)(ULP_SENTINEL_PROGRAM_OFFSET + size), channel, rtcio);
+    return ULP_OK;
+#else
+    return ULP_ERROR_UNSUPPORTED;
+#endif
+}
+
+void ulp_manager_default_params(ulp_sentinel_params_t* p_params) {
+    const hydro_watering_config_t& watering = ConfigManager::instance().getConfig().watering;
+    uint32_t threshold = watering.threshold + watering.hysteresis / 2;
+    p_params->threshold = threshold > HAL_ADC_RAW_MAX ? HAL_ADC_RAW_MAX : (uint16_t)threshold;
+    p_params->confirm = DEFAULT_CONFIRM;
+    p_params->budget = ULP_SENTINEL_MAX_SLEEP_MS / ULP_SENTINEL_PERIOD_MS;
+    p_params->settle_ms = SENSOR_SETTLE_MAX_MS;
+    p_params->period_ms = ULP_SENTINEL_PERIOD_MS;
+}
+
+ulp_result_t ulp_manager_set_params(const ulp_sentinel_params_t* p_params) {
+    if (p_params == nullptr || p_params->confirm == 0 || p_params->budget == 0 ||
+        p_params->period_ms == 0 || period_ticks(p_params->period_ms) > 0xFFFF ||
+        p_params->settle_ms > 1000) {
+        return ULP_ERROR_INVALID_PARAM;
+    }
+    s_params = *p_params;
+    s_params_valid = true;
+    return ULP_OK;
+}
+
+ulp_result_t ulp_manager_start() {
+#if ULP_SENTINEL_SUPPORTED
+    if (!program_loaded()) return ULP_ERROR_NOT_LOADED;
+    if (!s_params_valid) return ULP_ERROR_INVALID_PARAM;
+
+    write_var(ULP_SENTINEL_VAR_THRESHOLD, s_params.threshold);
+    write_var(ULP_SENTINEL_VAR_CONFIRM, s_params.confirm);
+    write_var(ULP_SENTINEL_VAR_BUDGET, s_params.budget);
+    write_var(ULP_SENTINEL_VAR_SETTLE_MS, s_params.settle_ms);
+    write_var(ULP_SENTINEL_VAR_LAST, 0);
+    write_var(ULP_SENTINEL_VAR_COUNT, 0);
+    write_var(ULP_SENTINEL_VAR_ABOVE, 0);
+    write_var(ULP_SENTINEL_VAR_HIST_IDX, 0);
+    write_var(ULP_SENTINEL_VAR_WAKE_REASON, ULP_SENTINEL_WAKE_NONE);
+    uint32_t ticks = period_ticks(s_params.period_ms);
+    write_var(ULP_SENTINEL_VAR_TICKS, (uint16_t)ticks);
+    write_var(ULP_SENTINEL_VAR_TICK, 1);  // 启动后第一次运行即采样
+
+    // ADC1 交给 ULP，衰减与主CPU采集一致，读数可直接与浇水阈值比较
+    adc1_channel_t channel = (adc1_channel_t)digitalPinToAnalogChannel(PIN_SENSOR_HUMIDITY);
+    adc1_config_width(ADC_WIDTH_BIT_12);
+    adc1_config_channel_atten(channel, ADC_ATTEN_DB_11);
+    adc1_ulp_enable();
+
+    // 传感器门控切换为 RTC GPIO，由 ULP 驱动；初始为断电
+    gpio_num_t gate = (gpio_num_t)PIN_POWER_GATE_SENSOR;
+    rtc_gpio_init(gate);
+    rtc_gpio_set_direction(gate, RTC_GPIO_MODE_OUTPUT_ONLY);
+    rtc_gpio_set_level(gate, !POWER_ON);
+    rtc_gpio_hold_dis(gate);
+
+    uint32_t tick_ms = s_params.period_ms / ticks;
+    esp_err_t err = ulp_set_wakeup_period(0, tick_ms * 1000);
+    if (err != ESP_OK) {
+        rtc_gpio_deinit(gate);
+        LOG_ERROR("ULP", "Timer period %lums out of range: %s", (unsigned long)tick_ms, esp_err_to_name(err));
+        return ULP_ERROR_START_FAILED;
+    }
+    err = ulp_run(ULP_SENTINEL_PROGRAM_OFFSET);
+    if (err != ESP_OK) {
+        rtc_gpio_deinit(gate);
+        LOG_ERROR("ULP", "Failed to start sentinel: %s", esp_err_to_name(err));
+        return ULP_ERROR_START_FAILED;
+    }
+
+    LOG_INFO("ULP", "Sentinel armed: threshold=%u confirm=%u budget=%u period=%lus (%lu x %lums)",
+             s_params.threshold, s_params.confirm, s_params.budget,
+             (unsigned long)(s_params.period_ms / 1000), (unsigned long)ticks, (unsigned long)tick_ms);
+    return ULP_OK;
+#else
+    return ULP_ERROR_UNSUPPORTED;
+#endif
+}
+
+ulp_result_t ulp_manager_arm(const ulp_sentinel_params_t* p_params) {
+    ulp_result_t result = ulp_manager_set_params(p_params);
+    if (result != ULP_OK) return result;
+    result = ulp_manager_load();
+    if (result != ULP_OK) return result;
+    return ulp_manager_start();
+}
+
+void ulp_manager_stop() {
+#if ULP_SENTINEL_SUPPORTED
+    CLEAR_PERI_REG_MASK(RTC_CNTL_ULP_CP_TIMER_REG, RTC_CNTL_ULP_CP_SLP_TIMER_EN);
+#endif
+}
+
+ulp_sentinel_wake_t ulp_manager_get_wake_reason() {
+    return s_wake_reason;
+}
+
+ulp_result_t ulp_manager_read_state(ulp_sentinel_state_t* p_state) {
+    if (p_state == nullptr) return ULP_ERROR_INVALID_PARAM;
+    if (!program_loaded()) return ULP_ERROR_NOT_LOADED;
+
+    p_state->threshold = read_var(ULP_SENTINEL_VAR_THRESHOLD);
+    p_state->confirm = read_var(ULP_SENTINEL_VAR_CONFIRM);
+    p_state->budget = read_var(ULP_SENTINEL_VAR_BUDGET);
+    p_state->settle_ms = read_var(ULP_SENTINEL_VAR_SETTLE_MS);
+    p_state->last = read_var(ULP_SENTINEL_VAR_LAST);
+    p_state->count = read_var(ULP_SENTINEL_VAR_COUNT);
+    p_state->above = read_var(ULP_SENTINEL_VAR_ABOVE);
+    p_state->hist_idx = read_var(ULP_SENTINEL_VAR_HIST_IDX);
+    p_state->wake_reason = read_var(ULP_SENTINEL_VAR_WAKE_REASON);
+    p_state->ticks = read_var(ULP_SENTINEL_VAR_TICKS);
+    p_state->tick = read_var(ULP_SENTINEL_VAR_TICK);
+    for (uint8_t i = 0; i < ULP_SENTINEL_HISTORY_LEN; i++) {
+        p_state->history[i] = read_var(ULP_SENTINEL_HISTORY_OFFSET + i);
+    }
+    return ULP_OK;
+}
+
+uint8_t ulp_manager_get_history(uint16_t* out, uint8_t max) {
+    ulp_sentinel_state_t state;
+    if (ulp_manager_read_state(&state) != ULP_OK) return 0;
+    return ulp_sentinel_history(&state, out, max);
+}
@@ -1,10 +1,96 @@
 /**
  * @file ulp_manager.h
  * @brief ULP管理器
- * @details 负责ULP协处理器的协调和管理
+ * @details 负责ULP协处理器的协调和管理：加载哨兵程序、写入参数、在休眠前启动，
+ *          以及在主CPU被唤醒后读取唤醒原因与采样历史。
+ *          程序由 ULP 状态机（FSM）指令宏在运行时生成，不需要额外的 ULP 工具链；
+ *          判定逻辑的主机侧模型见 ulp_sentinel.h。
  */
 
 #ifndef ULP_MANAGER_H
 #define ULP_MANAGER_H
 
-#endif // ULP_MANAGER_H
\ No newline at end of file
+#include <stdint.h>
+#include <stdbool.h>
+#include "ulp_sentinel.h"
+
+/**
+ * @brief ULP管理器操作结果
+ */
+typedef enum {
+    ULP_OK = 0,
+    ULP_ERROR_NOT_LOADED,      ///< 程序尚未加载
+    ULP_ERROR_LOAD_FAILED,     ///< 程序超出 ULP 保留内存或指令生成失败
+    ULP_ERROR_INVALID_PARAM,
+    ULP_ERROR_START_FAILED,
+    ULP_ERROR_UNSUPPORTED      ///< 固件未启用 ULP 协处理器
+} ulp_result_t;
+
+/**
+ * @brief 哨兵参数
+ */
+typedef struct {
+    uint16_t threshold;        ///< 唤醒阈值 (ADC值，越大越干)
+    uint16_t confirm;          ///< 连续超过阈值的次数 (>=1)
+    uint16_t budget;           ///< 最多采样次数，用完后唤醒主CPU (>=1)
+    uint16_t settle_ms;        ///< 传感器上电稳定时间 (ms)
+    uint32_t period_ms;        ///< 采样周期 (ms)
+} ulp_sentinel_params_t;
+
+/**
+ * @brief 启动时调用：停止 ULP、归还传感器电源引脚并记录唤醒原因
+ * @details 必须在 power_manager_init() 之前调用
+ */
+void ulp_manager_init();
+
+/**
+ * @brief 生成并加载哨兵程序到 RTC 慢速内存
+ */
+ulp_result_t ulp_manager_load();
+
+/**
+ * @brief 由当前配置填充默认参数
+ * @details 阈值取浇水阈值加半个迟滞带（与湿度滤波的进入条件一致），连续2次确认
+ */
+void ulp_manager_default_params(ulp_sentinel_params_t* p_params);
+
+/**
+ * @brief 写入哨兵参数
+ */
+ulp_result_t ulp_manager_set_params(const ulp_sentinel_params_t* p_params);
+
+/**
+ * @brief 配置 ADC 与 RTC GPIO，清零计数并启动 ULP 定时器
+ * @details 之后应立即调用 hal_rtc_enter_sentinel_sleep()
+ */
+ulp_result_t ulp_manager_start();
+
+/**
+ * @brief 加载程序、写入参数并启动
+ */
+ulp_result_t ulp_manager_arm(const ulp_sentinel_params_t* p_params);
+
+/**
+ * @brief 停止 ULP 定时器
+ */
+void ulp_manager_stop();
+
+/**
+ * @brief 本次启动的唤醒原因
+ * @return 非哨兵唤醒（冷启动、模式开关）时为 ULP_SENTINEL_WAKE_NONE
+ */
+ulp_sentinel_wake_t ulp_manager_get_wake_reason();
+
+/**
+ * @brief 读取 RTC 慢速内存中的哨兵状态
+ * @return ULP_ERROR_NOT_LOADED 表示内存中没有有效程序（冷启动）
+ */
+ulp_result_t ulp_manager_read_state(ulp_sentinel_state_t* p_state);
+
+/**
+ * @brief 按时间顺序取出哨兵最近的读数
+ * @return 取出的数量
+ */
+uint8_t ulp_manager_get_history(uint16_t* out, uint8_t max);
+
+#endif // ULP_MANAGER_H
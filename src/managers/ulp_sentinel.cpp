@@ -0,0 +1,84 @@
+/**
+ * @file ulp_sentinel.cpp
+ * @brief ULP 哨兵判定模型实现
+ * @details 每一步对应 ulp_manager.cpp 中程序的一段指令，修改任一方都必须同步另一方
+ */
+
+#include "ulp_sentinel.h"
+#include <string.h>
+
+void ulp_sentinel_model_init(ulp_sentinel_state_t* p_state, uint16_t threshold, uint16_t confirm,
+                             uint16_t budget, uint16_t settle_ms) {
+    memset(p_state, 0, sizeof(*p_state));
+    p_state->threshold = threshold;
+    p_state->confirm = confirm;
+    p_state->budget = budget;
+    p_state->settle_ms = settle_ms;
+    p_state->ticks = 1;
+    p_state->tick = 1;
+}
+
+ulp_sentinel_wake_t ulp_sentinel_model_step(ulp_sentinel_state_t* p_state, const uint16_t* adc) {
+    // 上次的唤醒尚未送达（主CPU还没进入休眠），不采样直接重试
+    if (p_state->wake_reason != ULP_SENTINEL_WAKE_NONE) {
+        return (ulp_sentinel_wake_t)p_state->wake_reason;
+    }
+
+    // 子周期计数：未到零不采样
+    p_state->tick--;
+    if (p_state->tick >= 1) {
+        return ULP_SENTINEL_WAKE_NONE;
+    }
+    p_state->tick = p_state->ticks;
+
+    // 过采样：16位累加后右移
+    uint16_t sum = 0;
+    for (uint8_t i = 0; i < ULP_SENTINEL_OVERSAMPLE; i++) {
+        sum = (uint16_t)(sum + adc[i]);
+    }
+    uint16_t reading = sum >> ULP_SENTINEL_OVERSAMPLE_SHIFT;
+
+    p_state->last = reading;
+    p_state->history[p_state->hist_idx & (ULP_SENTINEL_HISTORY_LEN - 1)] = reading;
+    p_state->hist_idx = (p_state->hist_idx + 1) & (ULP_SENTINEL_HISTORY_LEN - 1);
+    p_state->count++;
+
+    // threshold - reading 借位即 reading > threshold
+    if (reading > p_state->threshold) {
+        p_state->above++;
+        // above - confirm 不借位即 above >= confirm
+        if (p_state->above >= p_state->confirm) {
+            p_state->wake_reason = ULP_SENTINEL_WAKE_THRESHOLD;
+            return ULP_SENTINEL_WAKE_THRESHOLD;
+        }
+    } else {
+        p_state->above = 0;
+    }
+
+    if (p_state->budget < 2) {
+        p_state->budget = 0;
+        p_state->wake_reason = ULP_SENTINEL_WAKE_BUDGET;
+        return ULP_SENTINEL_WAKE_BUDGET;
+    }
+    p_state->budget--;
+    return ULP_SENTINEL_WAKE_NONE;
+}
+
+uint8_t ulp_sentinel_history(const ulp_sentinel_state_t* p_state, uint16_t* out, uint8_t max) {
+    uint8_t n = p_state->count < ULP_SENTINEL_HISTORY_LEN ? (uint8_t)p_state->count : ULP_SENTINEL_HISTORY_LEN;
+    if (n > max) n = max;
+    // 写入位置之前的 n 个样本即最近的 n 个
+    for (uint8_t i = 0; i < n; i++) {
+        uint8_t idx = (p_state->hist_idx + ULP_SENTINEL_HISTORY_LEN - n + i) & (ULP_SENTINEL_HISTORY_LEN - 1);
+        out[i] = p_state->history[idx];
+    }
+    return n;
+}
+
+const char* ulp_sentinel_wake_name(ulp_sentinel_wake_t reason) {
+    switch (reason) {
+        case ULP_SENTINEL_WAKE_THRESHOLD: return "threshold";
+        case ULP_SENTINEL_WAKE_BUDGET:    return "budget";
+        default:                          return "none";
+    }
+}
@@ -0,0 +1,100 @@
+/**
+ * @file ulp_sentinel.h
+ * @brief ULP 哨兵程序的 RTC 内存布局与判定模型
+ * @details
+ *   哨兵程序（见 ulp_manager.cpp）在主CPU深度睡眠期间由 ULP 定时器周期性启动。
+ *   定时器周期有硬件上限（ULP_SENTINEL_TIMER_MAX_MS），采样周期被拆成 ticks 个子周期，
+ *   程序每次启动先递减子周期计数，未到零即停止；到零时重装计数并采样一次：
+ *   1. 打开传感器电源门控，等待 settle_ms 毫秒；
+ *   2. 连续采集 ULP_SENTINEL_OVERSAMPLE 次湿度 ADC，取平均；
+ *   3. 关闭电源门控，把读数写入 RTC 慢速内存中的历史环形缓冲；
+ *   4. 读数大于 threshold（越大越干）时累加连续计数，达到 confirm 次唤醒主CPU；
+ *      否则计数清零；
+ *   5. 采样预算 budget 用完时唤醒主CPU（定期刷新屏幕与电池状态）。
+ *   唤醒后 ULP 定时器停止，由主CPU在下次休眠前重新启动。
+ *
+ *   ULP 只能做16位无符号整数运算，本文件中的模型逐条复现程序的判定逻辑（包括溢出行为），
+ *   不依赖硬件，可在主机或设备上用测试向量验证阈值行为。
+ */
+
+#ifndef ULP_SENTINEL_H
+#define ULP_SENTINEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ULP_SENTINEL_OVERSAMPLE_SHIFT 2
+#define ULP_SENTINEL_OVERSAMPLE       (1 << ULP_SENTINEL_OVERSAMPLE_SHIFT)  // 每次唤醒的ADC采样数
+#define ULP_SENTINEL_HISTORY_LEN      16  // 必须为2的幂（ULP 用按位与回绕）
+#define ULP_SENTINEL_MAGIC            0x5345  // "SE"，主CPU加载程序时写入
+
+// RTC 慢速内存布局（32位字偏移；ULP 只读写每个字的低16位）
+#define ULP_SENTINEL_VAR_MAGIC        0
+#define ULP_SENTINEL_VAR_THRESHOLD    1   // 唤醒阈值 (ADC值)
+#define ULP_SENTINEL_VAR_CONFIRM      2   // 连续超过阈值的次数要求
+#define ULP_SENTINEL_VAR_BUDGET       3   // 剩余采样预算
+#define ULP_SENTINEL_VAR_SETTLE_MS    4   // 上电稳定时间 (ms)
+#define ULP_SENTINEL_VAR_LAST         5   // 最近一次读数
+#define ULP_SENTINEL_VAR_COUNT        6   // 本轮采样次数
+#define ULP_SENTINEL_VAR_ABOVE        7   // 连续超过阈值的次数
+#define ULP_SENTINEL_VAR_HIST_IDX     8   // 历史缓冲下一个写入位置
+#define ULP_SENTINEL_VAR_WAKE_REASON  9   // ulp_sentinel_wake_t
+#define ULP_SENTINEL_VAR_TICKS        10  // 每个采样周期的定时器子周期数 (>=1)
+#define ULP_SENTINEL_VAR_TICK         11  // 距下次采样剩余的子周期数
+#define ULP_SENTINEL_HISTORY_OFFSET   16
+#define ULP_SENTINEL_PROGRAM_OFFSET   (ULP_SENTINEL_HISTORY_OFFSET + ULP_SENTINEL_HISTORY_LEN)
+
+/**
+ * @brief 哨兵唤醒主CPU的原因
+ */
+typedef enum {
+    ULP_SENTINEL_WAKE_NONE = 0,       ///< 未唤醒（或本次不是由哨兵唤醒）
+    ULP_SENTINEL_WAKE_THRESHOLD = 1,  ///< 土壤变干，需要检查是否浇水
+    ULP_SENTINEL_WAKE_BUDGET = 2      ///< 采样预算用完
+} ulp_sentinel_wake_t;
+
+/**
+ * @brief 哨兵状态（与 RTC 慢速内存中的变量一一对应）
+ */
+typedef struct {
+    uint16_t threshold;
+    uint16_t confirm;
+    uint16_t budget;
+    uint16_t settle_ms;
+    uint16_t last;
+    uint16_t count;
+    uint16_t above;
+    uint16_t hist_idx;
+    uint16_t wake_reason;
+    uint16_t ticks;
+    uint16_t tick;
+    uint16_t history[ULP_SENTINEL_HISTORY_LEN];
+} ulp_sentinel_state_t;
+
+/**
+ * @brief 以给定参数初始化模型状态（与 ulp_manager_start() 写入的初始值一致）
+ * @details 子周期数为1，即每一步都采样；需要时直接设置 ticks
+ */
+void ulp_sentinel_model_init(ulp_sentinel_state_t* p_state, uint16_t threshold, uint16_t confirm,
+                             uint16_t budget, uint16_t settle_ms);
+
+/**
+ * @brief 模拟一次 ULP 定时器启动
+ * @param p_state 哨兵状态
+ * @param adc 本次的 ULP_SENTINEL_OVERSAMPLE 个ADC原始值（子周期未到零时不使用）
+ * @return 唤醒原因；已唤醒过（wake_reason 非零）时不再采样，直接返回原因
+ */
+ulp_sentinel_wake_t ulp_sentinel_model_step(ulp_sentinel_state_t* p_state, const uint16_t* adc);
+
+/**
+ * @brief 按时间顺序（从旧到新）取出历史读数
+ * @return 取出的数量
+ */
+uint8_t ulp_sentinel_history(const ulp_sentinel_state_t* p_state, uint16_t* out, uint8_t max);
+
+/**
+ * @brief 唤醒原因名称
+ */
+const char* ulp_sentinel_wake_name(ulp_sentinel_wake_t reason);
+
+#endif // ULP_SENTINEL_H
@@ -0,0 +1,241 @@
+/**
+ * @file watering_controller.cpp
+ * @brief 闭环自适应浇水时长实现
+ */
+
+#include "watering_controller.h"
+#include "managers/log_manager.h"
+#include "data/timing_constants.h"
+#include "../services/config_manager.h"
+#include <Arduino.h>
+#include <Preferences.h>
+#include <string.h>
+#include <time.h>
+
+#define NVS_NAMESPACE     "wctrl"
+#define NVS_KEY_MODEL     "model"
+#define MODEL_MAGIC       0x57435452  // "WCTR"
+#define PENDING_EXPIRE    6           // 超过 soak_s 的此倍数仍未观测则放弃（期间离开了RUN模式）
+
+typedef struct {
+    uint32_t magic;
+    watering_ctrl_state_t state;
+} saved_model_t;
+
+static watering_ctrl_state_t s_state;
+static bool s_initialized = false;
+
+// --- 私有函数 ---
+
+static uint32_t plant_hash(const char* name) {
+    uint32_t hash = 2166136261u;  // FNV-1a
+    for (const char* p = name; *p != '\0'; p++) {
+        hash = (hash ^ (uint8_t)*p) * 16777619u;
+    }
+    return hash;
+}
+
+static float clampf(float value, float lo, float hi) {
+    return value < lo ? lo : (value > hi ? hi : value);
+}
+
+// 满占空比秒数 → 指定占空比下的时长 (ms)
+static uint32_t duration_for(float effective_s, uint8_t duty) {
+    return (uint32_t)(effective_s * 255.0f / duty * 1000.0f + 0.5f);
+}
+
+static void save_model() {
+    saved_model_t saved;
+    saved.magic = MODEL_MAGIC;
+    saved.state = s_state;
+
+    Preferences prefs;
+    if (prefs.begin(NVS_NAMESPACE, false)) {
+        prefs.putBytes(NVS_KEY_MODEL, &saved, sizeof(saved));
+        prefs.end();
+    }
+}
+
+// --- 纯函数核心 ---
+
+void watering_ctrl_state_init(watering_ctrl_state_t* p_state, uint32_t plant_hash) {
+    memset(p_state, 0, sizeof(*p_state));
+    p_state->gain = WATERING_CTRL_DEFAULT_GAIN;
+    p_state->plant_hash = plant_hash;
+}
+
+void watering_ctrl_plan(const watering_ctrl_state_t* p_state, const watering_ctrl_config_t* p_config,
+                        float current, watering_ctrl_plan_t* p_plan) {
+    uint8_t max_duty = p_config->max_duty > 0 ? p_config->max_duty : 1;
+    uint8_t min_duty = max_duty < WATERING_CTRL_MIN_DUTY ? max_duty : WATERING_CTRL_MIN_DUTY;
+
+    p_plan->deficit = current - p_config->target;
+    p_plan->learned = p_state->observations > 0;
+
+    if (!p_plan->learned) {
+        // 尚无观测：按固定时长浇水，渗透后得到第一次增益
+        p_plan->duty = max_duty;
+        p_plan->duration_ms = p_config->fixed_duration_ms;
+    } else if (p_plan->deficit <= 0.0f) {
+        // 已在目标以内（目标高于浇水阈值的配置）：最小剂量
+        p_plan->duty = min_duty;
+        p_plan->duration_ms = p_config->min_duration_ms;
+    } else {
+        float effective_s = p_plan->deficit / p_state->gain;
+        uint8_t duty = max_duty;
+        uint32_t duration_ms = duration_for(effective_s, duty);
+
+        // 剂量小时降低占空比，用更长的时间浇同样的水
+        if (duration_ms < p_config->min_duration_ms) {
+            float wanted = effective_s * 255.0f * 1000.0f / p_config->min_duration_ms;
+            duty = (uint8_t)clampf(wanted + 0.5f, min_duty, max_duty);
+            duration_ms = duration_for(effective_s, duty);
+            if (duration_ms < p_config->min_duration_ms) {
+                duration_ms = p_config->min_duration_ms;
+            }
+        }
+        if (duration_ms > p_config->max_duration_ms) {
+            duration_ms = p_config->max_duration_ms;
+        }
+        p_plan->duty = duty;
+        p_plan->duration_ms = duration_ms;
+    }
+
+    p_plan->expected_drop = p_state->gain * (p_plan->duration_ms / 1000.0f) * (p_plan->duty / 255.0f);
+}
+
+void watering_ctrl_begin(watering_ctrl_state_t* p_state, float before, uint8_t duty,
+                         uint32_t duration_ms, uint32_t now) {
+    // 新的浇水覆盖尚未观测的上一次（两次响应无法分开）
+    p_state->pending = duty > 0 && duration_ms > 0;
+    p_state->pending_before = before;
+    p_state->pending_duty = duty;
+    p_state->pending_duration_ms = duration_ms;
+    p_state->pending_time = now;
+}
+
+bool watering_ctrl_observe(watering_ctrl_state_t* p_state, const watering_ctrl_config_t* p_config,
+                           float current, uint32_t now) {
+    if (!p_state->pending) {
+        return false;
+    }
+    if (now < p_state->pending_time || now - p_state->pending_time > p_config->soak_s * PENDING_EXPIRE) {
+        p_state->pending = false;  // 时钟倒退或观测过期
+        return false;
+    }
+    if (now - p_state->pending_time < p_config->soak_s) {
+        return false;
+    }
+
+    p_state->pending = false;
+    float effective_s = (p_state->pending_duration_ms / 1000.0f) * (p_state->pending_duty / 255.0f);
+    if (effective_s <= 0.0f) {
+        return false;
+    }
+
+    float observed = (p_state->pending_before - current) / effective_s;
+    p_state->last_observed_gain = observed;
+    p_state->last_after = current;
+
+    if (p_state->observations == 0) {
+        // 初始增益只是猜测，第一次观测直接采用
+        p_state->gain = clampf(observed, WATERING_CTRL_MIN_GAIN, WATERING_CTRL_MAX_GAIN);
+    } else {
+        float bounded = clampf(observed, p_state->gain * 0.5f, p_state->gain * 2.0f);
+        float gain = p_state->gain + WATERING_CTRL_ALPHA * (bounded - p_state->gain);
+        p_state->gain = clampf(gain, WATERING_CTRL_MIN_GAIN, WATERING_CTRL_MAX_GAIN);
+    }
+
+    float half_band = p_config->band / 2.0f;
+    if (current >= p_config->target - half_band && current <= p_config->target + half_band) {
+        p_state->hits++;
+    }
+    if (p_state->observations < UINT16_MAX) {
+        p_state->observations++;
+    }
+    return true;
+}
+
+// --- RUN 模式实例 ---
+
+void watering_controller_load_config(watering_ctrl_config_t* p_config) {
+    hydro_config_t& config = ConfigManager::instance().getConfig();
+    p_config->target = config.watering.target;
+    p_config->band = config.watering.hysteresis;
+    p_config->max_duty = (uint8_t)(config.watering.power > 255 ? 255 : config.watering.power);
+    p_config->fixed_duration_ms = config.watering.duration_ms;
+    p_config->min_duration_ms = ADAPTIVE_WATERING_MIN_MS;
+    p_config->max_duration_ms = config.watering.duration_ms > ADAPTIVE_WATERING_MAX_MS ?
+                                config.watering.duration_ms : ADAPTIVE_WATERING_MAX_MS;
+    p_config->soak_s = ADAPTIVE_WATERING_SOAK_MS / 1000;
+}
+
+void watering_controller_init() {
+    if (s_initialized) {
+        return;
+    }
+
+    uint32_t hash = plant_hash(ConfigManager::instance().getConfig().watering.plant_type);
+    watering_ctrl_state_init(&s_state, hash);
+
+    Preferences prefs;
+    if (prefs.begin(NVS_NAMESPACE, true)) {
+        saved_model_t saved;
+        if (prefs.getBytesLength(NVS_KEY_MODEL) == sizeof(saved) &&
+            prefs.getBytes(NVS_KEY_MODEL, &saved, sizeof(saved)) == sizeof(saved) &&
+            saved.magic == MODEL_MAGIC) {
+            if (saved.state.plant_hash == hash) {
+                s_state = saved.state;
+            } else {
+                LOG_INFO("WaterCtrl", "Plant type changed, relearning watering model");
+            }
+        }
+        prefs.end();
+    }
+
+    s_initialized = true;
+    LOG_INFO("WaterCtrl", "Watering model: gain=%.1f ADC/s, %u observations, %u in band",
+             s_state.gain, s_state.observations, s_state.hits);
+}
+
+bool watering_controller_enabled() {
+    return ConfigManager::instance().getConfig().watering.adaptive != 0;
+}
+
+void watering_controller_plan(float current, watering_ctrl_plan_t* p_plan) {
+    watering_ctrl_config_t config;
+    watering_controller_load_config(&config);
+    watering_ctrl_plan(&s_state, &config, current, p_plan);
+}
+
+void watering_controller_begin(float before, uint8_t duty, uint32_t duration_ms) {
+    watering_ctrl_begin(&s_state, before, duty, duration_ms, (uint32_t)time(nullptr));
+    save_model();
+}
+
+void watering_controller_observe(float current) {
+    if (!s_state.pending) {
+        return;
+    }
+
+    watering_ctrl_config_t config;
+    watering_controller_load_config(&config);
+    bool was_pending = s_state.pending;
+    if (watering_ctrl_observe(&s_state, &config, current, (uint32_t)time(nullptr))) {
+        LOG_INFO("WaterCtrl", "Watering response: %.0f -> %.0f, observed gain %.1f, model gain %.1f ADC/s",
+                 s_state.pending_before, current, s_state.last_observed_gain, s_state.gain);
+    }
+    if (was_pending && !s_state.pending) {
+        save_model();
+    }
+}
+
+void watering_controller_get_state(watering_ctrl_state_t* p_state) {
+    *p_state = s_state;
+}
+
+void watering_controller_reset() {
+    watering_ctrl_state_init(&s_state, s_state.plant_hash);
+    save_model();
+    LOG_INFO("WaterCtrl", "Watering model cleared");
+}
@@ -0,0 +1,141 @@
+/**
+ * @file watering_controller.h
+ * @brief 闭环自适应浇水时长
+ * @details
+ *   按植物学习土壤对浇水的响应，根据当前缺水量计算本次的占空比与时长：
+ *   1. 模型：增益 gain = 每"满占空比秒"浇水带来的湿度ADC下降量。
+ *      有效浇水量按 时长 × 占空比/255 计算（水泵流量近似与占空比成正比）。
+ *   2. 规划：缺水量 = 当前读数 − 目标值，所需有效秒数 = 缺水量 / gain；
+ *      先以配置的 power 为占空比求时长，短于最短时长时降低占空比（不低于
+ *      WATERING_CTRL_MIN_DUTY）以拉长时长、让水慢慢渗入；时长不超过上限，
+ *      不足部分留给下一次浇水。
+ *   3. 学习：浇水后等待 soak_s 渗透，用此后第一次读数的下降量更新增益
+ *      （指数平均，单次观测限制在 [1/2, 2] 倍，防止一次异常读数带偏模型）。
+ *      尚无观测时按配置的固定时长浇水，只做学习。
+ *
+ *   目标带为 target ± hysteresis/2：浇水后读数落在带内视为命中。
+ *   模型保存在NVS中，按植物类型区分（更换植物类型时重新学习）。
+ *   核心是对状态结构的纯函数，可用模拟土壤模型离线测试（run adapt sim）。
+ */
+
+#ifndef WATERING_CONTROLLER_H
+#define WATERING_CONTROLLER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define WATERING_CTRL_MIN_DUTY      120       // 最低占空比，低于此值水泵不能稳定出水
+#define WATERING_CTRL_DEFAULT_GAIN  60.0f     // 初始增益 (ADC/满占空比秒)
+#define WATERING_CTRL_MIN_GAIN      5.0f
+#define WATERING_CTRL_MAX_GAIN      1000.0f
+#define WATERING_CTRL_ALPHA         0.25f     // 增益更新的平滑系数
+
+/**
+ * @brief 控制器参数
+ */
+typedef struct {
+    uint16_t target;            ///< 浇水后的目标读数 (ADC值，越小越湿)
+    uint16_t band;              ///< 目标带总宽度 (ADC值)
+    uint8_t max_duty;           ///< 最大占空比 (0-255)
+    uint32_t fixed_duration_ms; ///< 尚无观测时使用的固定时长
+    uint32_t min_duration_ms;   ///< 最短时长
+    uint32_t max_duration_ms;   ///< 最长时长
+    uint32_t soak_s;            ///< 浇水后等待渗透的时间 (秒)
+} watering_ctrl_config_t;
+
+/**
+ * @brief 控制器状态
+ */
+typedef struct {
+    float gain;                 ///< 学习到的增益 (ADC/满占空比秒)
+    uint16_t observations;      ///< 已完成的观测次数
+    uint16_t hits;              ///< 浇水后落在目标带内的次数
+    uint32_t plant_hash;        ///< 模型所属植物类型的哈希
+    bool pending;               ///< 有一次浇水等待观测
+    float pending_before;       ///< 浇水前读数
+    uint8_t pending_duty;
+    uint32_t pending_duration_ms;
+    uint32_t pending_time;      ///< 浇水时间 (系统时钟秒)
+    float last_observed_gain;   ///< 最近一次观测得到的增益（未平滑）
+    float last_after;           ///< 最近一次观测的浇水后读数
+} watering_ctrl_state_t;
+
+/**
+ * @brief 浇水计划
+ */
+typedef struct {
+    uint8_t duty;               ///< 占空比
+    uint32_t duration_ms;       ///< 时长
+    float deficit;              ///< 缺水量 (ADC值)
+    float expected_drop;        ///< 按模型预计的读数下降量
+    bool learned;               ///< 是否按学习到的模型计算（否则为固定时长）
+} watering_ctrl_plan_t;
+
+/**
+ * @brief 清空状态（使用初始增益）
+ */
+void watering_ctrl_state_init(watering_ctrl_state_t* p_state, uint32_t plant_hash);
+
+/**
+ * @brief 计算本次浇水的占空比与时长（纯函数）
+ * @param current 当前湿度读数 (ADC值)
+ */
+void watering_ctrl_plan(const watering_ctrl_state_t* p_state, const watering_ctrl_config_t* p_config,
+                        float current, watering_ctrl_plan_t* p_plan);
+
+/**
+ * @brief 记录一次开始的浇水，等待观测（纯函数）
+ * @param before 浇水前读数
+ * @param now 当前时间 (秒)
+ */
+void watering_ctrl_begin(watering_ctrl_state_t* p_state, float before, uint8_t duty,
+                         uint32_t duration_ms, uint32_t now);
+
+/**
+ * @brief 渗透时间已过时用当前读数更新模型（纯函数）
+ * @return true 本次完成了一次观测
+ */
+bool watering_ctrl_observe(watering_ctrl_state_t* p_state, const watering_ctrl_config_t* p_config,
+                           float current, uint32_t now);
+
+/**
+ * @brief 由当前配置填充控制器参数
+ */
+void watering_controller_load_config(watering_ctrl_config_t* p_config);
+
+/**
+ * @brief 初始化 RUN 模式使用的控制器实例（从NVS读取模型）
+ */
+void watering_controller_init();
+
+/**
+ * @brief 是否启用自适应浇水 (watering.adaptive)
+ */
+bool watering_controller_enabled();
+
+/**
+ * @brief 用当前配置和模型计算本次浇水计划
+ */
+void watering_controller_plan(float current, watering_ctrl_plan_t* p_plan);
+
+/**
+ * @brief 记录一次浇水（自动或强制），渗透后观测响应
+ */
+void watering_controller_begin(float before, uint8_t duty, uint32_t duration_ms);
+
+/**
+ * @brief 每次湿度检查调用：等待观测的浇水渗透时间已过时更新模型
+ */
+void watering_controller_observe(float current);
+
+/**
+ * @brief 获取控制器状态副本
+ */
+void watering_controller_get_state(watering_ctrl_state_t* p_state);
+
+/**
+ * @brief 清空学习到的模型
+ */
+void watering_controller_reset();
+
+#endif // WATERING_CONTROLLER_H
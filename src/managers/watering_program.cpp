@@ -0,0 +1,215 @@
+/**
+ * @file watering_program.cpp
+ * @brief 分段渗透浇水程序实现
+ */
+
+#include "watering_program.h"
+#include "actuator_manager.h"
+#include "sensor_manager.h"
+#include "log_manager.h"
+#include "data/timing_constants.h"
+#include "../services/config_manager.h"
+#include <Arduino.h>
+#include <string.h>
+
+static watering_program_t s_program;
+static watering_program_status_t s_status;
+static uint32_t s_start_time = 0;
+static uint32_t s_phase_start = 0;
+static bool s_done_pending = false;
+
+// --- 私有函数 ---
+
+static void finish(bool stopped_early) {
+    s_status.phase = WATERING_PROGRAM_IDLE;
+    s_status.stopped_early = stopped_early;
+    s_status.elapsed_ms = millis() - s_start_time;
+    s_done_pending = true;
+    LOG_INFO("WaterProg", "Program finished: %u/%u pulses, %lums pump time%s",
+             s_status.pulses_done, s_status.pulses, (unsigned long)s_status.pump_ms,
+             stopped_early ? " (target reached)" : "");
+}
+
+static bool start_pulse() {
+    actuator_profile_t profile;
+    actuator_profile_soft_start(&profile, s_program.duty, s_program.pulse_ms,
+                                ACTUATOR_SOFT_START_MS, ACTUATOR_SOFT_STOP_MS);
+    actuator_result_t result = actuator_manager_run_profile(&profile);
+    if (result != ACTUATOR_OK) {
+        LOG_ERROR("WaterProg", "Failed to start pulse %u (error %d)", s_status.pulses_done + 1, result);
+        return false;
+    }
+    s_status.phase = WATERING_PROGRAM_PULSE;
+    s_phase_start = millis();
+    LOG_DEBUG("WaterProg", "Pulse %u/%u: %lums at %u/255", s_status.pulses_done + 1, s_status.pulses,
+              (unsigned long)s_program.pulse_ms, s_program.duty);
+    return true;
+}
+
+// --- 公共 API ---
+
+void watering_program_from_config(uint8_t duty, uint32_t duration_ms, watering_program_t* p_program) {
+    hydro_config_t& config = ConfigManager::instance().getConfig();
+
+    uint8_t pulses = config.watering.pulse_count;
+    if (pulses < 1) {
+        pulses = 1;
+    } else if (pulses > WATERING_PROGRAM_MAX_PULSES) {
+        pulses = WATERING_PROGRAM_MAX_PULSES;
+    }
+    while (pulses > 1 && duration_ms / pulses < WATERING_PROGRAM_MIN_PULSE_MS) {
+        pulses--;
+    }
+
+    p_program->duty = duty;
+    p_program->pulses = pulses;
+    p_program->pulse_ms = duration_ms / pulses;
+    p_program->gap_ms = (uint32_t)config.watering.pulse_gap_s * 1000;
+    p_program->sample = pulses > 1 && config.watering.pulse_sample != 0;
+    p_program->target = config.watering.target;
+}
+
+watering_program_result_t watering_program_start(const watering_program_t* p_program) {
+    if (p_program == nullptr || p_program->pulses == 0 ||
+        p_program->pulses > WATERING_PROGRAM_MAX_PULSES || p_program->pulse_ms == 0) {
+        return WATERING_PROGRAM_ERROR_INVALID_PARAM;
+    }
+    if (s_status.phase != WATERING_PROGRAM_IDLE || actuator_manager_is_pump_running()) {
+        LOG_WARN("WaterProg", "Watering already in progress");
+        return WATERING_PROGRAM_ERROR_BUSY;
+    }
+
+    s_program = *p_program;
+    memset(&s_status, 0, sizeof(s_status));
+    s_status.pulses = p_program->pulses;
+    s_status.total_ms = p_program->pulse_ms * p_program->pulses + p_program->gap_ms * (p_program->pulses - 1);
+    s_start_time = millis();
+    s_done_pending = false;
+
+    if (p_program->pulses > 1) {
+        LOG_INFO("WaterProg", "Soak program: %u x %lums at %u/255, %lus gaps%s",
+                 p_program->pulses, (unsigned long)p_program->pulse_ms, p_program->duty,
+                 (unsigned long)(p_program->gap_ms / 1000), p_program->sample ? ", sampling" : "");
+    }
+    if (!start_pulse()) {
+        s_status.phase = WATERING_PROGRAM_IDLE;
+        return WATERING_PROGRAM_ERROR_BUSY;
+    }
+    return WATERING_PROGRAM_OK;
+}
+
+void watering_program_loop() {
+    uint32_t now = millis();
+
+    switch (s_status.phase) {
+        case WATERING_PROGRAM_PULSE:
+            // 停泵由执行器的定时器完成，这里只推进到下一阶段
+            if (actuator_manager_is_pump_running()) {
+                break;
+            }
+            s_status.pulses_done++;
+            s_status.pump_ms += s_program.pulse_ms;
+            if (s_status.pulses_done >= s_status.pulses) {
+                finish(false);
+            } else {
+                s_status.phase = WATERING_PROGRAM_SOAK;
+                s_phase_start = now;
+            }
+            break;
+
+        case WATERING_PROGRAM_SOAK:
+            if (now - s_phase_start < s_program.gap_ms) {
+                break;
+            }
+            if (s_program.sample && sensor_manager_start_async(nullptr, nullptr) == SENSOR_OK) {
+                s_status.phase = WATERING_PROGRAM_SAMPLE;
+                s_phase_start = now;
+            } else if (!s_program.sample || !sensor_manager_async_busy()) {
+                if (!start_pulse()) {
+                    s_status.aborted = true;
+                    finish(false);
+                }
+            }
+            // 采集任务被其他使用者占用时下一次循环重试
+            break;
+
+        case WATERING_PROGRAM_SAMPLE: {
+            sensor_async_result_t acquisition;
+            if (!sensor_manager_poll_async(&acquisition)) {
+                break;
+            }
+            if (acquisition.humidity_result == SENSOR_OK) {
+                s_status.samples++;
+                s_status.last_sample = acquisition.humidity;
+                LOG_DEBUG("WaterProg", "Soak sample after pulse %u: %.0f (target %.0f)",
+                          s_status.pulses_done, acquisition.humidity, s_program.target);
+                if (acquisition.humidity <= s_program.target) {
+                    finish(true);
+                    break;
+                }
+            } else {
+                LOG_WARN("WaterProg", "Soak sample failed (error %d), continuing", acquisition.humidity_result);
+            }
+            if (!start_pulse()) {
+                s_status.aborted = true;
+                finish(false);
+            }
+            break;
+        }
+
+        case WATERING_PROGRAM_IDLE:
+        default:
+            break;
+    }
+}
+
+void watering_program_abort() {
+    if (s_status.phase == WATERING_PROGRAM_IDLE) {
+        return;
+    }
+
+    if (s_status.phase == WATERING_PROGRAM_PULSE) {
+        // 计入已运行的部分脉冲
+        uint32_t ran = millis() - s_phase_start;
+        s_status.pump_ms += ran < s_program.pulse_ms ? ran : s_program.pulse_ms;
+        actuator_manager_stop_pump();
+    } else if (s_status.phase == WATERING_PROGRAM_SAMPLE) {
+        sensor_manager_poll_async(nullptr);  // 丢弃结果（采集任务自行结束）
+    }
+
+    LOG_INFO("WaterProg", "Program aborted");
+    s_status.aborted = true;
+    finish(false);
+}
+
+bool watering_program_is_running() {
+    return s_status.phase != WATERING_PROGRAM_IDLE;
+}
+
+bool watering_program_poll_done(watering_program_status_t* p_status) {
+    if (!s_done_pending) {
+        return false;
+    }
+    s_done_pending = false;
+    if (p_status != nullptr) {
+        *p_status = s_status;
+    }
+    return true;
+}
+
+void watering_program_get_status(watering_program_status_t* p_status) {
+    *p_status = s_status;
+    if (s_status.phase != WATERING_PROGRAM_IDLE) {
+        p_status->elapsed_ms = millis() - s_start_time;
+    }
+}
+
+const char* watering_program_phase_name(watering_program_phase_t phase) {
+    switch (phase) {
+        case WATERING_PROGRAM_IDLE:   return "idle";
+        case WATERING_PROGRAM_PULSE:  return "pulse";
+        case WATERING_PROGRAM_SOAK:   return "soak";
+        case WATERING_PROGRAM_SAMPLE: return "sample";
+    }
+    return "unknown";
+}
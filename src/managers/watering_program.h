@@ -0,0 +1,116 @@
+/**
+ * @file watering_program.h
+ * @brief 分段渗透浇水程序
+ * @details
+ *   干燥或疏水的土壤来不及吸收一次连续浇下的水，多余的水从表面流走，
+ *   随后又要补浇，浪费升压模块的电能。浇水程序把一次剂量分成 N 个脉冲：
+ *   1. 每个脉冲由执行器引擎按软启动曲线运行 pulse_ms，定时器精确停泵；
+ *   2. 脉冲之间等待 gap_ms 让水渗入（期间关闭12V电源）；
+ *   3. 可选：间隙末尾通过异步采集读取一次湿度，读数达到目标
+ *      (≤ target，越小越湿) 时提前结束，剩余脉冲不再运行。
+ *   整个程序由 watering_program_loop() 推进，不阻塞主循环；
+ *   结束后通过 watering_program_poll_done() 取回实际运行的水泵时间。
+ */
+
+#ifndef WATERING_PROGRAM_H
+#define WATERING_PROGRAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define WATERING_PROGRAM_MAX_PULSES 10
+
+/**
+ * @brief 浇水程序操作结果
+ */
+typedef enum {
+    WATERING_PROGRAM_OK = 0,
+    WATERING_PROGRAM_ERROR_BUSY,            ///< 程序或水泵正在运行
+    WATERING_PROGRAM_ERROR_INVALID_PARAM    ///< 参数无效
+} watering_program_result_t;
+
+/**
+ * @brief 程序阶段
+ */
+typedef enum {
+    WATERING_PROGRAM_IDLE = 0,
+    WATERING_PROGRAM_PULSE,                 ///< 水泵运行中
+    WATERING_PROGRAM_SOAK,                  ///< 渗透间隙
+    WATERING_PROGRAM_SAMPLE                 ///< 间隙末尾的湿度采样
+} watering_program_phase_t;
+
+/**
+ * @brief 程序参数
+ */
+typedef struct {
+    uint8_t duty;               ///< 占空比 (0-255)
+    uint8_t pulses;             ///< 脉冲数 (1-WATERING_PROGRAM_MAX_PULSES)
+    uint32_t pulse_ms;          ///< 每个脉冲的时长 (含软启动与降速)
+    uint32_t gap_ms;            ///< 脉冲之间的渗透间隙
+    bool sample;                ///< 间隙末尾采样湿度
+    float target;               ///< 提前结束的目标读数 (ADC值)
+} watering_program_t;
+
+/**
+ * @brief 程序状态
+ */
+typedef struct {
+    watering_program_phase_t phase;
+    uint8_t pulses;             ///< 计划的脉冲数
+    uint8_t pulses_done;        ///< 已完成的脉冲数
+    uint32_t pump_ms;           ///< 实际运行的水泵时间
+    uint32_t elapsed_ms;        ///< 从开始经过的时间
+    uint32_t total_ms;          ///< 计划总时长（含间隙，不含采样）
+    uint8_t samples;            ///< 间隙采样次数
+    float last_sample;          ///< 最近一次间隙采样的读数
+    bool stopped_early;         ///< 因达到目标提前结束
+    bool aborted;               ///< 被中止
+} watering_program_status_t;
+
+/**
+ * @brief 按配置把一次剂量拆分为浇水程序
+ * @details 脉冲数取 watering.pulse_count，脉冲过短 (< WATERING_PROGRAM_MIN_PULSE_MS)
+ *          时减少脉冲数；间隙、采样与目标读数取自浇水配置
+ * @param duty 占空比
+ * @param duration_ms 本次剂量的总水泵时间
+ */
+void watering_program_from_config(uint8_t duty, uint32_t duration_ms, watering_program_t* p_program);
+
+/**
+ * @brief 开始浇水程序（立即运行第一个脉冲）
+ */
+watering_program_result_t watering_program_start(const watering_program_t* p_program);
+
+/**
+ * @brief 推进程序，应在主循环中周期性调用
+ */
+void watering_program_loop();
+
+/**
+ * @brief 中止程序并停泵
+ */
+void watering_program_abort();
+
+/**
+ * @brief 程序是否正在运行
+ */
+bool watering_program_is_running();
+
+/**
+ * @brief 查询程序是否已结束，结束时取回最终状态
+ * @param p_status 输出状态（可为NULL）
+ * @return true 已结束（每次程序只返回一次）
+ */
+bool watering_program_poll_done(watering_program_status_t* p_status);
+
+/**
+ * @brief 获取当前（或最近一次）程序的状态
+ */
+void watering_program_get_status(watering_program_status_t* p_status);
+
+/**
+ * @brief 阶段名称
+ */
+const char* watering_program_phase_name(watering_program_phase_t phase);
+
+#endif // WATERING_PROGRAM_H
@@ -59,6 +59,19 @@ hydro_config_t ConfigManager::getDefaultConfig() {
     cfg.watering.humidity_dry = 2600;        // 干燥上限 (ADC值)
     strncpy(cfg.watering.plant_type, "UnnamedPlant", sizeof(cfg.watering.plant_type) - 1);
     cfg.watering.plant_type[sizeof(cfg.watering.plant_type) - 1] = '\0';
+    cfg.watering.filter_window = 5;          // 5点中位数
+    cfg.watering.hampel_k = 3.0f;            // 3倍MAD视为尖峰
+    cfg.watering.hysteresis = 100;           // 阈值上下各50
+    cfg.watering.daily_budget_s = 0;         // 不限水泵运行时间
+    cfg.watering.flow_ml_min = 0;            // 流量未标定
+    cfg.watering.daily_budget_ml = 0;        // 不限水量
+    cfg.watering.quiet_start_h = 0;          // 不启用静默时段
+    cfg.watering.quiet_end_h = 0;
+    cfg.watering.adaptive = 0;               // 固定时长；自适应需显式开启
+    cfg.watering.target = 1500;              // 浇水后目标读数（阈值与湿润下限之间）
+    cfg.watering.pulse_count = 1;            // 连续浇水
+    cfg.watering.pulse_gap_s = 30;           // 分段时每段之间渗透30秒
+    cfg.watering.pulse_sample = 1;           // 分段时间隙末尾采样，达到目标即停止
 
     // WiFi配置默认值
     memset(cfg.wifi.ssid, 0, sizeof(cfg.wifi.ssid));
@@ -79,6 +92,27 @@ hydro_config_t ConfigManager::getDefaultConfig() {
     cfg.system.timezone[sizeof(cfg.system.timezone) - 1] = '\0';
     strncpy(cfg.system.ntp_server, "pool.ntp.org", sizeof(cfg.system.ntp_server) - 1);
     cfg.system.ntp_server[sizeof(cfg.system.ntp_server) - 1] = '\0';
+    memset(cfg.system.log_levels, 0, sizeof(cfg.system.log_levels));
+    cfg.system.run_sleep = 0;  // 保持唤醒轮询；深度睡眠（1/2）需显式开启
+    cfg.system.check_max_s = 7200;      // 按干燥速率预测最多延长到2小时检查一次
+    cfg.system.check_margin_pct = 30;   // 在预计越过阈值前30%的时间处检查
+
+    // 电池模型默认值
+    memset(cfg.battery.soc_curve, 0, sizeof(cfg.battery.soc_curve));  // 使用内置曲线
+    cfg.battery.capacity_mah = 2000;
+    cfg.battery.internal_resistance_mohm = 150;
+
+    // 能耗账本默认电流（与电池模型的负载估计一致）
+    cfg.power.sensor_ua = 5000;
+    cfg.power.boost_ua = 20000;
+    cfg.power.screen_ua = 8000;
+    cfg.power.pump_ua = 250000;
+    cfg.power.cpu_ua = 45000;
+    cfg.power.wifi_ua = 80000;
+    cfg.power.sleep_ua = 20;
+    cfg.power.sensor_linger_ms = 0;     // 每次检查只读取一次，保持只会延长开启时间
+    cfg.power.boost_linger_ms = 2000;   // 短于渗透间隙，间隙期间仍关闭12V
+    cfg.power.screen_linger_ms = 1000;  // 覆盖模式切换时的屏幕重新上电
 
     return cfg;
 }
@@ -117,6 +151,20 @@ bool ConfigManager::loadConfig() {
         const char* plant_type = watering_obj["plant_type"] | m_config.watering.plant_type;
         strncpy(m_config.watering.plant_type, plant_type, sizeof(m_config.watering.plant_type) - 1);
         m_config.watering.plant_type[sizeof(m_config.watering.plant_type) - 1] = '\0';
+
+        m_config.watering.filter_window = watering_obj["filter_window"] | m_config.watering.filter_window;
+        m_config.watering.hampel_k = watering_obj["hampel_k"] | m_config.watering.hampel_k;
+        m_config.watering.hysteresis = watering_obj["hysteresis"] | m_config.watering.hysteresis;
+        m_config.watering.daily_budget_s = watering_obj["daily_budget_s"] | m_config.watering.daily_budget_s;
+        m_config.watering.flow_ml_min = watering_obj["flow_ml_min"] | m_config.watering.flow_ml_min;
+        m_config.watering.daily_budget_ml = watering_obj["daily_budget_ml"] | m_config.watering.daily_budget_ml;
+        m_config.watering.quiet_start_h = watering_obj["quiet_start_h"] | m_config.watering.quiet_start_h;
+        m_config.watering.quiet_end_h = watering_obj["quiet_end_h"] | m_config.watering.quiet_end_h;
+        m_config.watering.adaptive = watering_obj["adaptive"] | m_config.watering.adaptive;
+        m_config.watering.target = watering_obj["target"] | m_config.watering.target;
+        m_config.watering.pulse_count = watering_obj["pulse_count"] | m_config.watering.pulse_count;
+        m_config.watering.pulse_gap_s = watering_obj["pulse_gap_s"] | m_config.watering.pulse_gap_s;
+        m_config.watering.pulse_sample = watering_obj["pulse_sample"] | m_config.watering.pulse_sample;
     }
 
     // 加载WiFi配置
@@ -169,6 +217,41 @@ bool ConfigManager::loadConfig() {
         const char* ntp_server = system_obj["ntp_server"] | m_config.system.ntp_server;
         strncpy(m_config.system.ntp_server, ntp_server, sizeof(m_config.system.ntp_server) - 1);
         m_config.system.ntp_server[sizeof(m_config.system.ntp_server) - 1] = '\0';
+
+        const char* log_levels = system_obj["log_levels"] | m_config.system.log_levels;
+        strncpy(m_config.system.log_levels, log_levels, sizeof(m_config.system.log_levels) - 1);
+        m_config.system.log_levels[sizeof(m_config.system.log_levels) - 1] = '\0';
+
+        m_config.system.run_sleep = system_obj["run_sleep"] | m_config.system.run_sleep;
+        m_config.system.check_max_s = system_obj["check_max_s"] | m_config.system.check_max_s;
+        m_config.system.check_margin_pct = system_obj["check_margin_pct"] | m_config.system.check_margin_pct;
+    }
+
+    // 加载电池模型配置
+    JsonObject battery_obj = doc["battery"];
+    if (!battery_obj.isNull()) {
+        const char* soc_curve = battery_obj["soc_curve"] | m_config.battery.soc_curve;
+        strncpy(m_config.battery.soc_curve, soc_curve, sizeof(m_config.battery.soc_curve) - 1);
+        m_config.battery.soc_curve[sizeof(m_config.battery.soc_curve) - 1] = '\0';
+
+        m_config.battery.capacity_mah = battery_obj["capacity_mah"] | m_config.battery.capacity_mah;
+        m_config.battery.internal_resistance_mohm =
+            battery_obj["internal_resistance_mohm"] | m_config.battery.internal_resistance_mohm;
+    }
+
+    // 加载能耗账本配置
+    JsonObject power_obj = doc["power"];
+    if (!power_obj.isNull()) {
+        m_config.power.sensor_ua = power_obj["sensor_ua"] | m_config.power.sensor_ua;
+        m_config.power.boost_ua = power_obj["boost_ua"] | m_config.power.boost_ua;
+        m_config.power.screen_ua = power_obj["screen_ua"] | m_config.power.screen_ua;
+        m_config.power.pump_ua = power_obj["pump_ua"] | m_config.power.pump_ua;
+        m_config.power.cpu_ua = power_obj["cpu_ua"] | m_config.power.cpu_ua;
+        m_config.power.wifi_ua = power_obj["wifi_ua"] | m_config.power.wifi_ua;
+        m_config.power.sleep_ua = power_obj["sleep_ua"] | m_config.power.sleep_ua;
+        m_config.power.sensor_linger_ms = power_obj["sensor_linger_ms"] | m_config.power.sensor_linger_ms;
+        m_config.power.boost_linger_ms = power_obj["boost_linger_ms"] | m_config.power.boost_linger_ms;
+        m_config.power.screen_linger_ms = power_obj["screen_linger_ms"] | m_config.power.screen_linger_ms;
     }
 
     LOG_INFO("ConfigManager", "Configuration loaded successfully");
@@ -193,6 +276,19 @@ bool ConfigManager::saveConfig() {
     watering_obj["humidity_wet"] = m_config.watering.humidity_wet;
     watering_obj["humidity_dry"] = m_config.watering.humidity_dry;
     watering_obj["plant_type"] = m_config.watering.plant_type;
+    watering_obj["filter_window"] = m_config.watering.filter_window;
+    watering_obj["hampel_k"] = m_config.watering.hampel_k;
+    watering_obj["hysteresis"] = m_config.watering.hysteresis;
+    watering_obj["daily_budget_s"] = m_config.watering.daily_budget_s;
+    watering_obj["flow_ml_min"] = m_config.watering.flow_ml_min;
+    watering_obj["daily_budget_ml"] = m_config.watering.daily_budget_ml;
+    watering_obj["quiet_start_h"] = m_config.watering.quiet_start_h;
+    watering_obj["quiet_end_h"] = m_config.watering.quiet_end_h;
+    watering_obj["adaptive"] = m_config.watering.adaptive;
+    watering_obj["target"] = m_config.watering.target;
+    watering_obj["pulse_count"] = m_config.watering.pulse_count;
+    watering_obj["pulse_gap_s"] = m_config.watering.pulse_gap_s;
+    watering_obj["pulse_sample"] = m_config.watering.pulse_sample;
 
     // WiFi配置
     JsonObject wifi_obj = doc["wifi"].to<JsonObject>();
@@ -213,6 +309,29 @@ bool ConfigManager::saveConfig() {
     system_obj["ntp_enabled"] = m_config.system.ntp_enabled;
     system_obj["timezone"] = m_config.system.timezone;
     system_obj["ntp_server"] = m_config.system.ntp_server;
+    system_obj["log_levels"] = m_config.system.log_levels;
+    system_obj["run_sleep"] = m_config.system.run_sleep;
+    system_obj["check_max_s"] = m_config.system.check_max_s;
+    system_obj["check_margin_pct"] = m_config.system.check_margin_pct;
+
+    // 电池模型配置
+    JsonObject battery_obj = doc["battery"].to<JsonObject>();
+    battery_obj["soc_curve"] = m_config.battery.soc_curve;
+    battery_obj["capacity_mah"] = m_config.battery.capacity_mah;
+    battery_obj["internal_resistance_mohm"] = m_config.battery.internal_resistance_mohm;
+
+    // 能耗账本配置
+    JsonObject power_obj = doc["power"].to<JsonObject>();
+    power_obj["sensor_ua"] = m_config.power.sensor_ua;
+    power_obj["boost_ua"] = m_config.power.boost_ua;
+    power_obj["screen_ua"] = m_config.power.screen_ua;
+    power_obj["pump_ua"] = m_config.power.pump_ua;
+    power_obj["cpu_ua"] = m_config.power.cpu_ua;
+    power_obj["wifi_ua"] = m_config.power.wifi_ua;
+    power_obj["sleep_ua"] = m_config.power.sleep_ua;
+    power_obj["sensor_linger_ms"] = m_config.power.sensor_linger_ms;
+    power_obj["boost_linger_ms"] = m_config.power.boost_linger_ms;
+    power_obj["screen_linger_ms"] = m_config.power.screen_linger_ms;
 
     // 序列化到字符串
     String json_output;
@@ -251,6 +370,19 @@ String ConfigManager::getConfigJson() {
     watering_obj["humidity_wet"] = m_config.watering.humidity_wet;
     watering_obj["humidity_dry"] = m_config.watering.humidity_dry;
     watering_obj["plant_type"] = m_config.watering.plant_type;
+    watering_obj["filter_window"] = m_config.watering.filter_window;
+    watering_obj["hampel_k"] = m_config.watering.hampel_k;
+    watering_obj["hysteresis"] = m_config.watering.hysteresis;
+    watering_obj["daily_budget_s"] = m_config.watering.daily_budget_s;
+    watering_obj["flow_ml_min"] = m_config.watering.flow_ml_min;
+    watering_obj["daily_budget_ml"] = m_config.watering.daily_budget_ml;
+    watering_obj["quiet_start_h"] = m_config.watering.quiet_start_h;
+    watering_obj["quiet_end_h"] = m_config.watering.quiet_end_h;
+    watering_obj["adaptive"] = m_config.watering.adaptive;
+    watering_obj["target"] = m_config.watering.target;
+    watering_obj["pulse_count"] = m_config.watering.pulse_count;
+    watering_obj["pulse_gap_s"] = m_config.watering.pulse_gap_s;
+    watering_obj["pulse_sample"] = m_config.watering.pulse_sample;
 
     // WiFi配置（隐藏密码和API Key）
     JsonObject wifi_obj = doc["wifi"].to<JsonObject>();
@@ -271,6 +403,29 @@ String ConfigManager::getConfigJson() {
     system_obj["ntp_enabled"] = m_config.system.ntp_enabled;
     system_obj["timezone"] = m_config.system.timezone;
     system_obj["ntp_server"] = m_config.system.ntp_server;
+    system_obj["log_levels"] = m_config.system.log_levels;
+    system_obj["run_sleep"] = m_config.system.run_sleep;
+    system_obj["check_max_s"] = m_config.system.check_max_s;
+    system_obj["check_margin_pct"] = m_config.system.check_margin_pct;
+
+    // 电池模型配置
+    JsonObject battery_obj = doc["battery"].to<JsonObject>();
+    battery_obj["soc_curve"] = m_config.battery.soc_curve;
+    battery_obj["capacity_mah"] = m_config.battery.capacity_mah;
+    battery_obj["internal_resistance_mohm"] = m_config.battery.internal_resistance_mohm;
+
+    // 能耗账本配置
+    JsonObject power_obj = doc["power"].to<JsonObject>();
+    power_obj["sensor_ua"] = m_config.power.sensor_ua;
+    power_obj["boost_ua"] = m_config.power.boost_ua;
+    power_obj["screen_ua"] = m_config.power.screen_ua;
+    power_obj["pump_ua"] = m_config.power.pump_ua;
+    power_obj["cpu_ua"] = m_config.power.cpu_ua;
+    power_obj["wifi_ua"] = m_config.power.wifi_ua;
+    power_obj["sleep_ua"] = m_config.power.sleep_ua;
+    power_obj["sensor_linger_ms"] = m_config.power.sensor_linger_ms;
+    power_obj["boost_linger_ms"] = m_config.power.boost_linger_ms;
+    power_obj["screen_linger_ms"] = m_config.power.screen_linger_ms;
 
     String json_output;
     serializeJsonPretty(doc, json_output);
@@ -8,12 +8,23 @@
 #include "wifi_manager.h"
 #include "history_manager.h"
 #include "../managers/sensor_manager.h"
+#include "../managers/power_manager.h"
 #include "time_manager.h"
 #include "../managers/log_manager.h"
 #include <ArduinoJson.h>
 
 LLMConnector* LLMConnector::s_instance = nullptr;
 
+/**
+ * @brief 日志查询回调：逐行追加到 String
+ */
+static bool append_log_line(const log_entry_t* entry, void* ctx) {
+    String* summary = (String*)ctx;
+    *summary += entry->line;
+    *summary += "\n";
+    return true;
+}
+
 LLMConnector& LLMConnector::instance() {
     if (s_instance == nullptr) {
         s_instance = new LLMConnector();
@@ -125,15 +136,27 @@ String LLMConnector::buildChatRequest(const char* user_message, bool use_history
         time_str = "未同步";
     }
 
+    // 传感器健康（故障时提示读数不可信）
+    sensor_health_t health;
+    sensor_manager_get_health(&health);
+    char faults_buf[64];
+    sensor_health_format(health.faults, faults_buf, sizeof(faults_buf));
+
+    // 能耗摘要：平均电流与耗电最多的条目
+    char energy_buf[96];
+    power_ledger_format_summary(energy_buf, sizeof(energy_buf));
+
     // 构建系统状态字符串
-    char status[512];
+    char status[640];
     snprintf(status, sizeof(status),
              "系统状态 -\n"
-             "传感器: 湿度%d ADC (%.0f%%), 电池%.2fV\n"
+             "传感器: 湿度%d ADC (%.0f%%), 电池%.2fV, 健康=%s (噪声%.0f, 连续无响应浇水%u次)\n"
              "配置: 阈值%d (%.0f%%), 功率%d, 时长%dms, 间隔%ds, 范围%d-%d\n"
-             "网络: WiFi=%s(%s), 时间=%s",
+             "网络: WiFi=%s(%s), 时间=%s\n"
+             "能耗: %s",
              sensor_data.soil_moisture, humidity_pct,
              sensor_data.battery_voltage,
+             faults_buf, health.noise_std, health.unresponsive_waterings,
              config.watering.threshold, threshold_pct,
              config.watering.power,
              config.watering.duration_ms,
@@ -142,15 +165,25 @@ String LLMConnector::buildChatRequest(const char* user_message, bool use_history
              config.watering.humidity_dry,
              wifi_connected ? "已连接" : "未连接",
              ssid,
-             time_str.c_str());
+             time_str.c_str(),
+             energy_buf);
 
     JsonObject status_msg = messages.add<JsonObject>();
     status_msg["role"] = "system";
     status_msg["content"] = status;
 
-    // ===== 3. 日志摘要（只发一次，最新20条）=====
-    String recent_logs = log_manager_get_recent_logs(20);
-    String log_summary = "最近系统日志:\n" + recent_logs;
+    // ===== 3. 日志摘要（只发一次，最新20条，包含Flash中的历史记录）=====
+    log_query_t log_query;
+    log_manager_query_init(&log_query);
+    log_query.max_level = LOG_LEVEL_INFO;
+    log_query.limit = 20;
+    log_query.sources = LOG_QUERY_SOURCE_ALL;
+
+    String log_summary = "最近系统日志:\n";
+    log_summary.reserve(log_query.limit * 96);
+    if (log_manager_query(&log_query, append_log_line, &log_summary) == 0) {
+        log_summary += "No logs";
+    }
 
     JsonObject log_msg = messages.add<JsonObject>();
     log_msg["role"] = "system";
@@ -0,0 +1,302 @@
+/**
+ * @file watering_scheduler.cpp
+ * @brief 浇水调度器实现
+ */
+
+#include "watering_scheduler.h"
+#include "config_manager.h"
+#include "../managers/log_manager.h"
+#include <ArduinoJson.h>
+#include <Preferences.h>
+#include <stdlib.h>
+
+static const char* NVS_NAMESPACE = "wsched";
+static const char* KEY_STATE = "state";
+static const uint32_t STATE_MAGIC = 0x57534331;     // "WSC1"
+static const uint32_t VALID_TIME = 1577836800;      // 2020-01-01，之前视为未校准
+static const uint32_t BOOT_DAY_FLAG = 0x80000000;   // 未校准时的"天"编号标记
+static const uint32_t SECONDS_PER_DAY = 86400;
+
+WateringScheduler* WateringScheduler::s_instance = nullptr;
+
+WateringScheduler& WateringScheduler::instance() {
+    if (s_instance == nullptr) {
+        s_instance = new WateringScheduler();
+    }
+    return *s_instance;
+}
+
+WateringScheduler::WateringScheduler() :
+    m_last_decision(WateringDecision::ALLOWED),
+    m_last_wait_s(0),
+    m_initialized(false)
+{
+    memset(&m_state, 0, sizeof(m_state));
+}
+
+bool WateringScheduler::init() {
+    if (m_initialized) {
+        return true;
+    }
+
+    // 静默时段和日期按本地时间计算；深度睡眠唤醒后时间管理器未必已设置时区
+    hydro_config_t& config = ConfigManager::instance().getConfig();
+    if (getenv("TZ") == nullptr) {
+        setenv("TZ", config.system.timezone, 1);
+        tzset();
+    }
+
+    Preferences prefs;
+    bool loaded = false;
+    if (prefs.begin(NVS_NAMESPACE, true)) {
+        State saved;
+        if (prefs.getBytesLength(KEY_STATE) == sizeof(saved) &&
+            prefs.getBytes(KEY_STATE, &saved, sizeof(saved)) == sizeof(saved) &&
+            saved.magic == STATE_MAGIC) {
+            m_state = saved;
+            loaded = true;
+        }
+        prefs.end();
+    }
+    if (!loaded) {
+        memset(&m_state, 0, sizeof(m_state));
+        m_state.magic = STATE_MAGIC;
+    }
+
+    m_initialized = true;
+    LOG_INFO("Scheduler", "Watering scheduler initialized (%s, today %u waterings / %lums)",
+             loaded ? "restored" : "no saved state", m_state.day_count, (unsigned long)m_state.day_pump_ms);
+    return true;
+}
+
+uint32_t WateringScheduler::dayKey(uint32_t now) {
+    if (now < VALID_TIME) {
+        return BOOT_DAY_FLAG | (now / SECONDS_PER_DAY);
+    }
+    time_t t = now;
+    struct tm timeinfo;
+    localtime_r(&t, &timeinfo);
+    return (uint32_t)(timeinfo.tm_year + 1900) * 10000 + (timeinfo.tm_mon + 1) * 100 + timeinfo.tm_mday;
+}
+
+uint32_t WateringScheduler::secondsToNextDay(uint32_t now) {
+    if (now < VALID_TIME) {
+        return SECONDS_PER_DAY - now % SECONDS_PER_DAY;
+    }
+    time_t t = now;
+    struct tm timeinfo;
+    localtime_r(&t, &timeinfo);
+    return SECONDS_PER_DAY - (timeinfo.tm_hour * 3600 + timeinfo.tm_min * 60 + timeinfo.tm_sec);
+}
+
+uint32_t WateringScheduler::volumeMl(uint32_t duration_ms, uint16_t flow_ml_min) {
+    return (uint32_t)((uint64_t)duration_ms * flow_ml_min / 60000);
+}
+
+void WateringScheduler::rollDay(uint32_t now) {
+    uint32_t key = dayKey(now);
+    if (key == m_state.day_key) {
+        return;
+    }
+    if (m_state.day_count > 0) {
+        LOG_INFO("Scheduler", "New day: yesterday %u waterings, %lums pump time",
+                 m_state.day_count, (unsigned long)m_state.day_pump_ms);
+    }
+    m_state.day_key = key;
+    m_state.day_pump_ms = 0;
+    m_state.day_volume_ml = 0;
+    m_state.day_count = 0;
+}
+
+void WateringScheduler::save() {
+    Preferences prefs;
+    if (!prefs.begin(NVS_NAMESPACE, false)) {
+        LOG_ERROR("Scheduler", "Failed to open NVS namespace");
+        return;
+    }
+    if (prefs.putBytes(KEY_STATE, &m_state, sizeof(m_state)) != sizeof(m_state)) {
+        LOG_ERROR("Scheduler", "Failed to save scheduler state");
+    }
+    prefs.end();
+}
+
+WateringDecision WateringScheduler::check(uint32_t requested_ms, uint32_t* p_allowed_ms) {
+    hydro_config_t& config = ConfigManager::instance().getConfig();
+    uint32_t now = (uint32_t)time(nullptr);
+    rollDay(now);
+
+    // 时钟倒退（断电后未校准）：从现在起重新计算间隔，宁可少浇一次
+    if (m_state.last_watering > now) {
+        LOG_WARN("Scheduler", "Clock went backwards, restarting min interval from now");
+        m_state.last_watering = now;
+        save();
+    }
+
+    WateringDecision decision = WateringDecision::ALLOWED;
+    uint32_t wait_s = 0;
+    uint32_t allowed_ms = requested_ms;
+
+    uint8_t quiet_start = config.watering.quiet_start_h;
+    uint8_t quiet_end = config.watering.quiet_end_h;
+    if (quiet_start != quiet_end && now >= VALID_TIME) {
+        time_t t = now;
+        struct tm timeinfo;
+        localtime_r(&t, &timeinfo);
+        uint8_t hour = timeinfo.tm_hour;
+        bool quiet = quiet_start < quiet_end ? (hour >= quiet_start && hour < quiet_end)
+                                             : (hour >= quiet_start || hour < quiet_end);
+        if (quiet) {
+            decision = WateringDecision::QUIET_HOURS;
+            int32_t secs = (int32_t)quiet_end * 3600 -
+                           (timeinfo.tm_hour * 3600 + timeinfo.tm_min * 60 + timeinfo.tm_sec);
+            wait_s = secs > 0 ? secs : secs + SECONDS_PER_DAY;
+        }
+    }
+
+    if (decision == WateringDecision::ALLOWED && m_state.total_count > 0 &&
+        now - m_state.last_watering < config.watering.min_interval_s) {
+        decision = WateringDecision::MIN_INTERVAL;
+        wait_s = config.watering.min_interval_s - (now - m_state.last_watering);
+    }
+
+    if (decision == WateringDecision::ALLOWED && config.watering.daily_budget_s > 0) {
+        uint32_t budget_ms = (uint32_t)config.watering.daily_budget_s * 1000;
+        if (m_state.day_pump_ms >= budget_ms) {
+            decision = WateringDecision::DAILY_TIME_BUDGET;
+            wait_s = secondsToNextDay(now);
+        } else if (allowed_ms > budget_ms - m_state.day_pump_ms) {
+            allowed_ms = budget_ms - m_state.day_pump_ms;
+        }
+    }
+
+    uint16_t flow = config.watering.flow_ml_min;
+    if (decision == WateringDecision::ALLOWED && config.watering.daily_budget_ml > 0 && flow > 0) {
+        uint32_t budget_ml = config.watering.daily_budget_ml;
+        if (m_state.day_volume_ml >= budget_ml) {
+            decision = WateringDecision::DAILY_VOLUME_BUDGET;
+            wait_s = secondsToNextDay(now);
+        } else {
+            uint32_t remaining_ms = (uint32_t)((uint64_t)(budget_ml - m_state.day_volume_ml) * 60000 / flow);
+            if (allowed_ms > remaining_ms) {
+                allowed_ms = remaining_ms;
+            }
+        }
+    }
+
+    if (decision != WateringDecision::ALLOWED) {
+        allowed_ms = 0;
+    }
+
+    // 原因变化时记录，重复的判定降为调试日志，避免每次检查刷屏
+    bool budget_spent = decision == WateringDecision::DAILY_TIME_BUDGET ||
+                        decision == WateringDecision::DAILY_VOLUME_BUDGET;
+    if (decision != m_last_decision && budget_spent) {
+        // 预算用完后当天不再自动浇水，需要让用户看到
+        LOG_WARN("Scheduler", "Watering skipped, %s spent (%lums / %lumL today), resumes in %lus",
+                 decisionName(decision), (unsigned long)m_state.day_pump_ms,
+                 (unsigned long)m_state.day_volume_ml, (unsigned long)wait_s);
+    } else if (decision != m_last_decision) {
+        LOG_INFO("Scheduler", "Watering %s (%s, wait %lus)",
+                 decision == WateringDecision::ALLOWED ? "allowed" : "deferred",
+                 decisionName(decision), (unsigned long)wait_s);
+    } else {
+        LOG_DEBUG("Scheduler", "Decision %s, wait %lus", decisionName(decision), (unsigned long)wait_s);
+    }
+    if (decision == WateringDecision::ALLOWED && allowed_ms < requested_ms) {
+        LOG_INFO("Scheduler", "Duration clipped to remaining budget: %lums of %lums",
+                 (unsigned long)allowed_ms, (unsigned long)requested_ms);
+    }
+    m_last_decision = decision;
+    m_last_wait_s = wait_s;
+
+    if (p_allowed_ms != nullptr) {
+        *p_allowed_ms = allowed_ms;
+    }
+    return decision;
+}
+
+void WateringScheduler::recordWatering(uint32_t duration_ms) {
+    hydro_config_t& config = ConfigManager::instance().getConfig();
+    uint32_t now = (uint32_t)time(nullptr);
+    rollDay(now);
+
+    m_state.last_watering = now;
+    m_state.day_pump_ms += duration_ms;
+    m_state.day_volume_ml += volumeMl(duration_ms, config.watering.flow_ml_min);
+    m_state.day_count++;
+    m_state.total_count++;
+    save();
+
+    LOG_DEBUG("Scheduler", "Recorded %lums watering, today %u / %lums",
+              (unsigned long)duration_ms, m_state.day_count, (unsigned long)m_state.day_pump_ms);
+}
+
+void WateringScheduler::reset() {
+    memset(&m_state, 0, sizeof(m_state));
+    m_state.magic = STATE_MAGIC;
+    m_last_decision = WateringDecision::ALLOWED;
+    m_last_wait_s = 0;
+    save();
+    LOG_INFO("Scheduler", "Scheduler state cleared");
+}
+
+void WateringScheduler::getStatus(WateringScheduleStatus* p_status) {
+    if (p_status == nullptr) {
+        return;
+    }
+    uint32_t now = (uint32_t)time(nullptr);
+    rollDay(now);
+
+    p_status->last_watering = m_state.total_count > 0 ? m_state.last_watering : 0;
+    p_status->since_last_s = m_state.total_count > 0 && now >= m_state.last_watering ? now - m_state.last_watering : 0;
+    p_status->day_pump_ms = m_state.day_pump_ms;
+    p_status->day_volume_ml = m_state.day_volume_ml;
+    p_status->day_count = m_state.day_count;
+    p_status->total_count = m_state.total_count;
+    p_status->decision = m_last_decision;
+    p_status->wait_s = m_last_wait_s;
+    p_status->clock_valid = now >= VALID_TIME;
+}
+
+const char* WateringScheduler::decisionName(WateringDecision decision) {
+    switch (decision) {
+        case WateringDecision::ALLOWED:             return "allowed";
+        case WateringDecision::QUIET_HOURS:         return "quiet_hours";
+        case WateringDecision::MIN_INTERVAL:        return "min_interval";
+        case WateringDecision::DAILY_TIME_BUDGET:   return "daily_time_budget";
+        case WateringDecision::DAILY_VOLUME_BUDGET: return "daily_volume_budget";
+    }
+    return "unknown";
+}
+
+String WateringScheduler::getStatusJson() {
+    JsonDocument doc;
+    hydro_config_t& config = ConfigManager::instance().getConfig();
+
+    WateringScheduleStatus status;
+    getStatus(&status);
+
+    doc["clock_valid"] = status.clock_valid;
+    doc["last_watering"] = status.last_watering;
+    doc["since_last_s"] = status.since_last_s;
+    doc["total_count"] = status.total_count;
+    doc["last_decision"] = decisionName(status.decision);
+    doc["wait_s"] = status.wait_s;
+
+    JsonObject today = doc["today"].to<JsonObject>();
+    today["count"] = status.day_count;
+    today["pump_ms"] = status.day_pump_ms;
+    today["volume_ml"] = status.day_volume_ml;
+
+    JsonObject limits = doc["limits"].to<JsonObject>();
+    limits["min_interval_s"] = config.watering.min_interval_s;
+    limits["daily_budget_s"] = config.watering.daily_budget_s;
+    limits["daily_budget_ml"] = config.watering.daily_budget_ml;
+    limits["flow_ml_min"] = config.watering.flow_ml_min;
+    limits["quiet_start_h"] = config.watering.quiet_start_h;
+    limits["quiet_end_h"] = config.watering.quiet_end_h;
+
+    String output;
+    serializeJson(doc, output);
+    return output;
+}
@@ -0,0 +1,150 @@
+/**
+ * @file watering_scheduler.h
+ * @brief 浇水调度器 - 最小浇水间隔、每日水量预算与静默时段
+ */
+
+#ifndef WATERING_SCHEDULER_H
+#define WATERING_SCHEDULER_H
+
+#include <Arduino.h>
+#include <time.h>
+
+/**
+ * @brief 调度判定结果
+ */
+enum class WateringDecision {
+    ALLOWED,             // 允许浇水（时长可能被剩余预算截短）
+    QUIET_HOURS,         // 处于静默时段
+    MIN_INTERVAL,        // 距上次浇水不足 min_interval_s
+    DAILY_TIME_BUDGET,   // 当日水泵运行时间已用完
+    DAILY_VOLUME_BUDGET  // 当日浇水量已用完
+};
+
+/**
+ * @brief 调度器状态（用于查询）
+ */
+struct WateringScheduleStatus {
+    uint32_t last_watering;      // 上次浇水时间 (系统时钟秒，0表示无记录)
+    uint32_t since_last_s;       // 距上次浇水的秒数
+    uint32_t day_pump_ms;        // 当日水泵运行时间
+    uint32_t day_volume_ml;      // 当日估算浇水量（未标定流量时为0）
+    uint16_t day_count;          // 当日浇水次数
+    uint32_t total_count;        // 累计浇水次数
+    WateringDecision decision;   // 最近一次判定
+    uint32_t wait_s;             // 最近一次判定下距可浇水的秒数
+    bool clock_valid;            // 系统时间是否已校准（静默时段仅在校准后生效）
+};
+
+/**
+ * @brief 浇水调度器单例类
+ *
+ * 功能特性:
+ * - 两次自动浇水之间至少间隔 watering.min_interval_s
+ * - 每日水泵运行时间上限 watering.daily_budget_s，以及按标定流量估算的水量上限
+ *   watering.daily_budget_ml；剩余预算不足一次时截短本次浇水
+ * - 静默时段 [quiet_start_h, quiet_end_h) 内不自动浇水（可跨零点）
+ * - 状态保存在NVS，重启和深度睡眠后保留
+ *
+ * 时间基准为系统时钟 time()：深度睡眠和软件复位期间由RTC继续计时；
+ * 未经NTP校准时按开机以来的时间计算"天"，静默时段不生效。
+ */
+class WateringScheduler {
+public:
+    /**
+     * @brief 获取单例实例
+     */
+    static WateringScheduler& instance();
+
+    /**
+     * @brief 初始化调度器，从NVS读取状态
+     * @return true 成功, false 失败
+     */
+    bool init();
+
+    /**
+     * @brief 判定现在是否可以自动浇水
+     * @param requested_ms 请求的浇水时长 (ms)
+     * @param p_allowed_ms 输出：允许的浇水时长，不超过剩余预算（可为nullptr）
+     * @return 判定结果；判定原因变化时记录日志
+     */
+    WateringDecision check(uint32_t requested_ms, uint32_t* p_allowed_ms);
+
+    /**
+     * @brief 记录一次浇水（自动、强制和手动浇水都应记录）
+     * @param duration_ms 实际浇水时长 (ms)
+     */
+    void recordWatering(uint32_t duration_ms);
+
+    /**
+     * @brief 清除浇水记录和当日统计
+     */
+    void reset();
+
+    /**
+     * @brief 获取调度器状态
+     */
+    void getStatus(WateringScheduleStatus* p_status);
+
+    /**
+     * @brief 判定结果名称
+     */
+    static const char* decisionName(WateringDecision decision);
+
+    /**
+     * @brief 返回状态JSON字符串
+     * @return JSON格式的状态信息
+     */
+    String getStatusJson();
+
+private:
+    WateringScheduler();
+    WateringScheduler(const WateringScheduler&) = delete;
+    WateringScheduler& operator=(const WateringScheduler&) = delete;
+
+    /**
+     * @brief 持久化状态
+     */
+    struct State {
+        uint32_t magic;
+        uint32_t last_watering;
+        uint32_t day_key;
+        uint32_t day_pump_ms;
+        uint32_t day_volume_ml;
+        uint16_t day_count;
+        uint32_t total_count;
+    };
+
+    /**
+     * @brief 日期变化时清零当日统计
+     */
+    void rollDay(uint32_t now);
+
+    /**
+     * @brief 写入NVS
+     */
+    void save();
+
+    /**
+     * @brief 当前时间所在"天"的编号（校准后为本地日期 YYYYMMDD）
+     */
+    static uint32_t dayKey(uint32_t now);
+
+    /**
+     * @brief 距下一天开始的秒数
+     */
+    static uint32_t secondsToNextDay(uint32_t now);
+
+    /**
+     * @brief 估算浇水量 (ml)
+     */
+    static uint32_t volumeMl(uint32_t duration_ms, uint16_t flow_ml_min);
+
+    State m_state;
+    WateringDecision m_last_decision;
+    uint32_t m_last_wait_s;
+    bool m_initialized;
+
+    static WateringScheduler* s_instance;
+};
+
+#endif // WATERING_SCHEDULER_H
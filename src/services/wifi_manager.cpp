@@ -6,6 +6,7 @@
 #include "wifi_manager.h"
 #include "config_manager.h"
 #include "../managers/log_manager.h"
+#include "../managers/power_manager.h"
 #include <ArduinoJson.h>
 #include "esp_wpa2.h"
 
@@ -58,6 +59,7 @@ bool WiFiManager::init() {
     m_state = WifiState::DISCONNECTED;
 
     WiFi.mode(WIFI_STA);
+    power_ledger_set_active(POWER_LEDGER_WIFI, true);  // STA 模式下射频保持工作
     WiFi.setAutoReconnect(false);
     WiFi.onEvent(wifiEventHandler);
 
@@ -186,6 +188,7 @@ void WiFiManager::attemptConnection() {
              m_connect_retry_count, WIFI_CONNECT_MAX_RETRIES);
 
     m_state = WifiState::CONNECTING;
+    power_ledger_set_active(POWER_LEDGER_WIFI, true);
     m_connect_start_time = millis();
     m_event_disconnect_reason = 0;
     m_event_got_ip = false;
@@ -250,7 +253,8 @@ bool WiFiManager::connect(const hydro_wifi_config_t& config) {
 
 void WiFiManager::disconnect() {
     m_auto_reconnect_enabled = false;
-    WiFi.disconnect(true);
+    WiFi.disconnect(true);  // 同时关闭射频
+    power_ledger_set_active(POWER_LEDGER_WIFI, false);
     m_state = WifiState::DISCONNECTED;
     LOG_INFO("WiFiManager", "Disconnected manually");
 }
@@ -261,6 +265,7 @@ bool WiFiManager::startScan() {
     }
 
     m_state = WifiState::SCANNING;
+    power_ledger_set_active(POWER_LEDGER_WIFI, true);
     m_scan_results.clear();
     WiFi.scanNetworks(true); // 异步扫描
     LOG_INFO("WiFiManager", "Started WiFi scan");
@@ -0,0 +1,62 @@
+/**
+ * @file loop_monitor.cpp
+ * @brief 主循环抖动监测实现
+ */
+
+#include "loop_monitor.h"
+#include "data/timing_constants.h"
+#include <Arduino.h>
+#include <string.h>
+
+static const uint32_t BUCKET_LIMITS_US[LOOP_MONITOR_BUCKETS - 1] = {
+    1000, 2000, 5000, 10000, 20000, 50000, 100000
+};
+
+static loop_monitor_stats_t s_stats;
+static uint64_t s_total_gap_us = 0;
+static uint32_t s_last_tick_us = 0;
+static bool s_started = false;
+
+void loop_monitor_tick() {
+    uint32_t now = micros();
+    if (!s_started) {
+        s_started = true;
+        s_last_tick_us = now;
+        return;
+    }
+
+    uint32_t gap = now - s_last_tick_us;
+    s_last_tick_us = now;
+
+    s_stats.iterations++;
+    s_stats.last_gap_us = gap;
+    if (gap > s_stats.max_gap_us) {
+        s_stats.max_gap_us = gap;
+    }
+    if (gap > LOOP_JITTER_BUDGET_MS * 1000UL) {
+        s_stats.over_budget++;
+    }
+    s_total_gap_us += gap;
+
+    uint8_t bucket = 0;
+    while (bucket < LOOP_MONITOR_BUCKETS - 1 && gap >= BUCKET_LIMITS_US[bucket]) {
+        bucket++;
+    }
+    s_stats.histogram[bucket]++;
+}
+
+void loop_monitor_reset() {
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_total_gap_us = 0;
+    s_started = false;
+}
+
+void loop_monitor_get_stats(loop_monitor_stats_t* p_stats) {
+    if (p_stats == nullptr) return;
+    *p_stats = s_stats;
+    p_stats->avg_gap_us = s_stats.iterations > 0 ? (uint32_t)(s_total_gap_us / s_stats.iterations) : 0;
+}
+
+uint32_t loop_monitor_bucket_limit_us(uint8_t bucket) {
+    return bucket < LOOP_MONITOR_BUCKETS - 1 ? BUCKET_LIMITS_US[bucket] : UINT32_MAX;
+}
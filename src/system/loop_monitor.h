@@ -0,0 +1,48 @@
+/**
+ * @file loop_monitor.h
+ * @brief 主循环抖动监测
+ * @details 在 loop() 开头调用 loop_monitor_tick()，记录相邻两次迭代的间隔
+ *          （最大值、平均值、超出 LOOP_JITTER_BUDGET_MS 的次数与分布直方图），
+ *          用于评估阻塞操作（如传感器预热）对 LVGL 刷新和泵定时停止的影响。
+ */
+
+#ifndef LOOP_MONITOR_H
+#define LOOP_MONITOR_H
+
+#include <stdint.h>
+
+#define LOOP_MONITOR_BUCKETS 8
+
+/**
+ * @brief 迭代间隔统计
+ */
+typedef struct {
+    uint32_t iterations;                        ///< 记录的间隔数
+    uint32_t last_gap_us;                       ///< 最近一次间隔
+    uint32_t max_gap_us;                        ///< 最大间隔
+    uint32_t avg_gap_us;                        ///< 平均间隔
+    uint32_t over_budget;                       ///< 超出 LOOP_JITTER_BUDGET_MS 的次数
+    uint32_t histogram[LOOP_MONITOR_BUCKETS];   ///< 按 loop_monitor_bucket_limit_us() 分桶
+} loop_monitor_stats_t;
+
+/**
+ * @brief 记录一次循环迭代（在每次迭代开头调用）
+ */
+void loop_monitor_tick();
+
+/**
+ * @brief 清零统计，下一次 tick 重新开始计时
+ */
+void loop_monitor_reset();
+
+/**
+ * @brief 获取统计结果
+ */
+void loop_monitor_get_stats(loop_monitor_stats_t* p_stats);
+
+/**
+ * @brief 直方图分桶上限 (微秒，不含)；最后一个桶无上限，返回 UINT32_MAX
+ */
+uint32_t loop_monitor_bucket_limit_us(uint8_t bucket);
+
+#endif // LOOP_MONITOR_H
@@ -6,6 +6,11 @@
 #include "test_commands_config.h"
 #include "test_command_registry.h"
 #include "../services/config_manager.h"
+#include "../managers/log_manager.h"
+#include "../managers/battery_manager.h"
+#include "../managers/humidity_filter.h"
+#include "../managers/watering_program.h"
+#include "../managers/power_manager.h"
 #include <Arduino.h>
 
 #ifdef TEST_MODE
@@ -119,6 +124,74 @@ static void handle_set(const char* args) {
         config.watering.plant_type[sizeof(config.watering.plant_type) - 1] = '\0';
         found = true;
     }
+    else if (strcmp(key, "watering.filter_window") == 0) {
+        int window = atoi(value);
+        if (window < 1 || window > HUMIDITY_FILTER_MAX_WINDOW) {
+            Serial.println("{\"status\": \"error\", \"message\": \"filter_window must be 1-9\"}");
+            return;
+        }
+        config.watering.filter_window = window;
+        found = true;
+    }
+    else if (strcmp(key, "watering.hampel_k") == 0) {
+        config.watering.hampel_k = atof(value);
+        found = true;
+    }
+    else if (strcmp(key, "watering.hysteresis") == 0) {
+        config.watering.hysteresis = atoi(value);
+        found = true;
+    }
+    else if (strcmp(key, "watering.daily_budget_s") == 0) {
+        config.watering.daily_budget_s = atoi(value);
+        found = true;
+    }
+    else if (strcmp(key, "watering.flow_ml_min") == 0) {
+        config.watering.flow_ml_min = atoi(value);
+        found = true;
+    }
+    else if (strcmp(key, "watering.daily_budget_ml") == 0) {
+        config.watering.daily_budget_ml = atoi(value);
+        found = true;
+    }
+    else if (strcmp(key, "watering.adaptive") == 0) {
+        config.watering.adaptive = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0) ? 1 : 0;
+        found = true;
+    }
+    else if (strcmp(key, "watering.target") == 0) {
+        config.watering.target = atoi(value);
+        found = true;
+    }
+    else if (strcmp(key, "watering.pulse_count") == 0) {
+        int count = atoi(value);
+        if (count < 1 || count > WATERING_PROGRAM_MAX_PULSES) {
+            Serial.printf("{\"status\": \"error\", \"message\": \"pulse_count must be 1-%d\"}\r\n",
+                          WATERING_PROGRAM_MAX_PULSES);
+            return;
+        }
+        config.watering.pulse_count = count;
+        found = true;
+    }
+    else if (strcmp(key, "watering.pulse_gap_s") == 0) {
+        config.watering.pulse_gap_s = atoi(value);
+        found = true;
+    }
+    else if (strcmp(key, "watering.pulse_sample") == 0) {
+        config.watering.pulse_sample = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0) ? 1 : 0;
+        found = true;
+    }
+    else if (strcmp(key, "watering.quiet_start_h") == 0 || strcmp(key, "watering.quiet_end_h") == 0) {
+        int hour = atoi(value);
+        if (hour < 0 || hour > 23) {
+            Serial.println("{\"status\": \"error\", \"message\": \"quiet hours must be 0-23\"}");
+            return;
+        }
+        if (strcmp(key, "watering.quiet_start_h") == 0) {
+            config.watering.quiet_start_h = hour;
+        } else {
+            config.watering.quiet_end_h = hour;
+        }
+        found = true;
+    }
     else if (strcmp(key, "wifi.ssid") == 0) {
         strncpy(config.wifi.ssid, value, sizeof(config.wifi.ssid) - 1);
         config.wifi.ssid[sizeof(config.wifi.ssid) - 1] = '\0';
@@ -172,6 +245,86 @@ static void handle_set(const char* args) {
         config.system.ntp_server[sizeof(config.system.ntp_server) - 1] = '\0';
         found = true;
     }
+    else if (strcmp(key, "system.log_levels") == 0) {
+        strncpy(config.system.log_levels, value, sizeof(config.system.log_levels) - 1);
+        config.system.log_levels[sizeof(config.system.log_levels) - 1] = '\0';
+        log_manager_apply_level_spec(config.system.log_levels);
+        found = true;
+    }
+    else if (strcmp(key, "system.run_sleep") == 0) {
+        int run_sleep = atoi(value);
+        if (run_sleep < 0 || run_sleep > 2) {
+            Serial.println("{\"status\": \"error\", \"message\": \"run_sleep must be 0 (poll), 1 (timer) or 2 (ULP sentinel)\"}");
+            return;
+        }
+        config.system.run_sleep = run_sleep;
+        found = true;
+    }
+    else if (strcmp(key, "system.check_max_s") == 0) {
+        long check_max_s = atol(value);
+        if (check_max_s < 0 || check_max_s > 21600) {
+            Serial.println("{\"status\": \"error\", \"message\": \"check_max_s must be 0-21600 (0 = fixed interval)\"}");
+            return;
+        }
+        config.system.check_max_s = (uint16_t)check_max_s;
+        found = true;
+    }
+    else if (strcmp(key, "system.check_margin_pct") == 0) {
+        int margin = atoi(value);
+        if (margin < 0 || margin > 90) {
+            Serial.println("{\"status\": \"error\", \"message\": \"check_margin_pct must be 0-90\"}");
+            return;
+        }
+        config.system.check_margin_pct = margin;
+        found = true;
+    }
+    else if (strcmp(key, "battery.soc_curve") == 0) {
+        if (value[0] != '\0' && !battery_manager_curve_valid(value)) {
+            Serial.println("{\"status\": \"error\", \"message\": \"Invalid curve, expected mV:percent,... with decreasing voltage\"}");
+            return;
+        }
+        strncpy(config.battery.soc_curve, value, sizeof(config.battery.soc_curve) - 1);
+        config.battery.soc_curve[sizeof(config.battery.soc_curve) - 1] = '\0';
+        battery_manager_apply_config();
+        found = true;
+    }
+    else if (strcmp(key, "battery.capacity_mah") == 0) {
+        config.battery.capacity_mah = atoi(value);
+        battery_manager_apply_config();
+        found = true;
+    }
+    else if (strcmp(key, "battery.internal_resistance_mohm") == 0) {
+        config.battery.internal_resistance_mohm = atoi(value);
+        battery_manager_apply_config();
+        found = true;
+    }
+    else if (strncmp(key, "power.", 6) == 0) {
+        struct { const char* name; uint32_t* field; } power_keys[] = {
+            {"sensor_ua", &config.power.sensor_ua}, {"boost_ua", &config.power.boost_ua},
+            {"screen_ua", &config.power.screen_ua}, {"pump_ua", &config.power.pump_ua},
+            {"cpu_ua", &config.power.cpu_ua},       {"wifi_ua", &config.power.wifi_ua},
+            {"sleep_ua", &config.power.sleep_ua},
+        };
+        for (size_t i = 0; i < sizeof(power_keys) / sizeof(power_keys[0]); i++) {
+            if (strcmp(key + 6, power_keys[i].name) == 0) {
+                *power_keys[i].field = strtoul(value, nullptr, 10);
+                power_manager_apply_config();
+                found = true;
+                break;
+            }
+        }
+        struct { const char* name; uint16_t* field; } linger_keys[] = {
+            {"sensor_linger_ms", &config.power.sensor_linger_ms},
+            {"boost_linger_ms", &config.power.boost_linger_ms},
+            {"screen_linger_ms", &config.power.screen_linger_ms},
+        };
+        for (size_t i = 0; !found && i < sizeof(linger_keys) / sizeof(linger_keys[0]); i++) {
+            if (strcmp(key + 6, linger_keys[i].name) == 0) {
+                *linger_keys[i].field = (uint16_t)atoi(value);
+                found = true;
+            }
+        }
+    }
 
     if (found) {
         Serial.print("{\"status\": \"success\", \"message\": \"Set ");
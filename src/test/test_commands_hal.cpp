@@ -7,13 +7,22 @@
 #include "test_command_registry.h"
 #include "managers/power_manager.h"
 #include "managers/sensor_manager.h"
+#include "managers/battery_manager.h"
 #include "managers/actuator_manager.h"
+#include "managers/watering_program.h"
 #include "ui/display_manager.h"
 #include "ui/ui_manager.h"
 #include "data/data_models.h"
 #include "managers/input_manager.h"
+#include "hal/hal_adc.h"
+#include "hal/hal_config.h"
+#include "data/timing_constants.h"
+#include "services/config_manager.h"
 #include <Arduino.h>
+#include <SPIFFS.h>
 #include <string.h>
+#include <math.h>
+#include <time.h>
 
 #ifdef TEST_MODE
 
@@ -21,6 +30,18 @@
 #define MAX_MODULE_NAME_LEN 10
 #define MAX_STATE_NAME_LEN  4
 #define MAX_ACTION_NAME_LEN 10
+#define ADC_BENCH_MAX_TRACE 512
+#define ADC_BENCH_MAGIC     0x54434441  // "ADCT"
+
+/**
+ * @brief 录制的 ADC 样本序列文件头（SPIFFS: /bench_<channel>.adc，其后为 count 个 uint16_t 原始读数）
+ */
+typedef struct {
+    uint32_t magic;
+    uint16_t count;
+    uint16_t interval_us;      ///< 录制时的采样间隔
+    float per_sample_us;       ///< 录制时每个样本的实际耗时（含间隔）
+} adc_bench_header_t;
 
 /* ========== 私有辅助函数 ========== */
 
@@ -43,14 +64,141 @@ static void process_power_command(const char* module_name, bool enable,
 }
 
 
+/**
+ * @brief 处理 "power battery [reset|feed <V> [load_mA]]"
+ * @details 无参数时读取一次电池电压（经快照缓存）更新模型；
+ *          feed 直接注入一次测量，用于验证滤波、门限与电量曲线
+ */
+static void handle_power_battery(const char* args) {
+    char option[MAX_ACTION_NAME_LEN] = "";
+    float voltage = 0.0f;
+    unsigned int load_ma = 0;
+    int items = sscanf(args, "%9s %f %u", option, &voltage, &load_ma);
+
+    battery_result_t result;
+    if (items <= 0) {
+        result = battery_manager_update(0);
+    } else if (strcmp(option, "reset") == 0) {
+        battery_manager_reset();
+        Serial.println("Battery model reset.");
+        return;
+    } else if (strcmp(option, "feed") == 0 && items >= 2) {
+        result = items == 3 ? battery_manager_feed_with_load(voltage, (uint16_t)load_ma)
+                            : battery_manager_feed(voltage);
+    } else {
+        Serial.println("Error: Usage: power battery [reset|feed <volts> [load_ma]]");
+        return;
+    }
+    if (result != BATTERY_OK) {
+        Serial.printf("Error: Battery update failed. Result: %d\r\n", result);
+    }
+
+    battery_state_t state;
+    battery_manager_get_state(&state);
+    if (!state.valid) {
+        Serial.println("Battery model has no estimate yet.");
+        return;
+    }
+    Serial.println("Battery model:");
+    Serial.printf("  - Measured:    %.3f V at %u mA load\r\n", state.raw_voltage, state.load_ma);
+    Serial.printf("  - Compensated: %.3f V\r\n", state.compensated_voltage);
+    Serial.printf("  - Filtered:    %.3f V (sigma %.1f mV)\r\n",
+                  state.filtered_voltage, sqrtf(state.variance) * 1000.0f);
+    Serial.printf("  - Charge:      %.1f%% (%s)\r\n", state.soc_percent, battery_manager_level_name(state.level));
+    Serial.printf("  - Runtime:     %.1f h at %.1f mA average\r\n", state.runtime_hours, state.avg_load_ma);
+    Serial.printf("  - Updates:     %lu accepted, %lu rejected\r\n",
+                  (unsigned long)state.updates, (unsigned long)state.rejected);
+}
+
+/**
+ * @brief 处理 "power stats [save|reset]"
+ * @details 显示能耗账本：各条目的累计时间、打开次数、估计电荷与占比
+ */
+static void handle_power_stats(const char* args) {
+    char option[MAX_ACTION_NAME_LEN] = "";
+    sscanf(args, "%9s", option);
+    if (strcmp(option, "reset") == 0) {
+        power_ledger_reset();
+        Serial.println("Energy ledger reset.");
+        return;
+    }
+    if (strcmp(option, "save") == 0) {
+        power_ledger_save();
+        Serial.println("Energy ledger saved to NVS.");
+    } else if (option[0] != '\0') {
+        Serial.println("Error: Usage: power stats [save|reset]");
+        return;
+    }
+
+    power_ledger_stats_t stats;
+    power_ledger_get_stats(&stats);
+    uint64_t span_ms = power_ledger_span_ms(&stats);
+    uint64_t total = 0;
+    for (int i = 0; i < POWER_LEDGER_COUNT; i++) {
+        total += stats.entries[i].charge_ua_ms;
+    }
+
+    Serial.printf("Energy ledger: %.2f h over %lu boots", span_ms / 3600000.0, (unsigned long)stats.boots);
+    if (stats.start_time != 0) {
+        time_t start = stats.start_time;
+        struct tm tm_start;
+        localtime_r(&start, &tm_start);
+        char date[20];
+        strftime(date, sizeof(date), "%Y-%m-%d %H:%M", &tm_start);
+        Serial.printf(", since %s", date);
+    }
+    Serial.println();
+    Serial.println("  - Entry      On time (h)  Switches  Current (uA)  Charge (mAh)  Share");
+    for (int i = 0; i < POWER_LEDGER_COUNT; i++) {
+        const power_ledger_entry_t& entry = stats.entries[i];
+        Serial.printf("  - %-9s  %11.3f  %8lu  %12lu  %12.3f  %5.1f%%\r\n",
+                      power_ledger_name((power_ledger_t)i), entry.on_ms / 3600000.0,
+                      (unsigned long)entry.switches, (unsigned long)power_ledger_current_ua((power_ledger_t)i),
+                      entry.charge_ua_ms / 3.6e9, total > 0 ? entry.charge_ua_ms * 100.0 / total : 0.0);
+    }
+    Serial.printf("  - Total:     %.3f mAh, average %.0f uA\r\n", total / 3.6e9,
+                  span_ms > 0 ? (double)total / span_ms : 0.0);
+}
+
+/**
+ * @brief 处理 "power rails"
+ * @details 显示各电源轨的租约、保持时间与共享统计
+ */
+static void handle_power_rails() {
+    Serial.println("Power rail leases:");
+    for (int i = 0; i < POWER_RAIL_COUNT; i++) {
+        power_rail_status_t status;
+        power_rail_get_status((power_rail_t)i, &status);
+        uint32_t shared = status.acquires - status.power_ups;
+        Serial.printf("  - %-9s %-3s leases=%u%s linger=%lums acquires=%lu power_ups=%lu shared=%lu\r\n",
+                      power_rail_name((power_rail_t)i), status.powered ? "ON" : "OFF", status.leases,
+                      status.lingering ? " (lingering)" : "", (unsigned long)status.linger_ms,
+                      (unsigned long)status.acquires, (unsigned long)status.power_ups, (unsigned long)shared);
+    }
+}
+
 // --- 命令处理函数 ---
 
 /**
  * @brief 处理 "power" 命令
- * @param args 格式: "set <module> <on|off>"
+ * @param args 格式: "set <module> <on|off>"、"battery [reset|feed <V> [load_mA]]"、
+ *             "stats [save|reset]" 或 "rails"
  *             module: sensor, boost12v, screen
  */
 void handle_power(const char* args) {
+    if (strncmp(args, "battery", 7) == 0 && (args[7] == '\0' || args[7] == ' ')) {
+        handle_power_battery(args + 7);
+        return;
+    }
+    if (strncmp(args, "stats", 5) == 0 && (args[5] == '\0' || args[5] == ' ')) {
+        handle_power_stats(args + 5);
+        return;
+    }
+    if (strcmp(args, "rails") == 0) {
+        handle_power_rails();
+        return;
+    }
+
     char action[MAX_ACTION_NAME_LEN];
     char module[MAX_MODULE_NAME_LEN];
     char state[MAX_STATE_NAME_LEN];
@@ -79,15 +227,400 @@ void handle_power(const char* args) {
     }
 }
 
+// 解析采集通道名称
+static bool parse_sensor_channel(const char* name, sensor_channel_t* p_channel, uint8_t* p_pin) {
+    if (strcmp(name, "humidity") == 0) {
+        *p_channel = SENSOR_CHANNEL_HUMIDITY;
+        *p_pin = PIN_SENSOR_HUMIDITY;
+        return true;
+    }
+    if (strcmp(name, "battery") == 0) {
+        *p_channel = SENSOR_CHANNEL_BATTERY;
+        *p_pin = PIN_SENSOR_BATTERY_ADC;
+        return true;
+    }
+    return false;
+}
+
+static const char* reject_name(hal_adc_reject_t reject) {
+    switch (reject) {
+        case HAL_ADC_REJECT_TRIM: return "trim";
+        case HAL_ADC_REJECT_MAD:  return "mad";
+        default:                  return "none";
+    }
+}
+
+static void print_sampling_config(const char* name, const hal_adc_sample_config_t* cfg) {
+    Serial.printf("  - %s: samples=%u reject=%s trim=%u%% k=%.1f interval=%uus\r\n",
+                  name, cfg->samples, reject_name(cfg->reject), cfg->trim_percent, cfg->mad_k, cfg->interval_us);
+}
+
+/**
+ * @brief 处理 "sensor sampling <humidity|battery> [key=value...]"
+ * @details 可设置 samples, reject(none|trim|mad), trim, k, interval
+ */
+static void handle_sensor_sampling(const char* args) {
+    char name[MAX_MODULE_NAME_LEN] = "";
+    int consumed = 0;
+    sensor_channel_t channel;
+    uint8_t pin;
+    if (sscanf(args, "%9s%n", name, &consumed) != 1 || !parse_sensor_channel(name, &channel, &pin)) {
+        hal_adc_sample_config_t cfg;
+        Serial.println("ADC sampling:");
+        sensor_manager_get_sampling(SENSOR_CHANNEL_HUMIDITY, &cfg);
+        print_sampling_config("humidity", &cfg);
+        sensor_manager_get_sampling(SENSOR_CHANNEL_BATTERY, &cfg);
+        print_sampling_config("battery", &cfg);
+        return;
+    }
+
+    hal_adc_sample_config_t cfg;
+    sensor_manager_get_sampling(channel, &cfg);
+
+    char buffer[96];
+    strncpy(buffer, args + consumed, sizeof(buffer) - 1);
+    buffer[sizeof(buffer) - 1] = '\0';
+
+    for (char* token = strtok(buffer, " "); token != nullptr; token = strtok(nullptr, " ")) {
+        char* value = strchr(token, '=');
+        if (value == nullptr) {
+            Serial.printf("Error: Expected key=value, got '%s'.\r\n", token);
+            return;
+        }
+        *value++ = '\0';
+        if (strcmp(token, "samples") == 0) {
+            cfg.samples = (uint8_t)atoi(value);
+        } else if (strcmp(token, "reject") == 0) {
+            if (strcmp(value, "none") == 0) cfg.reject = HAL_ADC_REJECT_NONE;
+            else if (strcmp(value, "trim") == 0) cfg.reject = HAL_ADC_REJECT_TRIM;
+            else if (strcmp(value, "mad") == 0) cfg.reject = HAL_ADC_REJECT_MAD;
+            else {
+                Serial.println("Error: reject must be none, trim or mad.");
+                return;
+            }
+        } else if (strcmp(token, "trim") == 0) {
+            cfg.trim_percent = (uint8_t)atoi(value);
+        } else if (strcmp(token, "k") == 0) {
+            cfg.mad_k = atof(value);
+        } else if (strcmp(token, "interval") == 0) {
+            cfg.interval_us = (uint16_t)atoi(value);
+        } else {
+            Serial.printf("Error: Unknown key '%s'.\r\n", token);
+            return;
+        }
+    }
+
+    if (sensor_manager_set_sampling(channel, &cfg) != SENSOR_OK) {
+        Serial.printf("Error: Invalid sampling config (samples 1-%d, trim 0-49, k > 0, interval <= 10000).\r\n",
+                      HAL_ADC_MAX_SAMPLES);
+        return;
+    }
+    Serial.println("ADC sampling updated:");
+    print_sampling_config(name, &cfg);
+}
+
+/**
+ * @brief 处理 "sensor stats <humidity|battery>"
+ * @details 打印最近一次多样本采集的统计量
+ */
+static void handle_sensor_stats(const char* name) {
+    sensor_channel_t channel;
+    uint8_t pin;
+    if (!parse_sensor_channel(name, &channel, &pin)) {
+        Serial.println("Error: Usage: sensor stats <humidity|battery>");
+        return;
+    }
+
+    hal_adc_stats_t stats;
+    if (!sensor_manager_get_last_stats(channel, &stats)) {
+        Serial.println("No acquisition yet. Run 'sensor read' first.");
+        return;
+    }
+    Serial.printf("Last %s acquisition:\r\n", name);
+    Serial.printf("  - Mean:     %.2f (%lu mV%s)\r\n", stats.mean, (unsigned long)stats.millivolts,
+                  hal_adc_is_calibrated() ? ", eFuse calibrated" : ", typical curve");
+    Serial.printf("  - Median:   %u\r\n", stats.median);
+    Serial.printf("  - Variance: %.2f (stddev %.2f)\r\n", stats.variance, sqrtf(stats.variance));
+    Serial.printf("  - Range:    %u - %u\r\n", stats.min, stats.max);
+    Serial.printf("  - Samples:  %u used / %u taken, %u at rail\r\n", stats.used, stats.taken, stats.rail);
+    Serial.printf("  - Duration: %lu us\r\n", (unsigned long)stats.duration_us);
+}
+
+static void bench_trace_path(const char* name, char* path, size_t size) {
+    snprintf(path, size, "/bench_%s.adc", name);
+}
+
+static bool bench_save_trace(const char* name, const uint16_t* trace, int trace_len,
+                             uint16_t interval_us, float per_sample_us) {
+    char path[32];
+    bench_trace_path(name, path, sizeof(path));
+    File file = SPIFFS.open(path, FILE_WRITE);
+    if (!file) return false;
+
+    adc_bench_header_t header = {ADC_BENCH_MAGIC, (uint16_t)trace_len, interval_us, per_sample_us};
+    size_t bytes = trace_len * sizeof(uint16_t);
+    bool ok = file.write((const uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+              file.write((const uint8_t*)trace, bytes) == bytes;
+    file.close();
+    if (!ok) SPIFFS.remove(path);
+    return ok;
+}
+
+/**
+ * @return 读取到的样本数；文件不存在或格式不符时返回0
+ */
+static int bench_load_trace(const char* name, uint16_t* trace, adc_bench_header_t* p_header) {
+    char path[32];
+    bench_trace_path(name, path, sizeof(path));
+    File file = SPIFFS.open(path, FILE_READ);
+    if (!file) return 0;
+
+    int count = 0;
+    if (file.read((uint8_t*)p_header, sizeof(*p_header)) == sizeof(*p_header) &&
+        p_header->magic == ADC_BENCH_MAGIC && p_header->count >= 16 && p_header->count <= ADC_BENCH_MAX_TRACE) {
+        size_t bytes = p_header->count * sizeof(uint16_t);
+        if (file.read((uint8_t*)trace, bytes) == bytes) count = p_header->count;
+    }
+    file.close();
+    return count;
+}
+
+/**
+ * @brief 按不同样本数切分样本序列，用给定剔除策略估计每个窗口
+ * @details 与整段样本的四分位均值比较，给出精度与ADC采集时间的取舍。
+ *          只调用 hal_adc_compute_stats()（纯函数），录制的序列可在任意策略下重放。
+ */
+static void bench_report(const char* name, const char* source, const uint16_t* trace, int trace_len,
+                         float per_sample_us, const hal_adc_sample_config_t* p_cfg) {
+    // 参考值：整段样本的四分位均值
+    static uint16_t sorted[ADC_BENCH_MAX_TRACE];
+    memcpy(sorted, trace, trace_len * sizeof(uint16_t));
+    for (int i = 1; i < trace_len; i++) {
+        uint16_t v = sorted[i];
+        int j = i - 1;
+        while (j >= 0 && sorted[j] > v) {
+            sorted[j + 1] = sorted[j];
+            j--;
+        }
+        sorted[j + 1] = v;
+    }
+    float reference = 0.0f;
+    int q = trace_len / 4;
+    for (int i = q; i < trace_len - q; i++) reference += sorted[i];
+    reference /= (trace_len - 2 * q);
+
+    float sq = 0.0f;
+    for (int i = 0; i < trace_len; i++) sq += (trace[i] - reference) * (trace[i] - reference);
+
+    Serial.printf("ADC bench on %s (%s): %d samples, %.1f us/sample, reference %.2f, raw stddev %.2f\r\n",
+                  name, source, trace_len, per_sample_us, reference, sqrtf(sq / trace_len));
+    Serial.printf("Policy: reject=%s trim=%u%% k=%.1f\r\n", reject_name(p_cfg->reject), p_cfg->trim_percent, p_cfg->mad_k);
+    Serial.println("   N  on-time(us)  rms(mean)  rms(median)  max|err|");
+
+    for (int n = 1; n <= HAL_ADC_MAX_SAMPLES && n * 4 <= trace_len; n *= 2) {
+        hal_adc_sample_config_t window_cfg = *p_cfg;
+        window_cfg.samples = (uint8_t)n;
+        int windows = trace_len / n;
+        float sq_mean = 0.0f, sq_median = 0.0f, max_err = 0.0f;
+        for (int w = 0; w < windows; w++) {
+            uint16_t window[HAL_ADC_MAX_SAMPLES];
+            memcpy(window, &trace[w * n], n * sizeof(uint16_t));
+            hal_adc_stats_t stats;
+            hal_adc_compute_stats(window, (uint8_t)n, &window_cfg, &stats);
+            float err_mean = stats.mean - reference;
+            float err_median = stats.median - reference;
+            sq_mean += err_mean * err_mean;
+            sq_median += err_median * err_median;
+            if (fabsf(err_mean) > max_err) max_err = fabsf(err_mean);
+        }
+        Serial.printf("%4d  %11.0f  %9.2f  %11.2f  %8.2f\r\n", n, n * per_sample_us,
+                      sqrtf(sq_mean / windows), sqrtf(sq_median / windows), max_err);
+    }
+}
+
+/**
+ * @brief 处理 "sensor bench <humidity|battery> [trace_len|replay]"
+ * @details 默认录制一段连续样本并保存到 SPIFFS，再用当前剔除策略评估；
+ *          replay 不访问ADC，对上次保存的样本序列重新评估，
+ *          用于在同一段数据上比较不同的 "sensor sampling" 策略。
+ */
+static void handle_sensor_bench(const char* args) {
+    char name[MAX_MODULE_NAME_LEN] = "";
+    char option[8] = "";
+    sensor_channel_t channel;
+    uint8_t pin;
+    if (sscanf(args, "%9s %7s", name, option) < 1 || !parse_sensor_channel(name, &channel, &pin)) {
+        Serial.println("Error: Usage: sensor bench <humidity|battery> [trace_len|replay]");
+        return;
+    }
+
+    hal_adc_sample_config_t cfg;
+    sensor_manager_get_sampling(channel, &cfg);
+    static uint16_t trace[ADC_BENCH_MAX_TRACE];
+
+    if (strcmp(option, "replay") == 0) {
+        adc_bench_header_t header;
+        int trace_len = bench_load_trace(name, trace, &header);
+        if (trace_len == 0) {
+            Serial.printf("Error: No recorded %s trace. Run 'sensor bench %s' first.\r\n", name, name);
+            return;
+        }
+        bench_report(name, "recorded", trace, trace_len, header.per_sample_us, &cfg);
+        return;
+    }
+
+    int trace_len = option[0] != '\0' ? atoi(option) : 256;
+    if (trace_len < 16 || trace_len > ADC_BENCH_MAX_TRACE) {
+        Serial.printf("Error: trace_len must be between 16 and %d.\r\n", ADC_BENCH_MAX_TRACE);
+        return;
+    }
+
+    bool power_toggled = channel == SENSOR_CHANNEL_HUMIDITY && !power_sensor_is_enabled();
+    if (power_toggled) {
+        power_sensor_enable(true);
+        delay(200);
+    }
+    uint32_t start = micros();
+    bool captured = hal_adc_capture(pin, trace, trace_len, cfg.interval_us);
+    uint32_t elapsed = micros() - start;
+    if (power_toggled) {
+        power_sensor_enable(false);
+    }
+    if (!captured) {
+        Serial.println("Error: Pin is not ADC capable.");
+        return;
+    }
+    float per_sample_us = (float)elapsed / trace_len;
+
+    if (!bench_save_trace(name, trace, trace_len, cfg.interval_us, per_sample_us)) {
+        Serial.println("Warning: Failed to save the trace to SPIFFS, replay unavailable.");
+    }
+    bench_report(name, "live", trace, trace_len, per_sample_us, &cfg);
+}
+
+/**
+ * @brief 处理 "sensor warmup [fixed|adaptive|reset]"
+ * @details 切换预热方式或清除学习值，并打印传感器电源的平均开启时间
+ */
+static void handle_sensor_warmup(const char* option) {
+    if (strcmp(option, "fixed") == 0) {
+        sensor_manager_set_warmup_mode(SENSOR_WARMUP_FIXED);
+    } else if (strcmp(option, "adaptive") == 0) {
+        sensor_manager_set_warmup_mode(SENSOR_WARMUP_ADAPTIVE);
+    } else if (strcmp(option, "reset") == 0) {
+        sensor_manager_reset_warmup();
+    } else if (option[0] != '\0') {
+        Serial.println("Error: Usage: sensor warmup [fixed|adaptive|reset]");
+        return;
+    }
+
+    sensor_warmup_stats_t stats;
+    sensor_manager_get_warmup_stats(&stats);
+    Serial.println("Sensor warm-up:");
+    Serial.printf("  - Mode:           %s\r\n", stats.mode == SENSOR_WARMUP_FIXED ? "fixed" : "adaptive");
+    Serial.printf("  - Learned settle: %u ms (NVS)\r\n", stats.learned_settle_ms);
+    Serial.printf("  - Last settle:    %u ms\r\n", stats.last_settle_ms);
+    Serial.printf("  - Readings:       %lu (%lu hit the %d ms ceiling)\r\n",
+                  (unsigned long)stats.readings, (unsigned long)stats.settle_timeouts, SENSOR_SETTLE_MAX_MS);
+    Serial.printf("  - Rail on-time:   %lu us avg per reading, %lu ms total\r\n",
+                  (unsigned long)stats.avg_rail_on_us, (unsigned long)(stats.rail_on_us / 1000));
+}
+
+/**
+ * @brief 处理 "sensor cache [reset]"
+ * @details 打印各通道的读取请求数与实际采集数
+ */
+static void handle_sensor_cache(const char* option) {
+    if (strcmp(option, "reset") == 0) {
+        sensor_manager_reset_cache_stats();
+        Serial.println("Sensor cache counters reset.");
+        return;
+    } else if (option[0] != '\0') {
+        Serial.println("Error: Usage: sensor cache [reset]");
+        return;
+    }
+
+    static const char* const names[SENSOR_CHANNEL_COUNT] = {"humidity", "battery"};
+    sensor_cache_stats_t stats;
+    sensor_manager_get_cache_stats(&stats);
+    Serial.println("Sensor snapshot cache:");
+    for (int i = 0; i < SENSOR_CHANNEL_COUNT; i++) {
+        uint32_t hits = stats.requests[i] - stats.acquisitions[i];
+        Serial.printf("  - %-8s: %lu requests, %lu acquisitions, %lu served from cache\r\n",
+                      names[i], (unsigned long)stats.requests[i], (unsigned long)stats.acquisitions[i],
+                      (unsigned long)hits);
+    }
+}
+
+/**
+ * @brief 处理 "sensor health [reset]"
+ * @details 打印健康监测的故障与各项增量统计
+ */
+static void handle_sensor_health(const char* option) {
+    if (strcmp(option, "reset") == 0) {
+        sensor_manager_reset_health();
+        Serial.println("Sensor health state cleared.");
+        return;
+    } else if (option[0] != '\0') {
+        Serial.println("Error: Usage: sensor health [reset]");
+        return;
+    }
+
+    sensor_health_t health;
+    sensor_manager_get_health(&health);
+    char faults[64];
+    Serial.println("Humidity sensor health:");
+    Serial.printf("  - Faults:      %s (0x%02lx, %lu changes)\r\n",
+                  sensor_health_format(health.faults, faults, sizeof(faults)),
+                  (unsigned long)health.faults, (unsigned long)health.fault_changes);
+    Serial.printf("  - Samples:     %lu ok, %lu failed (%u in a row)\r\n",
+                  (unsigned long)health.samples, (unsigned long)health.failures, health.consecutive_failures);
+    Serial.printf("  - Last value:  %.1f\r\n", health.last_value);
+    Serial.printf("  - Noise:       %.1f between reads (limit %.0f), %.1f within burst\r\n",
+                  health.noise_std, SENSOR_HEALTH_NOISE_SET, health.burst_std);
+    Serial.printf("  - Stuck run:   %u (limit %d)\r\n", health.stuck_run, SENSOR_HEALTH_STUCK_RUN);
+    Serial.printf("  - Jumps:       %lu total, score %.2f (limit %.1f)\r\n",
+                  (unsigned long)health.jumps, health.jump_score, SENSOR_HEALTH_JUMP_SET);
+    Serial.printf("  - Watering:    %s, %u unresponsive in a row\r\n",
+                  health.response_pending ? "waiting for response" : "idle", health.unresponsive_waterings);
+}
+
 /**
  * @brief 处理 "sensor" 命令
- * @param args 格式: "read <all|humidity|battery>"
+ * @param args 格式: "read <all|humidity|battery>", "stats <channel>",
+ *             "sampling [<channel> key=value...]", "bench <channel> [trace_len|replay]"
+ *             "warmup [fixed|adaptive|reset]", "cache [reset]" 或 "health [reset]"
  */
 void handle_sensor(const char* args) {
     char action[MAX_ACTION_NAME_LEN];
     char source[MAX_MODULE_NAME_LEN]; // Reuse for source
     int items = sscanf(args, "%9s %9s", action, source);
 
+    if (items >= 1 && strcmp(action, "sampling") == 0) {
+        handle_sensor_sampling(strstr(args, "sampling") + 8);
+        return;
+    }
+    if (items >= 1 && strcmp(action, "bench") == 0) {
+        handle_sensor_bench(strstr(args, "bench") + 5);
+        return;
+    }
+    if (items >= 1 && strcmp(action, "cache") == 0) {
+        handle_sensor_cache(items == 2 ? source : "");
+        return;
+    }
+    if (items >= 1 && strcmp(action, "warmup") == 0) {
+        handle_sensor_warmup(items == 2 ? source : "");
+        return;
+    }
+    if (items >= 1 && strcmp(action, "health") == 0) {
+        handle_sensor_health(items == 2 ? source : "");
+        return;
+    }
+    if (items >= 1 && strcmp(action, "stats") == 0) {
+        handle_sensor_stats(items == 2 ? source : "");
+        return;
+    }
+
     if (items < 1 || strcmp(action, "read") != 0) {
         Serial.println("Error: Invalid action. Usage: sensor read <source>");
         return;
@@ -135,18 +668,118 @@ void handle_sensor(const char* args) {
     }
 }
 
+// 阻塞等待曲线运行结束（不调用 actuator_manager_loop，验证停泵不依赖主循环）
+static void wait_pump_profile() {
+    uint32_t last_print = millis();
+    while (actuator_manager_is_pump_running()) {
+        delay(10);
+        if (millis() - last_print >= 500) {
+            last_print = millis();
+            actuator_status_t status;
+            actuator_manager_get_status(&status);
+            Serial.printf("  t=%lu ms duty=%u segment=%u\r\n",
+                          (unsigned long)status.elapsed_ms, status.duty, status.segment);
+        }
+    }
+
+    actuator_status_t status;
+    actuator_manager_get_status(&status);
+    Serial.printf("  - Timer events:   %lu\r\n", (unsigned long)status.events);
+    Serial.printf("  - Deadline error: %ld us\r\n", (long)status.last_stop_error_us);
+    actuator_manager_loop(); // 关闭12V电源
+}
+
+static void print_pump_status() {
+    actuator_status_t status;
+    actuator_manager_get_status(&status);
+    Serial.println("Pump engine:");
+    Serial.printf("  - Running:        %s\r\n", status.running ? "yes" : "no");
+    Serial.printf("  - Duty:           %u/255 (segment %u)\r\n", status.duty, status.segment);
+    if (status.total_ms == ACTUATOR_DURATION_INFINITE) {
+        Serial.printf("  - Elapsed:        %lu ms (until stopped)\r\n", (unsigned long)status.elapsed_ms);
+    } else {
+        Serial.printf("  - Elapsed:        %lu / %lu ms\r\n",
+                      (unsigned long)status.elapsed_ms, (unsigned long)status.total_ms);
+    }
+    Serial.printf("  - Timer events:   %lu\r\n", (unsigned long)status.events);
+    Serial.printf("  - Last deadline:  %ld us late\r\n", (long)status.last_stop_error_us);
+
+    watering_program_status_t program;
+    watering_program_get_status(&program);
+    Serial.println("Watering program:");
+    Serial.printf("  - Phase:          %s\r\n", watering_program_phase_name(program.phase));
+    Serial.printf("  - Pulses:         %u/%u (%lu ms pump time)\r\n",
+                  program.pulses_done, program.pulses, (unsigned long)program.pump_ms);
+    Serial.printf("  - Elapsed:        %lu / %lu ms\r\n",
+                  (unsigned long)program.elapsed_ms, (unsigned long)program.total_ms);
+    Serial.printf("  - Samples:        %u (last %.0f)\r\n", program.samples, program.last_sample);
+    Serial.printf("  - Result:         %s\r\n", program.stopped_early ? "target reached" :
+                  (program.aborted ? "aborted" : "all pulses"));
+}
+
+// 启动分段浇水程序后立即返回，由主循环推进；用 pump status 查看进度
+static void start_pump_program(int duty_cycle, const uint32_t* values, bool has_sample) {
+    if (values[0] == 0 || values[0] > WATERING_PROGRAM_MAX_PULSES || values[1] == 0 || values[1] > 30000) {
+        Serial.printf("Error: Count must be 1-%d and pulse_ms 1-30000.\r\n", WATERING_PROGRAM_MAX_PULSES);
+        return;
+    }
+
+    watering_program_t program;
+    program.duty = (uint8_t)duty_cycle;
+    program.pulses = (uint8_t)values[0];
+    program.pulse_ms = values[1];
+    program.gap_ms = values[2];
+    program.sample = has_sample ? values[3] != 0 : false;
+    program.target = ConfigManager::instance().getConfig().watering.target;
+
+    watering_program_result_t result = watering_program_start(&program);
+    if (result != WATERING_PROGRAM_OK) {
+        Serial.printf("Error: Failed to start program. Result: %d\r\n", result);
+        return;
+    }
+    Serial.printf("Watering program started: %u x %lu ms, %lu ms gaps, sampling %s (target %.0f).\r\n",
+                  program.pulses, (unsigned long)program.pulse_ms, (unsigned long)program.gap_ms,
+                  program.sample ? "on" : "off", program.target);
+}
+
 /**
  * @brief 处理 "pump" 命令
- * @param args 格式: "run <duty_cycle> <duration_ms>"
+ * @param args 格式: "run <duty_cycle> <duration_ms>" | "ramp ..." | "pulse ..." | "status"
  */
 void handle_pump(const char* args) {
-    char action[MAX_ACTION_NAME_LEN];
-    int duty_cycle;
-    uint32_t duration;
-    int items = sscanf(args, "%9s %d %lu", action, &duty_cycle, &duration);
+    char action[MAX_ACTION_NAME_LEN] = {0};
+    int duty_cycle = 0;
+    uint32_t values[4] = {0};
+    int items = sscanf(args, "%9s %d %lu %lu %lu %lu", action, &duty_cycle,
+                       &values[0], &values[1], &values[2], &values[3]);
 
-    if (items != 3 || strcmp(action, "run") != 0) {
-        Serial.println("Error: Invalid arguments. Usage: pump run <duty_cycle> <duration_ms>");
+    if (items >= 1 && strcmp(action, "status") == 0) {
+        print_pump_status();
+        return;
+    }
+    if (items >= 1 && strcmp(action, "stop") == 0) {
+        watering_program_abort();
+        actuator_manager_stop_pump();
+        Serial.println("Pump stopped.");
+        return;
+    }
+    if ((items == 5 || items == 6) && strcmp(action, "program") == 0) {
+        if (duty_cycle < 0 || duty_cycle > 255) {
+            Serial.println("Error: Duty cycle must be between 0 and 255.");
+            return;
+        }
+        start_pump_program(duty_cycle, values, items == 6);
+        return;
+    }
+
+    bool is_run = items == 3 && strcmp(action, "run") == 0;
+    bool is_ramp = items == 5 && strcmp(action, "ramp") == 0;
+    bool is_pulse = (items == 5 || items == 6) && strcmp(action, "pulse") == 0;
+    if (!is_run && !is_ramp && !is_pulse) {
+        Serial.println("Error: Invalid arguments. Usage: pump run <duty_cycle> <duration_ms> | "
+                       "pump ramp <duty> <ms> <up_ms> <down_ms> | "
+                       "pump pulse <duty> <count> <on_ms> <off_ms> [ramp_ms] | "
+                       "pump program <duty> <count> <pulse_ms> <gap_ms> [sample] | pump stop | pump status");
         return;
     }
 
@@ -155,22 +788,34 @@ void handle_pump(const char* args) {
         return;
     }
 
+    actuator_profile_t profile;
+    if (is_pulse) {
+        if (values[0] == 0 || values[0] > 100 || values[1] == 0) {
+            Serial.println("Error: Count must be 1-100 and on_ms must be positive.");
+            return;
+        }
+        actuator_profile_pulses(&profile, (uint8_t)duty_cycle, (uint16_t)values[0],
+                                values[1], values[2], items == 6 ? values[3] : ACTUATOR_SOFT_START_MS);
+    } else {
+        uint32_t ramp_up = is_ramp ? values[1] : ACTUATOR_SOFT_START_MS;
+        uint32_t ramp_down = is_ramp ? values[2] : ACTUATOR_SOFT_STOP_MS;
+        actuator_profile_soft_start(&profile, (uint8_t)duty_cycle, values[0], ramp_up, ramp_down);
+    }
+
+    uint32_t duration = actuator_profile_duration_ms(&profile);
     if (duration == 0 || duration > 30000) {
         Serial.println("Error: Duration must be between 1 and 30000 ms.");
         return;
     }
 
-    Serial.printf("Running pump with duty cycle %d for %lu ms...\r\n", duty_cycle, duration);
-    actuator_manager_run_pump_for((uint8_t)duty_cycle, duration);
-    
-    // 在测试命令中，我们可以阻塞地等待，以观察完整过程
-    uint32_t start = millis();
-    while (millis() - start < duration) {
-        actuator_manager_loop(); // 持续驱动管理器
-        delay(1);
+    Serial.printf("Running pump profile: %u segments, duty %d, %lu ms...\r\n",
+                  profile.count, duty_cycle, (unsigned long)duration);
+    actuator_result_t result = actuator_manager_run_profile(&profile);
+    if (result != ACTUATOR_OK) {
+        Serial.printf("Error: Failed to start pump. Result: %d\r\n", result);
+        return;
     }
-    // 确保最后一次状态更新被执行
-    actuator_manager_loop();
+    wait_pump_profile();
 
     Serial.println("Pump command finished.");
 }
@@ -291,12 +936,28 @@ void handle_system(const char* args) {
 
 static const CommandRegistryEntry hal_commands[] = {
     {"power", handle_power, "Controls power gates. Usage: power set <module> <on|off>\r\n"
-                           "  - module: sensor, boost12v, screen"},
+                           "  - module: sensor, boost12v, screen\r\n"
+                           "  - power battery [reset|feed <volts> [load_ma]]: update and show the battery model (charge, runtime)\r\n"
+                           "  - power stats [save|reset]: show the energy ledger (on-time, switches, charge per rail)\r\n"
+                           "  - power rails: show rail leases, linger times and how many acquires shared a powered rail"},
     {"sensor", handle_sensor, "Reads sensor data. Usage: sensor read <source>\r\n"
-                            "  - source: all, humidity, battery"},
+                            "  - source: all, humidity, battery\r\n"
+                            "  - sensor stats <humidity|battery>: show the last multi-sample acquisition\r\n"
+                            "  - sensor sampling [<humidity|battery> samples= reject=none|trim|mad trim= k= interval=]: show or set ADC sampling\r\n"
+                            "  - sensor bench <humidity|battery> [trace_len]: record and save a trace, report accuracy vs ADC on-time\r\n"
+                            "  - sensor bench <humidity|battery> replay: re-run the report on the saved trace with the current policy\r\n"
+                            "  - sensor warmup [fixed|adaptive|reset]: show warm-up stats and average sensor rail on-time\r\n"
+                            "  - sensor cache [reset]: show reads requested vs physical acquisitions\r\n"
+                            "  - sensor health [reset]: show humidity sensor fault state and health statistics"},
     {"pump", handle_pump, "Runs the water pump. Usage: pump run <duty> <ms>\r\n"
                          "  - duty: 0-255 (PWM duty cycle)\r\n"
-                         "  - ms: 1-30000 (duration in milliseconds)"},
+                         "  - ms: 1-30000 (duration in milliseconds, soft start/stop included)\r\n"
+                         "  - pump ramp <duty> <ms> <up_ms> <down_ms>: run with custom ramp-up/ramp-down\r\n"
+                         "  - pump pulse <duty> <count> <on_ms> <off_ms> [ramp_ms]: run a pulse train\r\n"
+                         "  - pump program <duty> <count> <pulse_ms> <gap_ms> [0|1]: start a soak program in the background\r\n"
+                         "    (1 = sample humidity in each gap, stop once watering.target is reached)\r\n"
+                         "  - pump stop: abort the program and stop the pump\r\n"
+                         "  - pump status: show the timer-driven pump engine and watering program state"},
     {"display", handle_display, "Controls the display. Usage: display <action> [params]\r\n"
                                "  - actions: init, text \"msg\", sleep, lvgl_test"},
     {"system", handle_system, "Gets system status. Usage: system get mode"}
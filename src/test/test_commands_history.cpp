@@ -0,0 +1,246 @@
+/**
+ * @file test_commands_history.cpp
+ * @brief Sensor time-series store test commands implementation
+ */
+
+#include "test_commands_history.h"
+#include "test_command_registry.h"
+#include "managers/ts/ts_store.h"
+#include "managers/ts/ts_block.h"
+#include "managers/ts/ts_rollup.h"
+#include <math.h>
+#include <Arduino.h>
+#include <string.h>
+
+#ifdef TEST_MODE
+
+// --- Helpers ---
+
+static bool parse_series(const char* name, ts_series_t* p_series) {
+    for (uint8_t i = 0; i < TS_SERIES_COUNT; i++) {
+        if (strcmp(name, ts_store_series_name((ts_series_t)i)) == 0) {
+            *p_series = (ts_series_t)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+typedef struct {
+    uint32_t printed;
+    uint32_t limit;
+} query_print_ctx_t;
+
+static bool print_sample(uint32_t ts, int32_t value, void* ctx) {
+    query_print_ctx_t* q = (query_print_ctx_t*)ctx;
+    Serial.printf("%lu,%ld\r\n", (unsigned long)ts, (long)value);
+    return ++q->printed < q->limit;
+}
+
+// --- Sub-command Handlers ---
+
+/**
+ * @brief Handles "history stats"
+ */
+static void handle_history_stats() {
+    ts_store_stats_t stats;
+    ts_store_get_stats(&stats);
+    if (!stats.mounted) {
+        Serial.println("History: not available (tsdb partition missing)");
+        return;
+    }
+
+    Serial.println("History stats:");
+    Serial.printf("  - Blocks:      %u/%u used (%lu KB partition)\r\n",
+                  stats.used_blocks, stats.block_count, (unsigned long)(stats.partition_size / 1024));
+    Serial.printf("  - Flash:       %lu samples in %lu bytes (%.2f bytes/sample)\r\n",
+                  (unsigned long)stats.flash_samples, (unsigned long)stats.flash_bytes,
+                  stats.flash_samples ? (double)stats.flash_bytes / stats.flash_samples : 0.0);
+    for (uint8_t i = 0; i < TS_SERIES_COUNT; i++) {
+        Serial.printf("  - Tail %-10s %u samples\r\n", ts_store_series_name((ts_series_t)i), stats.tail_samples[i]);
+    }
+    Serial.printf("  - Range:       %lu .. %lu\r\n", (unsigned long)stats.oldest_ts, (unsigned long)stats.newest_ts);
+    Serial.printf("  - This boot:   %lu samples, %lu blocks written, %lu sectors erased, %lu corrupt at mount\r\n",
+                  (unsigned long)stats.samples_appended, (unsigned long)stats.blocks_written,
+                  (unsigned long)stats.sectors_erased, (unsigned long)stats.corrupt_blocks);
+    Serial.printf("  - Clock:       %lu%s\r\n", (unsigned long)ts_store_now(),
+                  ts_store_now() == 0 ? " (not set, sampling paused)" : "");
+}
+
+/**
+ * @brief Handles "history query <series> [from] [to] [limit]"
+ * @details Prints matching samples as "ts,value" lines, oldest first.
+ */
+static void handle_history_query(const char* args) {
+    char name[16] = "";
+    unsigned long from = 0;
+    unsigned long to = UINT32_MAX;
+    unsigned long limit = 500;
+    ts_series_t series;
+
+    if (sscanf(args, "%15s %lu %lu %lu", name, &from, &to, &limit) < 1 || !parse_series(name, &series)) {
+        Serial.println("Error: Usage: history query <humidity|battery_mv|pump|refresh> [from] [to] [limit]");
+        return;
+    }
+
+    query_print_ctx_t ctx = {0, limit > 0 ? (uint32_t)limit : 1};
+    uint32_t start = micros();
+    ts_store_query(series, (uint32_t)from, (uint32_t)to, print_sample, &ctx);
+    Serial.printf("History query: %lu samples in %lu us\r\n",
+                  (unsigned long)ctx.printed, (unsigned long)(micros() - start));
+}
+
+/**
+ * @brief Handles "history bench [samples] [noise]"
+ * @details Encodes a synthetic 5-minute humidity random walk into RAM blocks
+ *          (no flash writes) and projects the size of one year of data.
+ */
+static void handle_history_bench(const char* args) {
+    long samples = 105120;   // one year of 5-minute samples
+    long noise = 8;          // ADC counts
+    sscanf(args, "%ld %ld", &samples, &noise);
+    if (samples <= 0 || samples > 1000000 || noise < 0 || noise > 2000) {
+        Serial.println("Error: Usage: history bench [samples 1-1000000] [noise 0-2000]");
+        return;
+    }
+
+    static ts_block_writer_t writer;
+    uint32_t ts = TS_STORE_MIN_VALID_TIME;
+    int32_t value = 2000;
+    uint32_t blocks = 0;
+    uint32_t bytes = 0;
+
+    randomSeed(1);
+    uint32_t start = micros();
+    ts_block_start(&writer, TS_SERIES_HUMIDITY, ts, value);
+    for (long i = 1; i < samples; i++) {
+        ts += 300;
+        value += random(-noise, noise + 1);
+        if (!ts_block_append(&writer, ts, value)) {
+            blocks++;
+            bytes += ts_block_used_bytes(&writer.block);
+            ts_block_start(&writer, TS_SERIES_HUMIDITY, ts, value);
+        }
+    }
+    blocks++;
+    bytes += ts_block_used_bytes(&writer.block);
+    uint32_t elapsed = micros() - start;
+
+    uint32_t flash_bytes = blocks * TS_BLOCK_SIZE;
+    Serial.printf("History bench: %ld samples, noise +/-%ld\r\n", samples, noise);
+    Serial.printf("  - Encoded:     %lu bytes in %lu blocks (%.3f bytes/sample, %lu bytes of flash)\r\n",
+                  (unsigned long)bytes, (unsigned long)blocks, (double)flash_bytes / samples,
+                  (unsigned long)flash_bytes);
+    Serial.printf("  - Per year:    %lu KB per series at 5-minute sampling\r\n",
+                  (unsigned long)((uint64_t)flash_bytes * 105120 / samples / 1024));
+    Serial.printf("  - Append cost: %.2f us/sample\r\n", (double)elapsed / samples);
+}
+
+/**
+ * @brief Handles "history chart <series> <days> [width]"
+ * @details Builds a width-column min/max/mean chart over the last `days` days
+ *          twice, from the auto-picked rollup tier and from a raw scan, and
+ *          compares cost and results.
+ */
+static void handle_history_chart(const char* args) {
+    static ts_rollup_point_t rollup[TS_ROLLUP_DAY_BUCKETS];
+    static ts_rollup_point_t raw[TS_ROLLUP_DAY_BUCKETS];
+    char name[16] = "";
+    unsigned long days = 30;
+    unsigned long width = 296;   // panel width
+    ts_series_t series;
+
+    if (sscanf(args, "%15s %lu %lu", name, &days, &width) < 1 || !parse_series(name, &series) ||
+        days == 0 || days > 3650 || width == 0 || width > TS_ROLLUP_DAY_BUCKETS) {
+        Serial.println("Error: Usage: history chart <series> [days] [width 1-400]");
+        return;
+    }
+
+    ts_store_stats_t stats;
+    ts_store_get_stats(&stats);
+    uint32_t t_to = stats.newest_ts;
+    if (t_to == 0) {
+        Serial.println("History chart: no samples stored.");
+        return;
+    }
+    uint32_t t_from = t_to > days * 86400UL ? t_to - days * 86400UL : 0;
+
+    ts_tier_t tier;
+    uint32_t start = micros();
+    uint16_t filled = ts_rollup_query(series, t_from, t_to, (uint16_t)width, TS_TIER_AUTO, rollup, &tier);
+    uint32_t rollup_us = micros() - start;
+
+    start = micros();
+    uint16_t raw_filled = ts_rollup_query(series, t_from, t_to, (uint16_t)width, TS_TIER_RAW, raw, NULL);
+    uint32_t raw_us = micros() - start;
+
+    uint32_t samples = 0;
+    uint32_t raw_samples = 0;
+    float max_mean_diff = 0.0f;
+    for (uint16_t i = 0; i < width; i++) {
+        samples += rollup[i].count;
+        raw_samples += raw[i].count;
+        if (rollup[i].count > 0 && raw[i].count > 0) {
+            float diff = fabsf(rollup[i].mean - raw[i].mean);
+            if (diff > max_mean_diff) max_mean_diff = diff;
+        }
+    }
+
+    Serial.printf("History chart: %s, %lu days, %lu columns, tier %s (%lu s buckets)\r\n",
+                  name, days, width, ts_rollup_tier_name(tier), (unsigned long)ts_rollup_tier_span(tier));
+    Serial.printf("  - Rollup:      %lu us, %u columns, %lu samples covered\r\n",
+                  (unsigned long)rollup_us, filled, (unsigned long)samples);
+    Serial.printf("  - Raw scan:    %lu us, %u columns, %lu samples decoded\r\n",
+                  (unsigned long)raw_us, raw_filled, (unsigned long)raw_samples);
+    Serial.printf("  - Max column mean difference: %.1f (bucket edges vs column edges)\r\n", max_mean_diff);
+}
+
+// --- Main Command Handler ---
+
+static void handle_history(const char* args) {
+    if (strcmp(args, "stats") == 0 || args[0] == '\0') {
+        handle_history_stats();
+        return;
+    }
+    if (strncmp(args, "query", 5) == 0 && (args[5] == '\0' || args[5] == ' ')) {
+        handle_history_query(args + 5);
+        return;
+    }
+    if (strncmp(args, "bench", 5) == 0 && (args[5] == '\0' || args[5] == ' ')) {
+        handle_history_bench(args + 5);
+        return;
+    }
+    if (strncmp(args, "chart", 5) == 0 && (args[5] == '\0' || args[5] == ' ')) {
+        handle_history_chart(args + 5);
+        return;
+    }
+    if (strcmp(args, "flush") == 0) {
+        Serial.println(ts_store_flush() ? "History tail blocks written." : "Error: history flush failed.");
+        return;
+    }
+    if (strcmp(args, "clear") == 0) {
+        Serial.println(ts_store_clear() ? "History cleared." : "Error: history clear failed.");
+        return;
+    }
+    Serial.println("Error: Unknown action. Usage: history [stats|query|chart|bench|flush|clear]");
+}
+
+// --- Command Definition ---
+
+static const CommandRegistryEntry history_commands[] = {
+    {"history", handle_history, "Sensor time-series store. Usage: history <action>\r\n"
+                               "  - history stats: block usage, bytes/sample and time range\r\n"
+                               "  - history query <series> [from] [to] [limit]: print ts,value samples (series: humidity, battery_mv, pump, refresh)\r\n"
+                               "  - history chart <series> [days] [width]: compare a rollup chart query against a raw scan\r\n"
+                               "  - history bench [samples] [noise]: encode a synthetic 5-minute series in RAM and project a year's size\r\n"
+                               "  - history flush: seal RAM tail blocks to flash\r\n"
+                               "  - history clear: erase the tsdb partition"}
+};
+
+// --- Public API ---
+
+void test_commands_history_init() {
+    test_registry_register_commands(history_commands, sizeof(history_commands) / sizeof(history_commands[0]));
+}
+
+#endif // TEST_MODE
@@ -0,0 +1,18 @@
+/**
+ * @file test_commands_history.h
+ * @brief Sensor time-series store test commands
+ */
+
+#ifndef TEST_COMMANDS_HISTORY_H
+#define TEST_COMMANDS_HISTORY_H
+
+#ifdef TEST_MODE
+
+/**
+ * @brief Initializes and registers time-series store test commands.
+ */
+void test_commands_history_init();
+
+#endif // TEST_MODE
+
+#endif // TEST_COMMANDS_HISTORY_H
@@ -6,19 +6,391 @@
 #include "test_commands_log.h"
 #include "test_command_registry.h"
 #include "managers/log_manager.h"
+#include "managers/log/log_store.h"
+#include "managers/log/log_archive.h"
+#include "services/config_manager.h"
 #include <Arduino.h>
+#include <SPIFFS.h>
 #include <string.h>
+#include "esp_crc.h"
+#include "mbedtls/base64.h"
 
 #ifdef TEST_MODE
 
+// --- Sub-command Handlers ---
+
+/**
+ * @brief Handles "log bench [count]"
+ * @details Emits `count` INFO records and reports per-call latency
+ *          and how many records the RAM ring had to drop.
+ */
+static void handle_log_bench(const char* args) {
+    int count = 200;
+    sscanf(args, "%d", &count);
+    if (count <= 0 || count > 10000) {
+        Serial.println("Error: count must be between 1 and 10000.");
+        return;
+    }
+
+    log_stats_t before;
+    log_manager_get_stats(&before);
+
+    uint32_t min_us = UINT32_MAX;
+    uint32_t max_us = 0;
+    uint64_t total_us = 0;
+    for (int i = 0; i < count; i++) {
+        uint32_t start = micros();
+        LOG_INFO("Bench", "bench record %d/%d value=%u", i + 1, count, (unsigned)start);
+        uint32_t elapsed = micros() - start;
+        total_us += elapsed;
+        if (elapsed < min_us) min_us = elapsed;
+        if (elapsed > max_us) max_us = elapsed;
+    }
+
+    log_stats_t after;
+    log_manager_get_stats(&after);
+
+    Serial.printf("Log bench: %d calls\r\n", count);
+    Serial.printf("  - Latency (us): avg=%lu min=%lu max=%lu\r\n",
+                  (unsigned long)(total_us / count), (unsigned long)min_us, (unsigned long)max_us);
+    Serial.printf("  - Logged:  %lu\r\n", (unsigned long)(after.records_logged - before.records_logged));
+    Serial.printf("  - Dropped: %lu\r\n", (unsigned long)(after.records_dropped - before.records_dropped));
+    Serial.printf("  - Ring:    %u/%u pending\r\n", after.ring_pending, after.ring_capacity);
+}
+
+/**
+ * @brief Handles "log store [format]"
+ * @details Prints the raw log partition journal status, or erases it.
+ */
+static void handle_log_store(const char* args) {
+    char action[16] = "";
+    sscanf(args, "%15s", action);
+
+    if (strcmp(action, "format") == 0) {
+        Serial.println("Erasing log partition...");
+        if (!log_store_format()) {
+            Serial.println("Error: Failed to format log partition.");
+            return;
+        }
+        Serial.println("Log partition formatted.");
+        return;
+    } else if (action[0] != '\0') {
+        Serial.println("Error: Unknown action. Usage: log store [format]");
+        return;
+    }
+
+    log_store_stats_t stats;
+    log_store_get_stats(&stats);
+    if (!stats.mounted) {
+        Serial.println("Log partition: not mounted (logging to SPIFFS)");
+        return;
+    }
+
+    Serial.println("Log partition:");
+    Serial.printf("  - Used:     %lu/%lu bytes\r\n", (unsigned long)stats.used_bytes, (unsigned long)stats.partition_size);
+    Serial.printf("  - Sectors:  head=%u tail=%u count=%u seq=%lu\r\n",
+                  stats.head_sector, stats.tail_sector, stats.sector_count, (unsigned long)stats.head_seq);
+    Serial.printf("  - Appended: %lu records\r\n", (unsigned long)stats.records_appended);
+    Serial.printf("  - Erased:   %lu sectors\r\n", (unsigned long)stats.sectors_erased);
+    Serial.printf("  - Torn:     %lu records recovered at mount\r\n", (unsigned long)stats.torn_records);
+}
+
+/**
+ * @brief Prints a compressed archive segment as base64 lines
+ * @details The BEGIN/END frame and the CRC32 let log_decode.py --archive pick the
+ *          segment out of a captured console log and verify it.
+ */
+static void dump_archive_segment(uint32_t index) {
+    char path[LOG_ARCHIVE_PATH_MAX];
+    log_archive_segment_path(index, path, sizeof(path));
+    File file = SPIFFS.open(path, FILE_READ);
+    if (!file) {
+        Serial.printf("Error: Segment %lu not found.\r\n", (unsigned long)index);
+        return;
+    }
+
+    uint32_t start = millis();
+    uint32_t size = file.size();
+    uint32_t crc = 0;
+    uint8_t chunk[48];
+    unsigned char line[68];
+    size_t n;
+
+    Serial.printf("-----BEGIN HLZA SEGMENT %lu %lu-----\r\n", (unsigned long)index, (unsigned long)size);
+    while ((n = file.read(chunk, sizeof(chunk))) > 0) {
+        size_t line_len = 0;
+        crc = esp_crc32_le(crc, chunk, n);
+        mbedtls_base64_encode(line, sizeof(line), &line_len, chunk, n);
+        Serial.write(line, line_len);
+        Serial.print("\r\n");
+    }
+    file.close();
+    Serial.printf("-----END HLZA SEGMENT crc32=%08lx-----\r\n", (unsigned long)crc);
+    Serial.printf("Dumped %lu bytes in %lu ms\r\n", (unsigned long)size, (unsigned long)(millis() - start));
+}
+
+/**
+ * @brief Handles "log archive [dump <n>|clear]"
+ * @details Lists compressed archive segments, dumps one, or deletes all of them.
+ */
+static void handle_log_archive(const char* args) {
+    char action[16] = "";
+    unsigned long index = 0;
+    int parsed = sscanf(args, "%15s %lu", action, &index);
+
+    if (strcmp(action, "dump") == 0) {
+        if (parsed < 2 || index == 0) {
+            Serial.println("Error: Usage: log archive dump <segment>");
+            return;
+        }
+        dump_archive_segment((uint32_t)index);
+        return;
+    } else if (strcmp(action, "clear") == 0) {
+        log_archive_clear();
+        Serial.println("Log archive cleared.");
+        return;
+    } else if (action[0] != '\0') {
+        Serial.println("Error: Unknown action. Usage: log archive [dump <n>|clear]");
+        return;
+    }
+
+    log_archive_stats_t stats;
+    log_archive_get_stats(&stats);
+    if (!stats.ready) {
+        Serial.println("Log archive: not available (SPIFFS not mounted)");
+        return;
+    }
+
+    log_archive_segment_t segments[16];
+    uint16_t total = log_archive_list(segments, 16);
+    uint16_t shown = total < 16 ? total : 16;
+
+    Serial.printf("Log archive: %u segments, %lu/%lu bytes\r\n",
+                  total, (unsigned long)stats.total_bytes, (unsigned long)LOG_ARCHIVE_BUDGET_BYTES);
+    for (uint16_t i = 0; i < shown; i++) {
+        const log_archive_segment_t* seg = &segments[i];
+        Serial.printf("  - #%lu: %lu bytes, %u blocks, %lu raw (%lu%%), %s\r\n",
+                      (unsigned long)seg->index, (unsigned long)seg->size, seg->blocks,
+                      (unsigned long)seg->raw_bytes,
+                      seg->raw_bytes ? (unsigned long)((uint64_t)seg->size * 100 / seg->raw_bytes) : 0UL,
+                      seg->source == LOG_ARCHIVE_SOURCE_SECTORS ? "sectors" : "file");
+    }
+    if (total > shown) {
+        Serial.printf("  ... %u older segments not shown\r\n", total - shown);
+    }
+    Serial.printf("  - This boot: %lu -> %lu bytes in %lu blocks, %lu segments deleted, %lu write errors\r\n",
+                  (unsigned long)stats.raw_in, (unsigned long)stats.compressed_out,
+                  (unsigned long)stats.blocks_written, (unsigned long)stats.segments_deleted,
+                  (unsigned long)stats.write_errors);
+}
+
+/**
+ * @brief Handles "log stats"
+ * @details Prints ring and background writer counters.
+ */
+static void handle_log_stats() {
+    log_stats_t stats;
+    log_manager_get_stats(&stats);
+
+    Serial.println("Log stats:");
+    Serial.printf("  - Logged:      %lu\r\n", (unsigned long)stats.records_logged);
+    Serial.printf("  - Dropped:     %lu\r\n", (unsigned long)stats.records_dropped);
+    Serial.printf("  - Ring:        %u/%u pending\r\n", stats.ring_pending, stats.ring_capacity);
+    Serial.printf("  - Flushes:     %lu\r\n", (unsigned long)stats.flush_count);
+    Serial.printf("  - Bytes:       %lu\r\n", (unsigned long)stats.bytes_written);
+    Serial.printf("  - Flash I/O:   %lu ms total, %lu us/flush\r\n",
+                  (unsigned long)(stats.flash_io_us / 1000),
+                  (unsigned long)(stats.flush_count ? stats.flash_io_us / stats.flush_count : 0));
+    Serial.printf("  - Max latency: %lu ms\r\n", (unsigned long)log_manager_get_max_latency());
+}
+
+/**
+ * @brief Handles "log latency <ms>"
+ */
+static void handle_log_latency(const char* args) {
+    unsigned long latency_ms = 0;
+    if (sscanf(args, "%lu", &latency_ms) != 1) {
+        Serial.println("Error: Usage: log latency <ms>");
+        return;
+    }
+    log_manager_set_max_latency(latency_ms);
+    Serial.printf("Max log latency set to %lu ms\r\n", (unsigned long)log_manager_get_max_latency());
+}
+
+/**
+ * @brief Handles "log level [<module|*> <level|default>]"
+ * @details Without arguments prints the level table. Changes are applied
+ *          immediately and persisted through ConfigManager.
+ */
+static void handle_log_level(const char* args) {
+    char module[LOG_MODULE_NAME_MAX];
+    char level_name[10];
+    int items = sscanf(args, "%23s %9s", module, level_name);
+
+    if (items <= 0) {
+        Serial.printf("Log levels: %s\r\n", log_manager_get_level_spec().c_str());
+        return;
+    }
+    if (items < 2) {
+        Serial.println("Error: Usage: log level <module|*> <error|warn|info|debug|default>");
+        return;
+    }
+
+    int level = log_manager_parse_level(level_name);
+    if (level < 0 && strcmp(level_name, "default") != 0) {
+        Serial.println("Error: Invalid log level. Use 'error', 'warn', 'info', 'debug' or 'default'.");
+        return;
+    }
+
+    if (strcmp(module, "*") == 0) {
+        if (level < 0) {
+            Serial.println("Error: The default level cannot be 'default'.");
+            return;
+        }
+        log_manager_set_default_level((log_level_t)level);
+    } else if (!log_manager_set_module_level(module, level)) {
+        Serial.printf("Error: Module level table is full (%d entries).\r\n", LOG_MODULE_LEVEL_MAX);
+        return;
+    }
+
+    // 持久化当前级别表
+    String spec = log_manager_get_level_spec();
+    hydro_config_t& config = ConfigManager::instance().getConfig();
+    strncpy(config.system.log_levels, spec.c_str(), sizeof(config.system.log_levels) - 1);
+    config.system.log_levels[sizeof(config.system.log_levels) - 1] = '\0';
+    if (!ConfigManager::instance().saveConfig()) {
+        Serial.println("Warning: Level applied but could not be saved.");
+    }
+    Serial.printf("Log levels: %s\r\n", spec.c_str());
+}
+
+/**
+ * @brief Prints one query result line
+ */
+static bool print_log_entry(const log_entry_t* entry, void* ctx) {
+    Serial.printf("%s%s\r\n", entry->from_flash ? "F " : "R ", entry->line);
+    return true;
+}
+
+/**
+ * @brief Handles "log query [level=<lvl>] [module=<name>] [since=<unix>] [until=<unix>] [limit=<n>] [src=ram|flash|all]"
+ * @details Streams matching records oldest-first. Lines are prefixed with
+ *          "F" (log partition) or "R" (RAM ring).
+ */
+static void handle_log_query(const char* args) {
+    log_query_t query;
+    log_manager_query_init(&query);
+    query.sources = LOG_QUERY_SOURCE_ALL;
+
+    char buffer[128];
+    strncpy(buffer, args, sizeof(buffer) - 1);
+    buffer[sizeof(buffer) - 1] = '\0';
+
+    char module[LOG_MODULE_NAME_MAX] = "";
+    char* save_ptr = nullptr;
+    for (char* token = strtok_r(buffer, " ", &save_ptr); token != nullptr; token = strtok_r(nullptr, " ", &save_ptr)) {
+        char* value = strchr(token, '=');
+        if (value == nullptr) {
+            Serial.printf("Error: Invalid filter '%s'. Use key=value.\r\n", token);
+            return;
+        }
+        *value++ = '\0';
+
+        if (strcmp(token, "level") == 0) {
+            int level = log_manager_parse_level(value);
+            if (level < 0) {
+                Serial.println("Error: Invalid log level. Use 'error', 'warn', 'info' or 'debug'.");
+                return;
+            }
+            query.max_level = level;
+        } else if (strcmp(token, "module") == 0) {
+            strncpy(module, value, sizeof(module) - 1);
+            module[sizeof(module) - 1] = '\0';
+            query.module = module;
+        } else if (strcmp(token, "since") == 0) {
+            query.since = strtoul(value, nullptr, 10);
+        } else if (strcmp(token, "until") == 0) {
+            query.until = strtoul(value, nullptr, 10);
+        } else if (strcmp(token, "limit") == 0) {
+            query.limit = (uint16_t)strtoul(value, nullptr, 10);
+        } else if (strcmp(token, "src") == 0) {
+            if (strcmp(value, "ram") == 0) {
+                query.sources = LOG_QUERY_SOURCE_RAM;
+            } else if (strcmp(value, "flash") == 0) {
+                query.sources = LOG_QUERY_SOURCE_FLASH;
+            } else if (strcmp(value, "all") == 0) {
+                query.sources = LOG_QUERY_SOURCE_ALL;
+            } else {
+                Serial.println("Error: src must be 'ram', 'flash' or 'all'.");
+                return;
+            }
+        } else {
+            Serial.printf("Error: Unknown filter '%s'.\r\n", token);
+            return;
+        }
+    }
+
+    uint32_t start = millis();
+    uint32_t count = log_manager_query(&query, print_log_entry, nullptr);
+    Serial.printf("Query matched %lu records in %lu ms\r\n", (unsigned long)count, (unsigned long)(millis() - start));
+}
+
+/**
+ * @brief Handles "log flush"
+ */
+static void handle_log_flush() {
+    uint32_t start = micros();
+    bool acked = log_manager_flush_now();
+    uint32_t elapsed = micros() - start;
+    if (!acked) {
+        Serial.println("Error: Flush was not acknowledged.");
+        return;
+    }
+    Serial.printf("Flush acknowledged in %lu us\r\n", (unsigned long)elapsed);
+}
+
 // --- Command Handler ---
 
 /**
  * @brief Handles the "log" command
- * @param args Format: "<level> <module> <message...>"
+ * @param args Format: "<level> <module> <message...>", "bench [count]", "store [format]",
+ *             "archive [...]", "level [...]", "query [...]", "stats", "flush" or "latency <ms>"
  *             level: debug, info, warn, error
  */
 void handle_log(const char* args) {
+    if (strncmp(args, "bench", 5) == 0 && (args[5] == '\0' || args[5] == ' ')) {
+        handle_log_bench(args + 5);
+        return;
+    }
+    if (strncmp(args, "store", 5) == 0 && (args[5] == '\0' || args[5] == ' ')) {
+        handle_log_store(args + 5);
+        return;
+    }
+    if (strncmp(args, "archive", 7) == 0 && (args[7] == '\0' || args[7] == ' ')) {
+        handle_log_archive(args + 7);
+        return;
+    }
+    if (strncmp(args, "level", 5) == 0 && (args[5] == '\0' || args[5] == ' ')) {
+        handle_log_level(args + 5);
+        return;
+    }
+    if (strncmp(args, "query", 5) == 0 && (args[5] == '\0' || args[5] == ' ')) {
+        handle_log_query(args + 5);
+        return;
+    }
+    if (strcmp(args, "stats") == 0) {
+        handle_log_stats();
+        return;
+    }
+    if (strcmp(args, "flush") == 0) {
+        handle_log_flush();
+        return;
+    }
+    if (strncmp(args, "latency", 7) == 0 && (args[7] == '\0' || args[7] == ' ')) {
+        handle_log_latency(args + 7);
+        return;
+    }
+
     char level[10];
     char module[20];
     char message[100];
@@ -48,13 +420,21 @@ void handle_log(const char* args) {
 // --- Command Definition ---
 
 static const CommandRegistryEntry log_commands[] = {
-    {"log", handle_log, "Generate a log message. Usage: log <level> <module> <message...>"}
+    {"log", handle_log, "Generate a log message. Usage: log <level> <module> <message...>\r\n"
+                       "  - log bench [count]: measure per-call latency and dropped records\r\n"
+                       "  - log store [format]: show or erase the log partition journal\r\n"
+                       "  - log archive [dump <n>|clear]: list compressed log segments, dump one as base64, or delete all\r\n"
+                       "  - log level [<module|*> <level|default>]: show or set runtime log levels\r\n"
+                       "  - log query [level=] [module=] [since=] [until=] [limit=] [src=ram|flash|all]: stream matching records\r\n"
+                       "  - log stats: show ring and writer counters\r\n"
+                       "  - log flush: flush the ring and wait for the writer's ack\r\n"
+                       "  - log latency <ms>: set the maximum time records wait in RAM"}
 };
 
 // --- Public API ---
 
 void test_commands_log_init() {
-    test_registry_register_commands(log_commands, sizeof(log_commands) / sizeof(log_commands));
+    test_registry_register_commands(log_commands, sizeof(log_commands) / sizeof(log_commands[0]));
 }
 
 #endif // TEST_MODE
\ No newline at end of file
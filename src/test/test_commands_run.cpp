@@ -6,23 +6,850 @@
 #include "test_commands_run.h"
 #include "test_command_registry.h"
 #include "../managers/run_mode_manager.h"
+#include "../managers/sensor_manager.h"
+#include "../managers/actuator_manager.h"
+#include "../managers/humidity_filter.h"
+#include "../managers/watering_controller.h"
+#include "../managers/drying_model.h"
+#include "../managers/ts/ts_store.h"
+#include "../services/watering_scheduler.h"
+#include "../services/config_manager.h"
+#include "../ui/ui_manager.h"
+#include "../system/loop_monitor.h"
+#include "../data/timing_constants.h"
 #include <Arduino.h>
+#include <stdlib.h>
 
 #ifdef TEST_MODE
 
+#define REPLAY_MAX_SAMPLES      4096   // 14 days at the 5 min history interval
+#define REPLAY_REFERENCE_HALF   2      // Recorded traces: centered 5-point median is the reference
+#define REPLAY_SYNTH_PERIOD     288    // Synthetic trace: one dry/wet cycle per 288 samples
+#define REPLAY_SYNTH_AMPLITUDE  300
+#define REPLAY_SYNTH_NOISE      15
+
+#define SIM_DRY_RATE            40.0f  // Simulated soil: mean drying rate (ADC/hour), faster in the afternoon
+#define SIM_NOISE               10     // Simulated soil: reading noise (+/- ADC)
+
+#define ADAPT_SIM_STEP_S        300    // Check period of the simulation (sleep-mode interval)
+
+#define PREDICT_SYNTH_OVERSHOOT 20     // Synthetic trace: watered this far past the decision point
+
+// --- Helper Functions ---
+
+/**
+ * @brief Print loop monitor statistics as a JSON object body (no braces)
+ */
+static void print_jitter_stats(const loop_monitor_stats_t* stats) {
+    Serial.printf("\"iterations\":%lu,\"avg_gap_us\":%lu,\"max_gap_us\":%lu,"
+                  "\"over_budget\":%lu,\"budget_ms\":%d,\"histogram\":[",
+                  (unsigned long)stats->iterations, (unsigned long)stats->avg_gap_us,
+                  (unsigned long)stats->max_gap_us, (unsigned long)stats->over_budget,
+                  LOOP_JITTER_BUDGET_MS);
+    for (uint8_t i = 0; i < LOOP_MONITOR_BUCKETS; i++) {
+        uint32_t limit = loop_monitor_bucket_limit_us(i);
+        if (limit == UINT32_MAX) {
+            Serial.printf("%s{\"lt_us\":null,\"count\":%lu}", i ? "," : "",
+                          (unsigned long)stats->histogram[i]);
+        } else {
+            Serial.printf("%s{\"lt_us\":%lu,\"count\":%lu}", i ? "," : "",
+                          (unsigned long)limit, (unsigned long)stats->histogram[i]);
+        }
+    }
+    Serial.print("]");
+}
+
+/**
+ * @brief Emulate the RUN mode loop with periodic sensor reads and measure jitter
+ *
+ * Runs ui/actuator loops back to back for duration_ms while acquiring both
+ * sensors every TEST_JITTER_BENCH_INTERVAL_MS, either blocking in the loop
+ * (sync) or through the acquisition task (async).
+ */
+static void run_jitter_bench(bool async, uint32_t duration_ms) {
+    uint32_t acquisitions = 0;
+    uint32_t failures = 0;
+    bool pending = false;
+
+    loop_monitor_reset();
+    uint32_t start = millis();
+    uint32_t last_acquire = start - TEST_JITTER_BENCH_INTERVAL_MS;
+
+    while (millis() - start < duration_ms || pending) {
+        loop_monitor_tick();
+        ui_manager_loop();
+        actuator_manager_loop();
+
+        uint32_t now = millis();
+        if (!pending && now - start < duration_ms && now - last_acquire >= TEST_JITTER_BENCH_INTERVAL_MS) {
+            last_acquire = now;
+            if (async) {
+                pending = sensor_manager_start_async(nullptr, nullptr) == SENSOR_OK;
+                if (!pending) failures++;
+            } else {
+                float humidity = 0.0f;
+                float voltage = 0.0f;
+                acquisitions++;
+                if (sensor_manager_get_humidity(&humidity) != SENSOR_OK) failures++;
+                sensor_manager_get_battery_voltage(&voltage);
+            }
+        }
+
+        sensor_async_result_t result;
+        if (pending && sensor_manager_poll_async(&result)) {
+            pending = false;
+            acquisitions++;
+            if (result.humidity_result != SENSOR_OK) failures++;
+        }
+
+        delay(TEST_LOOP_DELAY_MS);
+    }
+
+    loop_monitor_stats_t stats;
+    loop_monitor_get_stats(&stats);
+
+    Serial.printf("{\"command\":\"run jitter bench\",\"status\":\"success\",\"mode\":\"%s\","
+                  "\"duration_ms\":%lu,\"acquisitions\":%lu,\"failures\":%lu,",
+                  async ? "async" : "sync", (unsigned long)(millis() - start),
+                  (unsigned long)acquisitions, (unsigned long)failures);
+    print_jitter_stats(&stats);
+    Serial.println("}");
+}
+
+/**
+ * @brief Handle "run jitter" subcommands
+ *
+ * @param args "", "reset" or "bench <sync|async> [duration_ms]"
+ */
+static void handle_run_jitter(const char* args) {
+    char sub[12] = "";
+    char mode[8] = "";
+    unsigned long duration = TEST_JITTER_BENCH_DURATION_MS;
+    int items = sscanf(args, "%11s %7s %lu", sub, mode, &duration);
+
+    if (items <= 0) {
+        loop_monitor_stats_t stats;
+        loop_monitor_get_stats(&stats);
+        Serial.print("{\"command\":\"run jitter\",\"status\":\"success\",");
+        print_jitter_stats(&stats);
+        Serial.println("}");
+    } else if (strcmp(sub, "reset") == 0) {
+        loop_monitor_reset();
+        Serial.println("{\"command\":\"run jitter reset\",\"status\":\"success\"}");
+    } else if (strcmp(sub, "bench") == 0 && items >= 2 &&
+               (strcmp(mode, "sync") == 0 || strcmp(mode, "async") == 0) &&
+               duration > 0 && duration <= 600000) {
+        run_jitter_bench(strcmp(mode, "async") == 0, (uint32_t)duration);
+    } else {
+        Serial.println("Error: Invalid arguments. Usage: run jitter [reset|bench <sync|async> [duration_ms]]");
+    }
+}
+
+/**
+ * @brief Decision counters for one pass over a replay trace
+ */
+typedef struct {
+    uint32_t waterings;        // Rising edges of the watering decision
+    uint32_t false_waterings;  // ...that started while the reference said wet
+    uint32_t missed;           // Reference dry episodes with no watering decision
+    uint32_t outliers;         // Samples flagged by the Hampel stage
+} replay_counts_t;
+
+/**
+ * @brief Feed a trace through the decision logic with the given filter config
+ */
+static void replay_trace(const uint16_t* trace, const bool* dry, uint32_t count,
+                         const humidity_filter_config_t* config, replay_counts_t* counts) {
+    humidity_filter_state_t state;
+    humidity_filter_state_init(&state);
+    memset(counts, 0, sizeof(*counts));
+
+    bool in_episode = false;
+    bool episode_served = false;
+    for (uint32_t i = 0; i < count; i++) {
+        humidity_filter_result_t result;
+        humidity_filter_step(&state, config, trace[i], &result);
+
+        if (result.started) {
+            counts->waterings++;
+            if (!dry[i]) counts->false_waterings++;
+        }
+
+        if (dry[i] && !in_episode) {
+            in_episode = true;
+            episode_served = false;
+        } else if (!dry[i] && in_episode) {
+            in_episode = false;
+            if (!episode_served) counts->missed++;
+        }
+        if (in_episode && result.need_water) episode_served = true;
+    }
+    if (in_episode && !episode_served) counts->missed++;
+    counts->outliers = state.outliers;
+}
+
+static void print_replay_counts(const char* name, const replay_counts_t* counts) {
+    Serial.printf("\"%s\":{\"waterings\":%lu,\"false_waterings\":%lu,\"missed\":%lu,\"outliers\":%lu}",
+                  name, (unsigned long)counts->waterings, (unsigned long)counts->false_waterings,
+                  (unsigned long)counts->missed, (unsigned long)counts->outliers);
+}
+
+/**
+ * @brief Source of a replay trace: "history [days]" or "synth [a1] [a2] [a3]"
+ */
+typedef struct {
+    char source[10];
+    bool synth;
+    int given;                 // Numeric arguments present after the source
+    unsigned long arg[3];
+} replay_args_t;
+
+/**
+ * @brief Parse the source arguments shared by the replay commands
+ * @return false when the source is neither "history" nor "synth"
+ */
+static bool parse_replay_args(const char* args, replay_args_t* p_args) {
+    memset(p_args, 0, sizeof(*p_args));
+    int items = sscanf(args, "%9s %lu %lu %lu", p_args->source, &p_args->arg[0], &p_args->arg[1], &p_args->arg[2]);
+    if (items < 1) return false;
+    p_args->synth = strcmp(p_args->source, "synth") == 0;
+    p_args->given = items - 1;
+    return p_args->synth || strcmp(p_args->source, "history") == 0;
+}
+
+/**
+ * @brief Humidity trace for the replay commands, timestamps optional
+ */
+typedef struct {
+    uint16_t* values;
+    uint32_t* times;           // nullptr when the replay does not need them
+    uint32_t count;
+} replay_buffer_t;
+
+static void replay_buffer_free(replay_buffer_t* p_buf) {
+    free(p_buf->values);
+    free(p_buf->times);
+    p_buf->values = nullptr;
+    p_buf->times = nullptr;
+}
+
+/**
+ * @brief Allocate room for REPLAY_MAX_SAMPLES samples
+ * @return false (nothing left allocated) when out of memory
+ */
+static bool replay_buffer_alloc(replay_buffer_t* p_buf, bool with_times) {
+    p_buf->count = 0;
+    p_buf->values = (uint16_t*)malloc(REPLAY_MAX_SAMPLES * sizeof(uint16_t));
+    p_buf->times = with_times ? (uint32_t*)malloc(REPLAY_MAX_SAMPLES * sizeof(uint32_t)) : nullptr;
+    if (p_buf->values == nullptr || (with_times && p_buf->times == nullptr)) {
+        replay_buffer_free(p_buf);
+        return false;
+    }
+    return true;
+}
+
+static bool replay_load_visit(uint32_t ts, int32_t value, void* ctx) {
+    replay_buffer_t* p_buf = (replay_buffer_t*)ctx;
+    if (p_buf->count >= REPLAY_MAX_SAMPLES) return false;
+    if (p_buf->times != nullptr) p_buf->times[p_buf->count] = ts;
+    p_buf->values[p_buf->count++] = value < 0 ? 0 : (value > 65535 ? 65535 : (uint16_t)value);
+    return true;
+}
+
+/**
+ * @brief Load the last days of recorded humidity into the buffer
+ * @return false when the clock is not set or the time-series store is unavailable
+ */
+static bool replay_load_history(replay_buffer_t* p_buf, uint32_t days) {
+    uint32_t now = ts_store_now();
+    if (now == 0 || !ts_store_is_mounted()) return false;
+    p_buf->count = 0;
+    uint32_t from = now > days * 86400UL ? now - days * 86400UL : 0;
+    ts_store_query(TS_SERIES_HUMIDITY, from, now, replay_load_visit, p_buf);
+    return true;
+}
+
+static void print_replay_error(const char* command, const char* message) {
+    Serial.printf("{\"command\":\"%s\",\"status\":\"error\",\"message\":\"%s\"}\r\n", command, message);
+}
+
+/**
+ * @brief Diurnal drying rate of the simulated soil at time t (ADC/hour)
+ */
+static float sim_drying_rate(uint32_t t) {
+    float hour = (float)(t % 86400) / 3600.0f;
+    return SIM_DRY_RATE * (1.0f + 0.6f * sinf(2.0f * (float)M_PI * (hour - 8.0f) / 24.0f));
+}
+
+/**
+ * @brief A simulated sensor reading: the true value plus uniform noise
+ */
+static float sim_noisy(float truth, int32_t noise) {
+    return truth + random(-noise, noise + 1);
+}
+
+static uint16_t sim_to_adc(float value) {
+    return value < 0 ? 0 : (value > 4095 ? 4095 : (uint16_t)value);
+}
+
+/**
+ * @brief Handle "run replay" subcommands
+ *
+ * Replays a humidity trace through the watering decision twice: once as a
+ * plain threshold compare on each reading (the old behaviour) and once with
+ * the configured filter pipeline, then counts watering starts.
+ *
+ * A start is false when the reference says the soil was not dry: for
+ * synthetic traces the noise-free signal, for recorded history a centered
+ * 5-point median (non-causal, so unavailable to the live filter).
+ *
+ * @param args "history [days]" or "synth [samples] [spike_pct] [seed]"
+ */
+static void handle_run_replay(const char* args) {
+    replay_args_t source;
+    if (!parse_replay_args(args, &source)) {
+        Serial.println("Error: Invalid arguments. Usage: run replay <history [days]|synth [samples] [spike_pct] [seed]>");
+        return;
+    }
+
+    humidity_filter_config_t filtered_cfg;
+    humidity_filter_load_config(&filtered_cfg);
+    humidity_filter_config_t raw_cfg = {filtered_cfg.threshold, 1, 0.0f, 0};
+
+    replay_buffer_t buf;
+    bool* dry = nullptr;
+    if (!replay_buffer_alloc(&buf, false) || (dry = (bool*)malloc(REPLAY_MAX_SAMPLES * sizeof(bool))) == nullptr) {
+        replay_buffer_free(&buf);
+        print_replay_error("run replay", "Out of memory");
+        return;
+    }
+    uint16_t* trace = buf.values;
+
+    uint32_t count = 0;
+    uint32_t spikes = 0;
+    if (source.synth) {
+        unsigned long samples = source.arg[0];
+        count = source.given >= 1 && samples > 0 ? (samples < REPLAY_MAX_SAMPLES ? samples : REPLAY_MAX_SAMPLES) : 2016;
+        uint32_t spike_permille = source.given >= 2 ? source.arg[1] * 10 : 20;
+        randomSeed(source.given >= 3 ? source.arg[2] : 1);
+        for (uint32_t i = 0; i < count; i++) {
+            float truth = filtered_cfg.threshold +
+                          REPLAY_SYNTH_AMPLITUDE * sinf(2.0f * (float)M_PI * i / REPLAY_SYNTH_PERIOD);
+            float value = sim_noisy(truth, REPLAY_SYNTH_NOISE);
+            // Loose contact / condensation spikes read as very dry
+            if ((uint32_t)random(0, 1000) < spike_permille) {
+                value += random(600, 1200);
+                spikes++;
+            }
+            trace[i] = sim_to_adc(value);
+            dry[i] = truth > filtered_cfg.threshold;
+        }
+    } else {
+        uint32_t days = source.given >= 1 && source.arg[0] > 0 ? source.arg[0] : 7;
+        if (!replay_load_history(&buf, days)) {
+            replay_buffer_free(&buf);
+            free(dry);
+            print_replay_error("run replay", "History unavailable (clock or tsdb)");
+            return;
+        }
+        count = buf.count;
+
+        for (uint32_t i = 0; i < count; i++) {
+            uint16_t window[2 * REPLAY_REFERENCE_HALF + 1];
+            uint8_t n = 0;
+            for (int32_t j = (int32_t)i - REPLAY_REFERENCE_HALF; j <= (int32_t)i + REPLAY_REFERENCE_HALF; j++) {
+                if (j >= 0 && j < (int32_t)count) window[n++] = trace[j];
+            }
+            for (uint8_t a = 1; a < n; a++) {
+                uint16_t v = window[a];
+                int b = a - 1;
+                while (b >= 0 && window[b] > v) {
+                    window[b + 1] = window[b];
+                    b--;
+                }
+                window[b + 1] = v;
+            }
+            dry[i] = window[n / 2] > filtered_cfg.threshold;
+        }
+    }
+
+    replay_counts_t raw_counts;
+    replay_counts_t filtered_counts;
+    uint32_t start = micros();
+    replay_trace(trace, dry, count, &raw_cfg, &raw_counts);
+    replay_trace(trace, dry, count, &filtered_cfg, &filtered_counts);
+    uint32_t elapsed = micros() - start;
+    replay_buffer_free(&buf);
+    free(dry);
+
+    Serial.printf("{\"command\":\"run replay\",\"status\":\"success\",\"source\":\"%s\",\"samples\":%lu,",
+                  source.source, (unsigned long)count);
+    if (source.synth) Serial.printf("\"spikes\":%lu,", (unsigned long)spikes);
+    Serial.printf("\"threshold\":%u,\"window\":%u,\"hampel_k\":%.1f,\"hysteresis\":%u,",
+                  filtered_cfg.threshold, filtered_cfg.window, filtered_cfg.hampel_k, filtered_cfg.hysteresis);
+    print_replay_counts("raw", &raw_counts);
+    Serial.print(",");
+    print_replay_counts("filtered", &filtered_counts);
+    Serial.printf(",\"elapsed_us\":%lu}\r\n", (unsigned long)elapsed);
+}
+
+/**
+ * @brief Handle "run filter [reset]": show the live (RTC-retained) filter state
+ */
+static void handle_run_filter(const char* args) {
+    if (strncmp(args, "reset", 5) == 0) {
+        humidity_filter_reset();
+        Serial.println("{\"command\":\"run filter reset\",\"status\":\"success\"}");
+        return;
+    }
+
+    humidity_filter_state_t state;
+    humidity_filter_get_state(&state);
+    Serial.printf("{\"command\":\"run filter\",\"status\":\"success\",\"restored\":%s,\"samples\":%u,"
+                  "\"filtered\":%.0f,\"need_water\":%s,\"total\":%lu,\"outliers\":%lu,\"transitions\":%lu}\r\n",
+                  humidity_filter_was_restored() ? "true" : "false", state.count, state.last_filtered,
+                  state.need_water ? "true" : "false", (unsigned long)state.total,
+                  (unsigned long)state.outliers, (unsigned long)state.transitions);
+}
+
+/**
+ * @brief Handle "run sleep [now]": deep-sleep cycle statistics, or one cycle on demand
+ */
+static void handle_run_sleep(const char* args) {
+    if (strncmp(args, "now", 3) == 0) {
+        Serial.println("{\"command\":\"run sleep now\",\"status\":\"success\",\"message\":\"Entering RUN mode deep sleep\"}");
+        Serial.flush();
+        run_mode_manager_sleep();
+        return;
+    }
+
+    run_sleep_stats_t stats;
+    run_mode_manager_get_sleep_stats(&stats);
+    uint32_t avg_awake = stats.cycles > 0 ? (uint32_t)(stats.total_awake_ms / stats.cycles) : 0;
+    uint64_t total_ms = stats.total_awake_ms + stats.total_sleep_ms;
+    float awake_pct = total_ms > 0 ? (float)stats.total_awake_ms * 100.0f / (float)total_ms : 0.0f;
+    Serial.printf("{\"command\":\"run sleep\",\"status\":\"success\",\"woke_from_sleep\":%s,\"cycles\":%lu,"
+                  "\"last_awake_ms\":%lu,\"last_boot_ms\":%lu,\"last_check_ms\":%lu,\"last_display_ms\":%lu,"
+                  "\"avg_awake_ms\":%lu,\"max_awake_ms\":%lu,\"last_sleep_ms\":%lu,\"last_wake_cause\":%u,"
+                  "\"awake_pct\":%.3f}\r\n",
+                  run_mode_manager_woke_from_sleep() ? "true" : "false", (unsigned long)stats.cycles,
+                  (unsigned long)stats.last_awake_ms, (unsigned long)stats.last_boot_ms,
+                  (unsigned long)stats.last_check_ms, (unsigned long)stats.last_display_ms,
+                  (unsigned long)avg_awake, (unsigned long)stats.max_awake_ms,
+                  (unsigned long)stats.last_sleep_ms, stats.last_wake_cause, awake_pct);
+}
+
+/**
+ * @brief Handle "run schedule [check [ms]|reset]": watering scheduler state and decisions
+ */
+static void handle_run_schedule(const char* args) {
+    WateringScheduler& scheduler = WateringScheduler::instance();
+
+    if (strncmp(args, "reset", 5) == 0) {
+        scheduler.reset();
+        Serial.println("{\"command\":\"run schedule reset\",\"status\":\"success\"}");
+        return;
+    }
+    if (strncmp(args, "check", 5) == 0) {
+        unsigned long requested = ConfigManager::instance().getConfig().watering.duration_ms;
+        sscanf(args + 5, "%lu", &requested);
+        uint32_t allowed = 0;
+        WateringDecision decision = scheduler.check(requested, &allowed);
+        WateringScheduleStatus status;
+        scheduler.getStatus(&status);
+        Serial.printf("{\"command\":\"run schedule check\",\"status\":\"success\",\"decision\":\"%s\","
+                      "\"requested_ms\":%lu,\"allowed_ms\":%lu,\"wait_s\":%lu}\r\n",
+                      WateringScheduler::decisionName(decision), requested,
+                      (unsigned long)allowed, (unsigned long)status.wait_s);
+        return;
+    }
+
+    Serial.print("{\"command\":\"run schedule\",\"status\":\"success\",\"scheduler\":");
+    Serial.print(scheduler.getStatusJson());
+    Serial.println("}");
+}
+
+/**
+ * @brief Totals of one simulated watering strategy
+ */
+typedef struct {
+    uint32_t waterings;
+    float pump_s;          // Pump run time
+    float duty_s;          // Run time weighted by duty (energy and water proxy)
+    float runoff_s;        // Effective seconds beyond what the soil could take up
+    uint32_t observed;     // Waterings with a reading one soak time later
+    uint32_t in_band;      // ... of which inside the target band
+    float abs_error;       // Sum of |reading - target| at those readings
+    uint32_t dry_checks;   // Checks with the soil above the watering threshold
+    uint32_t checks;
+    float final_gain;
+} adapt_sim_result_t;
+
+/**
+ * @brief Run one strategy against the simulated soil
+ *
+ * Soil model: the reading rises by a diurnal drying rate between checks and
+ * drops by true_gain per full-duty pump second when watered, but not below
+ * watering.humidity_wet; water beyond that point is counted as runoff. The
+ * decision path is the live one: humidity filter, min interval, then either
+ * the fixed dose or the controller's plan.
+ */
+static void adapt_sim_run(bool adaptive, float true_gain, uint32_t days, uint32_t seed,
+                          adapt_sim_result_t* result) {
+    hydro_config_t config = ConfigManager::instance().getConfig();
+    humidity_filter_config_t filter_cfg;
+    humidity_filter_load_config(&filter_cfg);
+    watering_ctrl_config_t ctrl_cfg;
+    watering_controller_load_config(&ctrl_cfg);
+
+    humidity_filter_state_t filter;
+    humidity_filter_state_init(&filter);
+    watering_ctrl_state_t ctrl;
+    watering_ctrl_state_init(&ctrl, 0);
+    memset(result, 0, sizeof(*result));
+
+    randomSeed(seed);
+    float soil = config.watering.threshold - 100.0f;
+    float wet = config.watering.humidity_wet;
+    uint32_t last_water = 0;
+    bool measure_pending = false;
+    uint32_t steps = days * (86400 / ADAPT_SIM_STEP_S);
+
+    for (uint32_t i = 0; i < steps; i++) {
+        uint32_t t = (i + 1) * ADAPT_SIM_STEP_S;
+        soil += sim_drying_rate(t) * ADAPT_SIM_STEP_S / 3600.0f;
+        float reading = sim_noisy(soil, SIM_NOISE);
+
+        result->checks++;
+        if (soil > config.watering.threshold) result->dry_checks++;
+
+        if (adaptive) watering_ctrl_observe(&ctrl, &ctrl_cfg, reading, t);
+        if (measure_pending && t - last_water >= ctrl_cfg.soak_s) {
+            measure_pending = false;
+            float error = fabsf(reading - ctrl_cfg.target);
+            result->observed++;
+            result->abs_error += error;
+            if (error <= ctrl_cfg.band / 2.0f) result->in_band++;
+        }
+
+        humidity_filter_result_t filtered;
+        bool need = humidity_filter_step(&filter, &filter_cfg, reading, &filtered);
+        if (!need || (last_water != 0 && t - last_water < config.watering.min_interval_s)) {
+            continue;
+        }
+
+        uint8_t duty = config.watering.power;
+        uint32_t duration_ms = config.watering.duration_ms;
+        if (adaptive) {
+            watering_ctrl_plan_t plan;
+            watering_ctrl_plan(&ctrl, &ctrl_cfg, filtered.filtered, &plan);
+            duty = plan.duty;
+            duration_ms = plan.duration_ms;
+            watering_ctrl_begin(&ctrl, filtered.filtered, duty, duration_ms, t);
+        }
+
+        float effective_s = duration_ms / 1000.0f * duty / 255.0f;
+        soil -= true_gain * effective_s;
+        if (soil < wet) {
+            result->runoff_s += (wet - soil) / true_gain;
+            soil = wet;
+        }
+        result->waterings++;
+        result->pump_s += duration_ms / 1000.0f;
+        result->duty_s += effective_s;
+        last_water = t;
+        measure_pending = true;
+    }
+    result->final_gain = adaptive ? ctrl.gain : 0.0f;
+}
+
+static void print_adapt_sim_result(const char* name, const adapt_sim_result_t* r) {
+    Serial.printf("\"%s\":{\"waterings\":%lu,\"pump_s\":%.1f,\"duty_s\":%.1f,\"runoff_s\":%.1f,"
+                  "\"in_band\":%lu,\"observed\":%lu,\"mean_abs_error\":%.0f,\"dry_pct\":%.1f",
+                  name, (unsigned long)r->waterings, r->pump_s, r->duty_s, r->runoff_s,
+                  (unsigned long)r->in_band, (unsigned long)r->observed,
+                  r->observed ? r->abs_error / r->observed : 0.0f,
+                  r->checks ? r->dry_checks * 100.0f / r->checks : 0.0f);
+    if (r->final_gain > 0.0f) Serial.printf(",\"final_gain\":%.1f", r->final_gain);
+    Serial.print("}");
+}
+
+/**
+ * @brief Handle "run adapt [reset|plan <adc>|sim [gain] [days] [seed]]"
+ */
+static void handle_run_adapt(const char* args) {
+    if (strncmp(args, "reset", 5) == 0) {
+        watering_controller_reset();
+        Serial.println("{\"command\":\"run adapt reset\",\"status\":\"success\"}");
+        return;
+    }
+    if (strncmp(args, "plan", 4) == 0) {
+        float current = 0.0f;
+        if (sscanf(args + 4, "%f", &current) != 1) {
+            Serial.println("Error: Usage: run adapt plan <adc>");
+            return;
+        }
+        watering_ctrl_plan_t plan;
+        watering_controller_plan(current, &plan);
+        Serial.printf("{\"command\":\"run adapt plan\",\"status\":\"success\",\"deficit\":%.0f,\"duty\":%u,"
+                      "\"duration_ms\":%lu,\"expected_drop\":%.0f,\"learned\":%s}\r\n",
+                      plan.deficit, plan.duty, (unsigned long)plan.duration_ms, plan.expected_drop,
+                      plan.learned ? "true" : "false");
+        return;
+    }
+    if (strncmp(args, "sim", 3) == 0) {
+        float true_gain = 40.0f;
+        unsigned long days = 14, seed = 1;
+        sscanf(args + 3, "%f %lu %lu", &true_gain, &days, &seed);
+        if (true_gain <= 0.0f || days == 0 || days > 365) {
+            Serial.println("Error: Usage: run adapt sim [gain>0] [days 1-365] [seed]");
+            return;
+        }
+        adapt_sim_result_t fixed;
+        adapt_sim_result_t adaptive;
+        uint32_t start = micros();
+        adapt_sim_run(false, true_gain, days, seed, &fixed);
+        adapt_sim_run(true, true_gain, days, seed, &adaptive);
+        uint32_t elapsed = micros() - start;
+
+        Serial.printf("{\"command\":\"run adapt sim\",\"status\":\"success\",\"true_gain\":%.1f,\"days\":%lu,",
+                      true_gain, days);
+        print_adapt_sim_result("fixed", &fixed);
+        Serial.print(",");
+        print_adapt_sim_result("adaptive", &adaptive);
+        Serial.printf(",\"elapsed_us\":%lu}\r\n", (unsigned long)elapsed);
+        return;
+    }
+
+    watering_ctrl_state_t state;
+    watering_controller_get_state(&state);
+    Serial.printf("{\"command\":\"run adapt\",\"status\":\"success\",\"enabled\":%s,\"gain\":%.1f,"
+                  "\"observations\":%u,\"in_band\":%u,\"last_observed_gain\":%.1f,\"pending\":%s}\r\n",
+                  watering_controller_enabled() ? "true" : "false", state.gain, state.observations,
+                  state.hits, state.last_observed_gain, state.pending ? "true" : "false");
+}
+
+/**
+ * @brief Predictive schedule over a replay trace, scored against checking every sample
+ */
+typedef struct {
+    uint32_t checks;           // Sensor wakes of the predictive schedule
+    uint32_t crossings;        // Watering decisions when checking every sample
+    uint32_t late;             // ...not checked within one sample interval
+    uint64_t total_late_s;
+    uint32_t max_late_s;
+} predict_counts_t;
+
+/**
+ * @brief Replay a trace on the predictive schedule
+ *
+ * Checking every sample defines when the watering decision should start.
+ * The predictive pass feeds only the samples its own forecast asked for into
+ * a fresh filter and drying model, the way the sleep cycle would, and is
+ * scored by how long after each of those starts its next check came: from
+ * there on both schedules confirm at the base interval.
+ */
+static void predict_replay(const uint32_t* times, const uint16_t* values, uint32_t count,
+                           uint32_t base_s, predict_counts_t* counts, drying_model_state_t* p_model) {
+    humidity_filter_config_t filter_cfg;
+    humidity_filter_load_config(&filter_cfg);
+    drying_model_config_t model_cfg;
+    drying_model_load_config(&model_cfg);
+    memset(counts, 0, sizeof(*counts));
+    drying_model_state_init(p_model);
+
+    // Bit 0: decision started when checking every sample, bit 1: predictive check
+    uint8_t* marks = (uint8_t*)calloc(count > 0 ? count : 1, 1);
+    if (marks == nullptr) return;
+
+    humidity_filter_state_t filter;
+    humidity_filter_state_init(&filter);
+    for (uint32_t i = 0; i < count; i++) {
+        humidity_filter_result_t result;
+        humidity_filter_step(&filter, &filter_cfg, values[i], &result);
+        if (result.started) marks[i] |= 1;
+    }
+
+    humidity_filter_state_init(&filter);
+    uint32_t i = 0;
+    while (i < count) {
+        humidity_filter_result_t result;
+        humidity_filter_step(&filter, &filter_cfg, values[i], &result);
+        marks[i] |= 2;
+        counts->checks++;
+        if (result.started) drying_model_on_watering(p_model, times[i]);
+        drying_model_step(p_model, &model_cfg, values[i], times[i]);
+
+        drying_prediction_t prediction;
+        drying_model_predict(p_model, &model_cfg, values[i], times[i], base_s, &prediction);
+        uint32_t next = times[i] + prediction.interval_s;
+        while (++i < count && times[i] < next) {}
+    }
+
+    for (uint32_t start = 0; start < count; start++) {
+        if (!(marks[start] & 1)) continue;
+        uint32_t j = start;
+        while (j < count - 1 && !(marks[j] & 2)) j++;
+        uint32_t late_s = times[j] - times[start];
+        counts->crossings++;
+        counts->total_late_s += late_s;
+        if (late_s > base_s) counts->late++;
+        if (late_s > counts->max_late_s) counts->max_late_s = late_s;
+    }
+    free(marks);
+}
+
+/**
+ * @brief Handle "run predict [reset|replay <history [days]|synth [days] [seed]>]"
+ *
+ * Without arguments shows the live drying model and the interval it would
+ * sleep for now. The replay compares the predictive schedule with checking
+ * at every sample of the trace (one per history interval, the timer-sleep
+ * base): sensor wakes saved, and how late the watering decisions were seen.
+ */
+static void handle_run_predict(const char* args) {
+    if (strncmp(args, "reset", 5) == 0) {
+        drying_model_reset();
+        Serial.println("{\"command\":\"run predict reset\",\"status\":\"success\"}");
+        return;
+    }
+
+    if (strncmp(args, "replay", 6) == 0) {
+        replay_args_t source;
+        if (!parse_replay_args(args + 6, &source)) {
+            Serial.println("Error: Invalid arguments. Usage: run predict replay <history [days]|synth [days] [seed]>");
+            return;
+        }
+
+        replay_buffer_t buf;
+        if (!replay_buffer_alloc(&buf, true)) {
+            print_replay_error("run predict replay", "Out of memory");
+            return;
+        }
+        uint32_t* times = buf.times;
+        uint16_t* values = buf.values;
+
+        hydro_config_t config = ConfigManager::instance().getConfig();
+        uint32_t step_s = SENSOR_HISTORY_INTERVAL_MS / 1000;
+        uint32_t days = source.given >= 1 && source.arg[0] > 0 ? source.arg[0] : (source.synth ? 14 : 7);
+        uint32_t count = 0;
+        if (source.synth) {
+            // Diurnal drying, faster for a few hours after each watering; watered
+            // back to the target a little past the point the filter asks for it
+            count = days * 86400 / step_s;
+            if (count > REPLAY_MAX_SAMPLES) count = REPLAY_MAX_SAMPLES;
+            randomSeed(source.given >= 2 ? source.arg[1] : 1);
+            uint32_t now = ts_store_now();
+            uint32_t start = (now != 0 ? now : 1700000000) - count * step_s;
+            float truth = config.watering.target;
+            uint32_t last_water = start;
+            float water_at = config.watering.threshold + config.watering.hysteresis / 2.0f + PREDICT_SYNTH_OVERSHOOT;
+            for (uint32_t i = 0; i < count; i++) {
+                uint32_t t = start + i * step_s;
+                float rate = sim_drying_rate(t) * (1.0f + expf(-(float)(t - last_water) / 10800.0f));
+                truth += rate * step_s / 3600.0f;
+                if (truth > water_at) {
+                    truth = config.watering.target;
+                    last_water = t;
+                }
+                times[i] = t;
+                values[i] = sim_to_adc(sim_noisy(truth, SIM_NOISE));
+            }
+        } else {
+            if (!replay_load_history(&buf, days)) {
+                replay_buffer_free(&buf);
+                print_replay_error("run predict replay", "History unavailable (clock or tsdb)");
+                return;
+            }
+            count = buf.count;
+        }
+
+        predict_counts_t counts;
+        drying_model_state_t model;
+        uint32_t start_us = micros();
+        predict_replay(times, values, count, step_s, &counts, &model);
+        uint32_t elapsed = micros() - start_us;
+        uint32_t span_s = count > 1 ? times[count - 1] - times[0] : 0;
+        replay_buffer_free(&buf);
+
+        Serial.printf("{\"command\":\"run predict replay\",\"status\":\"success\",\"source\":\"%s\",\"samples\":%lu,"
+                      "\"span_h\":%.1f,\"check_max_s\":%u,\"check_margin_pct\":%u,\"checks\":%lu,"
+                      "\"wake_reduction\":%.1f,\"crossings\":%lu,\"late\":%lu,\"mean_late_s\":%lu,\"max_late_s\":%lu,"
+                      "\"rate\":%.1f,\"after_watering\":%.2f,\"elapsed_us\":%lu}\r\n",
+                      source.source, (unsigned long)count, span_s / 3600.0f, config.system.check_max_s,
+                      config.system.check_margin_pct, (unsigned long)counts.checks,
+                      counts.checks > 0 ? (float)count / counts.checks : 0.0f,
+                      (unsigned long)counts.crossings, (unsigned long)counts.late,
+                      (unsigned long)(counts.crossings > 0 ? counts.total_late_s / counts.crossings : 0),
+                      (unsigned long)counts.max_late_s, model.rate, model.post_factor, (unsigned long)elapsed);
+        return;
+    }
+
+    drying_model_state_t state;
+    drying_model_get_state(&state);
+    drying_prediction_t prediction;
+    uint32_t interval_ms = drying_model_next_interval_ms(RUN_SLEEP_INTERVAL_MS, &prediction);
+    Serial.printf("{\"command\":\"run predict\",\"status\":\"success\",\"observations\":%u,\"rate\":%.1f,"
+                  "\"after_watering\":%.2f,\"buckets\":[",
+                  state.observations, state.rate, state.post_factor);
+    for (uint8_t i = 0; i < DRYING_MODEL_BUCKETS; i++) {
+        Serial.printf("%s%.1f", i > 0 ? "," : "", state.bucket_obs[i] > 0 ? state.bucket_rate[i] : -1.0f);
+    }
+    Serial.printf("],\"last_value\":%.0f,\"learned\":%s,\"current_rate\":%.1f,\"cross_s\":%ld,"
+                  "\"next_sleep_s\":%lu}\r\n",
+                  state.last_value, prediction.learned ? "true" : "false", prediction.rate,
+                  prediction.cross_s == UINT32_MAX ? -1L : (long)prediction.cross_s,
+                  (unsigned long)(interval_ms / 1000));
+}
+
 // --- Command Handler Functions ---
 
 /**
  * @brief Handle "run" command
  *
- * @param args Expected format: "force_water"
+ * @param args Expected format: "force_water", "jitter [...]", "replay [...]", "filter [reset]", "sleep [now]"
+ *             "schedule [check [ms]|reset]", "adapt [reset|plan <adc>|sim [...]]" or "predict [reset|replay [...]]"
  */
 void handle_run(const char* args) {
     char action[20];
     int items = sscanf(args, "%19s", action);
 
+    if (items == 1 && strcmp(action, "jitter") == 0) {
+        handle_run_jitter(args + strlen("jitter") + strspn(args, " "));
+        return;
+    }
+    if (items == 1 && strcmp(action, "replay") == 0) {
+        handle_run_replay(strstr(args, "replay") + strlen("replay"));
+        return;
+    }
+    if (items == 1 && strcmp(action, "filter") == 0) {
+        const char* rest = strstr(args, "filter") + strlen("filter");
+        handle_run_filter(rest + strspn(rest, " "));
+        return;
+    }
+    if (items == 1 && strcmp(action, "adapt") == 0) {
+        const char* rest = strstr(args, "adapt") + strlen("adapt");
+        handle_run_adapt(rest + strspn(rest, " "));
+        return;
+    }
+    if (items == 1 && strcmp(action, "predict") == 0) {
+        const char* rest = strstr(args, "predict") + strlen("predict");
+        handle_run_predict(rest + strspn(rest, " "));
+        return;
+    }
+    if (items == 1 && strcmp(action, "schedule") == 0) {
+        const char* rest = strstr(args, "schedule") + strlen("schedule");
+        handle_run_schedule(rest + strspn(rest, " "));
+        return;
+    }
+    if (items == 1 && strcmp(action, "sleep") == 0) {
+        const char* rest = strstr(args, "sleep") + strlen("sleep");
+        handle_run_sleep(rest + strspn(rest, " "));
+        return;
+    }
+
     if (items != 1 || strcmp(action, "force_water") != 0) {
-        Serial.println("Error: Invalid arguments. Usage: run force_water");
+        Serial.println("Error: Invalid arguments. Usage: run <force_water|jitter|replay|filter|sleep|schedule|adapt|predict>");
         return;
     }
 
@@ -66,7 +893,26 @@ void handle_run(const char* args) {
 // Define all commands provided by this module
 static const CommandRegistryEntry run_commands[] = {
     {"run", handle_run, "RUN mode commands. Usage: run <action>\r\n"
-                       "  - action: force_water (triggers a full watering cycle)"}
+                       "  - action: force_water (triggers a full watering cycle)\r\n"
+                       "  - jitter: main loop iteration gap statistics\r\n"
+                       "  - jitter reset: clear loop statistics\r\n"
+                       "  - jitter bench <sync|async> [ms]: emulate the RUN loop with 1 Hz sensor reads\r\n"
+                       "    and compare blocking vs task-based acquisition\r\n"
+                       "  - replay history [days]: replay recorded humidity through the watering decision,\r\n"
+                       "    raw threshold vs filtered, and count false waterings\r\n"
+                       "  - replay synth [samples] [spike_pct] [seed]: same on a synthetic trace with spikes\r\n"
+                       "  - filter [reset]: show or clear the humidity filter state kept across deep sleep\r\n"
+                       "  - sleep: awake time per deep-sleep cycle (system.run_sleep=1|2)\r\n"
+                       "  - sleep now: save RUN state and deep-sleep until the next check\r\n"
+                       "  - schedule: watering scheduler state (min interval, daily budget, quiet hours)\r\n"
+                       "  - schedule check [ms]: evaluate an automatic watering now without recording it\r\n"
+                       "  - schedule reset: clear the watering record and today's totals\r\n"
+                       "  - adapt [reset]: learned soil response of the adaptive watering controller\r\n"
+                       "  - adapt plan <adc>: duty and duration the controller would use at this reading\r\n"
+                       "  - adapt sim [gain] [days] [seed]: fixed vs adaptive dose on a simulated soil\r\n"
+                       "  - predict [reset]: learned drying rate and the forecast next check\r\n"
+                       "  - predict replay <history [days]|synth [days] [seed]>: predictive check schedule vs\r\n"
+                       "    every history sample, sensor wakes and how late dry soil is seen"}
 };
 
 // --- Public API ---
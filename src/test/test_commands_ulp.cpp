@@ -0,0 +1,266 @@
+/**
+ * @file test_commands_ulp.cpp
+ * @brief ULP sentinel test commands implementation
+ */
+
+#include "test_commands_ulp.h"
+#include "test_command_registry.h"
+#include "managers/ulp_manager.h"
+#include "managers/ulp_sentinel.h"
+#include "managers/log_manager.h"
+#include "managers/power_manager.h"
+#include "data/timing_constants.h"
+#include "hal/hal_rtc.h"
+#include <Arduino.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef TEST_MODE
+
+#define MODEL_MAX_READINGS 64
+
+// --- Helpers ---
+
+// Feeds one reading to the model as ULP_SENTINEL_OVERSAMPLE identical ADC samples
+static ulp_sentinel_wake_t model_feed(ulp_sentinel_state_t* p_state, uint16_t reading) {
+    uint16_t adc[ULP_SENTINEL_OVERSAMPLE];
+    for (uint8_t i = 0; i < ULP_SENTINEL_OVERSAMPLE; i++) adc[i] = reading;
+    return ulp_sentinel_model_step(p_state, adc);
+}
+
+static void print_history(const ulp_sentinel_state_t* p_state) {
+    uint16_t history[ULP_SENTINEL_HISTORY_LEN];
+    uint8_t n = ulp_sentinel_history(p_state, history, ULP_SENTINEL_HISTORY_LEN);
+    Serial.print("  - History:     ");
+    for (uint8_t i = 0; i < n; i++) {
+        Serial.printf("%s%u", i ? "," : "", history[i]);
+    }
+    Serial.println(n ? "" : "(empty)");
+}
+
+// Threshold behaviour vectors: each reading is fed as identical ADC samples.
+// expect_step is the 1-based sample that wakes the CPU (0: no wake within the readings).
+typedef struct {
+    const char* name;
+    uint16_t threshold;
+    uint16_t confirm;
+    uint16_t budget;
+    uint16_t readings[8];
+    uint8_t count;
+    ulp_sentinel_wake_t expect_reason;
+    uint8_t expect_step;
+} model_vector_t;
+
+static const model_vector_t MODEL_VECTORS[] = {
+    {"wet stays asleep",        2000, 2, 100, {1500, 1600, 1700, 1800, 1900, 2000}, 6, ULP_SENTINEL_WAKE_NONE, 0},
+    {"equal is not dry",        2000, 1, 100, {2000, 2000, 2000}, 3, ULP_SENTINEL_WAKE_NONE, 0},
+    {"dry wakes at confirm",    2000, 2, 100, {1500, 2100, 2100}, 3, ULP_SENTINEL_WAKE_THRESHOLD, 3},
+    {"isolated spikes ignored", 2000, 2, 100, {2500, 1500, 2500, 1500, 2500, 1500}, 6, ULP_SENTINEL_WAKE_NONE, 0},
+    {"wet sample resets run",   2000, 3, 100, {2100, 2100, 1900, 2100, 2100, 2100}, 6, ULP_SENTINEL_WAKE_THRESHOLD, 6},
+    {"confirm 1 wakes at once", 2000, 1, 100, {2001}, 1, ULP_SENTINEL_WAKE_THRESHOLD, 1},
+    {"budget runs out",         2000, 2, 3, {1000, 1000, 1000, 1000}, 4, ULP_SENTINEL_WAKE_BUDGET, 3},
+    {"budget 1 wakes at once",  2000, 2, 1, {1000}, 1, ULP_SENTINEL_WAKE_BUDGET, 1},
+    {"dry beats budget",        2000, 1, 2, {1000, 3000}, 2, ULP_SENTINEL_WAKE_THRESHOLD, 2},
+    {"dry run past budget",     2000, 2, 2, {1000, 2500, 2500}, 3, ULP_SENTINEL_WAKE_BUDGET, 2},
+};
+
+static bool run_vector(const model_vector_t* v) {
+    ulp_sentinel_state_t state;
+    ulp_sentinel_model_init(&state, v->threshold, v->confirm, v->budget, 0);
+
+    ulp_sentinel_wake_t reason = ULP_SENTINEL_WAKE_NONE;
+    uint8_t step = 0;
+    for (uint8_t i = 0; i < v->count && reason == ULP_SENTINEL_WAKE_NONE; i++) {
+        reason = model_feed(&state, v->readings[i]);
+        step = i + 1;
+    }
+    if (reason == ULP_SENTINEL_WAKE_NONE) step = 0;
+    return reason == v->expect_reason && step == v->expect_step;
+}
+
+// --- Sub-command Handlers ---
+
+/**
+ * @brief Handles "ulp status"
+ */
+static void handle_ulp_status() {
+    Serial.println("ULP sentinel:");
+    Serial.printf("  - Boot wake:   %s\r\n", ulp_sentinel_wake_name(ulp_manager_get_wake_reason()));
+
+    ulp_sentinel_state_t state;
+    if (ulp_manager_read_state(&state) != ULP_OK) {
+        Serial.println("  - Program:     not loaded (cold boot)");
+        return;
+    }
+    Serial.printf("  - Params:      threshold=%u confirm=%u settle=%ums, %u timer ticks per sample (%u left)\r\n",
+                  state.threshold, state.confirm, state.settle_ms, state.ticks, state.tick);
+    Serial.printf("  - Run:         %u samples, last=%u, above=%u, budget left=%u, wake=%s\r\n",
+                  state.count, state.last, state.above, state.budget,
+                  ulp_sentinel_wake_name((ulp_sentinel_wake_t)state.wake_reason));
+    print_history(&state);
+}
+
+/**
+ * @brief Handles "ulp model <threshold> <confirm> <budget> <r1,r2,...>"
+ * @details Runs the host-side model over a reading sequence and prints one JSON line per sample.
+ */
+static void handle_ulp_model(const char* args) {
+    unsigned threshold, confirm, budget;
+    int consumed = 0;
+    if (sscanf(args, "%u %u %u %n", &threshold, &confirm, &budget, &consumed) < 3 || consumed == 0 ||
+        threshold > 0xFFFF || confirm > 0xFFFF || budget > 0xFFFF) {
+        Serial.println("Error: Usage: ulp model <threshold> <confirm> <budget> <r1,r2,...>");
+        return;
+    }
+
+    ulp_sentinel_state_t state;
+    ulp_sentinel_model_init(&state, threshold, confirm, budget, 0);
+
+    const char* p = args + consumed;
+    uint8_t n = 0;
+    while (*p != '\0' && n < MODEL_MAX_READINGS) {
+        char* end;
+        unsigned long reading = strtoul(p, &end, 10);
+        if (end == p) break;
+        p = (*end == ',') ? end + 1 : end;
+
+        ulp_sentinel_wake_t reason = model_feed(&state, (uint16_t)reading);
+        Serial.printf("{\"sample\":%u,\"reading\":%u,\"above\":%u,\"budget\":%u,\"wake\":\"%s\"}\r\n",
+                      ++n, state.last, state.above, state.budget, ulp_sentinel_wake_name(reason));
+        if (reason != ULP_SENTINEL_WAKE_NONE) break;
+    }
+    if (n == 0) {
+        Serial.println("Error: no readings given");
+        return;
+    }
+    print_history(&state);
+}
+
+/**
+ * @brief Handles "ulp selftest"
+ * @details Checks the model against the threshold/budget vectors and the 16-bit averaging edge cases.
+ */
+static void handle_ulp_selftest() {
+    uint8_t failed = 0;
+    uint8_t total = 0;
+    for (size_t i = 0; i < sizeof(MODEL_VECTORS) / sizeof(MODEL_VECTORS[0]); i++) {
+        bool ok = run_vector(&MODEL_VECTORS[i]);
+        Serial.printf("  - %-24s %s\r\n", MODEL_VECTORS[i].name, ok ? "PASS" : "FAIL");
+        failed += ok ? 0 : 1;
+        total++;
+    }
+
+    // Averaging truncates like the ULP's right shift: (3*2001 + 2000) >> 2 == 2000, not above 2000
+    ulp_sentinel_state_t state;
+    ulp_sentinel_model_init(&state, 2000, 1, 100, 0);
+    const uint16_t truncating[ULP_SENTINEL_OVERSAMPLE] = {2001, 2001, 2001, 2000};
+    bool ok = ulp_sentinel_model_step(&state, truncating) == ULP_SENTINEL_WAKE_NONE && state.last == 2000;
+    Serial.printf("  - %-24s %s\r\n", "average truncates", ok ? "PASS" : "FAIL");
+    failed += ok ? 0 : 1;
+    total++;
+
+    // A latched wake is retried without sampling again
+    ulp_sentinel_model_init(&state, 2000, 1, 100, 0);
+    model_feed(&state, 3000);
+    uint16_t count = state.count;
+    ok = model_feed(&state, 1000) == ULP_SENTINEL_WAKE_THRESHOLD && state.count == count && state.last == 3000;
+    Serial.printf("  - %-24s %s\r\n", "latched wake retried", ok ? "PASS" : "FAIL");
+    failed += ok ? 0 : 1;
+    total++;
+
+    // Timer sub-periods: only every ticks-th run samples, and a latched wake is retried on each run
+    ulp_sentinel_model_init(&state, 2000, 1, 100, 0);
+    state.ticks = 3;
+    bool sampled[6];
+    for (uint8_t i = 0; i < 6; i++) {
+        uint16_t before = state.count;
+        model_feed(&state, 1000);
+        sampled[i] = state.count != before;
+    }
+    ok = sampled[0] && !sampled[1] && !sampled[2] && sampled[3] && !sampled[4] && !sampled[5] &&
+         state.budget == 98 && model_feed(&state, 3000) == ULP_SENTINEL_WAKE_THRESHOLD &&
+         model_feed(&state, 1000) == ULP_SENTINEL_WAKE_THRESHOLD;
+    Serial.printf("  - %-24s %s\r\n", "timer sub-periods", ok ? "PASS" : "FAIL");
+    failed += ok ? 0 : 1;
+    total++;
+
+    // History ring keeps the newest ULP_SENTINEL_HISTORY_LEN readings in order
+    ulp_sentinel_model_init(&state, 4095, 1, 1000, 0);
+    for (uint16_t i = 1; i <= ULP_SENTINEL_HISTORY_LEN + 5; i++) model_feed(&state, i);
+    uint16_t history[ULP_SENTINEL_HISTORY_LEN];
+    uint8_t n = ulp_sentinel_history(&state, history, ULP_SENTINEL_HISTORY_LEN);
+    ok = n == ULP_SENTINEL_HISTORY_LEN && history[0] == 6 && history[n - 1] == ULP_SENTINEL_HISTORY_LEN + 5;
+    Serial.printf("  - %-24s %s\r\n", "history ring order", ok ? "PASS" : "FAIL");
+    failed += ok ? 0 : 1;
+    total++;
+
+    Serial.printf("ULP model selftest: %u/%u passed\r\n", total - failed, total);
+}
+
+/**
+ * @brief Handles "ulp arm [period_s] [threshold]"
+ * @details Arms the sentinel with the configured defaults and enters sentinel deep sleep.
+ */
+static void handle_ulp_arm(const char* args) {
+    ulp_sentinel_params_t params;
+    ulp_manager_default_params(&params);
+
+    unsigned long period_s = 0;
+    unsigned threshold = 0;
+    int parsed = sscanf(args, "%lu %u", &period_s, &threshold);
+    if (parsed >= 1 && period_s > 0) {
+        params.period_ms = period_s * 1000;
+        params.budget = ULP_SENTINEL_MAX_SLEEP_MS / params.period_ms;
+        if (params.budget == 0) params.budget = 1;
+    }
+    if (parsed >= 2 && threshold > 0 && threshold <= 0xFFFF) params.threshold = threshold;
+
+    ulp_result_t result = ulp_manager_arm(&params);
+    if (result != ULP_OK) {
+        Serial.printf("Error: failed to arm sentinel (%d)\r\n", result);
+        return;
+    }
+    Serial.println("Sentinel armed, entering deep sleep. Leave RUN mode or wait for the ULP to wake the CPU.");
+    power_ledger_suspend();
+    log_manager_flush_now();
+    Serial.flush();
+    hal_rtc_enter_sentinel_sleep();
+}
+
+static void handle_ulp(const char* args) {
+    if (strcmp(args, "status") == 0 || args[0] == '\0') {
+        handle_ulp_status();
+        return;
+    }
+    if (strncmp(args, "model", 5) == 0 && (args[5] == '\0' || args[5] == ' ')) {
+        handle_ulp_model(args + 5);
+        return;
+    }
+    if (strcmp(args, "selftest") == 0) {
+        handle_ulp_selftest();
+        return;
+    }
+    if (strncmp(args, "arm", 3) == 0 && (args[3] == '\0' || args[3] == ' ')) {
+        handle_ulp_arm(args + 3);
+        return;
+    }
+    Serial.println("Error: Unknown action. Usage: ulp [status|model|selftest|arm]");
+}
+
+// --- Command Definition ---
+
+static const CommandRegistryEntry ulp_commands[] = {
+    {"ulp", handle_ulp, "ULP sentinel. Usage: ulp <action>\r\n"
+                       "  - ulp status: boot wake reason, sentinel counters and sample history from RTC memory\r\n"
+                       "  - ulp model <threshold> <confirm> <budget> <r1,r2,...>: run the sentinel decision model over readings\r\n"
+                       "  - ulp selftest: check the decision model against threshold/budget vectors\r\n"
+                       "  - ulp arm [period_s] [threshold]: arm the sentinel and enter deep sleep"}
+};
+
+// --- Public API ---
+
+void test_commands_ulp_init() {
+    test_registry_register_commands(ulp_commands, sizeof(ulp_commands) / sizeof(ulp_commands[0]));
+}
+
+#endif // TEST_MODE
@@ -0,0 +1,18 @@
+/**
+ * @file test_commands_ulp.h
+ * @brief ULP sentinel test commands
+ */
+
+#ifndef TEST_COMMANDS_ULP_H
+#define TEST_COMMANDS_ULP_H
+
+#ifdef TEST_MODE
+
+/**
+ * @brief Initializes and registers ULP sentinel test commands.
+ */
+void test_commands_ulp_init();
+
+#endif // TEST_MODE
+
+#endif // TEST_COMMANDS_ULP_H
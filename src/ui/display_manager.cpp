@@ -16,6 +16,7 @@
 #include "hal/hal_gpio.h" // 引入GPIO HAL以设置引脚模式
 #include "managers/power_manager.h"
 #include "managers/log_manager.h"
+#include "data/timing_constants.h"
 
 // 使用 Waveshare 2.9" Rev2.1 (SSD1680, GDEM029T94) 对应的 GxEPD2 驱动类
 static GxEPD2_BW<GxEPD2_290_T94_V2, GxEPD2_290_T94_V2::HEIGHT> s_display(
@@ -46,6 +47,14 @@ static void display_refresh_task(void* parameter) {
         // Wait for refresh request from queue
         if (xQueueReceive(s_refresh_queue, &request, portMAX_DELAY) == pdTRUE) {
             if (s_initialized) {
+                // Hold a screen rail lease for the whole refresh so that a mode exit
+                // releasing its own lease cannot cut power mid-frame
+                bool was_on = false;
+                bool leased = power_rail_acquire(POWER_RAIL_SCREEN, &was_on) == POWER_OK;
+                if (leased && !was_on) {
+                    vTaskDelay(pdMS_TO_TICKS(POWER_STABILIZATION_DELAY_MS));
+                }
+
                 LOG_INFO("Display", ">>> refresh START (full=%d)", request.full_refresh);
 
                 // This is the blocking operation, but it runs in dedicated task
@@ -53,6 +62,10 @@ static void display_refresh_task(void* parameter) {
 
                 LOG_INFO("Display", "<<< refresh END");
 
+                if (leased) {
+                    power_rail_release(POWER_RAIL_SCREEN);
+                }
+
                 // Signal completion if semaphore exists (for blocking refresh)
                 if (s_refresh_complete_semaphore != NULL) {
                     xSemaphoreGive(s_refresh_complete_semaphore);
@@ -73,8 +86,8 @@ display_result_t display_manager_init() {
         return DISPLAY_OK;
     }
 
-    // 1) 打开墨水屏电源
-    power_result_t pwr = power_screen_enable(true);
+    // 1) 打开墨水屏电源（初始化期间持有租约，之后由刷新任务和模式管理器各自持有）
+    power_result_t pwr = power_rail_acquire(POWER_RAIL_SCREEN, nullptr);
     if (pwr != POWER_OK) {
         LOG_ERROR("Display", "Failed to enable screen power: %d", pwr);
         return DISPLAY_ERROR_POWER_FAILED;
@@ -85,6 +98,7 @@ display_result_t display_manager_init() {
     SPIClass* spi = hal_spi_get_display_bus();
     if (spi == nullptr) {
         LOG_ERROR("Display", "SPI bus is null");
+        power_rail_release(POWER_RAIL_SCREEN);
         return DISPLAY_ERROR_HW_FAILED;
     }
 
@@ -104,6 +118,7 @@ display_result_t display_manager_init() {
     // 基本渲染设置
     s_display.setRotation(1);         // 横屏
     s_display.setTextColor(GxEPD_BLACK);
+    power_rail_release(POWER_RAIL_SCREEN);
 
     // 首次全屏清屏，建立干净基线，避免局部刷新伪影
     // s_display.fillScreen(GxEPD_WHITE);